@@ -0,0 +1,242 @@
+// Micro-benchmarks of the Board operations every frame and every bot search leans on.
+//
+// Boards are set up from fixed layouts (LoadRows rewrites the grid of a saved
+// state), so each run measures the same positions.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TetrisEngine/Board.h"
+#include "TetrisEngine/ByteStream.h"
+#include "TetrisEngine/Game.h"
+
+using namespace tetris;
+
+namespace {
+    constexpr unsigned int SEED = 7;
+
+    constexpr PieceType ROTATING_PIECES[] = {
+        PieceType::I, PieceType::J, PieceType::L, PieceType::S, PieceType::T, PieceType::Z
+    };
+
+    // A ragged 12-row stack: no full rows, a few covered holes
+    const std::vector<std::string> RAGGED_STACK = {
+        "GGGG.GGGGG",
+        "GGGGG.GGGG",
+        "GG.GGGGGGG",
+        "GGGGGGG.GG",
+        "G.GGGGGGGG",
+        "GGGGGG.GGG",
+        "GGG.GGGGG.",
+        ".GGGGG.GGG",
+        "GGG..GGG.G",
+        ".GG..G..GG",
+        "..G..G...G",
+        ".....G....",
+    };
+
+    /**
+     * Replace the locked cells, keeping everything else about the board.
+     * @param rows Bottom row first, '.' for empty; rows above them are cleared
+     */
+    void LoadRows(Board& board, const std::vector<std::string>& rows) {
+        ByteWriter saved;
+        board.SaveState(saved);
+
+        // Skip the saved grid, a run-length list covering every cell
+        ByteReader reader(saved.Data(), saved.Size());
+        for (size_t cells = 0; cells < TOTAL_BOARD_HEIGHT * BOARD_WIDTH;) {
+            cells += reader.GetVarint();
+            reader.GetU8();
+        }
+
+        ByteWriter state;
+        for (const std::string& row : rows) {
+            if (row.size() != BOARD_WIDTH) throw std::invalid_argument("Row " + row + " is not one board wide");
+            for (char cell : row) {
+                state.PutVarint(1);
+                state.PutU8(static_cast<uint8_t>(cell == '.' ? PieceType::EMPTY : PieceType::G));
+            }
+        }
+        state.PutVarint((TOTAL_BOARD_HEIGHT - rows.size()) * BOARD_WIDTH);
+        state.PutU8(static_cast<uint8_t>(PieceType::EMPTY));
+        state.PutBytes(reader.Current(), reader.Remaining());
+
+        ByteReader in(state.Data(), state.Size());
+        board.LoadState(in);
+    }
+
+    void Settle(Board& board, int dx) {
+        while (board.MoveActivePiece(dx, 0)) {}
+        while (board.MoveActivePiece(0, -1)) {}
+    }
+}
+
+// Every piece and rotation at random spots over a ragged stack, in bounds and out, free and blocked
+static void BM_IsValidPosition(benchmark::State& state) {
+    Game game(1, SEED);
+    Board& board = game.getBoard(0);
+    LoadRows(board, RAGGED_STACK);
+
+    struct Candidate { uint16_t repr; Point position; };
+    std::vector<Candidate> candidates(4096);
+    std::mt19937 rng(SEED);
+    for (Candidate& candidate : candidates) {
+        const auto piece = board.CreatePieceByType(static_cast<PieceType>(1 + rng() % 7));
+        candidate.repr = piece->GetRepresentation(static_cast<RotationState>(rng() % 4));
+        candidate.position = Point(static_cast<int>(rng() % 13) - 2, static_cast<int>(rng() % 16));
+    }
+
+    size_t next = 0;
+    for (auto _ : state) {
+        const Candidate& candidate = candidates[next];
+        benchmark::DoNotOptimize(board.IsValidPosition(candidate.repr, candidate.position));
+        next = (next + 1) % candidates.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IsValidPosition);
+
+// Open air: the first kick test passes. One board per piece but O, each rotated once per iteration.
+static void BM_RotateActivePiece_Open(benchmark::State& state) {
+    constexpr size_t PIECES = std::size(ROTATING_PIECES);
+    Game game(PIECES, SEED);
+    for (size_t i = 0; i < PIECES; ++i) {
+        Board& board = game.getBoard(i);
+        board.SpawnNewPiece(ROTATING_PIECES[i]);
+        for (int row = 0; row < 6; ++row) board.MoveActivePiece(0, -1);
+    }
+    const auto direction = static_cast<RotationDirection>(state.range(0));
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < PIECES; ++i) benchmark::DoNotOptimize(game.getBoard(i).RotateActivePiece(direction));
+    }
+    state.SetItemsProcessed(state.iterations() * PIECES);
+}
+BENCHMARK(BM_RotateActivePiece_Open)->ArgName("direction")->DenseRange(0, 2);
+
+// A vertical I sunk into a one-wide well: every kick is tested and fails, the worst case
+static void BM_RotateActivePiece_Blocked(benchmark::State& state) {
+    Game game(1, SEED);
+    Board& board = game.getBoard(0);
+    LoadRows(board, std::vector<std::string>(8, ".GGGGGGGGG"));
+    board.SpawnNewPiece(PieceType::I);
+    board.RotateActivePiece(RotationDirection::CLOCKWISE);
+    Settle(board, -1);
+    const auto direction = static_cast<RotationDirection>(state.range(0));
+    if (board.RotateActivePiece(direction)) {
+        state.SkipWithError("The well did not block the rotation");
+        return;
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(board.RotateActivePiece(direction));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RotateActivePiece_Blocked)->ArgName("direction")->Arg(0)->Arg(1);
+
+// Spawn an O, shift it to one of five column pairs and hard drop it; every fifth drop clears two lines
+static void BM_HardDropActivePiece(benchmark::State& state) {
+    Game game(1, SEED);
+    Board& board = game.getBoard(0);
+
+    int column = 0;
+    for (auto _ : state) {
+        board.SpawnNewPiece(PieceType::O);
+        while (board.MoveActivePiece(-1, 0)) {}
+        for (int i = 0; i < column; ++i) board.MoveActivePiece(1, 0);
+        board.HardDropActivePiece();
+        column = (column + 2) % BOARD_WIDTH;
+    }
+    if (board.IsGameOver()) state.SkipWithError("The drops topped out");
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HardDropActivePiece);
+
+// A full scan of a 12-row stack, with that many full rows at the bottom to clear. Clearing
+// changes the board, so a batch of copies is restored per pause and cleared one per iteration:
+// pausing the timer costs more than a clear, and would swamp it if done every time.
+static void BM_ClearFullLines(benchmark::State& state) {
+    constexpr size_t BATCH = 256;
+    Game game(BATCH, SEED);
+    const int full = static_cast<int>(state.range(0));
+
+    std::vector<std::string> rows(full, "GGGGGGGGGG");
+    rows.insert(rows.end(), RAGGED_STACK.begin(), RAGGED_STACK.end() - full);
+    LoadRows(game.getBoard(0), rows);
+    ByteWriter saved;
+    game.getBoard(0).SaveState(saved);
+    auto restore = [&] {
+        for (size_t i = 0; i < BATCH; ++i) {
+            ByteReader in(saved.Data(), saved.Size());
+            game.getBoard(i).LoadState(in);
+        }
+    };
+    restore();
+
+    size_t next = 0;
+    for (auto _ : state) {
+        if (next == BATCH) {
+            state.PauseTiming();
+            restore();
+            state.ResumeTiming();
+            next = 0;
+        }
+        benchmark::DoNotOptimize(game.getBoard(next).ClearFullLines());
+        next += full > 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ClearFullLines)->ArgName("lines")->Arg(0)->Arg(1)->Arg(2)->Arg(4);
+
+// Queue a packet and raise it; the grid wraps, so the board never fills up
+static void BM_InsertGarbage(benchmark::State& state) {
+    Game game(1, SEED);
+    Board& board = game.getBoard(0);
+    const int lines = static_cast<int>(state.range(0));
+
+    for (auto _ : state) {
+        board.AddGarbageToQueue(lines);
+        board.InsertGarbage();
+    }
+    state.SetItemsProcessed(state.iterations() * lines);
+}
+BENCHMARK(BM_InsertGarbage)->ArgName("lines")->Arg(1)->Arg(4)->Arg(8);
+
+static void BM_SpawnRandomPiece(benchmark::State& state) {
+    Game game(1, SEED);
+    Board& board = game.getBoard(0);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(board.SpawnRandomPiece());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SpawnRandomPiece);
+
+// The allocating overload, and the one the spectator fills its tiles with
+static void BM_GetRenderableState(benchmark::State& state) {
+    Game game(1, SEED);
+    Board& board = game.getBoard(0);
+    LoadRows(board, RAGGED_STACK);
+    board.SpawnNewPiece(PieceType::T);
+
+    std::vector<PieceType> buffer(VISIBLE_BOARD_HEIGHT * BOARD_WIDTH);
+    for (auto _ : state) {
+        if (state.range(0)) {
+            board.GetRenderableState(buffer.data());
+            benchmark::DoNotOptimize(buffer.data());
+        } else {
+            benchmark::DoNotOptimize(board.GetRenderableState());
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetRenderableState)->ArgName("into_buffer")->Arg(0)->Arg(1);
@@ -0,0 +1,96 @@
+// Macro-benchmarks: whole headless games on fixed seeds.
+//
+// Every iteration plays the same SEED_COUNT games, so the rates are comparable
+// between runs and commits. Scripted games drive the engine alone with random
+// inputs; bot games go through MatchArena as tetris_farm does, bot search included.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+
+#include "TetrisEngine/Bot.h"
+#include "TetrisEngine/Farm.h"
+#include "TetrisEngine/Game.h"
+#include "TetrisEngine/Metrics.h"
+
+using namespace tetris;
+
+namespace {
+    constexpr uint64_t BASE_SEED = 2024;
+    constexpr uint64_t SEED_COUNT = 4;
+    constexpr uint64_t MAX_FRAMES = 3 * 60 * Game::FRAMES_PER_SECOND;
+
+    struct GameTotals {
+        uint64_t frames = 0;
+        uint64_t pieces = 0;
+        uint64_t attack = 0;
+    };
+
+    void SetGameCounters(benchmark::State& state, const GameTotals& totals) {
+        using benchmark::Counter;
+        state.counters["games"] = Counter(static_cast<double>(state.iterations() * SEED_COUNT), Counter::kIsRate);
+        state.counters["frames"] = Counter(static_cast<double>(totals.frames), Counter::kIsRate);
+        state.counters["pieces"] = Counter(static_cast<double>(totals.pieces), Counter::kIsRate);
+        if (totals.attack) state.counters["attack"] = Counter(static_cast<double>(totals.attack), Counter::kIsRate);
+    }
+}
+
+// Random inputs every few frames until every board tops out or the game hits three minutes
+static void BM_ScriptedGame(benchmark::State& state) {
+    const size_t players = static_cast<size_t>(state.range(0));
+    Game game(players, 0);
+    GameTotals totals;
+
+    // Pieces lock by gravity as well as by hard drops; the boards count every lock
+    auto locks = [] { return metrics::Collect().counters[static_cast<size_t>(metrics::Counter::PIECES)]; };
+    const uint64_t locksBefore = locks();
+
+    for (auto _ : state) {
+        for (uint64_t s = 0; s < SEED_COUNT; ++s) {
+            const uint64_t seed = MatchSeed(BASE_SEED, s);
+            game.Reset(static_cast<unsigned int>(seed));
+            std::mt19937 script(static_cast<uint32_t>(seed));
+
+            size_t alive = players;
+            for (uint64_t frame = 0; frame < MAX_FRAMES && alive; ++frame) {
+                for (size_t player = 0; player < players; ++player) {
+                    if (script() % 4) continue;
+                    const auto input = static_cast<InputType>(script() % (INPUT_TYPE_COUNT - 1));
+                    game.ApplyInput(player, input);
+                }
+                game.StepFrame();
+                ++totals.frames;
+
+                alive = 0;
+                for (size_t player = 0; player < players; ++player) alive += !game.getBoard(player).IsGameOver();
+            }
+        }
+    }
+    totals.pieces = locks() - locksBefore;
+    SetGameCounters(state, totals);
+}
+BENCHMARK(BM_ScriptedGame)->ArgName("players")->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+// The default heuristic bot: alone, or in a garbage duel against itself
+static void BM_BotGame(benchmark::State& state) {
+    const size_t players = static_cast<size_t>(state.range(0));
+    const HeuristicBot bot;
+    const Bot* bots[MATCH_MAX_PLAYERS] = {&bot, &bot};
+    const MatchConfig config;
+    MatchArena arena;
+    GameTotals totals;
+
+    for (auto _ : state) {
+        for (uint64_t s = 0; s < SEED_COUNT; ++s) {
+            const MatchResult result = arena.Play(bots, players, MatchSeed(BASE_SEED, s), config);
+            totals.frames += result.frames;
+            for (size_t p = 0; p < result.playerCount; ++p) {
+                totals.pieces += result.players[p].pieces;
+                totals.attack += result.players[p].attack;
+            }
+        }
+    }
+    SetGameCounters(state, totals);
+}
+BENCHMARK(BM_BotGame)->ArgName("players")->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
@@ -21,12 +21,18 @@ def main():
                       help='Disable building test executables')
     parser.set_defaults(build_tests=False)
     
+    # build the benchmark suite? Needs Google Benchmark (vcpkg install benchmark)
+    parser.add_argument('--bench', action='store_true', dest='build_benchmarks', help='Build the tetris_bench benchmarks')
+    
     # run files right after compilation?
     parser.add_argument('--run', action='store_true', help='run files immediately after compilation')
     
     # update doxygen documents?
     parser.add_argument('--document', action='store_true', dest='document', help='update doxygen files')
     
+    # compile profiling zones in?
+    parser.add_argument('--profile', action='store_true', help='Compile profiling zones in (see --trace)')
+    
     # use cache?
     parser.add_argument('--use-cache', action='store_true', dest='use_cache', help='Reuse existing build directory (skip deletion)')
         
@@ -61,9 +67,11 @@ def main():
         "-DCMAKE_BUILD_TYPE=Release",
         "-DENABLE_NN=ON",
         f"-DBUILD_TESTS={'ON' if args.build_tests else 'OFF'}",
+        f"-DBUILD_BENCHMARKS={'ON' if args.build_benchmarks else 'OFF'}",
         f"-DUSE_GPU=OFF",
         f"-DCMAKE_TOOLCHAIN_FILE={vcpkg_root}/scripts/buildsystems/vcpkg.cmake",
-        f"-DBUILD_DOC={'ON' if args.document else 'OFF'}"
+        f"-DBUILD_DOC={'ON' if args.document else 'OFF'}",
+        f"-DENABLE_PROFILE={'ON' if args.profile else 'OFF'}"
     ]
 
     # Run the CMake configuration command
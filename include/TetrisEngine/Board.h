@@ -20,7 +20,9 @@ Cols: 0 1 2 3 4 5 6 7 8 9 (x)
 
 #include "UtilFunctions.h"
 #include "Piece.h"
+#include "Rules.h"
 #include "Game.h"
+#include "GameEvents.h"
 #include <vector>
 #include <array>
 #include <queue>
@@ -31,10 +33,7 @@ Cols: 0 1 2 3 4 5 6 7 8 9 (x)
 
 namespace tetris {
 
-// Board dimensions and constants
-constexpr int BOARD_WIDTH = 10;
-constexpr int VISIBLE_BOARD_HEIGHT = 20; // Rows 0 to 19 from bottom are visible
-constexpr int TOTAL_BOARD_HEIGHT = 27;   // Rows 0 to 26 from bottom. Rows 20-26 are buffer/spawn area.
+// Board dimensions and constants live in Rules.h
 
 // Helper to define rotation transitions for SRS kicks
 enum class RotationDirection {
@@ -75,6 +74,11 @@ class Board {
          * Clears grid, resets score, and spawns the first piece.
          */
         void Reset();
+
+        /**
+         * @brief Reset as a freshly constructed board with this seed would start.
+         */
+        void Reset(unsigned int seed);
         /**
          * @brief Spawn a specific piece type.
          * @param type PieceType to spawn
@@ -121,6 +125,11 @@ class Board {
          */
         bool HasActivePiece() const { return currentPiece != nullptr; }
 
+        /**
+         * @brief returns true if the active piece may still be swapped with hold
+         */
+        bool CanHold() const { return canHold; }
+
     private: 
         std::unique_ptr<Piece> held_piece;
         bool canHold;
@@ -144,6 +153,22 @@ class Board {
          */
         PieceType GetCellState(int col, int row_from_bottom) const;
 
+        /**
+         * @brief Get occupancy of a row as a bitmask.
+         * @param row_from_bottom Vertical position (0 = bottom row)
+         * @return Bit c set if column c holds a locked cell (active piece excluded)
+         * @warning Returns 0 for invalid rows
+         */
+        uint16_t GetRowMask(int row_from_bottom) const;
+
+        /**
+         * @brief Get a stamp for the locked cells.
+         * @return Value that changes whenever locked cells may have changed (lock, clear, garbage, reset),
+         *         and on LoadState only if the restored cells differ
+         * @note Stamps are unique across boards, so a cache keyed by board address never mistakes a new board for an old one
+         */
+        uint64_t GetGridVersion() const { return gridVersion; }
+
         /**
          * @brief Access active tetromino.
          * @return Raw pointer to current piece (nullptr if none active)
@@ -157,6 +182,12 @@ class Board {
          */
         Point GetCurrentPiecePosition() const { return currentPieceTopLeftPos; }
 
+        /**
+         * @brief Get where the active piece would land if hard dropped.
+         * @return Top-left coordinate of the ghost; the piece position if it already rests or there is no piece
+         */
+        Point GetGhostPosition() const;
+
         /**
          * @brief Retrieve held piece type.
          * @return PieceType in hold slot, PieceType::EMPTY if none
@@ -175,6 +206,12 @@ class Board {
          */
         int GetLinesCleared() const { return linesClearedTotal; }
 
+        /**
+         * @brief Get total attack.
+         * @return Garbage lines generated this game, before any cancellation
+         */
+        int GetAttackTotal() const { return attackTotal; }
+
         /**
          * @brief Get current back to back. 
          * @return Current B2B chain
@@ -201,11 +238,49 @@ class Board {
          */
         std::vector<PieceType> GetRenderableState() const;
 
+        /**
+         * @brief Write the visible board state into a caller-owned buffer, without allocating.
+         * @param out VISIBLE_BOARD_HEIGHT * BOARD_WIDTH cells, laid out as GetRenderableState
+         */
+        void GetRenderableState(PieceType* out) const;
+
         /**
          * @brief Get upcoming pieces.
          * @return Next 5 pieces in queue. Represented as PieceType.
          */
         std::vector<PieceType> GetNextQueue() const;
+
+        /**
+         * @brief Write the upcoming pieces into a caller-owned buffer, without allocating.
+         * @param out 5 pieces, next first, as GetNextQueue
+         */
+        void GetNextQueue(PieceType* out) const;
+
+        /**
+         * @brief 64-bit hash of everything that affects a position's evaluation.
+         * @return Hash of locked cells, active piece (type, rotation, position), hold, next queue,
+         *         B2B, combo and pending garbage
+         * @note Score, timers and RNG state are deliberately excluded
+         */
+        uint64_t Hash() const;
+
+        /**
+         * @brief Append the complete board state (cells, pieces, bag, RNG, counters, timers).
+         * @note Typically 60-150 bytes: the grid is run-length encoded and counters are varints
+         */
+        void SaveState(ByteWriter& out) const;
+
+        /**
+         * @brief Restore state written by SaveState. The player ID and owning Game are kept.
+         * @throws std::runtime_error if the data is truncated or invalid
+         */
+        void LoadState(ByteReader& in);
+
+        /**
+         * @brief Events this board has emitted, for readers on any thread.
+         * @note LoadState emits nothing; readers that fold events should resync from the getters after one
+         */
+        const GameEventRing& GetEvents() const { return events; }
         /// @}
 
         // Iterator for board cells
@@ -257,13 +332,16 @@ class Board {
 
     private:
         std::array<PieceType, TOTAL_BOARD_HEIGHT * BOARD_WIDTH> grid;
+        uint64_t gridVersion = 0;
 
         std::unique_ptr<Piece> currentPiece;
         Point currentPieceTopLeftPos;
 
         bool isGameOverFlag;
+        GameEventRing events;
         int score;
         int linesClearedTotal;
+        int attackTotal;
     // Could add: level
 
         /// @name Internal Game Logic
@@ -310,11 +388,15 @@ class Board {
          */
         bool IsValidPosition(uint16_t piece_representation, Point top_left_pos) const;
 
+        /// AddGarbageToQueue: garbage that no attack sent, e.g. added from the UI
+        static constexpr uint64_t NO_SENT_FRAME = ~uint64_t{0};
+
         /**
          * @brief Adds garbage lines to the garbage queue
          * @param int number of lines to add to the queue
+         * @param sentFrame Game frame the attack was sent on, for the garbage delay metric
          */
-        void AddGarbageToQueue(int lines);
+        void AddGarbageToQueue(int lines, uint64_t sentFrame = NO_SENT_FRAME);
 
         /**
          * @brief Sends all garbage in the queue to the bottom of the board
@@ -329,8 +411,10 @@ class Board {
 
     private:
         std::queue<int> garbage_queue;
+        std::queue<uint64_t> garbage_sent_frames;   ///< Per garbage_queue entry, for the garbage delay metric
         int garbage_count;
         int hole_col;
+        SeekableRng garbageRng;
         /// @}
 
         /// @name Piece Factory
@@ -344,7 +428,12 @@ class Board {
         std::unique_ptr<Piece> CreatePieceByType(PieceType type);
 
     private:
-        std::mt19937 rng;
+        /**
+         * @brief Upcoming piece i (0 = next) without building the whole queue.
+         */
+        PieceType PeekNext(size_t i) const;
+
+        SeekableRng rng;
         std::vector<PieceType> grab_bag;
         std::vector<PieceType> grab_bag_next;
         size_t index;
@@ -381,6 +470,11 @@ class Board {
         bool IsAllMiniSpin() const;
 
     private:
+        /**
+         * @brief An event stamped with the frame, pending garbage, the active piece if any and, for SPAWN and GAME_OVER, the next queue.
+         */
+        GameEvent MakeEvent(GameEventType type) const;
+
         int back_to_back;
         int combo;
         mutable bool lastMoveWasRotation;
@@ -0,0 +1,173 @@
+#ifndef BOT_H
+#define BOT_H
+
+// Placement-level players for headless games (self-play, tuning, evaluation).
+//
+// A bot scores every action of a position in the VecEnv action space
+// (hold * PLACEMENT_COUNT + placement). Bots are stateless, so one instance can
+// score positions from any number of threads at once.
+
+#include "Features.h"
+#include "Rules.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace tetris {
+
+class NeuralNetwork;
+
+constexpr int BOT_ACTION_COUNT = 2 * PLACEMENT_COUNT;
+
+/**
+ * @brief A position to move from, in rules-kernel form.
+ */
+struct BotPosition {
+    const uint16_t* rows = nullptr;  ///< TOTAL_BOARD_HEIGHT row masks
+    PieceType current = PieceType::EMPTY;
+    PieceType hold = PieceType::EMPTY;
+    std::array<PieceType, FEATURE_NEXT_PIECES> next{};
+    int backToBack = 0;
+    int combo = 0;
+};
+
+/**
+ * @brief Position reached by one action, with the piece queue advanced.
+ */
+struct AfterState {
+    std::array<uint16_t, TOTAL_BOARD_HEIGHT> rows{};
+    PieceType current = PieceType::EMPTY;                ///< Piece spawning next
+    PieceType hold = PieceType::EMPTY;
+    std::array<PieceType, FEATURE_NEXT_PIECES> next{};  ///< Slots past the known queue are EMPTY
+    int lines = 0;
+    int attack = 0;
+    int backToBack = 0;
+    int combo = 0;
+    bool toppedOut = false;  ///< The next piece cannot spawn
+};
+
+/**
+ * @brief Play one action on a copy of the position.
+ * @return false if the action is illegal
+ */
+bool ApplyAction(const BotPosition& position, int action, AfterState& out);
+
+class Bot {
+    public:
+        virtual ~Bot() = default;
+
+        /**
+         * @brief Score every action; higher is better.
+         * @param mask BOT_ACTION_COUNT legal-action flags
+         * @param scores Receives BOT_ACTION_COUNT scores, -infinity for illegal actions
+         */
+        virtual void ScoreActions(const BotPosition& position, const uint8_t* mask, float* scores) const = 0;
+
+        virtual std::string GetName() const = 0;
+
+        /**
+         * @brief Placements looked ahead when scoring an action; 1 scores the after-state itself.
+         */
+        virtual int GetSearchDepth() const { return 1; }
+};
+
+/**
+ * @brief What a bot's decisions have cost, counted by whoever asks for them (see MatchArena).
+ */
+struct BotSearchStats {
+    uint64_t decisions = 0;   ///< ScoreActions calls, one per piece placed
+    uint64_t nodes = 0;       ///< Legal actions scored over all decisions
+    uint64_t searchNs = 0;    ///< Time spent in ScoreActions
+    int depth = 0;            ///< Deepest GetSearchDepth among the bots asked
+};
+
+/**
+ * @brief Model calls made by a NetworkBot so far.
+ */
+struct InferenceStats {
+    uint64_t batches = 0;     ///< Model runs, one per decision with a legal non-topping-out action
+    uint64_t positions = 0;   ///< After-states evaluated over all batches
+    uint64_t totalNs = 0;     ///< Time inside the model runs
+};
+
+/**
+ * @brief Linear evaluation weights for HeuristicBot.
+ */
+struct HeuristicWeights {
+    float aggregateHeight = -0.510066f;
+    float lines = 0.760666f;
+    float holes = -0.35663f;
+    float bumpiness = -0.184483f;
+    float attack = 0.5f;
+    float topOut = -100.0f;
+};
+
+/**
+ * @brief Read weights from "name = value" lines; '#' starts a comment, missing names keep their defaults.
+ * @throws std::runtime_error if the file cannot be read or names an unknown weight
+ */
+HeuristicWeights LoadHeuristicWeights(const std::filesystem::path& path);
+
+/**
+ * @brief Write weights in the format LoadHeuristicWeights reads.
+ * @throws std::runtime_error if the file cannot be written
+ */
+void SaveHeuristicWeights(const std::filesystem::path& path, const HeuristicWeights& weights);
+
+/**
+ * @brief One-ply greedy bot scoring each after-state with a linear evaluation.
+ */
+class HeuristicBot : public Bot {
+    public:
+        explicit HeuristicBot(HeuristicWeights weights = {});
+
+        void ScoreActions(const BotPosition& position, const uint8_t* mask, float* scores) const override;
+        std::string GetName() const override { return "heuristic"; }
+
+        /**
+         * @brief Evaluate an after-state.
+         */
+        float Evaluate(const AfterState& state) const;
+
+        const HeuristicWeights& GetWeights() const { return m_weights; }
+
+    private:
+        HeuristicWeights m_weights;
+};
+
+/**
+ * @brief One-ply bot scoring each after-state as attack plus the network's value.
+ *
+ * All legal after-states of a position go through the network as one batch.
+ */
+class NetworkBot : public Bot {
+    public:
+        /**
+         * @param network Must outlive the bot; its first output is read as the value
+         * @param topOutScore Score of actions that top out
+         */
+        explicit NetworkBot(const NeuralNetwork& network, float topOutScore = -100.0f);
+
+        void ScoreActions(const BotPosition& position, const uint8_t* mask, float* scores) const override;
+        std::string GetName() const override { return "model"; }
+
+        /**
+         * @brief Any thread: batches run so far, over every thread scoring with this bot.
+         */
+        InferenceStats GetInferenceStats() const noexcept;
+
+    private:
+        const NeuralNetwork& m_network;
+        float m_topOutScore;
+
+        // Shared by every scoring thread; one update per batch
+        mutable std::atomic<uint64_t> m_batches{0};
+        mutable std::atomic<uint64_t> m_positions{0};
+        mutable std::atomic<uint64_t> m_batchNs{0};
+};
+
+} // namespace tetris
+
+#endif // BOT_H
@@ -0,0 +1,194 @@
+#ifndef BYTESTREAM_H
+#define BYTESTREAM_H
+
+// Little-endian binary encoding helpers for replays and saved game state.
+//
+// Fixed-width values are written byte by byte so the output is the same on every
+// platform. Counters and small integers use LEB128 varints (signed values are
+// zigzag-encoded first), which keeps typical board state to a few bytes per field.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace tetris {
+
+class ByteWriter {
+    public:
+        void PutU8(uint8_t value) { m_buffer.push_back(value); }
+
+        void PutU16(uint16_t value) { _putFixed(value, 2); }
+        void PutU32(uint32_t value) { _putFixed(value, 4); }
+        void PutU64(uint64_t value) { _putFixed(value, 8); }
+
+        void PutDouble(double value) {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            PutU64(bits);
+        }
+
+        /**
+         * @brief Unsigned LEB128: 7 bits per byte, high bit set on all but the last.
+         */
+        void PutVarint(uint64_t value) {
+            while (value >= 0x80) {
+                m_buffer.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            m_buffer.push_back(static_cast<uint8_t>(value));
+        }
+
+        /**
+         * @brief Zigzag-encoded varint, so small negative values stay short.
+         */
+        void PutSigned(int64_t value) {
+            PutVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+        }
+
+        void PutBytes(const void* data, size_t size) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+        }
+
+        size_t Size() const noexcept { return m_buffer.size(); }
+        const uint8_t* Data() const noexcept { return m_buffer.data(); }
+        const std::vector<uint8_t>& GetBuffer() const noexcept { return m_buffer; }
+        void Clear() noexcept { m_buffer.clear(); }
+
+    private:
+        void _putFixed(uint64_t value, int bytes) {
+            for (int i = 0; i < bytes; ++i) {
+                m_buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+            }
+        }
+
+        std::vector<uint8_t> m_buffer;
+};
+
+/**
+ * @brief Reads what ByteWriter wrote.
+ *
+ * Every getter checks bounds, so truncated or corrupt input throws instead of
+ * reading past the end.
+ * @note Does not own the data; it must outlive the reader
+ */
+class ByteReader {
+    public:
+        ByteReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+        uint8_t GetU8() {
+            _require(1);
+            return m_data[m_position++];
+        }
+
+        uint16_t GetU16() { return static_cast<uint16_t>(_getFixed(2)); }
+        uint32_t GetU32() { return static_cast<uint32_t>(_getFixed(4)); }
+        uint64_t GetU64() { return _getFixed(8); }
+
+        double GetDouble() {
+            uint64_t bits = GetU64();
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        /**
+         * @throws std::runtime_error on truncation or a varint longer than 64 bits
+         */
+        uint64_t GetVarint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                uint8_t byte = GetU8();
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) return value;
+            }
+            throw std::runtime_error("Malformed varint");
+        }
+
+        int64_t GetSigned() {
+            uint64_t value = GetVarint();
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        void GetBytes(void* out, size_t size) {
+            _require(size);
+            std::memcpy(out, m_data + m_position, size);
+            m_position += size;
+        }
+
+        void Skip(size_t size) {
+            _require(size);
+            m_position += size;
+        }
+
+        /**
+         * @brief Pointer to the next unread byte, for handing a sub-range to another reader.
+         */
+        const uint8_t* Current() const noexcept { return m_data + m_position; }
+
+        size_t Position() const noexcept { return m_position; }
+        size_t Remaining() const noexcept { return m_size - m_position; }
+        bool AtEnd() const noexcept { return m_position == m_size; }
+
+    private:
+        void _require(size_t bytes) const {
+            if (bytes > m_size - m_position) throw std::runtime_error("Unexpected end of data");
+        }
+
+        uint64_t _getFixed(int bytes) {
+            _require(static_cast<size_t>(bytes));
+            uint64_t value = 0;
+            for (int i = 0; i < bytes; ++i) {
+                value |= static_cast<uint64_t>(m_data[m_position++]) << (8 * i);
+            }
+            return value;
+        }
+
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_position = 0;
+};
+
+/**
+ * @brief 64-bit FNV-1a hash of a byte range.
+ * @param seed Previous hash value, for hashing several ranges in sequence
+ */
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Write a file through a temporary next to it, renamed into place once complete,
+ * so readers see the old contents or the new ones and never a partial file.
+ * @param write Creates the file at the temporary path it is given; may throw to abandon the write
+ * @param tempSuffix Appended to path for the temporary; make it unique if processes may race
+ * @throws std::runtime_error if the temporary cannot be moved into place. Whatever is thrown,
+ * the temporary is removed and the file at path is left as it was.
+ */
+void WriteFileAtomically(const std::filesystem::path& path,
+                         const std::function<void(const std::filesystem::path& tempPath)>& write,
+                         const std::string& tempSuffix = ".tmp");
+
+/**
+ * @brief WriteFileAtomically for content streamed in binary mode.
+ * @throws std::runtime_error if the file cannot be opened or written
+ */
+void WriteFileAtomically(const std::filesystem::path& path, const std::function<void(std::ostream& out)>& write);
+
+void WriteFileAtomically(const std::filesystem::path& path, const ByteWriter& bytes);
+
+} // namespace tetris
+
+#endif // BYTESTREAM_H
@@ -0,0 +1,110 @@
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+// Bounded cache of network outputs, shared by every search thread.
+//
+// Entries live in 8-way buckets spread over independently locked shards. Lookups
+// take no lock: each slot carries a sequence counter (a seqlock), and a reader
+// that races a writer simply reports a miss. Inserts lock only their shard and
+// evict with a per-bucket CLOCK hand, so recently hit entries get a second chance.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace tetris {
+
+/**
+ * @brief Counters summed over all shards.
+ */
+struct EvalCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t inserts = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;      ///< Occupied slots right now
+    size_t capacity = 0;     ///< Total slots
+    size_t memoryBytes = 0;  ///< Bytes allocated for slots and values
+
+    double HitRate() const { return hits + misses ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0; }
+};
+
+class EvalCache {
+    public:
+        static constexpr size_t WAYS = 8;
+
+        /**
+         * @param capacity Approximate number of entries; rounded up to a power-of-two bucket count
+         * @param valueSize Floats stored per entry (the network's output size)
+         * @param shardCount Number of independently locked shards; rounded up to a power of two
+         */
+        EvalCache(size_t capacity, size_t valueSize, size_t shardCount = 16);
+        ~EvalCache();
+
+        EvalCache(const EvalCache&)            = delete;
+        EvalCache& operator=(const EvalCache&) = delete;
+
+        /**
+         * @brief Combine a position hash with the model version that evaluated it.
+         *
+         * Entries written by an older model then stop matching as soon as a new
+         * one is swapped in, without having to clear the cache.
+         */
+        static uint64_t MakeKey(uint64_t positionHash, uint64_t modelVersion);
+
+        /**
+         * @brief Look up an entry without taking a lock.
+         * @param out Receives GetValueSize() floats on a hit; unspecified on a miss
+         * @return true on a hit
+         */
+        bool Lookup(uint64_t key, float* out);
+
+        /**
+         * @brief Insert or overwrite an entry, evicting one from the same bucket if it is full.
+         * @param values GetValueSize() floats
+         */
+        void Insert(uint64_t key, const float* values);
+
+        /**
+         * @brief Drop every entry. Counters are kept.
+         */
+        void Clear();
+
+        EvalCacheStats GetStats() const;
+        size_t GetValueSize() const noexcept { return m_valueSize; }
+
+    private:
+        struct Slot {
+            std::atomic<uint32_t> seq{0};       // odd while a writer is mid-update
+            std::atomic<uint8_t> referenced{0}; // CLOCK bit, set by hits
+            std::atomic<uint64_t> key{0};       // 0 = empty
+        };
+
+        struct alignas(64) Shard {
+            std::mutex writeMutex;
+            std::unique_ptr<Slot[]> slots;
+            std::unique_ptr<std::atomic<float>[]> values;
+            std::unique_ptr<uint8_t[]> hands;   // per-bucket CLOCK hand, guarded by writeMutex
+
+            alignas(64) std::atomic<uint64_t> hits{0};
+            std::atomic<uint64_t> misses{0};
+            std::atomic<uint64_t> inserts{0};
+            std::atomic<uint64_t> evictions{0};
+            std::atomic<size_t> entries{0};
+        };
+
+        Shard& _shardFor(uint64_t key) const;
+        size_t _bucketFor(uint64_t key) const { return static_cast<size_t>(key) & (m_bucketsPerShard - 1); }
+        void _writeSlot(Shard& shard, size_t slotIndex, uint64_t key, const float* values);
+
+        const size_t m_valueSize;
+        size_t m_shardCount;
+        size_t m_bucketsPerShard;
+        std::unique_ptr<Shard[]> m_shards;
+};
+
+} // namespace tetris
+
+#endif // EVALCACHE_H
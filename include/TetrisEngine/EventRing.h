@@ -0,0 +1,110 @@
+#ifndef EVENTRING_H
+#define EVENTRING_H
+
+// Fixed-size broadcast ring from one writer thread to any number of readers.
+//
+// The writer never waits, allocates or looks at the readers: it overwrites the
+// oldest slot and moves on. Each reader keeps its own cursor (the sequence number
+// of the next event it wants) and drains whatever it has not seen yet; a reader
+// that falls more than CAPACITY events behind is told how many it lost instead of
+// holding the writer up. Slots are sequence-locked and their payload is copied as
+// relaxed atomic words, so a read racing an overwrite is detected and discarded
+// rather than being a data race.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace tetris {
+
+template <typename T, size_t CAPACITY>
+class EventRing {
+        static_assert(std::is_trivially_copyable_v<T>, "EventRing events are copied as raw words");
+        static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "EventRing capacity must be a power of two");
+
+        static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        static constexpr uint64_t MASK = CAPACITY - 1;
+
+    public:
+        EventRing() = default;
+
+        EventRing(const EventRing&) = delete;
+        EventRing& operator=(const EventRing&) = delete;
+
+        static constexpr size_t Capacity() noexcept { return CAPACITY; }
+
+        /**
+         * @brief Writer: append an event, overwriting the oldest once the ring is full.
+         */
+        void Push(const T& event) noexcept {
+            std::array<uint64_t, WORDS> words{};
+            std::memcpy(words.data(), &event, sizeof(T));
+
+            const uint64_t sequence = m_head.load(std::memory_order_relaxed);
+            Slot& slot = m_slots[sequence & MASK];
+            slot.version.store(sequence * 2 + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < WORDS; ++i) slot.words[i].store(words[i], std::memory_order_relaxed);
+            slot.version.store(sequence * 2 + 2, std::memory_order_release);
+            m_head.store(sequence + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Any thread: events pushed so far. A new reader starts its cursor here to see only what comes next.
+         */
+        uint64_t GetHead() const noexcept { return m_head.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Reader: pass every event after the cursor to visit, oldest first, and advance the cursor.
+         * @param cursor The reader's own position; 0 reads from the oldest event still held
+         * @param visit Called as visit(const T&)
+         * @return Events the reader missed because they were overwritten before it got to them
+         */
+        template <typename Visit>
+        uint64_t Drain(uint64_t& cursor, Visit&& visit) const {
+            const uint64_t head = m_head.load(std::memory_order_acquire);
+            uint64_t lost = 0;
+            if (head - cursor > CAPACITY) {
+                lost = head - CAPACITY - cursor;
+                cursor = head - CAPACITY;
+            }
+
+            for (; cursor < head; ++cursor) {
+                const Slot& slot = m_slots[cursor & MASK];
+                const uint64_t expected = cursor * 2 + 2;
+                if (slot.version.load(std::memory_order_acquire) != expected) {
+                    ++lost;
+                    continue;
+                }
+                std::array<uint64_t, WORDS> words;
+                for (size_t i = 0; i < WORDS; ++i) words[i] = slot.words[i].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.version.load(std::memory_order_relaxed) != expected) {
+                    ++lost;
+                    continue;
+                }
+
+                // Trivially copyable (asserted above) but not trivial, hence the void* for -Wclass-memaccess
+                T event;
+                std::memcpy(static_cast<void*>(&event), words.data(), sizeof(T));
+                visit(event);
+            }
+            return lost;
+        }
+
+    private:
+        struct Slot {
+            std::atomic<uint64_t> version{0};   ///< 2n+1 while event n is written, 2n+2 once it is complete
+            std::array<std::atomic<uint64_t>, WORDS> words{};
+        };
+
+        std::array<Slot, CAPACITY> m_slots{};
+        alignas(64) std::atomic<uint64_t> m_head{0};
+};
+
+} // namespace tetris
+
+#endif // EVENTRING_H
@@ -0,0 +1,214 @@
+#ifndef FARM_H
+#define FARM_H
+
+// Headless bot matches and the statistics tetris_farm aggregates over them.
+//
+// A match is a real Game: bots turn their chosen placement into inputs (hold,
+// rotate at spawn, slide, hard drop) at a fixed number of pieces per second of
+// game time, and garbage goes through the game's router with its usual delay.
+// Everything follows from the match seed, so any single game of a run can be
+// replayed on its own.
+
+#include "Bot.h"
+#include "Game.h"
+#include "GarbageRouter.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace tetris {
+
+/// Players per match: solo or one against one
+constexpr size_t MATCH_MAX_PLAYERS = 2;
+
+struct MatchConfig {
+    /// Bot speed in game time; one piece every FRAMES_PER_SECOND / piecesPerSecond frames
+    double piecesPerSecond = 2.0;
+
+    /// Game length cap; a versus match still undecided by then is a draw
+    uint32_t maxFrames = 3 * 60 * Game::FRAMES_PER_SECOND;
+
+    uint32_t garbageDelayFrames = DEFAULT_GARBAGE_DELAY_FRAMES;
+};
+
+struct MatchPlayerResult {
+    uint32_t pieces = 0;
+    uint32_t lines = 0;
+    uint32_t attack = 0;   ///< Garbage generated, before cancellation
+    bool toppedOut = false;
+};
+
+struct MatchResult {
+    uint64_t seed = 0;
+    uint32_t frames = 0;
+    uint8_t playerCount = 0;
+    int8_t winner = -1;    ///< Seat of the winner; -1 for a draw or a solo game
+    std::array<MatchPlayerResult, MATCH_MAX_PLAYERS> players{};
+};
+
+/**
+ * @brief Seed of match number `match` in a run seeded with `base` (SplitMix64).
+ *
+ * Neighbouring match numbers get unrelated seeds.
+ */
+uint64_t MatchSeed(uint64_t base, uint64_t match);
+
+/**
+ * @brief Reusable state for playing matches back to back on one thread.
+ *
+ * Games are kept per player count and reseeded for every match (Game::Reset),
+ * so a worker builds its boards once rather than once per game. A match is
+ * either played to the end in one call or stepped frame by frame, which gives
+ * the same result.
+ */
+class MatchArena {
+    public:
+        /**
+         * @brief Play one match to the end.
+         * @param bots One bot per seat, 1 to MATCH_MAX_PLAYERS of them; bots may be shared across arenas
+         * @throws std::invalid_argument for an unsupported number of bots
+         */
+        MatchResult Play(const Bot* const* bots, size_t count, uint64_t seed, const MatchConfig& config);
+
+        /**
+         * @brief Set up a match to be advanced with Step.
+         * @note The bots must outlive the match
+         * @throws std::invalid_argument for an unsupported number of bots
+         */
+        void Start(const Bot* const* bots, size_t count, uint64_t seed, const MatchConfig& config);
+
+        /**
+         * @brief Advance the running match by one frame.
+         * @return false once the match is over (or none was started)
+         */
+        bool Step();
+
+        /**
+         * @brief Result of the current match; final once Step has returned false.
+         */
+        MatchResult GetResult() const;
+
+        /**
+         * @brief Game of the current match.
+         * @warning Only valid after Start
+         */
+        const Game& GetGame() const { return *m_game; }
+
+        /**
+         * @brief Cost of every decision this arena has asked its bots for, over all matches.
+         */
+        const BotSearchStats& GetSearchStats() const noexcept { return m_searchStats; }
+
+        /**
+         * @brief Action the player's bot chose last in this match, -1 before its first.
+         *
+         * With one-ply bots this is the whole principal variation.
+         * @param piece Receives the piece that was current when it chose
+         */
+        int GetLastAction(size_t player, PieceType& piece) const {
+            piece = m_lastPiece.at(player);
+            return m_lastAction.at(player);
+        }
+
+    private:
+        void _placePiece(Game& game, size_t player, const Bot& bot);
+
+        std::array<std::unique_ptr<Game>, MATCH_MAX_PLAYERS> m_games;
+        std::array<uint16_t, TOTAL_BOARD_HEIGHT> m_rows{};
+        std::array<uint8_t, BOT_ACTION_COUNT> m_mask{};
+        std::array<float, BOT_ACTION_COUNT> m_scores{};
+
+        // Current match
+        Game* m_game = nullptr;
+        std::array<const Bot*, MATCH_MAX_PLAYERS> m_bots{};
+        MatchConfig m_config;
+        double m_framesPerPiece = 0.0;
+        std::array<double, MATCH_MAX_PLAYERS> m_nextMove{};
+        MatchResult m_result;
+        bool m_running = false;
+
+        BotSearchStats m_searchStats;
+        std::array<int, MATCH_MAX_PLAYERS> m_lastAction{};
+        std::array<PieceType, MATCH_MAX_PLAYERS> m_lastPiece{};
+};
+
+/**
+ * @brief Glicko-2 rating (Glickman, 2012), on the familiar 1500 scale.
+ */
+struct GlickoRating {
+    double rating = 1500.0;
+    double deviation = 350.0;
+    double volatility = 0.06;
+};
+
+struct GlickoOutcome {
+    double opponentRating;
+    double opponentDeviation;
+    double score;   ///< 1 win, 0.5 draw, 0 loss
+};
+
+/**
+ * @brief Apply one rating period's games to a rating.
+ * @param tau Volatility constraint; 0.3 to 1.2, smaller is steadier
+ * @note With no games only the deviation grows, as the algorithm prescribes
+ */
+void UpdateGlicko(GlickoRating& rating, const GlickoOutcome* outcomes, size_t count, double tau = 0.5);
+
+/**
+ * @brief Elo update for one game; scoreA is 1, 0.5 or 0 from A's side.
+ */
+void UpdateElo(double& ratingA, double& ratingB, double scoreA, double k);
+
+struct ParticipantStats {
+    uint64_t games = 0;
+    uint64_t wins = 0;
+    uint64_t losses = 0;
+    uint64_t draws = 0;
+    uint64_t pieces = 0;
+    uint64_t lines = 0;
+    uint64_t attack = 0;
+    uint64_t frames = 0;   ///< Game time spent playing
+    double elo = 1500.0;
+    GlickoRating glicko;
+
+    double WinRate() const { return games ? (wins + 0.5 * draws) / games : 0.0; }
+    double LinesPerGame() const { return games ? static_cast<double>(lines) / games : 0.0; }
+    double AttackPerMinute() const { return frames ? attack * 60.0 * Game::FRAMES_PER_SECOND / frames : 0.0; }
+    double PiecesPerSecond() const { return frames ? pieces * static_cast<double>(Game::FRAMES_PER_SECOND) / frames : 0.0; }
+};
+
+/**
+ * @brief Running totals and ratings for a set of participants.
+ *
+ * Elo is updated game by game and Glicko-2 once per rating period, so feeding the
+ * same results in the same order always gives the same ratings.
+ */
+class FarmStats {
+    public:
+        explicit FarmStats(size_t participants, double eloK = 16.0);
+
+        /**
+         * @param seats Participant index of every seat in the match
+         */
+        void Add(const MatchResult& result, const size_t* seats);
+
+        /**
+         * @brief Close the current rating period and update every Glicko rating.
+         */
+        void EndRatingPeriod();
+
+        const std::vector<ParticipantStats>& GetParticipants() const noexcept { return m_stats; }
+        uint64_t GetGames() const noexcept { return m_games; }
+
+    private:
+        std::vector<ParticipantStats> m_stats;
+        std::vector<std::vector<GlickoOutcome>> m_period;
+        double m_eloK;
+        uint64_t m_games = 0;
+};
+
+} // namespace tetris
+
+#endif // FARM_H
@@ -0,0 +1,44 @@
+#ifndef FEATURES_H
+#define FEATURES_H
+
+// Network input encoding shared by inference, training and data generation.
+// Layout (all floats, 0 or 1):
+//   [0, 200)    visible cells, index row * 10 + col with row 0 at the bottom
+//   [200, 207)  one-hot active piece (I J L O S T Z)
+//   [207, 214)  one-hot held piece, all zero if the hold slot is empty
+//   [214, 249)  one-hot next 5 pieces, 7 floats each
+// Changing the layout invalidates every trained model, so bump FEATURE_VERSION.
+
+#include "Rules.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace tetris {
+
+class Board;
+
+constexpr uint32_t FEATURE_VERSION = 1;
+constexpr size_t FEATURE_PIECE_TYPES = 7;
+constexpr size_t FEATURE_NEXT_PIECES = 5;
+constexpr size_t FEATURE_CELLS = VISIBLE_BOARD_HEIGHT * BOARD_WIDTH;
+constexpr size_t BOARD_FEATURE_SIZE = FEATURE_CELLS + FEATURE_PIECE_TYPES * (2 + FEATURE_NEXT_PIECES);
+
+/**
+ * @brief Encode a position from raw state.
+ * @param rowMasks 20 visible row bitmasks, bottom row first (bit c = column c)
+ * @param current Active piece, PieceType::EMPTY if none
+ * @param hold Held piece, PieceType::EMPTY if none
+ * @param next FEATURE_NEXT_PIECES upcoming pieces
+ * @param out Receives BOARD_FEATURE_SIZE floats
+ */
+void EncodeFeatures(const uint16_t* rowMasks, PieceType current, PieceType hold, const PieceType* next, float* out);
+
+/**
+ * @brief Encode a live board (locked cells only; the active piece goes in its one-hot slot).
+ * @param out Receives BOARD_FEATURE_SIZE floats
+ */
+void EncodeBoard(const Board& board, float* out);
+
+} // namespace tetris
+
+#endif // FEATURES_H
@@ -0,0 +1,57 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+// Frame-time statistics for the render loops.
+//
+// Keeps the last WINDOW frames in a ring, so percentiles describe what the window
+// has looked like lately rather than since startup, plus running totals.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace tetris {
+
+class FrameStats {
+    public:
+        /// Frames the percentiles and the rate are computed over
+        static constexpr size_t WINDOW = 256;
+
+        /**
+         * @brief Record one rendered frame.
+         * @param workSeconds Time spent building and submitting the frame, waits excluded
+         * @param endSeconds When the frame finished, on any monotonic clock in seconds
+         */
+        void Record(double workSeconds, double endSeconds) noexcept;
+
+        /// Frames recorded since construction
+        uint64_t GetFrames() const noexcept { return m_frames; }
+
+        /// Frames finished in the last second before the latest one (at most WINDOW)
+        double GetFramesPerSecond() const noexcept;
+
+        /// Over the window, in milliseconds
+        double GetMeanMs() const noexcept;
+        double GetMaxMs() const noexcept;
+
+        /**
+         * @brief Work-time percentile over the window, in milliseconds.
+         * @param percentile 0 to 100; nearest-rank
+         */
+        double GetPercentileMs(double percentile) const noexcept;
+
+        /// Mean work time over every frame ever recorded, in milliseconds
+        double GetLifetimeMeanMs() const noexcept;
+
+    private:
+        size_t _count() const noexcept { return m_frames < WINDOW ? static_cast<size_t>(m_frames) : WINDOW; }
+
+        std::array<double, WINDOW> m_work{};   ///< Seconds, ring indexed by frame % WINDOW
+        std::array<double, WINDOW> m_end{};
+        uint64_t m_frames = 0;
+        double m_totalWork = 0.0;
+};
+
+} // namespace tetris
+
+#endif // FRAMESTATS_H
@@ -2,9 +2,13 @@
 #define GAME_H
 
 #include "Board.h"
+#include "ByteStream.h"
+#include "GarbageRouter.h"
 #include "UtilFunctions.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <vector>
-#include <queue>
 #include <memory>
 #include <random>
 #include <stdexcept>
@@ -12,27 +16,69 @@
 namespace tetris {
 
 class Board;
+class ReplayRecorder;
+class ThreadPool;
+
+/// Bump whenever a rules change makes the same inputs play out differently
+constexpr uint32_t GAME_RULES_VERSION = 2;
+
+/**
+ * @brief Player commands, applied through Game::ApplyInput so they can be recorded.
+ * @note Values are stored in replays; append new inputs, never renumber
+ */
+enum class InputType : uint8_t {
+    MOVE_LEFT = 0,
+    MOVE_RIGHT = 1,
+    SOFT_DROP = 2,   ///< Down one row, or lock and spawn if the piece is resting
+    HARD_DROP = 3,   ///< Drop, lock and spawn
+    HOLD = 4,
+    ROTATE_CW = 5,
+    ROTATE_CCW = 6,
+    ROTATE_180 = 7,
+    RESET = 8        ///< Reset this player's board
+};
+
+constexpr int INPUT_TYPE_COUNT = 9;
 
 class Game {
     public:
+        /// Logical simulation rate; gravity and lock delay advance in whole frames
+        static constexpr int FRAMES_PER_SECOND = 60;
+        static constexpr double FRAME_SECONDS = 1.0 / FRAMES_PER_SECOND;
     
         Game() : Game(1) {}
 
-        explicit Game(size_t numPlayers) : m_seed(std::random_device{}()) {
+        explicit Game(size_t numPlayers) : Game(numPlayers, std::random_device{}()) {}
+
+        /**
+         * @brief Seeded game: the same seed and inputs always produce the same game.
+         */
+        Game(size_t numPlayers, unsigned int seed) : m_seed(seed), m_router(RouterSeed(seed)) {
             for (size_t i = 0; i < numPlayers; ++i) {
                 addPlayer(static_cast<int>(i));
-                pending_garbage_queues.push_back(std::queue<int>());
             }
 
-            gravityClock = GravityClock(0.02, 7200, 0.0035, [this](int rows) { this->moveAllPiecesDown(rows);} );
+            // StepFrame applies the rows per board, so boards can fall in parallel
+            gravityClock = GravityClock(0.02, 7200, 0.0035, [this](int rows) { this->m_gravityRows += rows; } );
         }
 
         void addPlayer(int playerID) {
             m_boards.emplace_back(std::make_unique<Board>(m_seed, playerID, *this));
+            m_outboxes.emplace_back();
+            m_boardStepNs.push_back(0);
+            m_router.AddPlayer();
         }
 
         void Reset();
 
+        /**
+         * @brief Start over exactly as Game(playerCount(), seed) would, reusing this game's allocations.
+         *
+         * Targeting strategies and the garbage delay are kept; everything else is as new.
+         * @throws std::runtime_error while a recorder is attached, since its replay holds the old seed
+         */
+        void Reset(unsigned int seed);
+
         // I doubt we'll be using const Game, but here you go
         Board& getBoard(size_t index) {
             if (index >= m_boards.size()) throw std::out_of_range("Invalid board index");
@@ -57,19 +103,126 @@ class Game {
 
         unsigned int getRNG() const noexcept { return m_seed; }
 
+        const GravityClock& getGravityClock() const noexcept { return gravityClock; }
+
         size_t playerCount() const noexcept { return m_boards.size(); }
 
+        /**
+         * @brief Route an attack through the garbage router (see GarbageRouter::Route).
+         *
+         * Attacks sent while StepFrame advances the boards wait in the sender's outbox
+         * and are routed in player order once every board has finished the frame.
+         */
         void TransferGarbage(size_t sendingPlayerID, int lines);
 
+        /**
+         * @brief Targeting strategies, delivery delay and garbage in flight.
+         */
+        GarbageRouter& GetGarbageRouter() noexcept { return m_router; }
+        const GarbageRouter& GetGarbageRouter() const noexcept { return m_router; }
+
         void moveAllPiecesDown(int row);
+
+        /**
+         * @brief Run as many fixed frames as wall-clock time since the last call covers.
+         */
         void Update();
 
+        /**
+         * @brief Advance exactly one logical frame: gravity, lock delay on every board,
+         *        then knockouts and garbage deliveries that are due.
+         *
+         * Boards only meet through garbage, so with a thread pool set they advance in
+         * parallel and their attacks are routed afterwards in player order. The result
+         * is identical to a serial step.
+         */
+        void StepFrame();
+
+        /// Below this many boards, waking the pool costs more than the frame itself
+        static constexpr size_t PARALLEL_STEP_MIN_BOARDS = 8;
+
+        /**
+         * @brief Step boards on this pool once the game has at least minBoards players.
+         * @param pool Not owned and must outlive the game; nullptr steps serially
+         * @note Never pass a pool whose ParallelFor is the one calling StepFrame: calls on one pool are serialized
+         */
+        void SetThreadPool(ThreadPool* pool, size_t minBoards = PARALLEL_STEP_MIN_BOARDS) noexcept {
+            m_pool = pool;
+            m_parallelMinBoards = minBoards;
+        }
+
+        /**
+         * @brief Time each board's part of StepFrame, for the performance overlay.
+         * @note Off by default: it costs two clock reads per board per frame
+         */
+        void SetBoardTiming(bool enabled) noexcept {
+            m_timeBoards = enabled;
+            std::fill(m_boardStepNs.begin(), m_boardStepNs.end(), 0);
+        }
+
+        /**
+         * @brief Nanoseconds the board took in the last StepFrame; 0 while timing is off.
+         * @throws std::out_of_range for a player the game does not have
+         */
+        int64_t GetBoardStepNs(size_t player) const { return m_boardStepNs.at(player); }
+
+        /**
+         * @brief Frames stepped since construction (restored by LoadState).
+         */
+        uint64_t GetFrame() const noexcept { return m_frame; }
+
+        /**
+         * @brief Apply a player command to their board.
+         * @return false if the board is (now) topped out
+         * @note Ignored, and not recorded, on a topped-out board unless it is InputType::RESET
+         */
+        bool ApplyInput(size_t player, InputType input);
+
+        /**
+         * @brief Queue garbage on a player's board from outside the game (UI, tests).
+         */
+        void AddGarbage(size_t player, int lines);
+
+        /**
+         * @brief Inputs, garbage, resets and frames are reported to the recorder while attached.
+         * @param recorder nullptr to detach
+         */
+        void SetRecorder(ReplayRecorder* recorder) noexcept { m_recorder = recorder; }
+
+        /**
+         * @brief Append the full simulation state: frame, every board, garbage router, gravity.
+         */
+        void SaveState(ByteWriter& out) const;
+
+        /**
+         * @brief Restore state written by SaveState on a game with the same player count.
+         * @throws std::runtime_error if the data is invalid or the player count differs
+         */
+        void LoadState(ByteReader& in);
+
     private:
+        static uint32_t RouterSeed(unsigned int seed) noexcept { return seed ^ 0x5bd1e995u; }
+
+        void _deliverGarbage();
+        void _applyGravity(Board& board, int rows);
+        void _stepBoard(size_t player, int gravityRows);
+
         std::vector<std::unique_ptr<Board>> m_boards;
+        std::vector<std::vector<int>> m_outboxes;   // attacks sent during the board phase of StepFrame, per sender
         unsigned int m_seed;
-        std::vector<std::queue<int>> pending_garbage_queues;
+        GarbageRouter m_router;
         GravityClock gravityClock;
         double accumulatedTime = 0.0;
+        std::chrono::steady_clock::time_point m_lastUpdate{};
+        uint64_t m_frame = 0;
+        ReplayRecorder* m_recorder = nullptr;
+
+        ThreadPool* m_pool = nullptr;
+        size_t m_parallelMinBoards = PARALLEL_STEP_MIN_BOARDS;
+        bool m_steppingBoards = false;
+        int m_gravityRows = 0;
+        bool m_timeBoards = false;
+        std::vector<int64_t> m_boardStepNs;         // written only by the thread stepping that board
     };
 } // namespace tetris
 
@@ -0,0 +1,147 @@
+#ifndef GAMEEVENTS_H
+#define GAMEEVENTS_H
+
+// Typed events a Board emits as it plays.
+//
+// Every spawn, move, rotation, hold, lock, clear and garbage change is pushed as a
+// fixed-size GameEvent into the board's own EventRing, by whichever thread is
+// stepping the board and without allocating or locking. Anything that wants to
+// follow a game (panels, stats, loggers) keeps a cursor into that ring and folds
+// the events it drains, instead of polling the board's getters every frame from
+// another thread.
+
+#include "EventRing.h"
+#include "Piece.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace tetris {
+
+class Board;
+
+/// Upcoming pieces carried by a SPAWN event, as in Board::GetNextQueue
+constexpr size_t EVENT_NEXT_PIECES = 5;
+
+enum class GameEventType : uint8_t {
+    RESET,              ///< Board reset; the first event of every game
+    SPAWN,              ///< A piece entered at the top; carries the next queue
+    MOVE,               ///< Shift or fall by (dx, dy), from input or gravity
+    ROTATE,             ///< Rotation succeeded with kick (dx, dy)
+    HOLD,               ///< piece went into hold; the swapped-in piece follows as SPAWN
+    LOCK,               ///< piece locked at (x, y); lines it cleared, pending garbage after any rise
+    CLEAR,              ///< Lines cleared, with the spin and the combo and B2B chain after the clear
+    GARBAGE_SENT,       ///< Lines of attack left over after cancelling, sent to the opponents
+    GARBAGE_RECEIVED,   ///< Lines of garbage queued against this board
+    GARBAGE_CANCELLED,  ///< Lines of queued garbage cancelled by this board's attack
+    GAME_OVER           ///< piece could not spawn; carries the next queue it left
+};
+
+enum class SpinType : uint8_t {
+    NONE,
+    MINI,           ///< All-mini spin by a piece other than T
+    T_SPIN_MINI,
+    T_SPIN
+};
+
+/**
+ * @brief One thing that happened on a board. Fields an event type does not use are zero.
+ */
+struct GameEvent {
+    uint32_t frame = 0;                         ///< Game frame the event happened in
+    GameEventType type = GameEventType::RESET;
+    PieceType piece = PieceType::EMPTY;         ///< The piece the event is about
+    SpinType spin = SpinType::NONE;             ///< LOCK, CLEAR
+    uint8_t rotation = 0;                       ///< RotationState of the piece
+    int8_t x = 0;                               ///< Piece top-left after the event
+    int8_t y = 0;
+    int8_t dx = 0;                              ///< MOVE: the step; ROTATE: the kick
+    int8_t dy = 0;
+    uint16_t lines = 0;                         ///< LOCK, CLEAR: rows cleared; GARBAGE_*: lines
+    uint16_t combo = 0;                         ///< CLEAR
+    uint16_t b2b = 0;                           ///< CLEAR
+    uint16_t pending = 0;                       ///< Garbage queued against the board after the event
+    uint32_t next = 0;                          ///< SPAWN, GAME_OVER: the next queue, 4 bits a piece, nearest in the low bits
+
+    /// SPAWN, GAME_OVER: upcoming piece i, 0 being the next one
+    PieceType NextPiece(size_t i) const noexcept { return static_cast<PieceType>((next >> (4 * i)) & 0xF); }
+};
+
+static_assert(sizeof(GameEvent) == 24, "GameEvent should stay three words");
+
+/// Events a board keeps for readers that fall behind
+using GameEventRing = EventRing<GameEvent, 128>;
+
+/**
+ * @brief What the panels show about a board, folded from its events.
+ */
+struct BoardHud {
+    PieceType held = PieceType::EMPTY;
+    bool canHold = true;
+    std::array<PieceType, EVENT_NEXT_PIECES> next{};
+    int pending = 0;
+    int combo = 0;
+    int b2b = 0;
+    int lines = 0;
+    int attack = 0;     ///< Before cancellation, as Board::GetAttackTotal
+    bool gameOver = false;
+
+    /**
+     * @brief Fold one event in.
+     */
+    void Apply(const GameEvent& event) noexcept;
+
+    /**
+     * @brief Take every field from the board's getters, e.g. after a LoadState or lost events.
+     */
+    void Sync(const Board& board);
+};
+
+/**
+ * @brief Follows one board's events: keeps its HUD current and the latest few events for a log.
+ *
+ * Reads from any thread. Starting at the ring's first event, the folded HUD
+ * matches the board without ever calling its getters; if the reader falls so far
+ * behind that events are overwritten, it resyncs from a board the caller owns.
+ */
+class BoardEventReader {
+    public:
+        static constexpr size_t RECENT = 16;
+
+        /**
+         * @brief Drain new events.
+         * @param ring The board's events; the board may be playing on another thread
+         * @param fallback Board to resync from if events were lost, e.g. the render thread's snapshot of it
+         * @return true if any events arrived
+         */
+        bool Update(const GameEventRing& ring, const Board& fallback);
+
+        const BoardHud& GetHud() const noexcept { return m_hud; }
+
+        /// Recent events, oldest first
+        size_t GetRecentCount() const noexcept { return m_recentCount; }
+        const GameEvent& GetRecent(size_t i) const noexcept {
+            return m_recent[(m_recentStart + i) % RECENT];
+        }
+
+        /// Events missed because the ring overwrote them first
+        uint64_t GetLost() const noexcept { return m_lost; }
+
+    private:
+        uint64_t m_cursor = 0;
+        uint64_t m_lost = 0;
+        BoardHud m_hud;
+        std::array<GameEvent, RECENT> m_recent{};
+        size_t m_recentStart = 0;
+        size_t m_recentCount = 0;
+};
+
+/**
+ * @brief Describe an event in a line of text, e.g. "Clear T-spin double (combo 1, B2B 2)".
+ * @return Characters written, excluding the terminator, as snprintf
+ */
+int FormatGameEvent(const GameEvent& event, char* out, size_t size);
+
+} // namespace tetris
+
+#endif // GAMEEVENTS_H
@@ -0,0 +1,192 @@
+#ifndef GARBAGEROUTER_H
+#define GARBAGEROUTER_H
+
+// Garbage routing between any number of boards.
+//
+// Every attack first cancels garbage already in flight to the attacker, then the
+// rest goes to one opponent picked by the attacker's targeting strategy and waits
+// in that opponent's pending queue for a fixed number of frames before it reaches
+// their board. Every pick is O(1) (KOS recomputes its target once per frame), so
+// a 64-board battle royale costs the same per attack as a duel.
+
+#include "ByteStream.h"
+#include "UtilFunctions.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace tetris {
+
+/**
+ * @brief How a player picks who receives their attacks.
+ * @note Values are saved in snapshots; append new strategies, never renumber
+ */
+enum class TargetingStrategy : uint8_t {
+    EVEN = 0,       ///< Round-robin over living opponents
+    RANDOM = 1,     ///< Uniformly random living opponent
+    ATTACKERS = 2,  ///< Round-robin over opponents currently targeting you; RANDOM if there are none
+    KOS = 3,        ///< Opponent in the most danger (tallest stack plus incoming garbage)
+    MANUAL = 4      ///< Fixed target from SetManualTarget; EVEN while it is unset or dead
+};
+
+constexpr size_t NO_TARGET = std::numeric_limits<size_t>::max();
+
+/// Frames between an attack and the garbage reaching the target's board (a third of a second)
+constexpr uint32_t DEFAULT_GARBAGE_DELAY_FRAMES = 20;
+
+/**
+ * @brief Garbage on its way to a board.
+ */
+struct GarbagePacket {
+    uint32_t sender;
+    int lines;
+    uint64_t deliverFrame;
+    uint64_t sentFrame;     ///< Not saved; a restored packet takes deliverFrame minus the restored delay
+};
+
+class GarbageRouter {
+    public:
+        explicit GarbageRouter(uint32_t seed = 0, uint32_t delayFrames = DEFAULT_GARBAGE_DELAY_FRAMES);
+
+        /**
+         * @brief Add a living player using EVEN targeting.
+         * @return the new player's index
+         */
+        size_t AddPlayer();
+
+        size_t GetPlayerCount() const noexcept { return m_players.size(); }
+
+        /// @name Targeting
+        /// @{
+        void SetStrategy(size_t player, TargetingStrategy strategy);
+        TargetingStrategy GetStrategy(size_t player) const { return m_players.at(player).strategy; }
+
+        /**
+         * @brief Target for MANUAL; NO_TARGET to clear.
+         * @throws std::out_of_range for an unknown player or target
+         */
+        void SetManualTarget(size_t player, size_t target);
+
+        /**
+         * @brief Who the player last attacked (what ATTACKERS counts), or NO_TARGET.
+         */
+        size_t GetTarget(size_t player) const { return m_players.at(player).target; }
+
+        /**
+         * @brief Opponents whose current target is this player.
+         */
+        const std::vector<uint32_t>& GetAttackers(size_t player) const { return m_players.at(player).attackers; }
+
+        /**
+         * @brief Danger used by KOS; higher is closer to topping out.
+         */
+        void SetDanger(size_t player, int danger);
+
+        bool UsesDanger() const noexcept { return m_knockoutPlayers > 0; }
+        /// @}
+
+        /// @name Alive set
+        /// @{
+        /**
+         * @brief Knocked-out players are never targeted and lose their pending garbage.
+         */
+        void SetAlive(size_t player, bool alive);
+        bool IsAlive(size_t player) const { return m_players.at(player).alivePosition != NOT_ALIVE; }
+        size_t GetAliveCount() const noexcept { return m_alive.size(); }
+        /// @}
+
+        /**
+         * @brief Route an attack sent on a given frame.
+         *
+         * Cancels the oldest garbage in flight to the sender first; whatever is left is
+         * queued for one opponent.
+         * @return the receiving player, or NO_TARGET if everything was cancelled or there is no living opponent
+         */
+        size_t Route(size_t sender, int lines, uint64_t frame);
+
+        /**
+         * @brief Hand every packet due by this frame to deliver(target, lines, sentFrame), in player order.
+         */
+        template <typename Fn>
+        void Deliver(uint64_t frame, Fn&& deliver) {
+            if (m_inFlightPackets == 0) return;
+            for (size_t target = 0; target < m_players.size(); ++target) {
+                std::deque<GarbagePacket>& pending = m_players[target].pending;
+                while (!pending.empty() && pending.front().deliverFrame <= frame) {
+                    const GarbagePacket packet = pending.front();
+                    m_players[target].incoming -= packet.lines;
+                    --m_inFlightPackets;
+                    pending.pop_front();
+                    deliver(target, packet.lines, packet.sentFrame);
+                }
+            }
+        }
+
+        /**
+         * @brief Lines in flight to a player.
+         */
+        int GetIncoming(size_t player) const { return m_players.at(player).incoming; }
+
+        const std::deque<GarbagePacket>& GetPending(size_t player) const { return m_players.at(player).pending; }
+
+        uint32_t GetDelayFrames() const noexcept { return m_delayFrames; }
+        void SetDelayFrames(uint32_t frames) noexcept { m_delayFrames = frames; }
+
+        /**
+         * @brief Drop all garbage in flight and revive every player; strategies are kept.
+         */
+        void Reset();
+
+        /**
+         * @brief Reset and reseed target picking, as a router constructed with this seed.
+         */
+        void Reset(uint32_t seed);
+
+        void SaveState(ByteWriter& out) const;
+
+        /**
+         * @throws std::runtime_error if the data is invalid or for a different player count
+         */
+        void LoadState(ByteReader& in);
+
+    private:
+        static constexpr uint32_t NOT_ALIVE = std::numeric_limits<uint32_t>::max();
+
+        struct Player {
+            TargetingStrategy strategy = TargetingStrategy::EVEN;
+            size_t manualTarget = NO_TARGET;
+            size_t target = NO_TARGET;
+            uint32_t alivePosition = NOT_ALIVE;   // index into m_alive
+            uint32_t attackerPosition = 0;        // index into attackers of m_players[target]
+            uint64_t cursor = 0;                  // round-robin position for EVEN / ATTACKERS
+            int danger = 0;
+            int incoming = 0;
+            std::vector<uint32_t> attackers;
+            std::deque<GarbagePacket> pending;
+        };
+
+        size_t _pickTarget(size_t sender, uint64_t frame);
+        size_t _pickEven(size_t sender);
+        size_t _pickRandom(size_t sender);
+        size_t _pickKnockout(size_t sender, uint64_t frame);
+        void _setTarget(size_t player, size_t target);
+        void _clearPending(size_t player);
+
+        std::vector<Player> m_players;
+        std::vector<uint32_t> m_alive;
+        SeekableRng m_rng;
+        uint32_t m_delayFrames;
+        size_t m_inFlightPackets = 0;
+        size_t m_knockoutPlayers = 0;
+
+        // KOS target, recomputed at most once per frame; the runner-up covers the leader attacking
+        uint64_t m_knockoutFrame = std::numeric_limits<uint64_t>::max();
+        size_t m_mostInDanger = NO_TARGET;
+        size_t m_secondMostInDanger = NO_TARGET;
+};
+
+} // namespace tetris
+
+#endif // GARBAGEROUTER_H
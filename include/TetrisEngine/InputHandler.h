@@ -0,0 +1,111 @@
+#ifndef INPUTHANDLER_H
+#define INPUTHANDLER_H
+
+// Held-key handling: DAS, ARR and soft drop factor in logical time.
+//
+// Keys arrive as press/release events stamped with the time they happened. The
+// handler turns them into Game::ApplyInput calls, so everything it does is
+// recorded, and schedules the auto-repeats a held key produces on the game's own
+// clock (logical seconds since frame 0). Given the same events at the same logical
+// times it always produces the same inputs, whichever thread or frame rate
+// delivered them, which is what lets bots and replays drive it too.
+
+#include "Game.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace tetris {
+
+/**
+ * @brief How held keys repeat, in the units players tune them in.
+ */
+struct HandlingSettings {
+    double dasMs = 133.0;   ///< Delayed auto shift: how long a move key is held before it repeats
+    double arrMs = 33.0;    ///< Auto repeat rate: time between repeated moves; 0 shifts straight to the wall
+    double sdf = 20.0;      ///< Soft drop factor: held soft drop falls this many times faster than gravity; 0 drops to the floor at once
+};
+
+/**
+ * @brief A key going down or up, as the input thread saw it.
+ */
+struct KeyEvent {
+    int64_t timeNs = 0;     ///< steady_clock time of the change, in nanoseconds since the clock's epoch
+    uint32_t player = 0;
+    InputType input = InputType::MOVE_LEFT;
+    bool pressed = false;
+};
+
+/**
+ * @brief One player's held keys.
+ *
+ * A press applies its input straight away. Moves held past DAS then repeat every
+ * ARR, and a held soft drop keeps falling at gravity times SDF without ever locking
+ * the piece; other keys do not repeat. Holding both directions follows the one
+ * pressed last, and releasing it hands back to the other with DAS charging afresh.
+ * Repeats that find the piece blocked are skipped rather than sent to the game.
+ */
+class InputHandler {
+    public:
+        static constexpr double NEVER = std::numeric_limits<double>::infinity();
+
+        /**
+         * @throws std::invalid_argument for negative or non-finite settings
+         */
+        InputHandler(size_t player, const HandlingSettings& settings = {});
+
+        const HandlingSettings& GetSettings() const noexcept { return m_settings; }
+
+        /**
+         * @brief Press or release a key at a logical time.
+         *
+         * Repeats due before then are applied first. Times before the last one handled
+         * count as that time, so late events are never applied out of order.
+         */
+        void OnKey(Game& game, InputType input, bool pressed, double time);
+
+        /**
+         * @brief Apply every repeat due up to and including a logical time.
+         */
+        void Advance(Game& game, double time);
+
+        /**
+         * @brief Logical time of the next repeat, or NEVER if no held key will repeat.
+         * @note Shift-to-wall with ARR 0 has no deadline; it is kept up by every Advance
+         */
+        double NextDeadline() const noexcept;
+
+        /// Inputs passed to Game::ApplyInput so far
+        uint64_t GetInputsSent() const noexcept { return m_inputsSent; }
+
+        /**
+         * @brief Forget every held key, e.g. when focus is lost and releases may never arrive.
+         */
+        void ReleaseAll() noexcept;
+
+    private:
+        bool _step(Game& game, int dx, int dy);
+        void _shiftToWall(Game& game);
+        void _dropToFloor(Game& game);
+        void _restartShift(double time);
+
+        size_t m_player;
+        HandlingSettings m_settings;
+        double m_das;
+        double m_arr;
+        double m_time = 0.0;        ///< Last logical time handled
+        uint64_t m_inputsSent = 0;
+
+        bool m_leftHeld = false;
+        bool m_rightHeld = false;
+        int m_direction = 0;        ///< -1 left, 1 right, 0 no move key held
+        double m_nextShift = NEVER;
+        bool m_charged = false;     ///< DAS has run out for the held direction
+
+        bool m_softDropHeld = false;
+        double m_nextDrop = NEVER;
+};
+
+} // namespace tetris
+
+#endif // INPUTHANDLER_H
@@ -0,0 +1,54 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace tetris {
+    /**
+     * @brief Read-only memory mapping of a whole file.
+     *
+     * Pages are mapped shared, so every process mapping the same file shares
+     * the same physical pages instead of holding a private copy.
+     */
+    class MappedFile {
+        public:
+            MappedFile() = default;
+
+            /**
+             * @brief Map an entire file read-only.
+             * @param path File to map
+             * @throws std::runtime_error if the file cannot be opened or mapped
+             */
+            explicit MappedFile(const std::filesystem::path& path);
+            ~MappedFile();
+
+            MappedFile(const MappedFile&)            = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            MappedFile(MappedFile&& other) noexcept;
+            MappedFile& operator=(MappedFile&& other) noexcept;
+
+            const uint8_t* data() const noexcept { return m_data; }
+            size_t size() const noexcept { return m_size; }
+            bool empty() const noexcept { return m_size == 0; }
+
+            const std::filesystem::path& path() const noexcept { return m_path; }
+
+            /**
+             * @brief Tell the OS pages will be read in random order, turning off read-ahead.
+             * @note A hint only; does nothing where unsupported
+             */
+            void AdviseRandomAccess() const noexcept;
+
+        private:
+            void _release() noexcept;
+
+            std::filesystem::path m_path;
+            const uint8_t* m_data = nullptr;
+            size_t m_size = 0;
+    };
+}
+
+#endif // MAPPEDFILE_H
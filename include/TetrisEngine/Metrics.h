@@ -0,0 +1,199 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+// Latency histograms and throughput counters for long runs, with a file exporter.
+//
+// Recording goes to blocks owned by the calling thread: a handful of relaxed
+// loads and stores, no locks and no shared cache lines, so the engine records
+// from its hot paths in every build. Collect() sums every thread's block (those
+// of threads that have exited included) only when someone asks; a new thread
+// reuses the block of one that exited, so blocks never outnumber the most threads
+// alive at once. Latencies land
+// in log-linear buckets in the style of HdrHistogram: exact below 128 ns, then 64
+// buckets per power of two, so any percentile is within 1.6% of the true value
+// up to 2^42 ns (73 minutes). MetricsExporter writes the totals every few seconds
+// in the Prometheus text format (for node_exporter's textfile collector) and as
+// JSON with the raw buckets for offline analysis.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tetris::metrics {
+
+enum class Latency : uint8_t {
+    INPUT_TO_DISPLAY,   ///< Key change to the end of the first frame drawn with it applied
+    BOT_DECISION,       ///< One Bot::ScoreActions call
+    INFERENCE,          ///< One model batch
+    GARBAGE_DELAY       ///< Game time from an attack being sent to its lines rising into the target's stack
+};
+
+constexpr size_t LATENCY_COUNT = 4;
+
+enum class Counter : uint8_t {
+    GAMES,       ///< Bot matches finished
+    PIECES,      ///< Pieces locked on any board
+    POSITIONS    ///< Positions evaluated by bots and the network
+};
+
+constexpr size_t COUNTER_COUNT = 3;
+
+/// snake_case names used in both export formats, e.g. "bot_decision"
+const char* GetName(Latency latency) noexcept;
+const char* GetName(Counter counter) noexcept;
+
+/**
+ * @brief Distribution of nanosecond values in log-linear buckets.
+ */
+class LatencyHistogram {
+    public:
+        /// Values below this get a bucket each
+        static constexpr uint64_t EXACT_LIMIT = 128;
+        /// Buckets per power of two above EXACT_LIMIT
+        static constexpr uint64_t SUB_BUCKETS = 64;
+        /// Larger values are counted in the last bucket
+        static constexpr int MAX_VALUE_BITS = 42;
+        static constexpr size_t BUCKET_COUNT = EXACT_LIMIT + (MAX_VALUE_BITS - 7) * SUB_BUCKETS;
+
+        LatencyHistogram() : m_counts(BUCKET_COUNT, 0) {}
+
+        static size_t BucketFor(uint64_t value) noexcept;
+        /// Smallest and largest value a bucket holds
+        static uint64_t BucketLow(size_t bucket) noexcept;
+        static uint64_t BucketHigh(size_t bucket) noexcept;
+
+        void Record(uint64_t value, uint64_t count = 1) noexcept;
+
+        /**
+         * @brief Add counts straight to a bucket, e.g. when summing per-thread buckets; pair with AddTotals.
+         */
+        void AddBucket(size_t bucket, uint64_t count) noexcept { m_counts[bucket] += count; m_total += count; }
+
+        /**
+         * @brief Account for the sum and max of values added through AddBucket.
+         */
+        void AddTotals(uint64_t sum, uint64_t max) noexcept { m_sum += sum; m_max = std::max(m_max, max); }
+
+        void Merge(const LatencyHistogram& other) noexcept;
+
+        uint64_t GetCount() const noexcept { return m_total; }
+        uint64_t GetBucketCount(size_t bucket) const noexcept { return m_counts[bucket]; }
+        uint64_t GetSum() const noexcept { return m_sum; }
+        uint64_t GetMax() const noexcept { return m_max; }
+        double GetMean() const noexcept { return m_total ? static_cast<double>(m_sum) / m_total : 0.0; }
+
+        /**
+         * @brief Nearest-rank percentile, reported as the top of its bucket (never above the max).
+         * @param percentile 0 to 100; 0 with nothing recorded
+         */
+        uint64_t GetPercentile(double percentile) const noexcept;
+
+    private:
+        std::vector<uint64_t> m_counts;
+        uint64_t m_total = 0;
+        uint64_t m_sum = 0;
+        uint64_t m_max = 0;
+};
+
+/**
+ * @brief Any thread: record one latency, in nanoseconds.
+ */
+void RecordLatency(Latency latency, uint64_t nanoseconds) noexcept;
+
+/**
+ * @brief Any thread: bump a throughput counter.
+ */
+void Increment(Counter counter, uint64_t amount = 1) noexcept;
+
+/**
+ * @brief Every thread's metrics summed at one moment.
+ */
+struct MetricsSnapshot {
+    double uptimeSeconds = 0.0;                        ///< Since metrics were first touched in this process
+    std::array<LatencyHistogram, LATENCY_COUNT> latencies;
+    std::array<uint64_t, COUNTER_COUNT> counters{};
+    std::array<double, COUNTER_COUNT> rates{};         ///< Per second over the interval Collect was given
+    double rateSeconds = 0.0;                          ///< Length of that interval
+};
+
+/**
+ * @brief Sum every thread's metrics.
+ * @param previous Rates are over the time since this earlier snapshot; nullptr for since startup
+ */
+MetricsSnapshot Collect(const MetricsSnapshot* previous = nullptr);
+
+/**
+ * @brief Prometheus text exposition format: a summary per latency in seconds, a counter and a rate gauge per counter.
+ */
+void WritePrometheus(std::ostream& out, const MetricsSnapshot& snapshot);
+
+/**
+ * @brief One JSON object with every latency's percentiles and non-empty buckets, and the counters and rates.
+ */
+void WriteJson(std::ostream& out, const MetricsSnapshot& snapshot);
+
+struct MetricsExportOptions {
+    std::string prometheusPath;    ///< Empty to skip this format
+    std::string jsonPath;          ///< Empty to skip this format
+    double intervalSeconds = 10.0;
+};
+
+/**
+ * @brief Writes the metrics to files on a background thread every interval, and once more on Stop.
+ *
+ * Files are written next to their destination and renamed over it, so a reader
+ * never sees a partial file.
+ */
+class MetricsExporter {
+    public:
+        /**
+         * @throws std::invalid_argument with no path or an interval that is not positive
+         */
+        explicit MetricsExporter(MetricsExportOptions options);
+        ~MetricsExporter();
+
+        MetricsExporter(const MetricsExporter&) = delete;
+        MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+        /**
+         * @brief Export now, on the calling thread.
+         * @throws std::runtime_error if a file cannot be written
+         */
+        void ExportNow();
+
+        /**
+         * @brief Stop the thread and write a final export. Called by the destructor.
+         */
+        void Stop();
+
+        /**
+         * @brief Message from the most recent failed background export, empty if none.
+         */
+        std::string GetLastError() const;
+
+    private:
+        void _run();
+
+        MetricsExportOptions m_options;
+        std::mutex m_exportMutex;             ///< Serializes exports
+        MetricsSnapshot m_previous;           ///< Guarded by m_exportMutex
+        bool m_hasPrevious = false;           ///< Guarded by m_exportMutex
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_stop = false;                  ///< Guarded by m_mutex
+        std::string m_lastError;              ///< Guarded by m_mutex
+        std::thread m_thread;
+};
+
+} // namespace tetris::metrics
+
+#endif // METRICS_H
@@ -0,0 +1,212 @@
+#ifndef NEURALNETWORK_H
+#define NEURALNETWORK_H
+
+// This header deliberately does not include ONNX Runtime. Executables that never
+// configure a model never load libonnxruntime; see OnnxRuntime.h for the backend.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tetris {
+    class Board;
+    class EvalCache;
+
+    /**
+     * @brief Options controlling how a model is turned into an ORT session.
+     */
+    struct ModelLoadOptions {
+        /// Directory for optimized-model caches. Empty means "<model dir>/.ort_cache".
+        std::filesystem::path cacheDirectory;
+
+        /// Serialize the optimized graph on first load and reuse it afterwards.
+        bool useCache = true;
+
+        /// External-data files (relative to the model directory) to memory-map.
+        /// Empty means "<model file name>.data" if such a file exists.
+        std::vector<std::filesystem::path> externalDataFiles;
+
+        int intraOpThreads = 1;
+    };
+
+    /**
+     * @brief Timings of a single model load, used to judge cold vs cached startup.
+     */
+    struct ModelLoadStats {
+        bool cacheHit = false;
+        double libraryLoadSeconds = 0.0;  ///< Time spent opening the runtime library (first load only)
+        double hashSeconds = 0.0;         ///< Time spent mapping and hashing the model
+        double sessionSeconds = 0.0;      ///< Time spent inside ORT session creation
+        double totalSeconds = 0.0;        ///< Whole load, runtime library included
+        size_t mappedBytes = 0;           ///< Bytes served from shared file mappings
+        std::filesystem::path cachePath;
+    };
+
+    /**
+     * @brief Runtime-loaded inference implementation.
+     */
+    class InferenceBackend {
+        public:
+            virtual ~InferenceBackend() = default;
+
+            /**
+             * @brief Run a batch through the model.
+             * @param input batchSize * GetInputSize() floats
+             * @param batchSize number of entries in the batch
+             * @param output receives batchSize * GetOutputSize() floats
+             */
+            virtual void Run(const float* input, size_t batchSize, float* output) const = 0;
+
+            virtual size_t GetInputSize() const = 0;
+            virtual size_t GetOutputSize() const = 0;
+            virtual const ModelLoadStats& GetLoadStats() const = 0;
+    };
+
+    /**
+     * @brief Create the ONNX Runtime backend for a model.
+     *
+     * The runtime library is opened on the first call.
+     * @throws std::runtime_error if NN support was compiled out, the runtime library
+     *         cannot be found, or the model fails to load
+     */
+    std::unique_ptr<InferenceBackend> CreateOnnxBackend(const std::filesystem::path& modelPath, const ModelLoadOptions& options = {});
+
+    /**
+     * @brief Builds the backend for a model file; CreateOnnxBackend unless a NeuralNetwork is given another.
+     */
+    using BackendFactory = std::function<std::unique_ptr<InferenceBackend>(const std::filesystem::path&, const ModelLoadOptions&)>;
+
+    /**
+     * @brief Options for picking up new checkpoints while running.
+     */
+    struct ModelWatchOptions {
+        /// How often the model file's timestamp and size are checked
+        std::chrono::milliseconds pollInterval{1000};
+
+        /// Batch size of the zero-input warm-up run made before a new session goes live
+        size_t warmupBatchSize = 8;
+
+        /// Called on the watcher thread after each successful swap
+        std::function<void(uint64_t version, const ModelLoadStats& stats)> onReload;
+    };
+
+    /**
+     * @brief Inference wrapper around a loaded model, with optional hot reload.
+     *
+     * Run() grabs a reference to the current backend and evaluates on it, so a
+     * reload never waits for in-flight evaluations and they always finish on the
+     * session they started on. The old session is freed once the last one returns.
+     */
+    class NeuralNetwork {
+        public:
+            explicit NeuralNetwork(const std::filesystem::path& modelPath, ModelLoadOptions options = {});
+
+            /**
+             * @brief Load through a custom factory, used for the first load and every reload.
+             * @throws whatever the factory throws
+             */
+            NeuralNetwork(const std::filesystem::path& modelPath, BackendFactory factory, ModelLoadOptions options = {});
+            ~NeuralNetwork();
+
+            NeuralNetwork(const NeuralNetwork&)            = delete;
+            NeuralNetwork& operator=(const NeuralNetwork&) = delete;
+
+            /**
+             * @brief Run a batch through the current model.
+             * @param input batchSize * GetInputSize() floats
+             * @param batchSize number of entries in the batch
+             * @param output receives batchSize * GetOutputSize() floats
+             */
+            void Run(const float* input, size_t batchSize, float* output) const { GetBackend()->Run(input, batchSize, output); }
+
+            size_t GetInputSize() const { return GetBackend()->GetInputSize(); }
+            size_t GetOutputSize() const { return GetBackend()->GetOutputSize(); }
+            ModelLoadStats GetLoadStats() const { return GetBackend()->GetLoadStats(); }
+
+            /**
+             * @brief Evaluate positions, answering what it can from a cache first.
+             *
+             * Boards are encoded with EncodeBoard; the misses go to the model in a
+             * single batch and are inserted into the cache under the current model version.
+             * @param boards count positions to evaluate
+             * @param output receives count * GetOutputSize() floats
+             * @param cache optional, must have GetValueSize() == GetOutputSize()
+             * @return Number of positions that needed a model call
+             */
+            size_t Evaluate(const Board* const* boards, size_t count, float* output, EvalCache* cache = nullptr) const;
+
+            /**
+             * @brief Reference to the backend that is current right now.
+             * @note Hold on to it for a whole batch if several calls must see the same model
+             */
+            std::shared_ptr<const InferenceBackend> GetBackend() const;
+
+            /**
+             * @brief Incremented every time a new model is swapped in (starts at 0).
+             */
+            uint64_t GetModelVersion() const noexcept { return m_version.load(std::memory_order_acquire); }
+
+            /// @name Hot Reload
+            /// @{
+            /**
+             * @brief Start a background thread that reloads the model when its file changes.
+             *
+             * The new session is built and warmed up on the watcher thread; callers of
+             * Run() only ever see the pointer swap.
+             */
+            void WatchForUpdates(ModelWatchOptions options = {});
+
+            /**
+             * @brief Stop the watcher thread, if running. Called by the destructor.
+             */
+            void StopWatching();
+
+            /**
+             * @brief Message from the most recent failed reload, empty if none.
+             * @note A failed reload keeps serving the previous model, and the same file is
+             *       not tried again until its timestamp or size changes
+             */
+            std::string GetLastReloadError() const;
+            /// @}
+
+        private:
+            /// What the watcher compares to notice a new checkpoint
+            struct FileStamp {
+                std::filesystem::file_time_type time{};
+                uintmax_t size = 0;
+                bool operator==(const FileStamp&) const = default;
+            };
+
+            bool _stampModel(FileStamp& stamp) const;
+            void _watchLoop(ModelWatchOptions options, FileStamp loaded);
+            bool _reload(const ModelWatchOptions& options);
+
+            std::filesystem::path m_modelPath;
+            ModelLoadOptions m_loadOptions;
+            BackendFactory m_factory;
+
+            // Only guards copying the pointer (a refcount bump), never a model load
+            mutable std::mutex m_backendMutex;
+            std::shared_ptr<const InferenceBackend> m_backend;
+            std::atomic<uint64_t> m_version{0};
+
+            std::thread m_watcher;
+            std::mutex m_watchMutex;
+            std::condition_variable m_watchSignal;
+            bool m_stopWatching = false;
+
+            mutable std::mutex m_errorMutex;
+            std::string m_lastReloadError;
+    };
+}
+
+#endif // NEURALNETWORK_H
@@ -0,0 +1,95 @@
+#ifndef ONLINETRAINER_H
+#define ONLINETRAINER_H
+
+// In-process training on top of the ONNX Runtime training API.
+//
+// Artifacts are produced once in Python with
+//   onnxruntime.training.artifacts.generate_artifacts(...)
+// for a model taking float features [batch, F] and float targets [batch, T] and
+// producing the loss as its first output. F and T must match the ReplayBuffer.
+//
+// Requires an ONNX Runtime build with training support; like NeuralNetwork, the
+// runtime library is only opened when a trainer is constructed.
+
+#include "ReplayBuffer.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tetris {
+
+/**
+ * @brief Files produced by onnxruntime-training's artifact generator.
+ */
+struct TrainingArtifacts {
+    std::filesystem::path checkpoint;      ///< checkpoint (trainable parameters + optimizer state)
+    std::filesystem::path trainingModel;   ///< training_model.onnx
+    std::filesystem::path evalModel;       ///< eval_model.onnx, needed for evaluation and export
+    std::filesystem::path optimizerModel;  ///< optimizer_model.onnx
+};
+
+struct OnlineTrainerOptions {
+    size_t batchSize = 256;
+
+    /// Overrides the learning rate stored in the optimizer graph when positive
+    float learningRate = 0.0f;
+
+    /// Eval-graph outputs kept in the exported inference model
+    std::vector<std::string> inferenceOutputs = {"value"};
+
+    uint64_t seed = 0;
+    int intraOpThreads = 1;
+};
+
+/**
+ * @brief Trains a small network continuously from an in-memory ReplayBuffer.
+ *
+ * Exported inference models are written next to their destination and renamed
+ * into place, so a NeuralNetwork watching that path swaps them in atomically.
+ */
+class OnlineTrainer {
+    public:
+        /**
+         * @throws std::runtime_error if the runtime lacks training support or an artifact fails to load
+         */
+        explicit OnlineTrainer(const TrainingArtifacts& artifacts, OnlineTrainerOptions options = {});
+        ~OnlineTrainer();
+
+        OnlineTrainer(const OnlineTrainer&)            = delete;
+        OnlineTrainer& operator=(const OnlineTrainer&) = delete;
+
+        /**
+         * @brief One optimization step on a minibatch sampled from the buffer.
+         * @return Training loss of the batch, or NaN if the buffer is empty
+         */
+        float TrainStep(const ReplayBuffer& buffer);
+
+        /**
+         * @brief Loss of the eval graph on a sampled minibatch (no parameter update).
+         * @return Eval loss, or NaN if the buffer is empty
+         */
+        float EvalStep(const ReplayBuffer& buffer);
+
+        /**
+         * @brief Write the current weights as an inference model the game can load.
+         */
+        void ExportInferenceModel(const std::filesystem::path& path);
+
+        /**
+         * @brief Persist parameters (and optionally optimizer state) to resume later.
+         */
+        void SaveCheckpoint(const std::filesystem::path& path, bool includeOptimizerState = true);
+
+        uint64_t GetStepCount() const noexcept;
+        float GetLastLoss() const noexcept;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace tetris
+
+#endif // ONLINETRAINER_H
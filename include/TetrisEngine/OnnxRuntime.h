@@ -0,0 +1,85 @@
+#ifndef ONNXRUNTIME_H
+#define ONNXRUNTIME_H
+
+// ONNX Runtime is not linked into the engine. The library is opened at runtime the
+// first time something needs it, and the C++ API is pointed at it through
+// Ort::InitApi (the engine is compiled with ORT_API_MANUAL_INIT).
+// Only code that actually talks to ORT should include this header.
+
+#include "NeuralNetwork.h"
+#include "MappedFile.h"
+#include <onnxruntime_cxx_api.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tetris {
+    /**
+     * @brief Load the ONNX Runtime shared library if it has not been loaded yet.
+     *
+     * Search order: the TETRIS_ONNXRUNTIME_PATH environment variable, the library
+     * the engine was built against, then the platform's default library search.
+     * @throws std::runtime_error naming every location tried if no usable library is found
+     */
+    void EnsureOnnxRuntimeLoaded();
+
+    /**
+     * @brief Load the runtime from one library file, without the search EnsureOnnxRuntimeLoaded does.
+     * @param error Receives why the file is unusable (missing, not ONNX Runtime, too old); may be nullptr
+     * @return true if the runtime is now loaded, from this file or an earlier call
+     * @note A file that is rejected is closed again
+     */
+    bool LoadOnnxRuntimeFrom(const std::string& path, std::string* error = nullptr);
+
+    /**
+     * @brief True once EnsureOnnxRuntimeLoaded has succeeded.
+     */
+    bool IsOnnxRuntimeLoaded() noexcept;
+
+    /**
+     * @brief Version string of the loaded runtime library (e.g. "1.21.0").
+     * @note Use this instead of Ort::GetVersionString, which needs ORT linked at build time
+     */
+    std::string GetOnnxRuntimeVersion();
+
+    /**
+     * @brief Process-wide ORT environment, created on first use.
+     * @note Loads the runtime library if needed
+     */
+    Ort::Env& GetOrtEnv();
+
+    /**
+     * @brief An ORT session together with the file mappings backing its weights.
+     *
+     * The mappings are declared before the session so that they outlive it.
+     */
+    struct ModelSession {
+        std::vector<MappedFile> mappings;
+        std::unique_ptr<Ort::Session> session;
+        std::string inputName;
+        std::string outputName;
+        size_t inputSize = 0;   ///< Floats per batch entry
+        size_t outputSize = 0;  ///< Floats per batch entry
+        ModelLoadStats stats;
+    };
+
+    /**
+     * @brief Create a session for an ONNX model, going through the optimized-model cache.
+     *
+     * The cache file is keyed by a hash of the model graph, the external data file
+     * sizes/timestamps and the ORT version. On a hit the cached ORT-format model is
+     * memory-mapped and ORT runs straight from the mapped bytes, so every worker
+     * process on the box shares one copy of the weights. Writing a new cache file
+     * deletes the ones left by earlier versions of the same model.
+     * @throws std::runtime_error or Ort::Exception if the model cannot be loaded
+     */
+    std::shared_ptr<ModelSession> LoadModel(Ort::Env& env, const std::filesystem::path& modelPath, const ModelLoadOptions& options = {});
+
+    /**
+     * @brief Path of the cache file LoadModel would use for a model.
+     */
+    std::filesystem::path GetModelCachePath(const std::filesystem::path& modelPath, const ModelLoadOptions& options = {});
+}
+
+#endif // ONNXRUNTIME_H
@@ -0,0 +1,70 @@
+#ifndef PERFSTATS_H
+#define PERFSTATS_H
+
+// Cheap always-on counters for the performance overlay.
+//
+// Allocations are counted by replacement global operator new / operator delete
+// (PerfStats.cpp), which bump a plain thread_local counter and forward to malloc.
+// The replacement is linked into whatever executable calls GetThreadAllocations;
+// the ctypes simulator library never does, so it keeps the default allocator.
+// ValueHistory holds the last N samples of a number in the layout ImGui::PlotLines
+// scrolls over.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace tetris {
+
+/**
+ * @brief Heap allocations the calling thread has made since it started.
+ * @note Take the difference of two calls on the same thread to count a stretch of work
+ */
+uint64_t GetThreadAllocations() noexcept;
+
+/**
+ * @brief The last N samples of a value, oldest first from GetOffset.
+ */
+template<size_t N>
+class ValueHistory {
+    public:
+        static_assert(N > 0, "ValueHistory needs room for a sample");
+
+        void Push(float value) noexcept {
+            m_values[m_next] = value;
+            m_next = (m_next + 1) % N;
+            if (m_count < N) ++m_count;
+        }
+
+        /// N values; slots never pushed to read 0
+        const float* Data() const noexcept { return m_values.data(); }
+        static constexpr size_t Capacity() noexcept { return N; }
+
+        /// Index of the oldest sample, the values_offset ImGui::PlotLines wants
+        size_t GetOffset() const noexcept { return m_count < N ? 0 : m_next; }
+
+        size_t GetCount() const noexcept { return m_count; }
+
+        /// Most recent sample, 0 before the first
+        float GetLatest() const noexcept { return m_count ? m_values[(m_next + N - 1) % N] : 0.0f; }
+
+        float GetMax() const noexcept {
+            return m_count ? *std::max_element(m_values.begin(), m_values.begin() + m_count) : 0.0f;
+        }
+
+        float GetMean() const noexcept {
+            float sum = 0.0f;
+            for (size_t i = 0; i < m_count; ++i) sum += m_values[i];
+            return m_count ? sum / static_cast<float>(m_count) : 0.0f;
+        }
+
+    private:
+        std::array<float, N> m_values{};
+        size_t m_next = 0;
+        size_t m_count = 0;
+};
+
+} // namespace tetris
+
+#endif // PERFSTATS_H
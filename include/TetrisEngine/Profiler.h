@@ -0,0 +1,84 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Scoped instrumentation zones with Chrome trace export.
+//
+// TETRIS_PROFILE_ZONE("name") times the rest of the enclosing scope and
+// TETRIS_PROFILE_THREAD("name") labels the calling thread. Both are
+// compiled in only when TETRIS_PROFILE is defined (CMake: -DENABLE_PROFILE=ON);
+// otherwise they expand to nothing and cost nothing. A finished zone is
+// pushed into a ring owned by the thread that ran it, so recording never locks or
+// allocates after a thread's first zone, and each thread keeps its most recent
+// RING_CAPACITY zones. A ring (about 1 MiB) is handed on to the next new thread
+// when its thread exits, so short-lived threads do not pile up rings; the trace
+// then shows both threads under one id. WriteChromeTrace dumps every ring as
+// trace-event JSON for chrome://tracing or Perfetto, and can be called while zones
+// are still being recorded.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tetris::profile {
+
+#ifdef TETRIS_PROFILE
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+/// Zones each thread keeps; older ones are overwritten
+constexpr size_t RING_CAPACITY = 1 << 15;
+
+/**
+ * @brief Times a scope and records it on the calling thread when the scope ends.
+ * @note Use through TETRIS_PROFILE_ZONE so release builds compile it out
+ */
+class Zone {
+    public:
+        /**
+         * @param name A string literal, or any string that outlives the trace
+         */
+        explicit Zone(const char* name) noexcept;
+        ~Zone();
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* m_name;
+        int64_t m_startNs;
+};
+
+/**
+ * @brief Record a zone on the calling thread that was timed some other way, e.g. across two calls.
+ * @param startNs,endNs steady_clock time since its epoch, in nanoseconds
+ */
+void RecordZone(const char* name, int64_t startNs, int64_t endNs) noexcept;
+
+/**
+ * @brief Name the calling thread in traces, e.g. "simulation". Threads are otherwise numbered.
+ */
+void SetThreadName(const char* name);
+
+/**
+ * @brief Write the zones every thread still holds as a Chrome trace-event JSON file.
+ * @return Zones written
+ * @throws std::runtime_error if the file cannot be written
+ */
+size_t WriteChromeTrace(const std::string& path);
+
+} // namespace tetris::profile
+
+#define TETRIS_PROFILE_JOIN_(a, b) a##b
+#define TETRIS_PROFILE_JOIN(a, b) TETRIS_PROFILE_JOIN_(a, b)
+
+#ifdef TETRIS_PROFILE
+#define TETRIS_PROFILE_ZONE(name) ::tetris::profile::Zone TETRIS_PROFILE_JOIN(tetrisProfileZone, __LINE__)(name)
+#define TETRIS_PROFILE_THREAD(name) ::tetris::profile::SetThreadName(name)
+#else
+#define TETRIS_PROFILE_ZONE(name) static_cast<void>(0)
+#define TETRIS_PROFILE_THREAD(name) static_cast<void>(0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,170 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// Seed-plus-inputs replays.
+//
+// A replay stores the game seed and ruleset, the stream of player inputs and
+// external garbage (each as a varint frame delta plus a one-byte tag), and a
+// run-length/varint encoded Game keyframe every few seconds. Any frame is reached
+// by loading the nearest earlier keyframe and re-simulating at most one interval
+// of frames, so seeking costs the same at minute 9 as at second 1.
+
+#include "ByteStream.h"
+#include "Game.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace tetris {
+
+constexpr char REPLAY_MAGIC[4] = {'T', 'R', 'P', 'L'};
+constexpr uint16_t REPLAY_FORMAT_VERSION = 2;
+
+/// Five seconds of play between keyframes
+constexpr uint32_t REPLAY_KEYFRAME_INTERVAL = 5 * Game::FRAMES_PER_SECOND;
+
+/**
+ * @brief Header fields of a replay.
+ */
+struct ReplayInfo {
+    uint32_t seed = 0;
+    uint16_t playerCount = 0;
+    uint32_t rulesVersion = 0;      ///< GAME_RULES_VERSION at recording time
+    uint32_t framesPerSecond = 0;
+    double initialGravity = 0.0;    ///< Gravity settings at the start of the recording
+    double gravityRampUpDelay = 0.0;
+    double gravityIncrement = 0.0;
+    uint32_t keyframeInterval = 0;
+    uint64_t startFrame = 0;        ///< Game frame recording began on
+    uint64_t endFrame = 0;          ///< Last frame whose inputs are included
+    uint32_t keyframeCount = 0;
+    uint64_t eventCount = 0;
+};
+
+/**
+ * @brief Records a live Game into the replay format.
+ *
+ * Attaches itself to the game on construction and detaches on destruction. Each
+ * input costs a couple of bytes appended to a buffer; a keyframe is a Game::SaveState
+ * every keyframeInterval frames (a few hundred bytes for two players).
+ * @warning The game must outlive the recorder
+ */
+class ReplayRecorder {
+    public:
+        explicit ReplayRecorder(Game& game, uint32_t keyframeInterval = REPLAY_KEYFRAME_INTERVAL);
+        ~ReplayRecorder();
+
+        ReplayRecorder(const ReplayRecorder&)            = delete;
+        ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+        /// @name Game hooks
+        /// @{
+        void OnInput(size_t player, InputType input);
+        void OnGarbage(size_t player, int lines);
+        void OnReset();
+        void OnFrame();
+        /// @}
+
+        /**
+         * @brief Encode everything recorded so far; the replay ends on the game's current frame.
+         */
+        std::vector<uint8_t> Serialize() const;
+
+        /**
+         * @throws std::runtime_error if the file cannot be written
+         */
+        void Save(const std::filesystem::path& path) const;
+
+        uint64_t GetEventCount() const noexcept { return m_eventCount; }
+        size_t GetKeyframeCount() const noexcept { return m_keyframes.size(); }
+
+    private:
+        struct Keyframe {
+            uint64_t frame;
+            uint64_t eventOffset;     ///< First event byte after the keyframe
+            uint64_t eventBaseFrame;  ///< Frame the next event's delta is relative to
+            uint64_t stateSize;
+        };
+
+        void _writeEventHeader(size_t player, uint8_t kind);
+        void _takeKeyframe();
+
+        Game& m_game;
+        ReplayInfo m_info;
+        ByteWriter m_events;
+        ByteWriter m_states;
+        std::vector<Keyframe> m_keyframes;
+        uint64_t m_lastEventFrame;
+        uint64_t m_eventCount = 0;
+};
+
+/**
+ * @brief Plays back a replay with random access.
+ */
+class ReplayPlayer {
+    public:
+        /**
+         * @throws std::runtime_error if the data is not a valid replay, or was recorded
+         *         under different rules than this build's
+         */
+        explicit ReplayPlayer(std::vector<uint8_t> data);
+        explicit ReplayPlayer(const std::filesystem::path& path);
+
+        ReplayPlayer(const ReplayPlayer&)            = delete;
+        ReplayPlayer& operator=(const ReplayPlayer&) = delete;
+
+        const ReplayInfo& GetInfo() const noexcept { return m_info; }
+
+        /**
+         * @brief Game state at the current frame (all of that frame's inputs applied).
+         */
+        const Game& GetGame() const noexcept { return *m_game; }
+
+        uint64_t GetFrame() const noexcept { return m_game->GetFrame(); }
+
+        /**
+         * @brief Jump to a frame in [startFrame, endFrame].
+         *
+         * Steps forward from the current frame when that is no further than from the
+         * nearest keyframe; otherwise restores that keyframe and re-simulates from it.
+         * @throws std::out_of_range outside the recorded frames
+         */
+        void Seek(uint64_t frame);
+
+        /**
+         * @brief Advance one frame.
+         * @return false (and does nothing) at the end of the replay
+         */
+        bool Step();
+
+    private:
+        struct Keyframe {
+            uint64_t frame;
+            uint64_t eventOffset;
+            uint64_t eventBaseFrame;
+            uint64_t stateOffset;
+            uint64_t stateSize;
+        };
+
+        void _parse();
+        void _loadKeyframe(size_t index);
+        void _readNextEventFrame();
+        void _applyEvents();
+
+        std::vector<uint8_t> m_data;
+        ReplayInfo m_info;
+        std::vector<Keyframe> m_keyframes;
+        size_t m_eventsBegin = 0;
+        size_t m_eventsEnd = 0;
+        size_t m_statesBegin = 0;
+
+        std::unique_ptr<Game> m_game;
+        size_t m_cursor = 0;            ///< Next unread event byte
+        uint64_t m_nextEventFrame = 0;  ///< UINT64_MAX once the events run out
+};
+
+} // namespace tetris
+
+#endif // REPLAY_H
@@ -0,0 +1,82 @@
+#ifndef REPLAYBUFFER_H
+#define REPLAYBUFFER_H
+
+#include "Features.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace tetris {
+
+class Board;
+
+/**
+ * @brief Fixed-capacity ring of (features, target) training samples.
+ *
+ * Self-play threads push positions as they are played; the trainer samples
+ * minibatches from the same process, so nothing goes through files. Once full,
+ * the oldest samples are overwritten.
+ *
+ * Each sample is an immutable shared block. The lock only covers swapping
+ * blocks in and picking them out, so a minibatch copy never blocks Push.
+ */
+class ReplayBuffer {
+    public:
+        /**
+         * @param capacity Maximum number of samples kept
+         * @param featureSize Floats per sample input
+         * @param targetSize Floats per sample target
+         */
+        explicit ReplayBuffer(size_t capacity, size_t featureSize = BOARD_FEATURE_SIZE, size_t targetSize = 1);
+
+        /**
+         * @brief Add one sample.
+         * @param features GetFeatureSize() floats
+         * @param targets GetTargetSize() floats
+         */
+        void Push(const float* features, const float* targets);
+
+        /**
+         * @brief Encode a board with EncodeBoard and add it with a scalar target.
+         */
+        void Push(const Board& board, float target);
+
+        /**
+         * @brief Draw a minibatch uniformly at random, with replacement.
+         * @param features Receives batchSize * GetFeatureSize() floats
+         * @param targets Receives batchSize * GetTargetSize() floats
+         * @return false (and writes nothing) if the buffer is empty
+         */
+        bool Sample(size_t batchSize, std::mt19937_64& rng, float* features, float* targets) const;
+
+        size_t Size() const;
+        size_t Capacity() const noexcept { return m_capacity; }
+        size_t GetFeatureSize() const noexcept { return m_featureSize; }
+        size_t GetTargetSize() const noexcept { return m_targetSize; }
+
+        /**
+         * @brief Samples pushed over the buffer's lifetime, including overwritten ones.
+         */
+        uint64_t TotalPushed() const;
+
+    private:
+        const size_t m_capacity;
+        const size_t m_featureSize;
+        const size_t m_targetSize;
+
+        /// Features followed by targets
+        using Block = std::shared_ptr<const float[]>;
+
+        mutable std::mutex m_mutex;
+        std::vector<Block> m_samples;
+        size_t m_next = 0;
+        size_t m_size = 0;
+        uint64_t m_pushed = 0;
+};
+
+} // namespace tetris
+
+#endif // REPLAYBUFFER_H
@@ -0,0 +1,106 @@
+#ifndef RULES_H
+#define RULES_H
+
+// Allocation-free rule kernels on a row-bitmask board.
+//
+// A board here is TOTAL_BOARD_HEIGHT uint16_t rows, row 0 at the bottom, with bit c
+// set when column c is occupied (the same layout Board::GetRowMask returns). Board
+// uses these for scoring and spawning; VecEnv runs whole games on them without
+// any Board or Piece objects.
+
+#include "Piece.h"
+#include <array>
+#include <cstdint>
+
+namespace tetris {
+
+// Board dimensions and constants
+constexpr int BOARD_WIDTH = 10;
+constexpr int VISIBLE_BOARD_HEIGHT = 20; // Rows 0 to 19 from bottom are visible
+constexpr int TOTAL_BOARD_HEIGHT = 27;   // Rows 0 to 26 from bottom. Rows 20-26 are buffer/spawn area.
+constexpr uint16_t FULL_ROW_MASK = (1u << BOARD_WIDTH) - 1;
+
+/**
+ * @brief A piece's 4x4 representation unpacked into row masks.
+ */
+struct PieceShape {
+    std::array<uint16_t, 4> rows{};  ///< rows[r] bit c = cell (x + c, y + r) relative to the top-left position
+    int8_t minCol = 0;               ///< Leftmost occupied column of the 4x4 box
+    int8_t maxCol = 0;               ///< Rightmost occupied column of the 4x4 box
+    int8_t minRow = 0;               ///< Lowest occupied row of the 4x4 box
+};
+
+/**
+ * @brief Precomputed shape for a piece and rotation.
+ * @warning type must be one of I, J, L, O, S, T, Z
+ */
+const PieceShape& GetPieceShape(PieceType type, RotationState rotation);
+
+/**
+ * @brief Top-left position a new piece spawns at.
+ */
+Point GetSpawnPosition(PieceType type);
+
+/**
+ * @brief Check that a piece lies inside the board and overlaps no occupied cell.
+ */
+bool PieceFits(const uint16_t* rows, const PieceShape& shape, int x, int y);
+
+/**
+ * @brief Lowest y a piece reaches falling straight down from y.
+ * @note Assumes the piece fits at (x, y)
+ */
+int DropPiece(const uint16_t* rows, const PieceShape& shape, int x, int y);
+
+/**
+ * @brief Write a piece into the board. Cells outside the board are dropped.
+ */
+void PlacePiece(uint16_t* rows, const PieceShape& shape, int x, int y);
+
+/**
+ * @brief Remove full visible rows and shift everything above down.
+ * @return number of lines cleared
+ */
+int ClearLines(uint16_t* rows);
+
+/// Placement index = rotation * BOARD_WIDTH + leftmost occupied column after landing
+constexpr int PLACEMENT_COUNT = 4 * BOARD_WIDTH;
+
+/**
+ * @brief Resolve a placement: rotate at spawn (no kicks), slide at spawn height, hard drop.
+ * @param x,y Receive the landing top-left position
+ * @return false if the placement is unreachable or does not exist for this piece
+ * @note O has only rotation 0; its other rotations would duplicate it
+ */
+bool FindPlacement(const uint16_t* rows, PieceType type, int placement, int& x, int& y);
+
+/**
+ * @brief Mark every reachable placement of a piece.
+ * @param mask Receives PLACEMENT_COUNT flags; all zero for PieceType::EMPTY
+ */
+void LegalPlacements(const uint16_t* rows, PieceType type, uint8_t* mask);
+
+/**
+ * @brief Garbage generated by one lock, in the order it is sent.
+ */
+struct AttackResult {
+    std::array<int, 4> sends{};  ///< Up to three B2B-charge bursts, then the clear itself
+    int count = 0;
+
+    int Total() const { int total = 0; for (int i = 0; i < count; ++i) total += sends[i]; return total; }
+};
+
+/**
+ * @brief Attack for a lock and update the B2B and combo counters.
+ * Based on the following scoring guidelines: https://tetris.fandom.com/wiki/Scoring
+ * @param tSpin t-spin status code 0, 1, 2
+ * @param allMiniSpin keep b2b if a mini-spin by a non-T was done
+ * @param lines number of lines cleared
+ * @param backToBack B2B chain, updated in place
+ * @param combo combo counter, updated in place
+ */
+AttackResult ComputeAttack(int tSpin, bool allMiniSpin, int lines, int& backToBack, int& combo);
+
+} // namespace tetris
+
+#endif // RULES_H
@@ -0,0 +1,160 @@
+#ifndef SELFPLAYSHARD_H
+#define SELFPLAYSHARD_H
+
+// Binary shard files written by tetris_selfplay; docs/selfplay_format.md is the
+// reference for readers in other languages. Everything is little-endian and laid
+// out with natural alignment, so a shard can be memory-mapped and viewed as a
+// header followed by recordCount SelfPlayRecord structs.
+//
+// Any change to ShardHeader or SelfPlayRecord must bump SHARD_FORMAT_VERSION.
+
+#include "Features.h"
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tetris {
+
+constexpr uint32_t SHARD_FORMAT_VERSION = 1;
+constexpr std::array<char, 4> SHARD_MAGIC = {'T', 'S', 'P', 'D'};
+constexpr size_t RECORD_ACTION_COUNT = 2 * PLACEMENT_COUNT;
+constexpr size_t RECORD_PIECES = 2 + FEATURE_NEXT_PIECES;
+
+/**
+ * @brief First 64 bytes of every shard.
+ */
+struct ShardHeader {
+    std::array<char, 4> magic = SHARD_MAGIC;
+    uint32_t version = SHARD_FORMAT_VERSION;
+    uint32_t headerSize = 64;
+    uint32_t recordSize = 0;
+    uint64_t recordCount = 0;
+    uint32_t featureVersion = FEATURE_VERSION;
+    uint32_t actionCount = RECORD_ACTION_COUNT;
+    uint64_t createdUnixSeconds = 0;
+    std::array<uint8_t, 24> reserved{};
+};
+
+/// SelfPlayRecord::flags
+enum SelfPlayRecordFlags : uint8_t {
+    RECORD_TOPPED_OUT = 1 << 0,  ///< The game this position belongs to ended in a top-out
+    RECORD_MODEL_BOT  = 1 << 1,  ///< Moves were chosen by a network rather than the heuristic
+};
+
+/**
+ * @brief One played position.
+ */
+struct SelfPlayRecord {
+    uint64_t gameId = 0;         ///< Unique within a run
+    float outcome = 0.0f;        ///< Reward summed from this position to the end of the game
+    float reward = 0.0f;         ///< Reward of the chosen action alone
+    uint32_t gameLength = 0;     ///< Positions in the whole game
+    uint16_t moveNumber = 0;     ///< 0-based index of this position in its game
+    int16_t action = -1;         ///< Chosen action, hold * 40 + rotation * 10 + column
+    std::array<uint16_t, VISIBLE_BOARD_HEIGHT> rows{};  ///< Visible row masks, bottom first
+    std::array<uint8_t, RECORD_PIECES> pieces{};        ///< current, hold, next 5 as PieceType values
+    uint8_t flags = 0;
+    std::array<uint16_t, RECORD_ACTION_COUNT> policy{}; ///< Search distribution over actions, probability * 65535
+};
+
+static_assert(sizeof(ShardHeader) == 64, "shard header layout changed");
+static_assert(sizeof(SelfPlayRecord) == 232, "shard record layout changed; bump SHARD_FORMAT_VERSION");
+
+struct ShardWriterStats {
+    uint64_t recordsWritten = 0;
+    uint64_t shardsWritten = 0;
+    uint64_t bytesWritten = 0;
+    double writeSeconds = 0.0;     ///< Writer thread time spent in file I/O
+    double producerWaitSeconds = 0.0;  ///< Time producers blocked because both buffers were full
+    size_t bufferedRecords = 0;    ///< Records accepted but not yet on disk
+};
+
+/**
+ * @brief Streams records into fixed-size shard files from a background thread.
+ *
+ * Producers fill one buffer while the writer thread writes the other. When the
+ * fill buffer reaches recordsPerShard it is handed over; if the writer is still
+ * busy with the previous shard the producer waits, and that wait is reported as
+ * backpressure. Each shard is written to a .tmp file and renamed into place, so
+ * readers never see a partial shard. Only the last shard of a run may be short.
+ */
+class ShardWriter {
+    public:
+        /**
+         * @param directory Created if missing; numbering continues after existing shards with the same prefix
+         * @param recordsPerShard Records in every full shard
+         * @param prefix File names are prefix-NNNNNN.tsp
+         */
+        ShardWriter(std::filesystem::path directory, size_t recordsPerShard = 65536, std::string prefix = "shard");
+
+        /**
+         * @brief Calls Close().
+         */
+        ~ShardWriter();
+
+        ShardWriter(const ShardWriter&)            = delete;
+        ShardWriter& operator=(const ShardWriter&) = delete;
+
+        /**
+         * @brief Queue records; safe to call from several threads.
+         *
+         * A call's records stay contiguous and in order, but may straddle two shards.
+         * @throws std::runtime_error if the writer has failed or been closed
+         */
+        void Append(const SelfPlayRecord* records, size_t count);
+
+        /**
+         * @brief Write out everything buffered and stop the writer thread.
+         * @throws std::runtime_error if a shard could not be written
+         */
+        void Close();
+
+        ShardWriterStats GetStats() const;
+
+        const std::filesystem::path& GetDirectory() const noexcept { return m_directory; }
+
+    private:
+        void _writerLoop();
+        void _writeShard(const std::vector<SelfPlayRecord>& records);
+
+        std::filesystem::path m_directory;
+        std::string m_prefix;
+        size_t m_recordsPerShard;
+        uint32_t m_nextShard = 0;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_writerWake;
+        std::condition_variable m_producerWake;
+        std::vector<SelfPlayRecord> m_filling;
+        std::vector<SelfPlayRecord> m_writing;  // Non-empty while the writer owns it
+        bool m_closing = false;
+        bool m_closed = false;
+        std::string m_error;
+        ShardWriterStats m_stats;
+
+        std::thread m_thread;
+};
+
+/**
+ * @brief Check a shard header against this build's format and the size of its file.
+ * @param fileSize Size of the whole shard file in bytes
+ * @param path Only used in error messages
+ * @throws std::runtime_error naming the field that does not match, or if the file is too short for recordCount
+ */
+void CheckShardHeader(const ShardHeader& header, uint64_t fileSize, const std::filesystem::path& path);
+
+/**
+ * @brief Read a whole shard back.
+ * @throws std::runtime_error if the file is missing, truncated or has an unsupported header
+ */
+std::vector<SelfPlayRecord> ReadShard(const std::filesystem::path& path, ShardHeader* header = nullptr);
+
+} // namespace tetris
+
+#endif // SELFPLAYSHARD_H
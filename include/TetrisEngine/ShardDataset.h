@@ -0,0 +1,165 @@
+#ifndef SHARDDATASET_H
+#define SHARDDATASET_H
+
+// Random-access training data over a directory of self-play shards.
+//
+// ShardDataset memory-maps shards on first touch and finds records through a
+// compact offset index (one entry per shard), so opening a dataset of hundreds
+// of millions of positions reads a single small file. DatasetLoader turns it
+// into an endless stream of shuffled, already-encoded minibatches prepared by
+// background threads.
+
+#include "MappedFile.h"
+#include "SelfPlayShard.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tetris {
+
+/// Written next to the shards by ShardDataset and reused while it matches them
+constexpr const char* DATASET_INDEX_FILE = "index.tsi";
+
+/// Floats in the policy target of one decoded sample
+constexpr size_t DATASET_POLICY_SIZE = RECORD_ACTION_COUNT;
+
+class ShardDataset {
+    public:
+        /**
+         * @brief Open every .tsp shard in a directory.
+         *
+         * Loads the offset index if it lists exactly the shards present (same names
+         * and sizes); otherwise reads each shard header and writes a new index.
+         * @throws std::runtime_error if there are no shards or a header is invalid
+         */
+        explicit ShardDataset(const std::filesystem::path& directory);
+        ~ShardDataset();
+
+        ShardDataset(const ShardDataset&)            = delete;
+        ShardDataset& operator=(const ShardDataset&) = delete;
+
+        /**
+         * @brief Total records over all shards.
+         */
+        uint64_t Size() const noexcept { return m_offsets.back(); }
+
+        size_t GetShardCount() const noexcept { return m_shards.size(); }
+
+        /**
+         * @brief True if the index was loaded from disk rather than rebuilt.
+         */
+        bool IndexWasLoaded() const noexcept { return m_indexLoaded; }
+
+        /**
+         * @brief Record by global index in [0, Size()); maps its shard on first use.
+         * @throws std::runtime_error if the shard no longer matches the index
+         */
+        const SelfPlayRecord& GetRecord(uint64_t index) const;
+
+        /**
+         * @brief Decode records into training tensors.
+         * @param observations Receives count * BOARD_FEATURE_SIZE floats
+         * @param policies Receives count * DATASET_POLICY_SIZE probabilities, or nullptr
+         * @param values Receives count outcomes, or nullptr
+         */
+        void Decode(const uint64_t* indices, size_t count, float* observations, float* policies, float* values) const;
+
+    private:
+        struct Shard;
+
+        bool _loadIndex(const std::vector<std::filesystem::path>& paths);
+        void _buildIndex(const std::vector<std::filesystem::path>& paths);
+        const SelfPlayRecord* _mapShard(size_t shard) const;
+
+        std::filesystem::path m_directory;
+        std::vector<std::unique_ptr<Shard>> m_shards;
+        std::vector<uint64_t> m_offsets;  // m_offsets[i] = first global index of shard i; back() = Size()
+        bool m_indexLoaded = false;
+};
+
+struct DatasetLoaderOptions {
+    size_t batchSize = 1024;
+
+    /// Background threads decoding batches
+    size_t threads = 2;
+
+    /// Decoded batches kept ready ahead of the consumer
+    size_t prefetchBatches = 8;
+
+    /// Selects the shuffle order; every epoch uses a different permutation
+    uint64_t seed = 0;
+};
+
+struct DatasetLoaderStats {
+    uint64_t batchesServed = 0;
+    uint64_t epoch = 0;               ///< Epoch the next batch starts in
+    double consumerWaitSeconds = 0.0; ///< Time Next() blocked because no batch was ready
+};
+
+/**
+ * @brief Shuffled minibatches from a ShardDataset, decoded ahead of time.
+ *
+ * Each epoch visits every record exactly once in a keyed pseudo-random order
+ * (a Feistel permutation, so no index array is ever materialized), and batches
+ * run across epoch boundaries. Batch k is always the same for a given seed no
+ * matter how many threads decode.
+ */
+class DatasetLoader {
+    public:
+        /**
+         * @param dataset Must outlive the loader
+         */
+        DatasetLoader(const ShardDataset& dataset, DatasetLoaderOptions options = {});
+        ~DatasetLoader();
+
+        DatasetLoader(const DatasetLoader&)            = delete;
+        DatasetLoader& operator=(const DatasetLoader&) = delete;
+
+        /**
+         * @brief Copy the next batch into caller buffers, waiting if it is not ready.
+         *
+         * The buffers can be anything the caller likes, e.g. page-locked memory a GPU
+         * copies from directly.
+         * @param observations Receives batchSize * BOARD_FEATURE_SIZE floats
+         * @param policies Receives batchSize * DATASET_POLICY_SIZE floats, or nullptr
+         * @param values Receives batchSize floats, or nullptr
+         * @throws std::runtime_error rethrown from a decoding thread
+         * @note Meant for a single consuming thread
+         */
+        void Next(float* observations, float* policies, float* values);
+
+        DatasetLoaderStats GetStats() const;
+        size_t GetBatchSize() const noexcept { return m_options.batchSize; }
+
+    private:
+        struct Slot;
+
+        void _workerLoop();
+        void _fill(Slot& slot, uint64_t batch);
+
+        const ShardDataset& m_dataset;
+        DatasetLoaderOptions m_options;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_slotFree;
+        std::condition_variable m_slotReady;
+        std::vector<std::unique_ptr<Slot>> m_slots;
+        uint64_t m_nextToFill = 0;
+        uint64_t m_nextToServe = 0;
+        bool m_stop = false;
+        std::exception_ptr m_error;
+        double m_waitSeconds = 0.0;
+
+        std::vector<std::thread> m_workers;
+};
+
+} // namespace tetris
+
+#endif // SHARDDATASET_H
@@ -0,0 +1,193 @@
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+// Runs a Game on its own thread at the fixed logical rate.
+//
+// The render thread never touches the simulated game. After every frame and every
+// command the simulation thread serializes the game (Game::SaveState, a few hundred
+// bytes) into a TripleBuffer; the render thread restores the latest publication
+// into a view game of its own and draws that. Commands travel the other way through
+// a queue and are applied as soon as they arrive, not at the next frame, so neither
+// input latency nor gravity and lock delay depend on how long a frame takes to draw.
+//
+// Keyboard events take a faster path: a lock-free SPSC queue of timestamped key
+// changes, which the simulation maps onto its logical clock and feeds to one
+// InputHandler per player. The thread also wakes for the handlers' repeat deadlines,
+// so DAS/ARR/SDF moves land at their exact time instead of the next frame.
+//
+// What the simulation itself costs (step time, each board's share when the game
+// has board timing on, heap allocations per frame) goes out through a second
+// TripleBuffer for the performance overlay. Each snapshot also carries the time
+// of the newest key it reflects, for measuring input-to-display latency.
+
+#include "Game.h"
+#include "InputHandler.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tetris {
+
+/**
+ * @brief Something the render thread asks the simulated game to do.
+ */
+struct GameCommand {
+    enum class Kind : uint8_t {
+        INPUT,          ///< Game::ApplyInput(player, input)
+        ADD_GARBAGE,    ///< Game::AddGarbage(player, lines)
+        RESET_GAME,     ///< Game::Reset()
+        RELEASE_KEYS    ///< InputHandler::ReleaseAll for every player, e.g. when the window loses focus
+    };
+
+    Kind kind = Kind::INPUT;
+    size_t player = 0;
+    InputType input = InputType::MOVE_LEFT;
+    int lines = 0;
+
+    static GameCommand Input(size_t player, InputType input) { return {Kind::INPUT, player, input, 0}; }
+    static GameCommand Garbage(size_t player, int lines) { return {Kind::ADD_GARBAGE, player, InputType::MOVE_LEFT, lines}; }
+    static GameCommand Reset() { return {Kind::RESET_GAME, 0, InputType::MOVE_LEFT, 0}; }
+    static GameCommand ReleaseKeys() { return {Kind::RELEASE_KEYS, 0, InputType::MOVE_LEFT, 0}; }
+};
+
+/**
+ * @brief Cost of the simulation thread's most recent batch of frames.
+ */
+struct SimulationStats {
+    uint64_t frames = 0;                ///< Frames simulated when published
+    double stepMs = 0.0;                ///< Mean Game::StepFrame time over the batch
+    double allocationsPerFrame = 0.0;   ///< Simulation-thread heap allocations per frame since the last publication
+    std::vector<float> boardUs;         ///< Each board's part of the last StepFrame, in microseconds (see Game::SetBoardTiming)
+};
+
+class SimulationThread {
+    public:
+        /**
+         * @param game Not owned; from Start until Stop only the simulation thread may touch it
+         * @param handling DAS/ARR/SDF for every player's keys
+         * @throws std::invalid_argument for invalid handling settings
+         * @note The current state is published straight away, so a view is available before Start
+         */
+        explicit SimulationThread(Game& game, const HandlingSettings& handling = {});
+        ~SimulationThread();
+
+        SimulationThread(const SimulationThread&) = delete;
+        SimulationThread& operator=(const SimulationThread&) = delete;
+
+        void Start();
+
+        /**
+         * @brief Stop and join the thread; the game may be used directly again afterwards.
+         */
+        void Stop();
+
+        /**
+         * @brief Queue a command; it is applied before the next frame is simulated.
+         */
+        void Submit(const GameCommand& command);
+
+        /**
+         * @brief Render thread: queue a key change for the player's InputHandler.
+         *
+         * The event's timestamp, not its arrival, decides when it happens in logical time;
+         * events stamped before the current frame began count as its start.
+         * @return false if the queue is full and the event was dropped
+         * @throws std::out_of_range for a player the game does not have
+         */
+        bool PushKey(const KeyEvent& event);
+
+        /**
+         * @brief Render thread: restore the latest publication into a view game.
+         * @param view A game with the simulated game's player count, used only for drawing
+         * @return true if the view changed
+         * @throws whatever the simulation threw; the simulation has stopped by then
+         */
+        bool UpdateView(Game& view);
+
+        /**
+         * @brief Render thread: when the newest key change in the view was made, reported once.
+         *
+         * Call after drawing a frame from UpdateView's view to measure input-to-display latency.
+         * @return KeyEvent::timeNs of the newest key the view reflects if not reported yet, otherwise 0
+         */
+        int64_t TakeViewInputNs();
+
+        /**
+         * @brief Called on the simulation thread after publishing a change that shows on screen.
+         *
+         * Frames where only timers advanced (gravity below a row, lock delay running)
+         * are published but do not count, so a render loop that sleeps until this
+         * fires redraws exactly when a piece moves, falls, locks or the boards change.
+         * @note Set before Start; keep it short, e.g. wake the render loop
+         */
+        void SetChangeCallback(std::function<void()> callback) { m_onChange = std::move(callback); }
+
+        /**
+         * @brief Any thread: a simulated board's events, as they happen rather than as of the last publication.
+         * @throws std::out_of_range for a player the game does not have
+         */
+        const GameEventRing& GetEvents(size_t player) const { return m_game.getBoard(player).GetEvents(); }
+
+        /**
+         * @brief Render thread: the latest simulation stats, picked up now.
+         * @note The reference stays valid until the next call
+         */
+        const SimulationStats& PollStats();
+
+        /// Frames simulated since Start
+        uint64_t GetFramesSimulated() const noexcept { return m_framesSimulated.load(std::memory_order_relaxed); }
+
+        /// Frames dropped because the simulation fell more than a few frames behind real time
+        uint64_t GetFramesDropped() const noexcept { return m_framesDropped.load(std::memory_order_relaxed); }
+
+    private:
+        struct Publication {
+            std::vector<uint8_t> state;   ///< Game::SaveState
+            int64_t inputNs = 0;          ///< Timestamp of the newest key press applied before it
+        };
+
+        void _run();
+        void _apply(const GameCommand& command);
+        void _publish();
+        void _notifyIfChanged();
+        void _publishStats(uint64_t frames, int64_t stepNs, uint64_t allocations);
+
+        Game& m_game;
+        TripleBuffer<Publication> m_snapshots;
+        TripleBuffer<SimulationStats> m_stats;
+        ByteWriter m_writer;
+        std::vector<InputHandler> m_handlers;   ///< Simulation thread only, one per player
+        SpscQueue<KeyEvent> m_keys;
+        std::vector<std::pair<double, KeyEvent>> m_pendingKeys;   ///< Popped keys and their logical times
+        int64_t m_appliedInputNs = 0;          ///< Simulation thread only
+        int64_t m_viewInputNs = 0;             ///< Render thread only, as of the last UpdateView
+        int64_t m_reportedInputNs = 0;         ///< Render thread only
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::vector<GameCommand> m_commands;   ///< Guarded by m_mutex
+        std::vector<GameCommand> m_applying;   ///< Simulation thread only
+        bool m_stop = false;                   ///< Guarded by m_mutex
+        std::exception_ptr m_error;            ///< Guarded by m_mutex
+
+        std::function<void()> m_onChange;
+        uint64_t m_shownSignature = 0;          ///< Simulation thread only
+
+        std::thread m_thread;
+        std::atomic<uint64_t> m_framesSimulated{0};
+        std::atomic<uint64_t> m_framesDropped{0};
+};
+
+} // namespace tetris
+
+#endif // SIMULATIONTHREAD_H
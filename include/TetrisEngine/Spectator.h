@@ -0,0 +1,132 @@
+#ifndef SPECTATOR_H
+#define SPECTATOR_H
+
+// Live bot matches for the spectator wall.
+//
+// A few simulation threads each own a share of the matches, step them at a fixed
+// logical rate and, after every batch of frames, publish what every board looks
+// like through a TripleBuffer. The render thread only ever reads the latest
+// publication, so a slow frame never holds a simulation back and the simulations
+// never wait for a frame.
+
+#include "Bot.h"
+#include "Farm.h"
+#include "TripleBuffer.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tetris {
+
+struct SpectatorConfig {
+    size_t matches = 64;          ///< Matches running at once
+    size_t playersPerMatch = 1;   ///< 1 for solo games, 2 for versus
+    size_t threads = 0;           ///< Simulation threads; 0 leaves one core for rendering
+    double speed = 1.0;           ///< Game seconds per wall-clock second; 0 runs as fast as possible
+    uint64_t seed = 0;            ///< Match k of slot s is seeded MatchSeed(seed, k * matches + s)
+    MatchConfig match;
+};
+
+/**
+ * @brief What one board looked like at the last publication.
+ */
+struct SpectatorTile {
+    std::array<PieceType, VISIBLE_BOARD_HEIGHT * BOARD_WIDTH> cells{};  ///< As Board::GetRenderableState
+    uint32_t pieces = 0;
+    uint32_t lines = 0;
+    uint32_t attack = 0;
+    uint32_t matchesPlayed = 0;   ///< Finished matches in this board's slot
+    bool toppedOut = false;
+    int16_t lastAction = -1;                ///< Bot's latest choice (see MatchArena::GetLastAction)
+    PieceType lastPiece = PieceType::EMPTY; ///< Piece it was choosing for
+};
+
+/**
+ * @brief Runs matches on background threads and publishes their boards.
+ *
+ * Tile t is seat t % playersPerMatch of match slot t / playersPerMatch. A finished
+ * match stays on screen for a second of game time before its slot starts the next one.
+ */
+class SpectatorFeed {
+    public:
+        /**
+         * @param bots Assigned round-robin over seats; shared by every thread, so they must outlive the feed
+         * @throws std::invalid_argument for no bots, no matches or an unsupported player count
+         */
+        SpectatorFeed(std::vector<const Bot*> bots, const SpectatorConfig& config);
+        ~SpectatorFeed();
+
+        SpectatorFeed(const SpectatorFeed&) = delete;
+        SpectatorFeed& operator=(const SpectatorFeed&) = delete;
+
+        size_t GetTileCount() const noexcept { return m_tileCount; }
+
+        /**
+         * @brief Pick up the latest publication of every simulation thread.
+         * @return true if any tile changed
+         * @throws whatever a simulation thread threw; that thread's matches stop
+         * @note Render thread only, like GetTile
+         */
+        bool Poll();
+
+        /**
+         * @brief Tile as of the last Poll.
+         */
+        const SpectatorTile& GetTile(size_t tile) const;
+
+        /// Frames simulated over all matches so far
+        uint64_t GetFramesSimulated() const noexcept { return m_framesSimulated.load(std::memory_order_relaxed); }
+
+        /// Matches finished so far
+        uint64_t GetMatchesPlayed() const noexcept { return m_matchesPlayed.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Any thread: bot decisions over every match so far, as of each thread's last publication.
+         */
+        BotSearchStats GetSearchStats() const noexcept;
+
+    private:
+        struct Slot {
+            MatchArena arena;
+            uint64_t match = 0;         ///< Matches started in this slot, the running one included
+            uint32_t finished = 0;
+            uint32_t holdFrames = 0;    ///< Frames left showing a finished match
+        };
+
+        struct Worker {
+            size_t firstSlot = 0;
+            std::vector<Slot> slots;
+            std::unique_ptr<TripleBuffer<std::vector<SpectatorTile>>> tiles;
+            BotSearchStats reported;    ///< Search totals already added to the feed's
+            std::thread thread;
+        };
+
+        void _run(Worker& worker);
+        void _startMatch(Slot& slot, size_t slotIndex);
+        void _publish(Worker& worker);
+
+        std::vector<const Bot*> m_bots;
+        SpectatorConfig m_config;
+        size_t m_tileCount;
+        std::vector<Worker> m_workers;
+        std::vector<std::pair<size_t, size_t>> m_tileOwners;  ///< (worker, index in its tiles)
+        std::atomic<bool> m_stop{false};
+        std::atomic<uint64_t> m_framesSimulated{0};
+        std::atomic<uint64_t> m_matchesPlayed{0};
+        std::atomic<uint64_t> m_decisions{0};
+        std::atomic<uint64_t> m_nodes{0};
+        std::atomic<uint64_t> m_searchNs{0};
+        std::atomic<int> m_searchDepth{0};
+        std::mutex m_errorMutex;
+        std::exception_ptr m_error;
+};
+
+} // namespace tetris
+
+#endif // SPECTATOR_H
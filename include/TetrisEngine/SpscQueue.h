@@ -0,0 +1,86 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+// Bounded lock-free queue from one producer thread to one consumer thread.
+//
+// A ring of slots with a head the consumer advances and a tail the producer
+// advances, each on its own cache line. Each side keeps a cached copy of the
+// other's index and only reloads it when the ring looks full (or empty), so a
+// push or pop usually touches no shared cache line but its own.
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace tetris {
+
+template <typename T>
+class SpscQueue {
+    public:
+        /**
+         * @param capacity Rounded up to a power of two
+         * @throws std::invalid_argument for a capacity of 0
+         */
+        explicit SpscQueue(size_t capacity) {
+            if (capacity == 0) throw std::invalid_argument("SpscQueue capacity must be at least 1");
+            size_t size = 1;
+            while (size < capacity) size <<= 1;
+            m_slots.resize(size);
+            m_mask = size - 1;
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        size_t Capacity() const noexcept { return m_slots.size(); }
+
+        /**
+         * @brief Producer: append a value.
+         * @return false, leaving the queue unchanged, if it is full
+         */
+        bool TryPush(const T& value) noexcept {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_headCache == m_slots.size()) {
+                m_headCache = m_head.load(std::memory_order_acquire);
+                if (tail - m_headCache == m_slots.size()) return false;
+            }
+            m_slots[tail & m_mask] = value;
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Consumer: take the oldest value.
+         * @return false if the queue is empty
+         */
+        bool TryPop(T& out) noexcept {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tailCache) {
+                m_tailCache = m_tail.load(std::memory_order_acquire);
+                if (head == m_tailCache) return false;
+            }
+            out = m_slots[head & m_mask];
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Either side: true if nothing was queued as of the call.
+         */
+        bool Empty() const noexcept {
+            return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::vector<T> m_slots;
+        size_t m_mask = 0;
+        alignas(64) std::atomic<size_t> m_head{0};  // next slot to pop
+        size_t m_tailCache = 0;                     // consumer only
+        alignas(64) std::atomic<size_t> m_tail{0};  // next slot to push
+        size_t m_headCache = 0;                     // producer only
+};
+
+} // namespace tetris
+
+#endif // SPSCQUEUE_H
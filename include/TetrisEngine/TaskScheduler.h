@@ -0,0 +1,87 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+// Work-stealing scheduler for many independent tasks of uneven length.
+//
+// Every worker owns a deque: it pops its own newest task and, when that runs dry,
+// steals the oldest task of another worker. Tasks submitted from outside are
+// dealt round-robin; tasks submitted from inside a task go to the submitting
+// worker, so recursive splits stay on one core until someone is idle.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tetris {
+
+class TaskScheduler {
+    public:
+        /// Receives the index of the worker running it, for per-worker scratch state
+        using Task = std::function<void(size_t worker)>;
+
+        /**
+         * @param threads Worker count; 0 means std::thread::hardware_concurrency()
+         * @param pinThreads Pin worker i to CPU i (mod the CPU count); ignored where unsupported
+         */
+        explicit TaskScheduler(size_t threads = 0, bool pinThreads = false);
+        ~TaskScheduler();
+
+        TaskScheduler(const TaskScheduler&)            = delete;
+        TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+        /**
+         * @brief Queue a task; safe to call from any thread, including from a running task.
+         */
+        void Submit(Task task);
+
+        /**
+         * @brief Block until every submitted task has finished.
+         *
+         * The first exception thrown by a task is rethrown here; tasks still queued at that
+         * point are run anyway, so Wait() always returns with the scheduler idle.
+         * @note Must not be called from inside a task
+         */
+        void Wait();
+
+        size_t Size() const noexcept { return m_workers.size(); }
+
+        /**
+         * @brief Tasks taken from another worker's deque since construction.
+         */
+        uint64_t GetSteals() const noexcept { return m_steals.load(std::memory_order_relaxed); }
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void _workerLoop(size_t worker);
+        bool _takeTask(size_t worker, Task& task);
+        void _push(size_t worker, Task&& task);
+
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        std::atomic<size_t> m_queued{0};      // tasks sitting in deques
+        std::atomic<size_t> m_unfinished{0};  // submitted but not yet finished
+        std::atomic<size_t> m_nextQueue{0};
+        std::atomic<uint64_t> m_steals{0};
+        std::exception_ptr m_error;
+        bool m_stop = false;
+};
+
+} // namespace tetris
+
+#endif // TASKSCHEDULER_H
@@ -0,0 +1,116 @@
+#ifndef TETRISSIM_H
+#define TETRISSIM_H
+
+/*
+ * Plain C interface to the batched simulator (VecEnv), built as libtetris_sim.
+ *
+ * Every function writes into buffers owned by the caller, so Python can hand in
+ * NumPy arrays through ctypes and nothing is copied or allocated per step. All
+ * buffers are C-contiguous and sized for every env at once:
+ *
+ *   observations  float   [num_envs, tetris_sim_observation_size()]
+ *   masks         uint8   [num_envs, tetris_sim_action_count()]
+ *   actions       int32   [num_envs]
+ *   rewards       float   [num_envs]
+ *   dones         uint8   [num_envs]
+ *
+ * Functions returning int return 0 on success and -1 on failure, including a NULL
+ * handle or a NULL buffer not marked "may be NULL"; the message is then available
+ * from tetris_sim_last_error() on the same thread.
+ */
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+    #if defined(TETRIS_SIM_BUILD)
+        #define TETRIS_SIM_API __declspec(dllexport)
+    #else
+        #define TETRIS_SIM_API __declspec(dllimport)
+    #endif
+#else
+    #define TETRIS_SIM_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bumped whenever a signature or buffer layout changes. */
+#define TETRIS_SIM_ABI_VERSION 2
+
+typedef struct TetrisSim TetrisSim;
+typedef struct TetrisDataset TetrisDataset;
+
+TETRIS_SIM_API uint32_t tetris_sim_abi_version(void);
+TETRIS_SIM_API uint32_t tetris_sim_observation_size(void);
+TETRIS_SIM_API uint32_t tetris_sim_action_count(void);
+
+/**
+ * @brief Create num_envs environments.
+ * @param threads Stepping threads including the caller, 0 for hardware concurrency
+ * @param max_pieces Episode length limit in pieces, 0 for none
+ * @param top_out_reward Reward added when an episode ends by topping out
+ * @return NULL on failure
+ */
+TETRIS_SIM_API TetrisSim* tetris_sim_create(uint32_t num_envs, uint32_t threads, uint32_t max_pieces, float top_out_reward);
+TETRIS_SIM_API void tetris_sim_destroy(TetrisSim* sim);
+TETRIS_SIM_API uint32_t tetris_sim_num_envs(const TetrisSim* sim);
+
+/** @param seeds uint64 [num_envs]; observations and masks may be NULL */
+TETRIS_SIM_API int tetris_sim_reset(TetrisSim* sim, const uint64_t* seeds, float* observations, uint8_t* masks);
+
+/** Finished envs reset themselves; observations and masks may be NULL. */
+TETRIS_SIM_API int tetris_sim_step(TetrisSim* sim, const int32_t* actions, float* observations, float* rewards, uint8_t* dones, uint8_t* masks);
+
+/** Legal-action masks of the current state. */
+TETRIS_SIM_API int tetris_sim_legal_moves(const TetrisSim* sim, uint8_t* masks);
+
+/** Observations of the current state. */
+TETRIS_SIM_API int tetris_sim_encode(const TetrisSim* sim, float* observations);
+
+/**
+ * @brief Raw state, for debugging and data recording.
+ * @param rows uint16 [num_envs, 27], bit c = column c, row 0 at the bottom (may be NULL)
+ * @param pieces uint8 [num_envs, 7]: current, hold, next 5 as PieceType values (may be NULL)
+ */
+TETRIS_SIM_API int tetris_sim_get_state(const TetrisSim* sim, uint16_t* rows, uint8_t* pieces);
+
+/**
+ * @brief Encode arbitrary positions without an env, e.g. when replaying recorded data.
+ * @param rows uint16 [count, 20] visible rows, bottom first
+ * @param pieces uint8 [count, 7]: current, hold, next 5
+ * @param observations float [count, tetris_sim_observation_size()]
+ */
+TETRIS_SIM_API int tetris_sim_encode_positions(const uint16_t* rows, const uint8_t* pieces, uint32_t count, float* observations);
+
+/**
+ * @brief Open a directory of self-play shards (docs/selfplay_format.md) for training.
+ *
+ * Background threads decode shuffled minibatches ahead of tetris_dataset_next.
+ * @param batch_size Samples per batch
+ * @param threads Decoding threads, at least 1
+ * @param seed Shuffle order; each epoch is a fresh permutation of every record
+ * @return NULL on failure
+ */
+TETRIS_SIM_API TetrisDataset* tetris_dataset_open(const char* directory, uint32_t batch_size, uint32_t threads, uint64_t seed);
+TETRIS_SIM_API void tetris_dataset_close(TetrisDataset* dataset);
+
+/** Records in the dataset, 0 for a NULL handle. */
+TETRIS_SIM_API uint64_t tetris_dataset_size(const TetrisDataset* dataset);
+
+/**
+ * @brief Copy the next batch out, blocking until it is decoded.
+ * @param observations float [batch_size, tetris_sim_observation_size()]
+ * @param policies float [batch_size, tetris_sim_action_count()] move distributions (may be NULL)
+ * @param values float [batch_size] game outcomes from each position (may be NULL)
+ */
+TETRIS_SIM_API int tetris_dataset_next(TetrisDataset* dataset, float* observations, float* policies, float* values);
+
+/** Message of the last failed call on this thread, "" if none. */
+TETRIS_SIM_API const char* tetris_sim_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TETRISSIM_H */
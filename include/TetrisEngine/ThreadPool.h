@@ -0,0 +1,68 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tetris {
+
+/**
+ * @brief Fixed set of worker threads for data-parallel loops.
+ *
+ * Workers sleep between calls; the calling thread takes part in every loop, so a
+ * pool of size 1 has no workers and runs everything inline.
+ */
+class ThreadPool {
+    public:
+        /**
+         * @param threads Total threads including the caller; 0 means std::thread::hardware_concurrency()
+         */
+        explicit ThreadPool(size_t threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&)            = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * @brief Run body over [0, count) in chunks of at most grain items and wait for all of them.
+         *
+         * Chunks are handed out dynamically, so uneven work balances itself. The first
+         * exception thrown by body is rethrown here once every chunk has finished.
+         * @note Calls from several threads at once are serialized
+         */
+        void ParallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& body);
+
+        size_t Size() const noexcept { return m_workers.size() + 1; }
+
+    private:
+        void _workerLoop();
+        void _runChunks();
+
+        std::vector<std::thread> m_workers;
+
+        std::mutex m_callMutex;     // one ParallelFor at a time
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_done;
+        uint64_t m_generation = 0;
+        size_t m_busy = 0;
+        bool m_stop = false;
+
+        // Current job, valid while a ParallelFor is running
+        const std::function<void(size_t, size_t)>* m_body = nullptr;
+        size_t m_count = 0;
+        size_t m_grain = 1;
+        std::atomic<size_t> m_next{0};
+        std::exception_ptr m_error;
+};
+
+} // namespace tetris
+
+#endif // THREADPOOL_H
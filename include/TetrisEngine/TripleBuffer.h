@@ -0,0 +1,69 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+// Lock-free hand-off of the latest value from one producer thread to one consumer.
+//
+// The producer fills its back buffer and publishes it; the consumer picks up the
+// most recent publication whenever it likes. Neither side ever waits for the
+// other: a producer running ahead simply overwrites publications nobody read,
+// and a slow consumer keeps drawing the last value it picked up.
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace tetris {
+
+template <typename T>
+class TripleBuffer {
+    public:
+        TripleBuffer() = default;
+
+        /**
+         * @brief Start all three buffers as copies of one value, e.g. to size their storage.
+         */
+        explicit TripleBuffer(const T& initial) : m_buffers{initial, initial, initial} {}
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        /**
+         * @brief Producer: the buffer to fill next. It still holds an older value, never the consumer's.
+         */
+        T& WriteBuffer() noexcept { return m_buffers[m_back]; }
+
+        /**
+         * @brief Producer: make the write buffer the latest value.
+         */
+        void Publish() noexcept {
+            m_back = m_middle.exchange(static_cast<uint8_t>(m_back | FRESH), std::memory_order_acq_rel) & INDEX;
+        }
+
+        /**
+         * @brief Consumer: pick up the latest publication, if there is a new one.
+         * @return true if Read now returns a newer value
+         */
+        bool Update() noexcept {
+            if (!(m_middle.load(std::memory_order_relaxed) & FRESH)) return false;
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+            return true;
+        }
+
+        /**
+         * @brief Consumer: the value picked up by the last Update; stable until the next one.
+         */
+        const T& Read() const noexcept { return m_buffers[m_front]; }
+
+    private:
+        static constexpr uint8_t INDEX = 0x3;
+        static constexpr uint8_t FRESH = 0x4;
+
+        std::array<T, 3> m_buffers{};
+        alignas(64) std::atomic<uint8_t> m_middle{1};  // index of the shared buffer, FRESH if unread
+        alignas(64) uint8_t m_back = 0;                // producer only
+        alignas(64) uint8_t m_front = 2;               // consumer only
+};
+
+} // namespace tetris
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,157 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+// CMA-ES search over HeuristicBot weights, scored by headless solo games.
+//
+// Every candidate of a run plays the same seeded games (common random numbers),
+// so two weight vectors are compared on identical piece sequences and the
+// difference between their scores is the difference between the weights, not
+// between their luck. Games are spread over a TaskScheduler and folded in a
+// fixed order, so a run gives the same numbers on any number of threads.
+
+#include "Bot.h"
+#include "ByteStream.h"
+#include "Farm.h"
+#include "TaskScheduler.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace tetris {
+
+/// Weights the tuner searches over; top_out only has to stay below every real evaluation
+constexpr size_t TUNED_WEIGHT_COUNT = 5;
+
+std::vector<double> WeightsToVector(const HeuristicWeights& weights);
+
+/**
+ * @brief Tuned weights from a search vector; weights not tuned keep their defaults.
+ */
+HeuristicWeights VectorToWeights(const std::vector<double>& vector);
+
+/**
+ * @brief Per-game score a candidate is maximising.
+ */
+enum class TuneObjective : uint8_t {
+    ATTACK = 0,   ///< Garbage generated; rewards tetrises and T-spins over singles
+    LINES = 1,    ///< Lines cleared; saturates once a candidate survives every game
+};
+
+struct TuneConfig {
+    MatchConfig match;
+    uint32_t games = 64;        ///< Games per candidate, the same ones for every candidate
+    uint64_t seed = 0;          ///< Game g is MatchSeed(seed, g)
+    TuneObjective objective = TuneObjective::ATTACK;
+};
+
+/**
+ * @brief Scores weight vectors by their mean result over the configured games.
+ */
+class WeightEvaluator {
+    public:
+        WeightEvaluator(TaskScheduler& scheduler, const TuneConfig& config);
+
+        /**
+         * @brief Mean per-game score of every candidate, in candidate order.
+         * @throws whatever a game throws, after all games have finished
+         */
+        std::vector<double> Evaluate(const std::vector<HeuristicWeights>& candidates);
+
+    private:
+        TaskScheduler& m_scheduler;
+        TuneConfig m_config;
+        std::vector<MatchArena> m_arenas;  ///< One per worker
+        std::vector<double> m_scores;      ///< candidate * games + game
+};
+
+/**
+ * @brief Covariance matrix adaptation evolution strategy (Hansen, "The CMA
+ * Evolution Strategy: A Tutorial"), maximising.
+ *
+ * Sampling is seeded from the run seed and the generation number, so a run
+ * restored from a checkpoint continues exactly as if it had never stopped.
+ */
+class CmaEs {
+    public:
+        /**
+         * @param mean Starting point
+         * @param sigma Initial step size, in the units of the search vector
+         * @param populationSize Candidates per generation; 0 picks 4 + 3 ln(n)
+         * @throws std::invalid_argument for an empty start point or a non-positive step size
+         */
+        CmaEs(std::vector<double> mean, double sigma, size_t populationSize = 0, uint64_t seed = 0);
+
+        /**
+         * @brief Sample this generation's candidates; asking again returns the same ones.
+         */
+        const std::vector<std::vector<double>>& Ask();
+
+        /**
+         * @brief Report one fitness per candidate from Ask and move to the next generation.
+         * @throws std::invalid_argument if the count does not match the population
+         */
+        void Tell(const std::vector<double>& fitness);
+
+        void Save(ByteWriter& out) const;
+
+        /**
+         * @throws std::runtime_error on truncated or inconsistent data
+         */
+        static CmaEs Load(ByteReader& in);
+
+        size_t GetDimension() const noexcept { return m_mean.size(); }
+        size_t GetPopulationSize() const noexcept { return m_lambda; }
+        uint64_t GetGeneration() const noexcept { return m_generation; }
+        double GetSigma() const noexcept { return m_sigma; }
+        const std::vector<double>& GetMean() const noexcept { return m_mean; }
+
+        /// Best candidate told so far; empty before the first Tell
+        const std::vector<double>& GetBest() const noexcept { return m_best; }
+        double GetBestFitness() const noexcept { return m_bestFitness; }
+
+    private:
+        void _setStrategyParameters();
+        void _updateEigensystem();
+
+        size_t m_lambda;
+        uint64_t m_seed;
+        uint64_t m_generation = 0;
+        double m_sigma;
+        std::vector<double> m_mean;
+        std::vector<double> m_covariance;    ///< n x n, row-major
+        std::vector<double> m_pathSigma;
+        std::vector<double> m_pathCovariance;
+        std::vector<double> m_best;
+        double m_bestFitness = 0.0;
+
+        // Derived from the above
+        size_t m_mu = 0;
+        std::vector<double> m_weights;
+        double m_muEff = 0.0, m_cSigma = 0.0, m_dSigma = 0.0, m_cc = 0.0, m_c1 = 0.0, m_cMu = 0.0, m_chiN = 0.0;
+        std::vector<double> m_basis;         ///< Eigenvectors of the covariance, as columns
+        std::vector<double> m_scales;        ///< Square roots of its eigenvalues
+        std::vector<std::vector<double>> m_population;
+        std::vector<std::vector<double>> m_steps;  ///< (x - mean) / sigma of every candidate
+        bool m_sampled = false;
+};
+
+/**
+ * @brief Write the optimiser and the game settings it is scored with.
+ *
+ * Written to a temporary file and renamed, so a crash never leaves a torn checkpoint.
+ * @throws std::runtime_error if the file cannot be written
+ */
+void SaveTunerCheckpoint(const std::filesystem::path& path, const CmaEs& optimizer, const TuneConfig& config);
+
+/**
+ * @brief Read a checkpoint written by SaveTunerCheckpoint.
+ * @param config Receives the game settings the run was scored with
+ * @throws std::runtime_error if the file is missing, truncated or not a tuner checkpoint
+ */
+CmaEs LoadTunerCheckpoint(const std::filesystem::path& path, TuneConfig& config);
+
+} // namespace tetris
+
+#endif // TUNER_H
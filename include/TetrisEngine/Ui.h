@@ -1,7 +1,19 @@
 #ifndef Ui_H
 #define Ui_H
 
+#include "FrameStats.h"
 #include "Game.h"
+#include "GameEvents.h"
+#include "PerfStats.h"
+#include "Replay.h"
+#include "SimulationThread.h"
+#include "Spectator.h"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <string>
 
@@ -11,27 +23,219 @@
 
 namespace tetris {
 
-// Wrapper
-bool DrawPlayer(Game& game, int playerNum, int offsetX, int offsetY, std::vector<std::string>& commandHistory, bool gameOver, int cellSize = 30);
+// Block grid of one board. Locked cells live in a texture that is only re-rendered when
+// Board::GetGridVersion changes (a lock, clear, garbage or reset); the ghost and active piece
+// are drawn on top, so a steady frame costs one texture blit and eight small rectangles.
+// Owns GPU memory: create after InitWindow and destroy before CloseWindow.
+class BoardRenderer {
+    public:
+        explicit BoardRenderer(int cellSize = 30);
+        ~BoardRenderer();
+
+        BoardRenderer(const BoardRenderer&) = delete;
+        BoardRenderer& operator=(const BoardRenderer&) = delete;
+
+        void Draw(const Board& board, int offsetX, int offsetY);
+
+        int GetCellSize() const { return m_cellSize; }
+
+        // Times the locked cells were re-rendered into the texture
+        uint64_t GetRedrawCount() const { return m_redraws; }
+
+    private:
+        void _renderLockedCells(const Board& board);
+        void _drawPiece(uint16_t repr, Point pos, int offsetX, int offsetY, Color color) const;
+
+        int m_cellSize;
+        RenderTexture2D m_texture{};
+        uint64_t m_gridVersion = 0;
+        uint64_t m_redraws = 0;
+};
+
+// Spectator wall: every tile of a SpectatorFeed at one pixel per cell in a single atlas texture,
+// uploaded once per frame and drawn with one point-filtered, scaled blit however many boards there are.
+// Owns GPU memory: create after InitWindow and destroy before CloseWindow.
+class SpectatorWallRenderer {
+    public:
+        SpectatorWallRenderer() = default;
+        ~SpectatorWallRenderer();
+
+        SpectatorWallRenderer(const SpectatorWallRenderer&) = delete;
+        SpectatorWallRenderer& operator=(const SpectatorWallRenderer&) = delete;
+
+        // Tiles are laid out in whichever grid shows them largest in the area
+        void Draw(const SpectatorFeed& feed, Rectangle area);
+
+    private:
+        void _layout(size_t tiles, Rectangle area);
+
+        Texture2D m_atlas{};
+        std::vector<Color> m_pixels;
+        size_t m_tiles = 0;
+        int m_columns = 0;
+        int m_rows = 0;
+        float m_scale = 1.0f;
+        float m_areaWidth = 0.0f;
+        float m_areaHeight = 0.0f;
+};
+
+// Event-driven frame pacing. While it exists, EndDrawing sleeps in the OS event wait until input
+// arrives, another thread calls Wake (the simulation reporting a change on screen) or a WakeAt
+// deadline passes, so an idle window costs no CPU; maxFps still caps the rate while busy (0 = uncapped).
+// Call FrameStart when the loop wakes and FrameEnd just before EndDrawing to collect frame times.
+// Create after InitWindow and destroy before CloseWindow.
+class FramePacer {
+    public:
+        explicit FramePacer(int maxFps);
+        ~FramePacer();
+
+        FramePacer(const FramePacer&) = delete;
+        FramePacer& operator=(const FramePacer&) = delete;
+
+        // Any thread: draw another frame as soon as possible
+        void Wake();
+
+        // Any thread: draw another frame no later than this many seconds from now
+        void WakeAfter(double seconds);
+
+        void FrameStart();
+        void FrameEnd();
+
+        int GetMaxFps() const { return m_maxFps; }
+        const FrameStats& GetStats() const { return m_stats; }
+
+    private:
+        void _run();
+
+        int m_maxFps;
+        FrameStats m_stats;
+        std::chrono::steady_clock::time_point m_frameStart{};
+
+        std::mutex m_mutex;
+        std::condition_variable m_changed;
+        std::chrono::steady_clock::time_point m_deadline = std::chrono::steady_clock::time_point::max();
+        bool m_stop = false;
+        std::thread m_timer;
+};
+
+// Where a frame's time goes on the render thread
+enum class FramePhase : uint8_t {
+    SIMULATION,   // keys, the simulation snapshot and board events
+    RENDER,       // raylib drawing
+    IMGUI         // building and drawing the panels
+};
+
+constexpr size_t FRAME_PHASE_COUNT = 3;
+
+// Scrolling numbers behind the performance panel; render thread only. Between FrameStart and FrameEnd,
+// Charge hands the time since the previous charge to a phase. Simulation and bot numbers are optional:
+// their sections only show once something has been set.
+class PerformanceMonitor {
+    public:
+        // Samples each plot scrolls over: frames for frame numbers, simulation publications, bot samples
+        static constexpr size_t HISTORY = 240;
+        using History = ValueHistory<HISTORY>;
+
+        // Bot totals are turned into rates this often
+        static constexpr double BOT_SAMPLE_SECONDS = 0.25;
+
+        void FrameStart();
+        void Charge(FramePhase phase);
+        void FrameEnd();
+
+        // Latest stats from SimulationThread::PollStats; recorded when the simulation has published since the last call
+        void SetSimulation(const SimulationStats& stats);
+
+        // Running bot totals, e.g. SpectatorFeed::GetSearchStats; inference is nullptr without a model
+        void SetBots(const BotSearchStats& search, const InferenceStats* inference);
+
+        // Move a bot just chose (see MatchArena::GetLastAction)
+        void SetPrincipalVariation(PieceType piece, int action) { m_pvPiece = piece; m_pvAction = action; }
+
+        const History& GetPhaseMs(FramePhase phase) const { return m_phaseMs[static_cast<size_t>(phase)]; }
+        const History& GetFrameMs() const { return m_frameMs; }
+        const History& GetAllocations() const { return m_allocations; }
+
+        bool HasSimulation() const { return m_hasSimulation; }
+        const History& GetStepMs() const { return m_stepMs; }
+        const History& GetSimulationAllocations() const { return m_simulationAllocations; }
+        const std::vector<History>& GetBoardUs() const { return m_boardUs; }
+
+        bool HasBots() const { return m_hasBots; }
+        bool HasInference() const { return m_hasInference; }
+        const History& GetNodesPerSecond() const { return m_nodesPerSecond; }
+        const History& GetDecisionUs() const { return m_decisionUs; }
+        const History& GetBatchMs() const { return m_batchMs; }
+        int GetSearchDepth() const { return m_depth; }
+        double GetNodesPerDecision() const { return m_nodesPerDecision; }
+        int GetPrincipalVariation(PieceType& piece) const { piece = m_pvPiece; return m_pvAction; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        Clock::time_point m_frameStart{};
+        Clock::time_point m_lastCharge{};
+        std::array<double, FRAME_PHASE_COUNT> m_charged{};
+        uint64_t m_allocationsAt = 0;
+        std::array<History, FRAME_PHASE_COUNT> m_phaseMs;
+        History m_frameMs;
+        History m_allocations;
+
+        bool m_hasSimulation = false;
+        uint64_t m_simulationFrames = 0;
+        History m_stepMs;
+        History m_simulationAllocations;
+        std::vector<History> m_boardUs;
+
+        bool m_hasBots = false;
+        bool m_hasInference = false;
+        Clock::time_point m_botSampleTime{};
+        BotSearchStats m_lastSearch;
+        InferenceStats m_lastInference;
+        History m_nodesPerSecond;
+        History m_decisionUs;
+        History m_batchMs;
+        int m_depth = 0;
+        double m_nodesPerDecision = 0.0;
+        PieceType m_pvPiece = PieceType::EMPTY;
+        int m_pvAction = -1;
+};
+
+// Frame time split by phase, allocations per frame, and the simulation and bot numbers when set, as scrolling plots
+void DrawPerformancePanel(const PerformanceMonitor& perf, const ImVec2& SetNextWindowPosVector);
+
+// Frame rate and frame times, from a FramePacer
+void DrawFrameStatsPanel(const FramePacer& pacer, const ImVec2& SetNextWindowPosVector);
+
+// Spectator totals
+void DrawSpectatorPanel(const SpectatorFeed& feed, double simFramesPerSecond, const ImVec2& SetNextWindowPosVector = ImVec2(20,20));
+
+// Wrapper: draws the player's board from a view of the simulated game, their panels from the board's events
+// (drained into the player's reader) and sends their inputs to the simulation. With a monitor, the board's
+// drawing is charged to FramePhase::RENDER and the panels to FramePhase::IMGUI.
+bool DrawPlayer(SimulationThread& sim, const Game& view, int playerNum, BoardRenderer& renderer, int offsetX, int offsetY, BoardEventReader& events, bool gameOver, PerformanceMonitor* perf = nullptr);
+
+// Keyboard: send every game key press and release, timestamped, to each player's DAS/ARR handler
+void PollGameKeys(SimulationThread& sim, size_t players);
 
 // Controls
 // TODO: Update this with gravity variable
-bool DrawControlsPanel(Board& board, int playerNum, std::vector<std::string>& commandHistory, bool gameOver, const ImVec2& SetNextWindowPosVector = ImVec2(600,100));
+bool DrawControlsPanel(SimulationThread& sim, const BoardHud& hud, int playerNum, bool gameOver, const ImVec2& SetNextWindowPosVector = ImVec2(600,100));
 
 // Next Queue
-void DrawQueuePanel(const Board& board, int playerNum, const ImVec2& SetNextWindowPosVector = ImVec2(450,100), const ImVec2& SetNextWindowSizeVector = ImVec2(100,0));
+void DrawQueuePanel(const BoardHud& hud, int playerNum, const ImVec2& SetNextWindowPosVector = ImVec2(450,100), const ImVec2& SetNextWindowSizeVector = ImVec2(100,0));
 
 // Hold
-void DrawHoldPanel(const Board& board, int playerNum, const ImVec2& SetNextWindowPosVector = ImVec2(450,350), const ImVec2& SetNextWindowSizeVector = ImVec2(100,0));
+void DrawHoldPanel(const BoardHud& hud, int playerNum, const ImVec2& SetNextWindowPosVector = ImVec2(450,350), const ImVec2& SetNextWindowSizeVector = ImVec2(100,0));
 
-// Command History
-void DrawHistoryPanel(const std::vector<std::string>& commandHistory, int playerNum, const ImVec2& SetNextWindowPosVector = ImVec2(600,350), const ImVec2& ScrollRegionSizeVector = ImVec2(250,200));
+// Recent events, formatted as they are drawn
+void DrawHistoryPanel(const BoardEventReader& events, int playerNum, const ImVec2& SetNextWindowPosVector = ImVec2(600,350), const ImVec2& ScrollRegionSizeVector = ImVec2(250,200));
 
-// Command History
-void DrawGarbagePanel(const Board& board, int playerNum, const ImVec2& SetNextWindowPosVector = ImVec2(100,800), const ImVec2& ScrollRegionSizeVector = ImVec2(250,200));
+// Garbage Stats
+void DrawGarbagePanel(const BoardHud& hud, int playerNum, const ImVec2& SetNextWindowPosVector = ImVec2(100,800), const ImVec2& ScrollRegionSizeVector = ImVec2(250,200));
 
-// Block Grid
-void DrawBoardGrid(const Board& board, int offsetX, int offsetY, int cellSize = 30);
+// Replay transport: play/pause, +-5 s and a frame slider; seeks the player and reports how long that took
+void DrawReplayPanel(ReplayPlayer& player, bool& playing, double& lastSeekMs, const ImVec2& SetNextWindowPosVector = ImVec2(100,20));
 
 } // namespace tetris::ui
 
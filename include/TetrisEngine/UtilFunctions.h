@@ -1,10 +1,49 @@
 #ifndef UtilFunctions_H
 #define UtilFunctions_H
 
+#include "ByteStream.h"
 #include <chrono>
+#include <cstdint>
 #include <functional>
+#include <random>
 
 namespace tetris {
+    /**
+     * @brief mt19937 that remembers its seed and how many numbers it has produced.
+     *
+     * That pair is its whole state, so it saves in a few bytes and restores by
+     * reseeding and discarding (a few microseconds for a whole game's worth of draws).
+     */
+    class SeekableRng {
+        public:
+            using result_type = std::mt19937::result_type;
+
+            explicit SeekableRng(result_type seed = std::mt19937::default_seed) : engine(seed), seed(seed) {}
+
+            static constexpr result_type min() { return std::mt19937::min(); }
+            static constexpr result_type max() { return std::mt19937::max(); }
+
+            result_type operator()() {
+                ++draws;
+                return engine();
+            }
+
+            result_type GetSeed() const { return seed; }
+            uint64_t GetDraws() const { return draws; }
+
+            void Restore(result_type newSeed, uint64_t drawCount) {
+                engine.seed(newSeed);
+                engine.discard(drawCount);
+                seed = newSeed;
+                draws = drawCount;
+            }
+
+        private:
+            std::mt19937 engine;
+            result_type seed;
+            uint64_t draws = 0;
+    };
+
     class GravityClock {
         public:
             using Callback = std::function<void(int rows)>;
@@ -16,13 +55,33 @@ namespace tetris {
                 Callback tickCallback = nullptr
             );
 
+            /**
+             * @brief Advance by however many frames of wall-clock time passed since the last call.
+             */
             void update();
+
+            /**
+             * @brief Advance by a fixed number of logical frames; deterministic, unlike update().
+             */
+            void step(double elapsedFrames = 1.0);
+
             void reset(double initialG = 0.02, double GRampUpDelay = 7200, double GIncrement = 0.0035);
             
             void setInitialGravity(double value) { initialGravity = value; }
             void setRampUpDelay(double value) { gravityRampUpDelay = value; }
             void setGravityIncrement(double value) { gravityIncrement = value; }
 
+            double getInitialGravity() const { return initialGravity; }
+            double getRampUpDelay() const { return gravityRampUpDelay; }
+            double getGravityIncrement() const { return gravityIncrement; }
+
+            /// Rows per frame the active piece currently falls
+            double getCurrentGravity() const { return _computeCurrentGravity(); }
+
+            /// Elapsed frames, accumulator and settings; the callback is not saved
+            void saveState(ByteWriter& out) const;
+            void loadState(ByteReader& in);
+
         private:
             std::chrono::steady_clock::time_point start;
             double totalElapsedFrames = 0;
@@ -52,6 +111,9 @@ namespace tetris {
             int GetResetsLeft() const;
             void ResetCounter();
 
+            void SaveState(ByteWriter& out) const;
+            void LoadState(ByteReader& in);
+
         private:
             static constexpr double DELAY_DURATION = 0.5; // 0.5 seconds = 30 logical frames at 60 FPS
             int resetsLeft;
@@ -0,0 +1,126 @@
+#ifndef VECENV_H
+#define VECENV_H
+
+// Batched single-player environments for reinforcement learning.
+//
+// State is kept structure-of-arrays: every env's row masks sit in one contiguous
+// array, pieces, bags and counters in others, so a step touches a few cache lines
+// per env and no Board, Piece or Game objects are ever created.
+//
+// Actions are placements (see FindPlacement in Rules.h), offset by
+// PLACEMENT_COUNT when the piece is swapped with hold first:
+// action = hold * 40 + rotation * 10 + column. Placements are hard drops from
+// spawn height, so they never produce spins.
+
+#include "Features.h"
+#include "Rules.h"
+#include "ThreadPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace tetris {
+
+struct VecEnvConfig {
+    size_t numEnvs = 1;
+
+    /// Threads used to step envs, including the caller; 0 means hardware concurrency
+    size_t threads = 0;
+
+    /// Envs handed to a thread at a time
+    size_t grain = 256;
+
+    /// End an episode after this many placed pieces; 0 means no limit
+    uint32_t maxPieces = 0;
+
+    /// Reward added on top-out (and for illegal actions, which end the episode)
+    float topOutReward = -1.0f;
+};
+
+class VecEnv {
+    public:
+        static constexpr int PLACEMENTS = PLACEMENT_COUNT;
+        static constexpr int ACTION_COUNT = 2 * PLACEMENTS;  ///< Without hold, then with hold
+        static constexpr size_t OBSERVATION_SIZE = BOARD_FEATURE_SIZE;
+
+        explicit VecEnv(VecEnvConfig config);
+        ~VecEnv();
+
+        VecEnv(const VecEnv&)            = delete;
+        VecEnv& operator=(const VecEnv&) = delete;
+
+        /**
+         * @brief Start a new episode in every env.
+         * @param seeds Size() seeds for the piece generators
+         * @param observations Receives Size() * OBSERVATION_SIZE floats, or nullptr
+         * @param masks Receives Size() * ACTION_COUNT legal-action flags, or nullptr
+         */
+        void Reset(const uint64_t* seeds, float* observations, uint8_t* masks);
+
+        /**
+         * @brief Apply one placement in every env.
+         *
+         * Envs that finish are reset straight away (their generator keeps running), so
+         * observations and masks for a done env already describe its next episode.
+         * @param actions Size() action indices
+         * @param observations Receives Size() * OBSERVATION_SIZE floats, or nullptr
+         * @param rewards Receives Size() floats: garbage lines sent, plus topOutReward on a top-out
+         * @param dones Receives Size() flags, 1 where an episode ended
+         * @param masks Receives Size() * ACTION_COUNT legal-action flags, or nullptr
+         */
+        void Step(const int32_t* actions, float* observations, float* rewards, uint8_t* dones, uint8_t* masks);
+
+        /**
+         * @brief Encode observations and masks of the current state without stepping.
+         */
+        void Observe(float* observations, uint8_t* masks) const;
+
+        size_t Size() const noexcept { return m_config.numEnvs; }
+
+        /// @name Per-Env State
+        /// @{
+        const uint16_t* GetRows(size_t env) const { return &m_rows[env * TOTAL_BOARD_HEIGHT]; }
+        PieceType GetCurrentPiece(size_t env) const { return m_current[env]; }
+        PieceType GetHeldPiece(size_t env) const { return m_hold[env]; }
+        void GetNextQueue(size_t env, PieceType* out) const;
+        uint32_t GetPiecesPlaced(size_t env) const { return m_pieces[env]; }
+        uint32_t GetLinesCleared(size_t env) const { return m_lines[env]; }
+        int32_t GetBackToBack(size_t env) const { return m_backToBack[env]; }
+        int32_t GetCombo(size_t env) const { return m_combo[env]; }
+        uint32_t GetEpisodeCount(size_t env) const { return m_episodes[env]; }
+
+        /**
+         * @brief Whether the env's last finished episode ended in a top-out (or an illegal action)
+         *        rather than at maxPieces; the counterpart of Board::IsGameOver once a done env is reset.
+         */
+        bool GetLastEpisodeToppedOut(size_t env) const { return m_toppedOut[env] != 0; }
+        /// @}
+
+    private:
+        void _resetEnv(size_t env);
+        void _observeEnv(size_t env, float* observation, uint8_t* mask) const;
+        float _stepEnv(size_t env, int32_t action, bool& done);
+        PieceType _peek(size_t env, size_t ahead) const;
+        PieceType _pop(size_t env);
+
+        VecEnvConfig m_config;
+        std::unique_ptr<ThreadPool> m_pool;
+
+        std::vector<uint16_t> m_rows;       // numEnvs * TOTAL_BOARD_HEIGHT
+        std::vector<PieceType> m_current;
+        std::vector<PieceType> m_hold;
+        std::vector<PieceType> m_bags;      // numEnvs * 14: current bag, then next bag
+        std::vector<uint8_t> m_bagIndex;
+        std::vector<uint64_t> m_rng;
+        std::vector<int32_t> m_backToBack;
+        std::vector<int32_t> m_combo;
+        std::vector<uint32_t> m_pieces;
+        std::vector<uint32_t> m_lines;
+        std::vector<uint32_t> m_episodes;
+        std::vector<uint8_t> m_toppedOut;
+};
+
+} // namespace tetris
+
+#endif // VECENV_H
@@ -0,0 +1,89 @@
+"""Readers for self-play shards (docs/selfplay_format.md).
+
+    records = read_shard("data/selfplay/shard-000000.tsp")
+    for batch in iterate_shards("data/selfplay", batch_size=1024):
+        obs = tetris_sim.encode_positions(batch["rows"], batch["pieces"])
+"""
+
+import random
+from pathlib import Path
+
+import numpy as np
+
+SHARD_MAGIC = b"TSPD"
+SHARD_FORMAT_VERSION = 1
+ACTION_COUNT = 80
+
+FLAG_TOPPED_OUT = 1 << 0
+FLAG_MODEL_BOT = 1 << 1
+
+HEADER_DTYPE = np.dtype([
+    ("magic", "S4"),
+    ("version", "<u4"),
+    ("header_size", "<u4"),
+    ("record_size", "<u4"),
+    ("record_count", "<u8"),
+    ("feature_version", "<u4"),
+    ("action_count", "<u4"),
+    ("created_unix_seconds", "<u8"),
+    ("reserved", "u1", 24),
+])
+
+RECORD_DTYPE = np.dtype([
+    ("game_id", "<u8"),
+    ("outcome", "<f4"),
+    ("reward", "<f4"),
+    ("game_length", "<u4"),
+    ("move_number", "<u2"),
+    ("action", "<i2"),
+    ("rows", "<u2", 20),
+    ("pieces", "u1", 7),
+    ("flags", "u1"),
+    ("policy", "<u2", ACTION_COUNT),
+])
+
+assert HEADER_DTYPE.itemsize == 64
+assert RECORD_DTYPE.itemsize == 232
+
+
+def read_header(path):
+    header = np.fromfile(path, dtype=HEADER_DTYPE, count=1)
+    if header.size != 1 or header["magic"][0] != SHARD_MAGIC:
+        raise ValueError(f"{path} is not a self-play shard")
+    header = header[0]
+    if header["version"] != SHARD_FORMAT_VERSION or header["record_size"] != RECORD_DTYPE.itemsize:
+        raise ValueError(f"{path} has format version {header['version']}, expected {SHARD_FORMAT_VERSION}")
+    return header
+
+
+def read_shard(path, mmap=True):
+    """Return the records of one shard as a structured array (memory-mapped by default)."""
+    header = read_header(path)
+    count = int(header["record_count"])
+    if mmap:
+        return np.memmap(path, dtype=RECORD_DTYPE, mode="r", offset=HEADER_DTYPE.itemsize, shape=(count,))
+    return np.fromfile(path, dtype=RECORD_DTYPE, count=count, offset=HEADER_DTYPE.itemsize)
+
+
+def shard_paths(directory):
+    return sorted(Path(directory).glob("*.tsp"))
+
+
+def policy_targets(records):
+    """Policy field as float32 probabilities [N, 80]."""
+    return records["policy"].astype(np.float32) / 65535.0
+
+
+def iterate_shards(directory, batch_size, shuffle=True, seed=0):
+    """Yield record batches from every shard in a directory, shuffled within each shard."""
+    rng = random.Random(seed)
+    paths = shard_paths(directory)
+    if shuffle:
+        rng.shuffle(paths)
+    for path in paths:
+        records = read_shard(path)
+        order = np.arange(len(records))
+        if shuffle:
+            np.random.default_rng(rng.getrandbits(64)).shuffle(order)
+        for start in range(0, len(order), batch_size):
+            yield records[np.sort(order[start:start + batch_size])]
@@ -0,0 +1,36 @@
+"""Networks trained on self-play data and exported to ONNX for the engine.
+
+The engine reads the first model output as the position value (see NetworkBot in
+include/TetrisEngine/Bot.h), so `value` must stay the first output.
+"""
+
+import torch
+from torch import nn
+
+OBSERVATION_SIZE = 249  # BOARD_FEATURE_SIZE in Features.h
+ACTION_COUNT = 80
+
+
+class ValuePolicyNet(nn.Module):
+    def __init__(self, hidden=256, layers=3):
+        super().__init__()
+        blocks = []
+        width = OBSERVATION_SIZE
+        for _ in range(layers):
+            blocks += [nn.Linear(width, hidden), nn.ReLU()]
+            width = hidden
+        self.trunk = nn.Sequential(*blocks)
+        self.value = nn.Linear(hidden, 1)
+        self.policy = nn.Linear(hidden, ACTION_COUNT)
+
+    def forward(self, observations):
+        features = self.trunk(observations)
+        return self.value(features), self.policy(features)
+
+
+def export_onnx(model, path):
+    model.eval()
+    example = torch.zeros(1, OBSERVATION_SIZE)
+    torch.onnx.export(model, example, str(path),
+                      input_names=["input"], output_names=["value", "policy"],
+                      dynamic_axes={"input": {0: "batch"}, "value": {0: "batch"}, "policy": {0: "batch"}})
@@ -0,0 +1,230 @@
+"""ctypes bindings for libtetris_sim (include/TetrisEngine/TetrisSim.h).
+
+Every call passes NumPy buffers straight to C++; nothing is copied and no Python
+objects are created per env. ctypes releases the GIL for the duration of each
+call, so one step() advances every env while other Python threads keep running.
+
+    sim = TetrisSim(num_envs=4096)
+    obs, masks = sim.reset(seed=0)
+    obs, rewards, dones, masks = sim.step(actions)
+
+    data = Dataset("data/selfplay", batch_size=1024)
+    obs, policies, values = data.next()
+"""
+
+import ctypes
+import os
+import sys
+from pathlib import Path
+
+import numpy as np
+
+ABI_VERSION = 2
+PIECES_PER_POSITION = 7  # current, hold, next 5
+
+_REPO_ROOT = Path(__file__).resolve().parents[1]
+
+
+def _library_name():
+    if sys.platform.startswith("win"):
+        return "tetris_sim.dll"
+    if sys.platform == "darwin":
+        return "libtetris_sim.dylib"
+    return "libtetris_sim.so"
+
+
+def _find_library():
+    override = os.environ.get("TETRIS_SIM_LIBRARY")
+    if override:
+        return override
+    name = _library_name()
+    for candidate in (_REPO_ROOT / "build" / "lib" / name,
+                      _REPO_ROOT / "build" / "lib" / "Release" / name):
+        if candidate.exists():
+            return str(candidate)
+    raise FileNotFoundError(
+        f"{name} not found under build/lib; build the tetris_sim target or set TETRIS_SIM_LIBRARY")
+
+
+def _pointer(ctype):
+    return np.ctypeslib.ndpointer(dtype=ctype, flags="C_CONTIGUOUS")
+
+
+_f32 = _pointer(np.float32)
+_u8 = _pointer(np.uint8)
+_u16 = _pointer(np.uint16)
+_i32 = _pointer(np.int32)
+_u64 = _pointer(np.uint64)
+
+
+def _optional(ptr_type):
+    """ndpointer that also accepts None (passed to C as NULL)."""
+    class Optional(ptr_type):
+        @classmethod
+        def from_param(cls, obj):
+            return None if obj is None else ptr_type.from_param(obj)
+    return Optional
+
+
+def _load(path=None):
+    lib = ctypes.CDLL(path or _find_library())
+
+    lib.tetris_sim_abi_version.restype = ctypes.c_uint32
+    lib.tetris_sim_observation_size.restype = ctypes.c_uint32
+    lib.tetris_sim_action_count.restype = ctypes.c_uint32
+    lib.tetris_sim_last_error.restype = ctypes.c_char_p
+
+    lib.tetris_sim_create.argtypes = [ctypes.c_uint32, ctypes.c_uint32, ctypes.c_uint32, ctypes.c_float]
+    lib.tetris_sim_create.restype = ctypes.c_void_p
+    lib.tetris_sim_destroy.argtypes = [ctypes.c_void_p]
+    lib.tetris_sim_num_envs.argtypes = [ctypes.c_void_p]
+    lib.tetris_sim_num_envs.restype = ctypes.c_uint32
+
+    lib.tetris_sim_reset.argtypes = [ctypes.c_void_p, _u64, _optional(_f32), _optional(_u8)]
+    lib.tetris_sim_step.argtypes = [ctypes.c_void_p, _i32, _optional(_f32), _f32, _u8, _optional(_u8)]
+    lib.tetris_sim_legal_moves.argtypes = [ctypes.c_void_p, _u8]
+    lib.tetris_sim_encode.argtypes = [ctypes.c_void_p, _f32]
+    lib.tetris_sim_get_state.argtypes = [ctypes.c_void_p, _optional(_u16), _optional(_u8)]
+    lib.tetris_sim_encode_positions.argtypes = [_u16, _u8, ctypes.c_uint32, _f32]
+    for fn in ("reset", "step", "legal_moves", "encode", "get_state", "encode_positions"):
+        getattr(lib, f"tetris_sim_{fn}").restype = ctypes.c_int
+
+    lib.tetris_dataset_open.argtypes = [ctypes.c_char_p, ctypes.c_uint32, ctypes.c_uint32, ctypes.c_uint64]
+    lib.tetris_dataset_open.restype = ctypes.c_void_p
+    lib.tetris_dataset_close.argtypes = [ctypes.c_void_p]
+    lib.tetris_dataset_size.argtypes = [ctypes.c_void_p]
+    lib.tetris_dataset_size.restype = ctypes.c_uint64
+    lib.tetris_dataset_next.argtypes = [ctypes.c_void_p, _f32, _optional(_f32), _optional(_f32)]
+    lib.tetris_dataset_next.restype = ctypes.c_int
+
+    version = lib.tetris_sim_abi_version()
+    if version != ABI_VERSION:
+        raise RuntimeError(f"libtetris_sim ABI version {version}, expected {ABI_VERSION}")
+    return lib
+
+
+_lib = None
+
+
+def library():
+    global _lib
+    if _lib is None:
+        _lib = _load()
+    return _lib
+
+
+def _check(status):
+    if status != 0:
+        raise RuntimeError(library().tetris_sim_last_error().decode())
+
+
+class TetrisSim:
+    """A batch of environments stepped together.
+
+    Output arrays are allocated once and reused by every call, so keep a copy if
+    a result has to outlive the next step.
+    """
+
+    def __init__(self, num_envs, threads=0, max_pieces=0, top_out_reward=-1.0):
+        lib = library()
+        self._handle = lib.tetris_sim_create(num_envs, threads, max_pieces, top_out_reward)
+        if not self._handle:
+            raise RuntimeError(lib.tetris_sim_last_error().decode())
+
+        self.num_envs = num_envs
+        self.observation_size = lib.tetris_sim_observation_size()
+        self.action_count = lib.tetris_sim_action_count()
+
+        self.observations = np.zeros((num_envs, self.observation_size), dtype=np.float32)
+        self.masks = np.zeros((num_envs, self.action_count), dtype=np.uint8)
+        self.rewards = np.zeros(num_envs, dtype=np.float32)
+        self.dones = np.zeros(num_envs, dtype=np.uint8)
+
+    def close(self):
+        if self._handle:
+            library().tetris_sim_destroy(self._handle)
+            self._handle = None
+
+    def __del__(self):
+        self.close()
+
+    def reset(self, seed=0, seeds=None):
+        if seeds is None:
+            seeds = np.arange(seed, seed + self.num_envs, dtype=np.uint64)
+        seeds = np.ascontiguousarray(seeds, dtype=np.uint64)
+        if seeds.shape != (self.num_envs,):
+            raise ValueError(f"expected {self.num_envs} seeds, got shape {seeds.shape}")
+        _check(library().tetris_sim_reset(self._handle, seeds, self.observations, self.masks))
+        return self.observations, self.masks
+
+    def step(self, actions):
+        actions = np.ascontiguousarray(actions, dtype=np.int32)
+        if actions.shape != (self.num_envs,):
+            raise ValueError(f"expected {self.num_envs} actions, got shape {actions.shape}")
+        _check(library().tetris_sim_step(self._handle, actions, self.observations,
+                                         self.rewards, self.dones, self.masks))
+        return self.observations, self.rewards, self.dones, self.masks
+
+    def legal_moves(self):
+        _check(library().tetris_sim_legal_moves(self._handle, self.masks))
+        return self.masks
+
+    def encode(self):
+        _check(library().tetris_sim_encode(self._handle, self.observations))
+        return self.observations
+
+    def state(self):
+        """Return (rows uint16 [N, 27], pieces uint8 [N, 7])."""
+        rows = np.zeros((self.num_envs, 27), dtype=np.uint16)
+        pieces = np.zeros((self.num_envs, PIECES_PER_POSITION), dtype=np.uint8)
+        _check(library().tetris_sim_get_state(self._handle, rows, pieces))
+        return rows, pieces
+
+
+def encode_positions(rows, pieces, out=None):
+    """Encode recorded positions: rows uint16 [N, 20], pieces uint8 [N, 7]."""
+    rows = np.ascontiguousarray(rows, dtype=np.uint16)
+    pieces = np.ascontiguousarray(pieces, dtype=np.uint8)
+    count = rows.shape[0]
+    if rows.shape != (count, 20) or pieces.shape != (count, PIECES_PER_POSITION):
+        raise ValueError("rows must be [N, 20] and pieces [N, 7]")
+    if out is None:
+        out = np.empty((count, library().tetris_sim_observation_size()), dtype=np.float32)
+    _check(library().tetris_sim_encode_positions(rows, pieces, count, out))
+    return out
+
+
+class Dataset:
+    """Shuffled minibatches from a directory of self-play shards.
+
+    Shards are memory-mapped and decoded by C++ threads ahead of time; next()
+    only copies a finished batch into the output arrays (which may be replaced,
+    e.g. by NumPy views of pinned torch tensors, as long as shapes and dtypes match).
+    """
+
+    def __init__(self, directory, batch_size=1024, threads=2, seed=0):
+        lib = library()
+        self._handle = lib.tetris_dataset_open(os.fsencode(str(directory)), batch_size, threads, seed)
+        if not self._handle:
+            raise RuntimeError(lib.tetris_sim_last_error().decode())
+
+        self.batch_size = batch_size
+        self.observations = np.zeros((batch_size, lib.tetris_sim_observation_size()), dtype=np.float32)
+        self.policies = np.zeros((batch_size, lib.tetris_sim_action_count()), dtype=np.float32)
+        self.values = np.zeros(batch_size, dtype=np.float32)
+
+    def __len__(self):
+        return int(library().tetris_dataset_size(self._handle))
+
+    def close(self):
+        if self._handle:
+            library().tetris_dataset_close(self._handle)
+            self._handle = None
+
+    def __del__(self):
+        self.close()
+
+    def next(self):
+        """Return (observations [B, 249], policies [B, 80], values [B]) for the next batch."""
+        _check(library().tetris_dataset_next(self._handle, self.observations, self.policies, self.values))
+        return self.observations, self.policies, self.values
@@ -0,0 +1,94 @@
+"""Train a value/policy network on self-play shards.
+
+    python train.py --data ../data/selfplay --steps 20000 --out ../models/best_model.onnx
+
+Batches come from libtetris_sim's dataset reader: shards are memory-mapped and
+decoded by C++ threads while the previous step runs, so the loop below never
+waits on Python-side data loading.
+"""
+
+import argparse
+import time
+from pathlib import Path
+
+import torch
+import torch.nn.functional as F
+
+from models import ValuePolicyNet, export_onnx
+from tetris_sim import Dataset
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--data", default="../data/selfplay", help="directory of .tsp shards")
+    parser.add_argument("--out", default="../models/best_model.onnx")
+    parser.add_argument("--steps", type=int, default=10000)
+    parser.add_argument("--batch-size", type=int, default=1024)
+    parser.add_argument("--loader-threads", type=int, default=2)
+    parser.add_argument("--lr", type=float, default=1e-3)
+    parser.add_argument("--policy-weight", type=float, default=1.0)
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--log-every", type=int, default=100)
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    device = torch.device("cuda" if torch.cuda.is_available() else "cpu")
+    torch.manual_seed(args.seed)
+
+    data = Dataset(args.data, batch_size=args.batch_size, threads=args.loader_threads, seed=args.seed)
+    print(f"{len(data)} positions in {args.data}, training on {device}")
+
+    # Let the loader write straight into page-locked tensors so host-to-device copies can overlap.
+    # With pinning there are two sets: the loader refills one while the other's non-blocking copies
+    # may still be in flight, and each set's event is waited on before the set is refilled.
+    pin = device.type == "cuda"
+    if pin:
+        buffers = [tuple(torch.empty(array.shape, dtype=torch.float32, pin_memory=True)
+                         for array in (data.observations, data.policies, data.values)) for _ in range(2)]
+    else:
+        buffers = [(torch.from_numpy(data.observations), torch.from_numpy(data.policies), torch.from_numpy(data.values))]
+    copied = [None] * len(buffers)
+
+    model = ValuePolicyNet().to(device)
+    optimizer = torch.optim.Adam(model.parameters(), lr=args.lr)
+
+    start = time.perf_counter()
+    for step in range(1, args.steps + 1):
+        slot = step % len(buffers)
+        if copied[slot] is not None:
+            copied[slot].synchronize()
+        observations, policies, values = buffers[slot]
+        data.observations, data.policies, data.values = observations.numpy(), policies.numpy(), values.numpy()
+
+        data.next()
+        obs = observations.to(device, non_blocking=pin)
+        target_policy = policies.to(device, non_blocking=pin)
+        target_value = values.to(device, non_blocking=pin).unsqueeze(1)
+        if pin:
+            copied[slot] = torch.cuda.Event()
+            copied[slot].record()
+
+        value, logits = model(obs)
+        value_loss = F.mse_loss(value, target_value)
+        policy_loss = -(target_policy * F.log_softmax(logits, dim=1)).sum(dim=1).mean()
+        loss = value_loss + args.policy_weight * policy_loss
+
+        optimizer.zero_grad(set_to_none=True)
+        loss.backward()
+        optimizer.step()
+
+        if step % args.log_every == 0:
+            elapsed = time.perf_counter() - start
+            print(f"step {step}: value {value_loss.item():.4f}, policy {policy_loss.item():.4f}, "
+                  f"{step * args.batch_size / elapsed:.0f} samples/s")
+
+    out = Path(args.out)
+    out.parent.mkdir(parents=True, exist_ok=True)
+    export_onnx(model.cpu(), out)
+    print(f"Exported {out}")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,24 +1,64 @@
 #include "../include/TetrisEngine/Board.h"
+#include "../include/TetrisEngine/Features.h"
+#include "../include/TetrisEngine/Metrics.h"
 #include "../include/TetrisEngine/Piece.h"
+#include "../include/TetrisEngine/Profiler.h"
 #include "../include/TetrisEngine/Game.h"
 #include "../include/TetrisEngine/UtilFunctions.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <iomanip>
 #include <iostream>
 #include <random>
+#include <stdexcept>
 #include <unordered_set>
 #include <raylib.h>
 
 namespace tetris {
-    Board::Board(unsigned int seed, int playerNum, Game& gameAddress) : playerID(playerNum), game(gameAddress), rng(seed),
-        grab_bag{ {PieceType::I, PieceType::J, PieceType::L, PieceType::O, PieceType::S, PieceType::T, PieceType::Z }}, 
-        grab_bag_next{ {PieceType::I, PieceType::J, PieceType::L, PieceType::O, PieceType::S, PieceType::T, PieceType::Z }},
+    namespace {
+        const std::vector<PieceType> InitialBag{ {PieceType::I, PieceType::J, PieceType::L, PieceType::O, PieceType::S, PieceType::T, PieceType::Z }};
+
+        // Grid stamps come from one counter so no two boards ever share one
+        std::atomic<uint64_t> GridVersions{0};
+
+        uint64_t NextGridVersion() {
+            return GridVersions.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        SpinType SpinFor(int tSpin, bool allMiniSpin) {
+            if (tSpin == 2) return SpinType::T_SPIN;
+            if (tSpin == 1) return SpinType::T_SPIN_MINI;
+            return allMiniSpin ? SpinType::MINI : SpinType::NONE;
+        }
+
+        // Game time of a frame, for the garbage delay metric
+        constexpr uint64_t FRAME_NS = 1000000000ull / Game::FRAMES_PER_SECOND;
+
+        // Holes differ between players sharing a seed
+        unsigned int GarbageSeed(unsigned int seed, int playerNum) {
+            return seed + 0x9e3779b9u * static_cast<unsigned int>(playerNum + 1);
+        }
+    }
+
+    Board::Board(unsigned int seed, int playerNum, Game& gameAddress) : playerID(playerNum), game(gameAddress),
+        garbageRng(GarbageSeed(seed, playerNum)), rng(seed),
+        grab_bag(InitialBag), 
+        grab_bag_next(InitialBag),
         lockDelayTimer()
     {
         Reset();
     }
 
+    void Board::Reset(unsigned int seed) {
+        rng.Restore(seed, 0);
+        garbageRng.Restore(GarbageSeed(seed, playerID), 0);
+        grab_bag = InitialBag;
+        grab_bag_next = InitialBag;
+        lockDelayTimer = LockDelayTimer();
+        Reset();
+    }
+
     void Board::Reset() {
         InitializeGrid();
         currentPiece.reset();
@@ -26,13 +66,18 @@ namespace tetris {
         isGameOverFlag = false;
         score = 0;
         linesClearedTotal = 0;
+        attackTotal = 0;
         index = 0;
         back_to_back = 0;
         combo = 0;
+        garbage_queue = {};
+        garbage_sent_frames = {};
         garbage_count = 0;
+        hole_col = -1;
         lastMoveWasRotation = false;
         last_piece_is_none = true;
         canHold = true;
+        events.Push(MakeEvent(GameEventType::RESET));
         SpawnRandomPiece();
         lockDelayTimer.Cancel();
         lockDelayTimer.ResetCounter();
@@ -56,6 +101,9 @@ namespace tetris {
         // Game over check: if spawn position is invalid
         if (!IsValidPosition(repr, spawnPos)) {
             isGameOverFlag = true;
+            GameEvent event = MakeEvent(GameEventType::GAME_OVER);
+            event.piece = type;
+            events.Push(event);
             return false;
         }
 
@@ -65,6 +113,7 @@ namespace tetris {
         lastMoveWasRotation = false;
         lockDelayTimer.Cancel();
         lockDelayTimer.ResetCounter();
+        events.Push(MakeEvent(GameEventType::SPAWN));
         return true;
     }
 
@@ -103,6 +152,10 @@ namespace tetris {
             if (!IsValidPosition(repr, newPos + Point(0, -1))) {
                 lockDelayTimer.Start();   // Start lock delay if downward move fails
             } 
+            GameEvent event = MakeEvent(GameEventType::MOVE);
+            event.dx = static_cast<int8_t>(delta_x);
+            event.dy = static_cast<int8_t>(delta_y);
+            events.Push(event);
             return true;
         }
 
@@ -110,6 +163,7 @@ namespace tetris {
     }
 
     bool Board::RotateActivePiece(RotationDirection direction) {
+        TETRIS_PROFILE_ZONE("Board::RotateActivePiece");
         if (!currentPiece) return false;
         PieceType type = currentPiece->GetType();
         if (type == PieceType::O) return true; // O doesn't rotate
@@ -138,6 +192,10 @@ namespace tetris {
                 if (!IsValidPosition(new_repr, test_pos + Point(0, -1))) {
                     lockDelayTimer.Start();   // Start lock delay if downward move fails
                 } 
+                GameEvent event = MakeEvent(GameEventType::ROTATE);
+                event.dx = static_cast<int8_t>(kick.x);
+                event.dy = static_cast<int8_t>(kick.y);
+                events.Push(event);
                 return true;
             }
         }
@@ -158,7 +216,16 @@ namespace tetris {
         LockActivePiece();
     }
 
+    Point Board::GetGhostPosition() const {
+        Point pos = currentPieceTopLeftPos;
+        if (!currentPiece) return pos;
+        uint16_t repr = currentPiece->GetCurrentRepresentation();
+        while (IsValidPosition(repr, {pos.x, pos.y - 1})) pos.y--;
+        return pos;
+    }
+
     void Board::LockActivePiece() {
+        TETRIS_PROFILE_ZONE("Board::LockActivePiece");
         if (!currentPiece) return;
         lockDelayTimer.Cancel();
         uint16_t repr = currentPiece->GetCurrentRepresentation();
@@ -184,6 +251,13 @@ namespace tetris {
         int lines = ClearFullLines();
 
         if (lines == 0) InsertGarbage();
+        gridVersion = NextGridVersion();
+        metrics::Increment(metrics::Counter::PIECES);
+
+        GameEvent event = MakeEvent(GameEventType::LOCK);
+        event.spin = SpinFor(isTSpin, isAllMiniSpin);
+        event.lines = static_cast<uint16_t>(lines);
+        events.Push(event);
 
         score += CalculateScore(isTSpin, isAllMiniSpin, lines);
         linesClearedTotal += lines;
@@ -198,69 +272,28 @@ namespace tetris {
     }
 
     int Board::CalculateScore(int isTSpin, bool isAllMiniSpin, int lines) {
-        // Score calculation
         int baseScore = 0;
-        int baseGarbage = 0;
-        bool isB2BEligible = false;
-
-        if (isTSpin == 2) {         // full t-spin
-            if (lines > 0){
-                baseGarbage = 2*lines;
-                isB2BEligible = true;
-            }
-        } else if (isTSpin == 1) {  // t-spin mini
-            if (lines > 0){
-                baseGarbage = lines - 1;
-                isB2BEligible = true;
-            }
-        } else {
-            if (lines > 1){
-                baseGarbage = 1<<(lines-2);
-                if (lines == 4) isB2BEligible = true;
-            }
-            if (isAllMiniSpin && lines > 0) {
-                isB2BEligible = true;
-            }
-        }
 
-        // Apply B2B bonus
-        if (isB2BEligible) {
-            if (back_to_back > 0) {
-                baseGarbage++;
-            }
-            back_to_back++;
-        } else if (lines > 0) {
-            // B2B Charging 
-            if (back_to_back >= 4){
-                for (int i = 0; i < 3; i++){
-                    if (back_to_back%3 > i){
-                        SendGarbage(back_to_back/3 + 1);
-                    } else {
-                        SendGarbage(back_to_back/3);
-                    }
-                }
-            }
-            back_to_back = 0;
+        // Garbage goes out in rule order: B2B charge bursts first, then the clear itself
+        AttackResult attack = ComputeAttack(isTSpin, isAllMiniSpin, lines, back_to_back, combo);
+        attackTotal += attack.Total();
+        if (lines > 0) {
+            GameEvent event = MakeEvent(GameEventType::CLEAR);
+            event.spin = SpinFor(isTSpin, isAllMiniSpin);
+            event.lines = static_cast<uint16_t>(lines);
+            event.combo = static_cast<uint16_t>(combo);
+            event.b2b = static_cast<uint16_t>(back_to_back);
+            events.Push(event);
         }
-
-        // Apply Combo bonus
-        if (lines > 0){
-            if (baseGarbage == 0){
-                baseGarbage = static_cast<int>(log(1.0 + (1.25*combo)));
-            } else {
-                baseGarbage *= static_cast<int>(1 + (0.25*combo));
-            }
-            combo++;
-        } else {
-            combo = 0;
+        for (int i = 0; i < attack.count; ++i) {
+            SendGarbage(attack.sends[i]);
         }
 
-        SendGarbage(baseGarbage);
-
         return baseScore;
     }
 
     int Board::ClearFullLines() {
+        TETRIS_PROFILE_ZONE("Board::ClearFullLines");
         int lines = 0;
         // Iterate from bottom (row 0) to top (row 19)
         for (size_t row = 0; row < VISIBLE_BOARD_HEIGHT; ++row) {
@@ -294,18 +327,24 @@ namespace tetris {
         return lines;
     }
 
-    void Board::AddGarbageToQueue(int lines) {
+    void Board::AddGarbageToQueue(int lines, uint64_t sentFrame) {
         if (lines < 1) return;
         garbage_queue.push(lines);
+        garbage_sent_frames.push(sentFrame);
         garbage_count += lines;
+
+        GameEvent event = MakeEvent(GameEventType::GARBAGE_RECEIVED);
+        event.lines = static_cast<uint16_t>(lines);
+        events.Push(event);
     }
 
     void Board::InsertGarbage(){
+        TETRIS_PROFILE_ZONE("Board::InsertGarbage");
         int total_garbage_lines = 0;
         bool garbage_broken = false;
         while(!garbage_queue.empty() && total_garbage_lines < 8){
-            // generate random hole if no previous
-            if (hole_col == -1) hole_col = rand()%10; //replace with better random number generator
+            // generate random hole if no previous (per-board RNG so replays reproduce it)
+            if (hole_col == -1) hole_col = std::uniform_int_distribution<int>(0, BOARD_WIDTH - 1)(garbageRng);
 
             // prevent exceeding garbage cap of 8
             int garbage_lines = garbage_queue.front();
@@ -314,7 +353,13 @@ namespace tetris {
                 garbage_queue.front() -= garbage_lines;
                 garbage_broken = true;
             } else {
+                // A packet split by the cap counts once, when its last line rises
+                const uint64_t sent = garbage_sent_frames.front();
+                if (sent != NO_SENT_FRAME) {
+                    metrics::RecordLatency(metrics::Latency::GARBAGE_DELAY, (game.GetFrame() - sent) * FRAME_NS);
+                }
                 garbage_queue.pop();
+                garbage_sent_frames.pop();
             }
             total_garbage_lines += garbage_lines;
 
@@ -331,12 +376,15 @@ namespace tetris {
     }
 
     void Board::SendGarbage(int lines) {
+        const int attack = lines;
+
         //cancel active garbage
         while (lines != 0 && !garbage_queue.empty()) {
             if (lines >= garbage_queue.front()){
                 lines -= garbage_queue.front();
                 garbage_count -= garbage_queue.front();
                 garbage_queue.pop();
+                garbage_sent_frames.pop();
             } else {
                 garbage_queue.front() -= lines;
                 garbage_count -= lines;
@@ -345,19 +393,30 @@ namespace tetris {
             }
         }
 
-        if (lines != 0) game.TransferGarbage(playerID, lines);
+        if (lines != attack) {
+            GameEvent event = MakeEvent(GameEventType::GARBAGE_CANCELLED);
+            event.lines = static_cast<uint16_t>(attack - lines);
+            events.Push(event);
+        }
+        if (lines != 0) {
+            GameEvent event = MakeEvent(GameEventType::GARBAGE_SENT);
+            event.lines = static_cast<uint16_t>(lines);
+            events.Push(event);
+            game.TransferGarbage(playerID, lines);
+        }
     }
 
     void Board::InitializeGrid() {
         std::fill(grid.begin(), grid.end(), PieceType::EMPTY);
+        gridVersion = NextGridVersion();
     }
 
     Point Board::CalculateSpawnPosition(PieceType type) {
-        int row = (type == PieceType::I) ? 19 : 20;
-        return {3, row}; // Centered at column 3
+        return GetSpawnPosition(type);
     }
 
     bool Board::IsValidPosition(uint16_t repr, Point pos) const {
+        TETRIS_PROFILE_ZONE("Board::IsValidPosition");
         for (int i = 0; i < 16; ++i) {
             if (repr & (1 << (15 - i))) {
                 int c = pos.x + (i % 4);
@@ -451,6 +510,180 @@ namespace tetris {
         return grid[row_from_bottom * BOARD_WIDTH + col];
     }
 
+    uint16_t Board::GetRowMask(int row_from_bottom) const {
+        if (row_from_bottom < 0 || row_from_bottom >= TOTAL_BOARD_HEIGHT) return 0;
+        uint16_t mask = 0;
+        const PieceType* row = &grid[row_from_bottom * BOARD_WIDTH];
+        for (int col = 0; col < BOARD_WIDTH; ++col) {
+            if (row[col] != PieceType::EMPTY) mask |= static_cast<uint16_t>(1u << col);
+        }
+        return mask;
+    }
+
+    namespace {
+        // splitmix64 finalizer
+        inline uint64_t MixHash(uint64_t x) {
+            x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+            x ^= x >> 27; x *= 0x94d049bb133111ebull;
+            return x ^ (x >> 31);
+        }
+    }
+
+    uint64_t Board::Hash() const {
+        uint64_t h = 0x9e3779b97f4a7c15ull;
+
+        // Four 10-bit rows per word
+        for (int row = 0; row < TOTAL_BOARD_HEIGHT; row += 4) {
+            uint64_t word = 0;
+            for (int i = 0; i < 4 && row + i < TOTAL_BOARD_HEIGHT; ++i) {
+                word |= static_cast<uint64_t>(GetRowMask(row + i)) << (16 * i);
+            }
+            h = MixHash(h ^ word);
+        }
+
+        uint64_t pieces = 0;
+        if (currentPiece) {
+            pieces = static_cast<uint64_t>(currentPiece->GetType())
+                   | static_cast<uint64_t>(currentPiece->GetCurrentRotation()) << 4
+                   | static_cast<uint64_t>(static_cast<uint8_t>(currentPieceTopLeftPos.x)) << 8
+                   | static_cast<uint64_t>(static_cast<uint8_t>(currentPieceTopLeftPos.y)) << 16;
+        }
+        pieces |= static_cast<uint64_t>(GetHeldPieceType()) << 24;
+        pieces |= static_cast<uint64_t>(canHold) << 28;
+        for (size_t i = 0; i < 5; ++i) {
+            pieces |= static_cast<uint64_t>(PeekNext(i)) << (32 + 4 * i);
+        }
+        h = MixHash(h ^ pieces);
+
+        uint64_t counters = static_cast<uint64_t>(static_cast<uint16_t>(back_to_back))
+                          | static_cast<uint64_t>(static_cast<uint16_t>(combo)) << 16
+                          | static_cast<uint64_t>(static_cast<uint16_t>(garbage_count)) << 32;
+        return MixHash(h ^ counters);
+    }
+
+    namespace {
+        PieceType ReadPieceType(ByteReader& in) {
+            uint8_t type = in.GetU8();
+            if (type > static_cast<uint8_t>(PieceType::G)) throw std::runtime_error("Corrupt board state: bad piece type");
+            return static_cast<PieceType>(type);
+        }
+    }
+
+    void Board::SaveState(ByteWriter& out) const {
+        // Grid as (run length, cell) pairs; the empty upper rows collapse into one run
+        size_t run = 0;
+        for (size_t i = 0; i < grid.size(); ++i) {
+            ++run;
+            if (i + 1 == grid.size() || grid[i + 1] != grid[i]) {
+                out.PutVarint(run);
+                out.PutU8(static_cast<uint8_t>(grid[i]));
+                run = 0;
+            }
+        }
+
+        out.PutU8(static_cast<uint8_t>(currentPiece ? currentPiece->GetType() : PieceType::EMPTY));
+        if (currentPiece) {
+            out.PutU8(static_cast<uint8_t>(currentPiece->GetCurrentRotation()));
+            out.PutSigned(currentPieceTopLeftPos.x);
+            out.PutSigned(currentPieceTopLeftPos.y);
+        }
+        out.PutU8(static_cast<uint8_t>(GetHeldPieceType()));
+        out.PutU8(static_cast<uint8_t>(canHold | isGameOverFlag << 1 | lastMoveWasRotation << 2 | last_piece_is_none << 3));
+
+        out.PutSigned(score);
+        out.PutSigned(linesClearedTotal);
+        out.PutSigned(attackTotal);
+        out.PutSigned(back_to_back);
+        out.PutSigned(combo);
+
+        std::queue<int> pending = garbage_queue;
+        out.PutVarint(pending.size());
+        for (; !pending.empty(); pending.pop()) out.PutSigned(pending.front());
+        out.PutSigned(garbage_count);
+        out.PutSigned(hole_col);
+
+        for (const SeekableRng* r : {&rng, &garbageRng}) {
+            out.PutVarint(r->GetSeed());
+            out.PutVarint(r->GetDraws());
+        }
+        for (PieceType pt : grab_bag) out.PutU8(static_cast<uint8_t>(pt));
+        for (PieceType pt : grab_bag_next) out.PutU8(static_cast<uint8_t>(pt));
+        out.PutVarint(index);
+        out.PutU8(static_cast<uint8_t>(last_piece));
+
+        lockDelayTimer.SaveState(out);
+    }
+
+    void Board::LoadState(ByteReader& in) {
+        const auto previous = grid;
+        for (size_t filled = 0; filled < grid.size();) {
+            uint64_t run = in.GetVarint();
+            PieceType cell = ReadPieceType(in);
+            if (run == 0 || run > grid.size() - filled) throw std::runtime_error("Corrupt board state: bad grid run");
+            std::fill_n(grid.begin() + filled, run, cell);
+            filled += run;
+        }
+        if (grid != previous) gridVersion = NextGridVersion();
+
+        PieceType current = ReadPieceType(in);
+        currentPiece = CreatePieceByType(current);
+        if (currentPiece) {
+            currentPiece->SetCurrentRotation(static_cast<RotationState>(in.GetU8() & 3));
+            currentPieceTopLeftPos.x = static_cast<int>(in.GetSigned());
+            currentPieceTopLeftPos.y = static_cast<int>(in.GetSigned());
+        } else if (current != PieceType::EMPTY) {
+            throw std::runtime_error("Corrupt board state: garbage cannot be the active piece");
+        }
+        held_piece = CreatePieceByType(ReadPieceType(in));
+        uint8_t flags = in.GetU8();
+        canHold = flags & 1;
+        isGameOverFlag = flags & 2;
+        lastMoveWasRotation = flags & 4;
+        last_piece_is_none = flags & 8;
+
+        score = static_cast<int>(in.GetSigned());
+        linesClearedTotal = static_cast<int>(in.GetSigned());
+        attackTotal = static_cast<int>(in.GetSigned());
+        back_to_back = static_cast<int>(in.GetSigned());
+        combo = static_cast<int>(in.GetSigned());
+
+        garbage_queue = {};
+        garbage_sent_frames = {};
+        for (uint64_t n = in.GetVarint(); n > 0; --n) {
+            garbage_queue.push(static_cast<int>(in.GetSigned()));
+            garbage_sent_frames.push(NO_SENT_FRAME);   // not saved: only the delay metric reads it
+        }
+        garbage_count = static_cast<int>(in.GetSigned());
+        hole_col = static_cast<int>(in.GetSigned());
+
+        for (SeekableRng* r : {&rng, &garbageRng}) {
+            auto seed = static_cast<SeekableRng::result_type>(in.GetVarint());
+            r->Restore(seed, in.GetVarint());
+        }
+        for (PieceType& pt : grab_bag) pt = ReadPieceType(in);
+        for (PieceType& pt : grab_bag_next) pt = ReadPieceType(in);
+        index = in.GetVarint();
+        if (index > grab_bag.size()) throw std::runtime_error("Corrupt board state: bad bag index");
+        last_piece = ReadPieceType(in);
+
+        lockDelayTimer.LoadState(in);
+    }
+
+    // Declared in Features.h; lives here so the feature encoder itself does not depend on Board
+    void EncodeBoard(const Board& board, float* out) {
+        uint16_t rows[VISIBLE_BOARD_HEIGHT];
+        for (int row = 0; row < VISIBLE_BOARD_HEIGHT; ++row) {
+            rows[row] = board.GetRowMask(row);
+        }
+
+        static_assert(FEATURE_NEXT_PIECES == 5, "the board shows exactly five next pieces");
+        PieceType next[FEATURE_NEXT_PIECES];
+        board.GetNextQueue(next);
+
+        const Piece* current = board.GetCurrentPiece();
+        EncodeFeatures(rows, current ? current->GetType() : PieceType::EMPTY, board.GetHeldPieceType(), next, out);
+    }
+
     Color tetris::Board::GetColorForPieceType(tetris::PieceType pt) const {
         switch (pt) {
             case PieceType::I: return SKYBLUE;
@@ -468,14 +701,15 @@ namespace tetris {
 
     std::vector<PieceType> Board::GetRenderableState() const {
         std::vector<PieceType> state(VISIBLE_BOARD_HEIGHT * BOARD_WIDTH, PieceType::EMPTY);
+        GetRenderableState(state.data());
+        return state;
+    }
 
+    void Board::GetRenderableState(PieceType* state) const {
         // Copy locked cells in reverse row order (top row first)
         for (int state_row = 0; state_row < VISIBLE_BOARD_HEIGHT; ++state_row) {
             int grid_row = VISIBLE_BOARD_HEIGHT - 1 - state_row;
-            for (int col = 0; col < BOARD_WIDTH; ++col) {
-                PieceType pt = GetCellState(col, grid_row);
-                state[state_row * BOARD_WIDTH + col] = pt;
-            }
+            std::copy_n(&grid[grid_row * BOARD_WIDTH], BOARD_WIDTH, state + state_row * BOARD_WIDTH);
         }
 
         // Overlay active piece
@@ -498,22 +732,27 @@ namespace tetris {
                 }
             }
         }
-
-        return state;
     }
 
     std::vector<PieceType> Board::GetNextQueue() const {
+        std::vector<PieceType> queue(5);
+        GetNextQueue(queue.data());
+        return queue;
+    }
+
+    void Board::GetNextQueue(PieceType* out) const {
         // look at next 5 pieces
-        std::vector<PieceType> queue;
-        for (int i = 0; i < 5; i++) {
-            size_t look_index = index + i;
-            if (look_index < grab_bag.size()){
-                queue.push_back(grab_bag[look_index]);
-            } else {
-                queue.push_back(grab_bag_next[look_index%grab_bag.size()]);
-            }
+        for (size_t i = 0; i < 5; i++) {
+            out[i] = PeekNext(i);
         }
-        return queue;
+    }
+
+    PieceType Board::PeekNext(size_t i) const {
+        size_t look_index = index + i;
+        if (look_index < grab_bag.size()){
+            return grab_bag[look_index];
+        }
+        return grab_bag_next[look_index%grab_bag.size()];
     }
 
     void Board::HoldPiece() {
@@ -525,6 +764,9 @@ namespace tetris {
         if (!held_piece) {
             held_piece = CreatePieceByType(currentPiece->GetType());
             currentPiece.reset();
+            GameEvent event = MakeEvent(GameEventType::HOLD);
+            event.piece = currentType;
+            events.Push(event);
             SpawnRandomPiece();
         } else { // Piece is not empty
             if (!canHold) return;
@@ -532,6 +774,9 @@ namespace tetris {
         
             // Store current piece in hold
             held_piece = CreatePieceByType(currentType);
+            GameEvent held = MakeEvent(GameEventType::HOLD);
+            held.piece = currentType;
+            events.Push(held);
             
             // Spawn held piece at correct position
             currentPiece = CreatePieceByType(heldType);
@@ -545,6 +790,9 @@ namespace tetris {
                 spawnPos
             )) {
                 isGameOverFlag = true;
+                events.Push(MakeEvent(GameEventType::GAME_OVER));
+            } else {
+                events.Push(MakeEvent(GameEventType::SPAWN));
             }
         }
 
@@ -554,6 +802,25 @@ namespace tetris {
         lockDelayTimer.ResetCounter();
     }
 
+    GameEvent Board::MakeEvent(GameEventType type) const {
+        GameEvent event;
+        event.frame = static_cast<uint32_t>(game.GetFrame());
+        event.type = type;
+        event.pending = static_cast<uint16_t>(garbage_count);
+        if (currentPiece) {
+            event.piece = currentPiece->GetType();
+            event.rotation = static_cast<uint8_t>(currentPiece->GetCurrentRotation());
+            event.x = static_cast<int8_t>(currentPieceTopLeftPos.x);
+            event.y = static_cast<int8_t>(currentPieceTopLeftPos.y);
+        }
+        if (type == GameEventType::SPAWN || type == GameEventType::GAME_OVER) {
+            for (size_t i = 0; i < EVENT_NEXT_PIECES; ++i) {
+                event.next |= static_cast<uint32_t>(PeekNext(i)) << (4 * i);
+            }
+        }
+        return event;
+    }
+
     int Board::IsTSpin() const {
         if (!currentPiece || currentPiece->GetType() != PieceType::T || !lastMoveWasRotation) {
             return 0;
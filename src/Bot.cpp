@@ -0,0 +1,226 @@
+#include "TetrisEngine/Bot.h"
+#include "TetrisEngine/Metrics.h"
+#include "TetrisEngine/NeuralNetwork.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace tetris {
+    namespace {
+        constexpr float ILLEGAL_SCORE = -std::numeric_limits<float>::infinity();
+
+        struct WeightField {
+            const char* name;
+            float HeuristicWeights::* member;
+        };
+
+        constexpr WeightField WEIGHT_FIELDS[] = {
+            {"aggregate_height", &HeuristicWeights::aggregateHeight},
+            {"lines",            &HeuristicWeights::lines},
+            {"holes",            &HeuristicWeights::holes},
+            {"bumpiness",        &HeuristicWeights::bumpiness},
+            {"attack",           &HeuristicWeights::attack},
+            {"top_out",          &HeuristicWeights::topOut},
+        };
+
+        std::string Trim(const std::string& text) {
+            const char* space = " \t\r\n";
+            size_t begin = text.find_first_not_of(space);
+            if (begin == std::string::npos) return {};
+            return text.substr(begin, text.find_last_not_of(space) - begin + 1);
+        }
+    }
+
+    bool ApplyAction(const BotPosition& position, int action, AfterState& out) {
+        if (action < 0 || action >= BOT_ACTION_COUNT) return false;
+
+        // Queue after a hold: an empty hold slot pulls the first next piece forward
+        PieceType current = position.current;
+        size_t queueStart = 0;
+        out.hold = position.hold;
+        if (action >= PLACEMENT_COUNT) {
+            out.hold = position.current;
+            if (position.hold == PieceType::EMPTY) {
+                current = position.next[0];
+                queueStart = 1;
+            } else {
+                current = position.hold;
+            }
+        }
+
+        const int placement = action % PLACEMENT_COUNT;
+        int x = 0, y = 0;
+        if (!FindPlacement(position.rows, current, placement, x, y)) return false;
+
+        std::copy_n(position.rows, TOTAL_BOARD_HEIGHT, out.rows.begin());
+        PlacePiece(out.rows.data(), GetPieceShape(current, static_cast<RotationState>(placement / BOARD_WIDTH)), x, y);
+        out.lines = ClearLines(out.rows.data());
+        out.backToBack = position.backToBack;
+        out.combo = position.combo;
+        out.attack = ComputeAttack(0, false, out.lines, out.backToBack, out.combo).Total();
+
+        out.current = position.next[queueStart];
+        out.next.fill(PieceType::EMPTY);
+        for (size_t i = queueStart + 1; i < FEATURE_NEXT_PIECES; ++i) out.next[i - queueStart - 1] = position.next[i];
+
+        const Point spawn = GetSpawnPosition(out.current);
+        out.toppedOut = !PieceFits(out.rows.data(), GetPieceShape(out.current, RotationState::STATE_0), spawn.x, spawn.y);
+        return true;
+    }
+
+    HeuristicWeights LoadHeuristicWeights(const std::filesystem::path& path) {
+        std::ifstream file(path);
+        if (!file) throw std::runtime_error("Cannot open heuristic weights " + path.string());
+
+        HeuristicWeights weights;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            ++lineNumber;
+            line = Trim(line.substr(0, line.find('#')));
+            if (line.empty()) continue;
+
+            size_t equals = line.find('=');
+            if (equals == std::string::npos) {
+                throw std::runtime_error(path.string() + ":" + std::to_string(lineNumber) + ": expected name = value");
+            }
+            std::string name = Trim(line.substr(0, equals));
+            std::string value = Trim(line.substr(equals + 1));
+
+            const WeightField* field = nullptr;
+            for (const WeightField& candidate : WEIGHT_FIELDS) {
+                if (name == candidate.name) field = &candidate;
+            }
+            if (!field) throw std::runtime_error(path.string() + ":" + std::to_string(lineNumber) + ": unknown weight " + name);
+
+            try {
+                weights.*(field->member) = std::stof(value);
+            } catch (const std::exception&) {
+                throw std::runtime_error(path.string() + ":" + std::to_string(lineNumber) + ": bad value " + value);
+            }
+        }
+        return weights;
+    }
+
+    void SaveHeuristicWeights(const std::filesystem::path& path, const HeuristicWeights& weights) {
+        std::ostringstream text;
+        text.precision(9);
+        for (const WeightField& field : WEIGHT_FIELDS) {
+            text << field.name << " = " << weights.*(field.member) << "\n";
+        }
+
+        std::ofstream file(path, std::ios::trunc);
+        if (!file || !(file << text.str())) throw std::runtime_error("Cannot write heuristic weights " + path.string());
+    }
+
+    HeuristicBot::HeuristicBot(HeuristicWeights weights)
+        : m_weights(weights)
+    {
+    }
+
+    float HeuristicBot::Evaluate(const AfterState& state) const {
+        if (state.toppedOut) return m_weights.topOut;
+
+        // Walk down from the top: the first row with a column's bit is its height,
+        // and every empty cell under a covered column is a hole
+        int heights[BOARD_WIDTH] = {};
+        uint16_t covered = 0;
+        int holes = 0;
+        for (int row = TOTAL_BOARD_HEIGHT - 1; row >= 0; --row) {
+            const uint16_t cells = state.rows[row];
+            uint16_t newlyCovered = cells & ~covered;
+            while (newlyCovered) {
+                heights[std::countr_zero(newlyCovered)] = row + 1;
+                newlyCovered &= newlyCovered - 1;
+            }
+            holes += std::popcount(static_cast<uint16_t>(covered & ~cells & FULL_ROW_MASK));
+            covered |= cells;
+        }
+
+        int aggregateHeight = 0;
+        int bumpiness = 0;
+        for (int col = 0; col < BOARD_WIDTH; ++col) {
+            aggregateHeight += heights[col];
+            if (col > 0) bumpiness += std::abs(heights[col] - heights[col - 1]);
+        }
+
+        return m_weights.aggregateHeight * aggregateHeight
+             + m_weights.lines * state.lines
+             + m_weights.holes * holes
+             + m_weights.bumpiness * bumpiness
+             + m_weights.attack * state.attack;
+    }
+
+    void HeuristicBot::ScoreActions(const BotPosition& position, const uint8_t* mask, float* scores) const {
+        AfterState state;
+        for (int action = 0; action < BOT_ACTION_COUNT; ++action) {
+            scores[action] = mask[action] && ApplyAction(position, action, state) ? Evaluate(state) : ILLEGAL_SCORE;
+        }
+    }
+
+    NetworkBot::NetworkBot(const NeuralNetwork& network, float topOutScore)
+        : m_network(network),
+          m_topOutScore(topOutScore)
+    {
+    }
+
+    void NetworkBot::ScoreActions(const BotPosition& position, const uint8_t* mask, float* scores) const {
+        std::shared_ptr<const InferenceBackend> backend = m_network.GetBackend();
+        if (backend->GetInputSize() != BOARD_FEATURE_SIZE) {
+            throw std::runtime_error("Model expects " + std::to_string(backend->GetInputSize()) + " inputs, board features have "
+                + std::to_string(BOARD_FEATURE_SIZE));
+        }
+
+        thread_local std::vector<float> input;
+        thread_local std::vector<float> output;
+        thread_local std::vector<int> actions;
+        thread_local std::vector<int> attacks;
+        input.resize(BOT_ACTION_COUNT * BOARD_FEATURE_SIZE);
+        actions.clear();
+        attacks.clear();
+
+        AfterState state;
+        for (int action = 0; action < BOT_ACTION_COUNT; ++action) {
+            scores[action] = ILLEGAL_SCORE;
+            if (!mask[action] || !ApplyAction(position, action, state)) continue;
+            if (state.toppedOut) {
+                scores[action] = m_topOutScore;
+                continue;
+            }
+            EncodeFeatures(state.rows.data(), state.current, state.hold, state.next.data(),
+                           input.data() + actions.size() * BOARD_FEATURE_SIZE);
+            actions.push_back(action);
+            attacks.push_back(state.attack);
+        }
+        if (actions.empty()) return;
+
+        const size_t outputSize = backend->GetOutputSize();
+        output.resize(actions.size() * outputSize);
+        const auto start = std::chrono::steady_clock::now();
+        backend->Run(input.data(), actions.size(), output.data());
+        const uint64_t batchNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        metrics::RecordLatency(metrics::Latency::INFERENCE, batchNs);
+        m_batchNs.fetch_add(batchNs, std::memory_order_relaxed);
+        m_batches.fetch_add(1, std::memory_order_relaxed);
+        m_positions.fetch_add(actions.size(), std::memory_order_relaxed);
+        for (size_t i = 0; i < actions.size(); ++i) {
+            scores[actions[i]] = static_cast<float>(attacks[i]) + output[i * outputSize];
+        }
+    }
+
+    InferenceStats NetworkBot::GetInferenceStats() const noexcept {
+        InferenceStats stats;
+        stats.batches = m_batches.load(std::memory_order_relaxed);
+        stats.positions = m_positions.load(std::memory_order_relaxed);
+        stats.totalNs = m_batchNs.load(std::memory_order_relaxed);
+        return stats;
+    }
+}
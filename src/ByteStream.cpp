@@ -0,0 +1,42 @@
+#include "TetrisEngine/ByteStream.h"
+#include <fstream>
+#include <system_error>
+
+namespace tetris {
+    void WriteFileAtomically(const std::filesystem::path& path,
+                             const std::function<void(const std::filesystem::path& tempPath)>& write,
+                             const std::string& tempSuffix) {
+        std::filesystem::path tempPath = path;
+        tempPath += tempSuffix;
+
+        std::error_code ec;
+        try {
+            write(tempPath);
+        } catch (...) {
+            std::filesystem::remove(tempPath, ec);
+            throw;
+        }
+
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            const std::string reason = ec.message();
+            std::filesystem::remove(tempPath, ec);
+            throw std::runtime_error("Cannot move " + tempPath.string() + " into place: " + reason);
+        }
+    }
+
+    void WriteFileAtomically(const std::filesystem::path& path, const std::function<void(std::ostream& out)>& write) {
+        WriteFileAtomically(path, [&write](const std::filesystem::path& tempPath) {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file) throw std::runtime_error("Cannot open " + tempPath.string());
+            write(file);
+            if (!file.flush()) throw std::runtime_error("Cannot write " + tempPath.string());
+        });
+    }
+
+    void WriteFileAtomically(const std::filesystem::path& path, const ByteWriter& bytes) {
+        WriteFileAtomically(path, [&bytes](std::ostream& out) {
+            out.write(reinterpret_cast<const char*>(bytes.Data()), static_cast<std::streamsize>(bytes.Size()));
+        });
+    }
+}
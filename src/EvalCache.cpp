@@ -0,0 +1,169 @@
+#include "TetrisEngine/EvalCache.h"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace tetris {
+    namespace {
+        inline uint64_t MixKey(uint64_t x) {
+            x ^= x >> 33; x *= 0xff51afd7ed558ccdull;
+            x ^= x >> 33; x *= 0xc4ceb9fe1a85ec53ull;
+            return x ^ (x >> 33);
+        }
+
+        // 0 marks an empty slot, so it can never be a real key
+        inline uint64_t NonZero(uint64_t key) {
+            return key ? key : 1;
+        }
+    }
+
+    EvalCache::EvalCache(size_t capacity, size_t valueSize, size_t shardCount)
+        : m_valueSize(valueSize)
+    {
+        if (valueSize == 0) throw std::invalid_argument("EvalCache value size must be positive");
+
+        m_shardCount = std::bit_ceil(std::max<size_t>(shardCount, 1));
+        size_t buckets = (std::max<size_t>(capacity, 1) + WAYS - 1) / WAYS;
+        m_bucketsPerShard = std::bit_ceil(std::max<size_t>((buckets + m_shardCount - 1) / m_shardCount, 1));
+
+        const size_t slotsPerShard = m_bucketsPerShard * WAYS;
+        m_shards = std::make_unique<Shard[]>(m_shardCount);
+        for (size_t i = 0; i < m_shardCount; ++i) {
+            Shard& shard = m_shards[i];
+            shard.slots = std::make_unique<Slot[]>(slotsPerShard);
+            shard.values = std::make_unique<std::atomic<float>[]>(slotsPerShard * m_valueSize);
+            shard.hands = std::make_unique<uint8_t[]>(m_bucketsPerShard);
+        }
+    }
+
+    EvalCache::~EvalCache() = default;
+
+    uint64_t EvalCache::MakeKey(uint64_t positionHash, uint64_t modelVersion) {
+        return NonZero(MixKey(positionHash ^ MixKey(modelVersion + 0x9e3779b97f4a7c15ull)));
+    }
+
+    EvalCache::Shard& EvalCache::_shardFor(uint64_t key) const {
+        // Buckets use the low bits, shards the high ones
+        return m_shards[static_cast<size_t>(key >> 40) & (m_shardCount - 1)];
+    }
+
+    bool EvalCache::Lookup(uint64_t key, float* out) {
+        key = NonZero(key);
+        Shard& shard = _shardFor(key);
+        const size_t first = _bucketFor(key) * WAYS;
+
+        for (size_t i = first; i < first + WAYS; ++i) {
+            Slot& slot = shard.slots[i];
+            const uint32_t before = slot.seq.load(std::memory_order_acquire);
+            if (before & 1u) continue;
+            if (slot.key.load(std::memory_order_relaxed) != key) continue;
+
+            const std::atomic<float>* values = &shard.values[i * m_valueSize];
+            for (size_t v = 0; v < m_valueSize; ++v) {
+                out[v] = values[v].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != before) break; // overwritten under us
+
+            if (!slot.referenced.load(std::memory_order_relaxed)) {
+                slot.referenced.store(1, std::memory_order_relaxed);
+            }
+            shard.hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void EvalCache::_writeSlot(Shard& shard, size_t slotIndex, uint64_t key, const float* values) {
+        Slot& slot = shard.slots[slotIndex];
+        const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.key.store(key, std::memory_order_relaxed);
+        if (values) {
+            std::atomic<float>* dst = &shard.values[slotIndex * m_valueSize];
+            for (size_t v = 0; v < m_valueSize; ++v) {
+                dst[v].store(values[v], std::memory_order_relaxed);
+            }
+        }
+
+        slot.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    void EvalCache::Insert(uint64_t key, const float* values) {
+        key = NonZero(key);
+        Shard& shard = _shardFor(key);
+        const size_t bucket = _bucketFor(key);
+        const size_t first = bucket * WAYS;
+
+        std::lock_guard<std::mutex> lock(shard.writeMutex);
+
+        size_t target = WAYS;
+        bool evicting = false;
+        for (size_t way = 0; way < WAYS; ++way) {
+            uint64_t current = shard.slots[first + way].key.load(std::memory_order_relaxed);
+            if (current == key) { target = way; break; }
+            if (current == 0 && target == WAYS) target = way;
+        }
+
+        if (target == WAYS) {
+            // CLOCK: clear reference bits until an unreferenced slot comes round
+            // (bounded, since concurrent hits can keep setting them)
+            uint8_t hand = shard.hands[bucket];
+            for (size_t sweep = 0; sweep < 2 * WAYS; ++sweep) {
+                if (!shard.slots[first + hand].referenced.exchange(0, std::memory_order_relaxed)) break;
+                hand = static_cast<uint8_t>((hand + 1) % WAYS);
+            }
+            target = hand;
+            shard.hands[bucket] = static_cast<uint8_t>((hand + 1) % WAYS);
+            evicting = true;
+        }
+
+        Slot& slot = shard.slots[first + target];
+        const bool wasEmpty = slot.key.load(std::memory_order_relaxed) == 0;
+        _writeSlot(shard, first + target, key, values);
+        slot.referenced.store(0, std::memory_order_relaxed);
+
+        shard.inserts.fetch_add(1, std::memory_order_relaxed);
+        if (evicting) shard.evictions.fetch_add(1, std::memory_order_relaxed);
+        if (wasEmpty) shard.entries.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void EvalCache::Clear() {
+        const size_t slotsPerShard = m_bucketsPerShard * WAYS;
+        for (size_t s = 0; s < m_shardCount; ++s) {
+            Shard& shard = m_shards[s];
+            std::lock_guard<std::mutex> lock(shard.writeMutex);
+            for (size_t i = 0; i < slotsPerShard; ++i) {
+                if (shard.slots[i].key.load(std::memory_order_relaxed) != 0) {
+                    _writeSlot(shard, i, 0, nullptr);
+                    shard.slots[i].referenced.store(0, std::memory_order_relaxed);
+                }
+            }
+            shard.entries.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    EvalCacheStats EvalCache::GetStats() const {
+        EvalCacheStats stats;
+        for (size_t s = 0; s < m_shardCount; ++s) {
+            const Shard& shard = m_shards[s];
+            stats.hits += shard.hits.load(std::memory_order_relaxed);
+            stats.misses += shard.misses.load(std::memory_order_relaxed);
+            stats.inserts += shard.inserts.load(std::memory_order_relaxed);
+            stats.evictions += shard.evictions.load(std::memory_order_relaxed);
+            stats.entries += shard.entries.load(std::memory_order_relaxed);
+        }
+
+        const size_t slotsPerShard = m_bucketsPerShard * WAYS;
+        stats.capacity = m_shardCount * slotsPerShard;
+        stats.memoryBytes = sizeof(*this)
+                          + m_shardCount * (sizeof(Shard) + m_bucketsPerShard)
+                          + stats.capacity * (sizeof(Slot) + m_valueSize * sizeof(std::atomic<float>));
+        return stats;
+    }
+}
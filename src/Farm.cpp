@@ -0,0 +1,289 @@
+#include "TetrisEngine/Farm.h"
+#include "TetrisEngine/Board.h"
+#include "TetrisEngine/Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace tetris {
+    namespace {
+        // Glicko-2 works on this scale internally
+        constexpr double GLICKO_SCALE = 173.7178;
+        constexpr double GLICKO_MAX_DEVIATION = 350.0;
+
+        double GlickoG(double phi) {
+            return 1.0 / std::sqrt(1.0 + 3.0 * phi * phi / (std::numbers::pi * std::numbers::pi));
+        }
+
+        double GlickoE(double mu, double muOpponent, double phiOpponent) {
+            return 1.0 / (1.0 + std::exp(-GlickoG(phiOpponent) * (mu - muOpponent)));
+        }
+
+        // Match seeds are 64-bit; games take 32
+        unsigned int GameSeed(uint64_t seed) {
+            return static_cast<unsigned int>(seed ^ (seed >> 32));
+        }
+    }
+
+    uint64_t MatchSeed(uint64_t base, uint64_t match) {
+        uint64_t z = base + 0x9e3779b97f4a7c15ull * (match + 1);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    MatchResult MatchArena::Play(const Bot* const* bots, size_t count, uint64_t seed, const MatchConfig& config) {
+        Start(bots, count, seed, config);
+        while (Step()) {}
+        return GetResult();
+    }
+
+    void MatchArena::Start(const Bot* const* bots, size_t count, uint64_t seed, const MatchConfig& config) {
+        if (count == 0 || count > MATCH_MAX_PLAYERS) throw std::invalid_argument("A match needs one or two bots");
+
+        std::unique_ptr<Game>& slot = m_games[count - 1];
+        if (slot) {
+            slot->Reset(GameSeed(seed));
+        } else {
+            slot = std::make_unique<Game>(count, GameSeed(seed));
+        }
+        m_game = slot.get();
+        m_game->GetGarbageRouter().SetDelayFrames(config.garbageDelayFrames);
+
+        m_bots.fill(nullptr);
+        std::copy_n(bots, count, m_bots.begin());
+        m_config = config;
+
+        // Bots think for one piece's worth of time before every placement, the first included
+        m_framesPerPiece = Game::FRAMES_PER_SECOND / std::max(config.piecesPerSecond, 1e-3);
+        m_nextMove.fill(m_framesPerPiece);
+
+        m_lastAction.fill(-1);
+        m_result = MatchResult();
+        m_result.seed = seed;
+        m_result.playerCount = static_cast<uint8_t>(count);
+        m_running = config.maxFrames > 0;
+    }
+
+    bool MatchArena::Step() {
+        if (!m_running) return false;
+
+        Game& game = *m_game;
+        const size_t count = m_result.playerCount;
+        const uint32_t frame = m_result.frames;
+        for (size_t player = 0; player < count; ++player) {
+            if (frame < m_nextMove[player] || game.getBoard(player).IsGameOver()) continue;
+            _placePiece(game, player, *m_bots[player]);
+            ++m_result.players[player].pieces;
+            m_nextMove[player] += m_framesPerPiece;
+        }
+        game.StepFrame();
+        ++m_result.frames;
+
+        size_t alive = 0;
+        for (size_t player = 0; player < count; ++player) alive += !game.getBoard(player).IsGameOver();
+        m_running = m_result.frames < m_config.maxFrames && alive > 0 && (count == 1 || alive > 1);
+        if (!m_running) metrics::Increment(metrics::Counter::GAMES);
+        return m_running;
+    }
+
+    MatchResult MatchArena::GetResult() const {
+        MatchResult result = m_result;
+        if (!m_game) return result;
+
+        const size_t count = result.playerCount;
+        for (size_t player = 0; player < count; ++player) {
+            const Board& board = m_game->getBoard(player);
+            MatchPlayerResult& stats = result.players[player];
+            stats.lines = static_cast<uint32_t>(board.GetLinesCleared());
+            stats.attack = static_cast<uint32_t>(board.GetAttackTotal());
+            stats.toppedOut = board.IsGameOver();
+            if (count > 1 && !stats.toppedOut && m_game->getBoard(1 - player).IsGameOver()) result.winner = static_cast<int8_t>(player);
+        }
+        return result;
+    }
+
+    void MatchArena::_placePiece(Game& game, size_t player, const Bot& bot) {
+        Board& board = game.getBoard(player);
+        const Piece* piece = board.GetCurrentPiece();
+        if (!piece) return;
+
+        for (int row = 0; row < TOTAL_BOARD_HEIGHT; ++row) m_rows[row] = board.GetRowMask(row);
+
+        BotPosition position;
+        position.rows = m_rows.data();
+        position.current = piece->GetType();
+        position.hold = board.GetHeldPieceType();
+        std::vector<PieceType> next = board.GetNextQueue();
+        for (size_t i = 0; i < std::min(next.size(), position.next.size()); ++i) position.next[i] = next[i];
+        position.backToBack = board.GetB2BChain();
+        position.combo = board.GetCombo();
+
+        // Same action space and legality as VecEnv
+        LegalPlacements(m_rows.data(), position.current, m_mask.data());
+        if (board.CanHold()) {
+            PieceType afterHold = position.hold != PieceType::EMPTY ? position.hold : position.next[0];
+            LegalPlacements(m_rows.data(), afterHold, m_mask.data() + PLACEMENT_COUNT);
+        } else {
+            std::fill_n(m_mask.data() + PLACEMENT_COUNT, PLACEMENT_COUNT, 0);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        bot.ScoreActions(position, m_mask.data(), m_scores.data());
+        const uint64_t searchNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        m_searchStats.searchNs += searchNs;
+        ++m_searchStats.decisions;
+        m_searchStats.depth = std::max(m_searchStats.depth, bot.GetSearchDepth());
+        metrics::RecordLatency(metrics::Latency::BOT_DECISION, searchNs);
+
+        int best = -1;
+        uint64_t nodes = 0;
+        for (int action = 0; action < BOT_ACTION_COUNT; ++action) {
+            nodes += m_mask[action];
+            if (m_mask[action] && std::isfinite(m_scores[action]) && (best < 0 || m_scores[action] > m_scores[best])) best = action;
+        }
+        m_searchStats.nodes += nodes;
+        metrics::Increment(metrics::Counter::POSITIONS, nodes);
+        m_lastAction[player] = best;
+        m_lastPiece[player] = position.current;
+
+        // Nowhere to go: drop where it stands and let the board decide if that tops out
+        int x = 0, y = 0;
+        if (best >= PLACEMENT_COUNT) game.ApplyInput(player, InputType::HOLD);
+        const int placement = best % PLACEMENT_COUNT;
+        if (best < 0 || !board.GetCurrentPiece() || !FindPlacement(m_rows.data(), board.GetCurrentPiece()->GetType(), placement, x, y)) {
+            game.ApplyInput(player, InputType::HARD_DROP);
+            return;
+        }
+
+        // Rotate at spawn, slide to the column, drop: exactly how FindPlacement reaches it
+        switch (static_cast<RotationState>(placement / BOARD_WIDTH)) {
+            case RotationState::STATE_R: game.ApplyInput(player, InputType::ROTATE_CW); break;
+            case RotationState::STATE_2: game.ApplyInput(player, InputType::ROTATE_180); break;
+            case RotationState::STATE_L: game.ApplyInput(player, InputType::ROTATE_CCW); break;
+            case RotationState::STATE_0: break;
+        }
+        for (int column = board.GetCurrentPiecePosition().x; column != x;) {
+            game.ApplyInput(player, column < x ? InputType::MOVE_RIGHT : InputType::MOVE_LEFT);
+            int moved = board.GetCurrentPiecePosition().x;
+            if (moved == column) break;  // blocked by a piece that fell since spawning
+            column = moved;
+        }
+        game.ApplyInput(player, InputType::HARD_DROP);
+    }
+
+    void UpdateElo(double& ratingA, double& ratingB, double scoreA, double k) {
+        double expectedA = 1.0 / (1.0 + std::pow(10.0, (ratingB - ratingA) / 400.0));
+        double delta = k * (scoreA - expectedA);
+        ratingA += delta;
+        ratingB -= delta;
+    }
+
+    void UpdateGlicko(GlickoRating& rating, const GlickoOutcome* outcomes, size_t count, double tau) {
+        const double mu = (rating.rating - 1500.0) / GLICKO_SCALE;
+        const double phi = rating.deviation / GLICKO_SCALE;
+        const double sigma = rating.volatility;
+
+        if (count == 0) {
+            rating.deviation = std::min(GLICKO_MAX_DEVIATION, std::sqrt(phi * phi + sigma * sigma) * GLICKO_SCALE);
+            return;
+        }
+
+        // Estimated variance and improvement from this period's games
+        double inverseVariance = 0.0;
+        double improvementSum = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            const double muOpponent = (outcomes[i].opponentRating - 1500.0) / GLICKO_SCALE;
+            const double phiOpponent = outcomes[i].opponentDeviation / GLICKO_SCALE;
+            const double g = GlickoG(phiOpponent);
+            const double e = GlickoE(mu, muOpponent, phiOpponent);
+            inverseVariance += g * g * e * (1.0 - e);
+            improvementSum += g * (outcomes[i].score - e);
+        }
+        const double v = 1.0 / inverseVariance;
+        const double delta = v * improvementSum;
+
+        // New volatility by the Illinois method (step 5 of Glickman's paper)
+        const double a = std::log(sigma * sigma);
+        auto f = [&](double x) {
+            const double ex = std::exp(x);
+            const double denominator = phi * phi + v + ex;
+            return ex * (delta * delta - phi * phi - v - ex) / (2.0 * denominator * denominator) - (x - a) / (tau * tau);
+        };
+        double lower = a;
+        double upper;
+        if (delta * delta > phi * phi + v) {
+            upper = std::log(delta * delta - phi * phi - v);
+        } else {
+            int k = 1;
+            while (f(a - k * tau) < 0.0) ++k;
+            upper = a - k * tau;
+        }
+        double fLower = f(lower);
+        double fUpper = f(upper);
+        while (std::abs(upper - lower) > 1e-6) {
+            const double c = lower + (lower - upper) * fLower / (fUpper - fLower);
+            const double fc = f(c);
+            if (fc * fUpper <= 0.0) {
+                lower = upper;
+                fLower = fUpper;
+            } else {
+                fLower /= 2.0;
+            }
+            upper = c;
+            fUpper = fc;
+        }
+        const double newSigma = std::exp(lower / 2.0);
+
+        const double phiStar = std::sqrt(phi * phi + newSigma * newSigma);
+        const double newPhi = 1.0 / std::sqrt(1.0 / (phiStar * phiStar) + 1.0 / v);
+        const double newMu = mu + newPhi * newPhi * improvementSum;
+
+        rating.rating = newMu * GLICKO_SCALE + 1500.0;
+        rating.deviation = std::min(GLICKO_MAX_DEVIATION, newPhi * GLICKO_SCALE);
+        rating.volatility = newSigma;
+    }
+
+    FarmStats::FarmStats(size_t participants, double eloK) : m_stats(participants), m_period(participants), m_eloK(eloK) {}
+
+    void FarmStats::Add(const MatchResult& result, const size_t* seats) {
+        ++m_games;
+        for (size_t seat = 0; seat < result.playerCount; ++seat) {
+            ParticipantStats& stats = m_stats.at(seats[seat]);
+            const MatchPlayerResult& player = result.players[seat];
+            ++stats.games;
+            stats.pieces += player.pieces;
+            stats.lines += player.lines;
+            stats.attack += player.attack;
+            stats.frames += result.frames;
+        }
+        if (result.playerCount != 2) return;
+
+        ParticipantStats& a = m_stats.at(seats[0]);
+        ParticipantStats& b = m_stats.at(seats[1]);
+        const double scoreA = result.winner == 0 ? 1.0 : result.winner == 1 ? 0.0 : 0.5;
+        if (result.winner < 0) {
+            ++a.draws;
+            ++b.draws;
+        } else {
+            ++(result.winner == 0 ? a : b).wins;
+            ++(result.winner == 0 ? b : a).losses;
+        }
+
+        // A mirror match says nothing about strength
+        if (seats[0] == seats[1]) return;
+        UpdateElo(a.elo, b.elo, scoreA, m_eloK);
+        m_period[seats[0]].push_back({b.glicko.rating, b.glicko.deviation, scoreA});
+        m_period[seats[1]].push_back({a.glicko.rating, a.glicko.deviation, 1.0 - scoreA});
+    }
+
+    void FarmStats::EndRatingPeriod() {
+        for (size_t i = 0; i < m_stats.size(); ++i) {
+            UpdateGlicko(m_stats[i].glicko, m_period[i].data(), m_period[i].size());
+            m_period[i].clear();
+        }
+    }
+}
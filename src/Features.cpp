@@ -0,0 +1,33 @@
+#include "TetrisEngine/Features.h"
+#include <algorithm>
+
+namespace tetris {
+    static_assert(FEATURE_CELLS == 200, "feature layout assumes a 10x20 visible board");
+
+    namespace {
+        // I..Z map to 0..6; EMPTY and G have no slot
+        inline void SetOneHot(float* slot, PieceType type) {
+            int index = static_cast<int>(type) - 1;
+            if (index >= 0 && index < static_cast<int>(FEATURE_PIECE_TYPES)) slot[index] = 1.0f;
+        }
+    }
+
+    void EncodeFeatures(const uint16_t* rowMasks, PieceType current, PieceType hold, const PieceType* next, float* out) {
+        std::fill_n(out, BOARD_FEATURE_SIZE, 0.0f);
+
+        for (int row = 0; row < VISIBLE_BOARD_HEIGHT; ++row) {
+            uint16_t mask = rowMasks[row];
+            float* cells = out + row * BOARD_WIDTH;
+            for (int col = 0; col < BOARD_WIDTH; ++col) {
+                cells[col] = static_cast<float>((mask >> col) & 1u);
+            }
+        }
+
+        float* pieces = out + FEATURE_CELLS;
+        SetOneHot(pieces, current);
+        SetOneHot(pieces + FEATURE_PIECE_TYPES, hold);
+        for (size_t i = 0; i < FEATURE_NEXT_PIECES; ++i) {
+            SetOneHot(pieces + FEATURE_PIECE_TYPES * (2 + i), next[i]);
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#include "TetrisEngine/FrameStats.h"
+#include <algorithm>
+#include <cmath>
+
+namespace tetris {
+    void FrameStats::Record(double workSeconds, double endSeconds) noexcept {
+        const size_t slot = static_cast<size_t>(m_frames % WINDOW);
+        m_work[slot] = workSeconds;
+        m_end[slot] = endSeconds;
+        ++m_frames;
+        m_totalWork += workSeconds;
+    }
+
+    double FrameStats::GetFramesPerSecond() const noexcept {
+        const size_t count = _count();
+        if (count == 0) return 0.0;
+
+        const double latest = m_end[static_cast<size_t>((m_frames - 1) % WINDOW)];
+        size_t recent = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (latest - m_end[i] < 1.0) ++recent;
+        }
+        return static_cast<double>(recent);
+    }
+
+    double FrameStats::GetMeanMs() const noexcept {
+        const size_t count = _count();
+        if (count == 0) return 0.0;
+        double sum = 0.0;
+        for (size_t i = 0; i < count; ++i) sum += m_work[i];
+        return sum / static_cast<double>(count) * 1000.0;
+    }
+
+    double FrameStats::GetMaxMs() const noexcept {
+        const size_t count = _count();
+        return count == 0 ? 0.0 : *std::max_element(m_work.begin(), m_work.begin() + count) * 1000.0;
+    }
+
+    double FrameStats::GetPercentileMs(double percentile) const noexcept {
+        const size_t count = _count();
+        if (count == 0) return 0.0;
+
+        std::array<double, WINDOW> sorted;
+        std::copy(m_work.begin(), m_work.begin() + count, sorted.begin());
+        const double clamped = std::clamp(percentile, 0.0, 100.0);
+        const size_t rank = std::max<size_t>(1, static_cast<size_t>(std::ceil(clamped / 100.0 * count)));
+        std::nth_element(sorted.begin(), sorted.begin() + (rank - 1), sorted.begin() + count);
+        return sorted[rank - 1] * 1000.0;
+    }
+
+    double FrameStats::GetLifetimeMeanMs() const noexcept {
+        return m_frames == 0 ? 0.0 : m_totalWork / static_cast<double>(m_frames) * 1000.0;
+    }
+}
@@ -1,70 +1,214 @@
 #include "TetrisEngine/Game.h"
 #include "TetrisEngine/Board.h"
+#include "TetrisEngine/Profiler.h"
+#include "TetrisEngine/Replay.h"
+#include "TetrisEngine/ThreadPool.h"
+#include <algorithm>
+
+// Wall-clock time Update() will catch up on at once; anything beyond (a stall, a debugger break) is dropped
+static constexpr double MaxFrameBacklog = 10.0;
+
+namespace {
+    // Rows up to and including the highest locked cell
+    int StackHeight(const tetris::Board& board) {
+        for (int row = tetris::TOTAL_BOARD_HEIGHT - 1; row >= 0; --row) {
+            if (board.GetRowMask(row)) return row + 1;
+        }
+        return 0;
+    }
+}
 
 namespace tetris {
     void Game::Reset() {
+        if (m_recorder) m_recorder->OnReset();
+
         for (size_t i = 0; i < playerCount(); i++) {
             getBoard(i).Reset();
         }
 
         gravityClock.reset();
+        m_router.Reset();
     }
 
-    void Game::TransferGarbage(size_t sendingPlayerID, int lines){
-        size_t target_player = (sendingPlayerID) ? 0u : 1u; // targetting only considers 2 players 
-        Board &target_board = getBoard(target_player);
-
-        // cancel pending garbage
-        while (lines != 0 && !pending_garbage_queues[sendingPlayerID].empty()) {
-            if (lines >= pending_garbage_queues[sendingPlayerID].front()){
-                lines -= pending_garbage_queues[sendingPlayerID].front();
-                pending_garbage_queues[sendingPlayerID].pop();
-            } else {
-                pending_garbage_queues[sendingPlayerID].front() -= lines;
-                lines = 0;
-            }
+    void Game::Reset(unsigned int seed) {
+        if (m_recorder) throw std::runtime_error("Cannot reseed a game while it is being recorded");
+
+        m_seed = seed;
+        for (std::unique_ptr<Board>& board : m_boards) {
+            board->Reset(seed);
         }
 
-        // send lines to other player
-        if (lines > 0) {
-            pending_garbage_queues[target_player].push(lines);
+        gravityClock.reset();
+        m_router.Reset(RouterSeed(seed));
+        m_frame = 0;
+        accumulatedTime = 0.0;
+        m_lastUpdate = {};
+    }
 
-            // wait 20 frames (or 500ms?)
-            target_board.AddGarbageToQueue(pending_garbage_queues[target_player].front());
-            pending_garbage_queues[target_player].pop();
+    void Game::TransferGarbage(size_t sendingPlayerID, int lines){
+        // Each board is stepped by one thread, so its outbox needs no lock
+        if (m_steppingBoards) {
+            if (lines > 0) m_outboxes.at(sendingPlayerID).push_back(lines);
+            return;
         }
+
+        m_router.Route(sendingPlayerID, lines, m_frame);
+
+        // With no delivery delay the garbage is due right away
+        if (m_router.GetDelayFrames() == 0) _deliverGarbage();
+    }
+
+    void Game::_deliverGarbage() {
+        m_router.Deliver(m_frame, [this](size_t target, int lines, uint64_t sentFrame) {
+            m_boards[target]->AddGarbageToQueue(lines, sentFrame);
+        });
     }
 
     // This is so scuffed
     void Game::moveAllPiecesDown(int row) {
-        for (int i = 0; i < row; i++) {  // Move one row at a time
-            for (size_t j = 0; j < m_boards.size(); j++) {
-                Board& board = *m_boards[j];
-                // Skip boards in lock delay
-                if (board.IsInLockDelay()) continue;
-                
-                if (board.HasActivePiece()) {
-                    if (!board.MoveActivePiece(0, -1)) {
-                        // If moving down fails, start lock delay if not already started
-                        if (!board.IsInLockDelay()) {
-                            board.StartLockDelay();
-                        }
-                    }
-                }
+        for (size_t j = 0; j < m_boards.size(); j++) {
+            _applyGravity(*m_boards[j], row);
+        }
+    }
+
+    void Game::_applyGravity(Board& board, int rows) {
+        for (int i = 0; i < rows; i++) {  // Move one row at a time
+            // Boards in lock delay stay put
+            if (board.IsInLockDelay()) return;
+
+            if (board.HasActivePiece() && !board.MoveActivePiece(0, -1)) {
+                // If moving down fails, start lock delay
+                board.StartLockDelay();
             }
         }
     }
 
     void Game::Update() {
-        static auto lastTime = std::chrono::steady_clock::now();
+        TETRIS_PROFILE_ZONE("Game::Update");
         auto now = std::chrono::steady_clock::now();
-        std::chrono::duration<double> deltaTime = now - lastTime;
-        lastTime = now;
+        if (m_lastUpdate == std::chrono::steady_clock::time_point{}) m_lastUpdate = now;
+        accumulatedTime += std::chrono::duration<double>(now - m_lastUpdate).count();
+        m_lastUpdate = now;
+
+        // Fixed steps keep the simulation independent of the render rate, which replays rely on
+        accumulatedTime = std::min(accumulatedTime, MaxFrameBacklog * FRAME_SECONDS);
+        while (accumulatedTime >= FRAME_SECONDS) {
+            accumulatedTime -= FRAME_SECONDS;
+            StepFrame();
+        }
+    }
 
-        gravityClock.update();
+    void Game::_stepBoard(size_t player, int gravityRows) {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = m_timeBoards ? Clock::now() : Clock::time_point{};
+        Board& board = *m_boards[player];
+        _applyGravity(board, gravityRows);
+        board.UpdateLockDelay(FRAME_SECONDS);
+        if (m_timeBoards) m_boardStepNs[player] = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    void Game::StepFrame() {
+        TETRIS_PROFILE_ZONE("Game::StepFrame");
+        m_gravityRows = 0;
+        gravityClock.step(1.0);
+        const int rows = m_gravityRows;
+
+        // Phase 1: boards advance independently; attacks collect in their outboxes
+        m_steppingBoards = true;
+        try {
+            const size_t count = m_boards.size();
+            if (m_pool && m_pool->Size() > 1 && count >= std::max<size_t>(m_parallelMinBoards, 2)) {
+                const size_t grain = std::max<size_t>(1, count / (m_pool->Size() * 4));
+                m_pool->ParallelFor(count, grain, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) _stepBoard(i, rows);
+                });
+            } else {
+                for (size_t i = 0; i < count; ++i) _stepBoard(i, rows);
+            }
+        } catch (...) {
+            m_steppingBoards = false;
+            for (std::vector<int>& outbox : m_outboxes) outbox.clear();
+            throw;
+        }
+        m_steppingBoards = false;
+
+        // Phase 2: route in player order, the order a serial step would have sent them in
+        for (size_t sender = 0; sender < m_outboxes.size(); ++sender) {
+            for (int lines : m_outboxes[sender]) m_router.Route(sender, lines, m_frame);
+            m_outboxes[sender].clear();
+        }
+
+        ++m_frame;
+
+        // Knocked-out boards stop receiving garbage; KOS targeting needs everyone's stack height
+        const bool trackDanger = m_router.UsesDanger();
+        for (size_t i = 0; i < m_boards.size(); ++i) {
+            const Board& board = *m_boards[i];
+            if (board.IsGameOver() == m_router.IsAlive(i)) m_router.SetAlive(i, !board.IsGameOver());
+            if (trackDanger) m_router.SetDanger(i, StackHeight(board));
+        }
+        _deliverGarbage();
+
+        if (m_recorder) m_recorder->OnFrame();
+    }
+
+    bool Game::ApplyInput(size_t player, InputType input) {
+        Board& board = getBoard(player);
+        if (board.IsGameOver() && input != InputType::RESET) return false;
+        if (m_recorder) m_recorder->OnInput(player, input);
+
+        switch (input) {
+            case InputType::MOVE_LEFT:  board.MoveActivePiece(-1, 0); break;
+            case InputType::MOVE_RIGHT: board.MoveActivePiece(1, 0); break;
+            case InputType::SOFT_DROP:
+                if (!board.MoveActivePiece(0, -1)) {
+                    board.LockActivePiece();
+                    board.SpawnRandomPiece();
+                }
+                break;
+            case InputType::HARD_DROP:
+                board.HardDropActivePiece();
+                board.SpawnRandomPiece();
+                break;
+            case InputType::HOLD:       board.HoldPiece(); break;
+            case InputType::ROTATE_CW:  board.RotateActivePiece(RotationDirection::CLOCKWISE); break;
+            case InputType::ROTATE_CCW: board.RotateActivePiece(RotationDirection::COUNTER_CLOCKWISE); break;
+            case InputType::ROTATE_180: board.RotateActivePiece(RotationDirection::ONE_EIGHTY); break;
+            case InputType::RESET:      board.Reset(); break;
+        }
+        return !board.IsGameOver();
+    }
+
+    void Game::AddGarbage(size_t player, int lines) {
+        Board& board = getBoard(player);
+        if (lines < 1) return;
+        if (m_recorder) m_recorder->OnGarbage(player, lines);
+        board.AddGarbageToQueue(lines);
+    }
+
+    void Game::SaveState(ByteWriter& out) const {
+        out.PutVarint(m_frame);
+        out.PutVarint(m_boards.size());
+        for (const std::unique_ptr<Board>& board : m_boards) {
+            board->SaveState(out);
+        }
+        m_router.SaveState(out);
+        gravityClock.saveState(out);
+    }
+
+    void Game::LoadState(ByteReader& in) {
+        uint64_t frame = in.GetVarint();
+        if (in.GetVarint() != m_boards.size()) throw std::runtime_error("Saved game has a different number of players");
         for (std::unique_ptr<Board>& board : m_boards) {
-            board->UpdateLockDelay(deltaTime.count());
+            board->LoadState(in);
         }
+        m_router.LoadState(in);
+        gravityClock.loadState(in);
+        m_frame = frame;
+
+        // Wall-clock time before the restore must not be simulated by the next Update()
+        accumulatedTime = 0.0;
+        m_lastUpdate = {};
     }
 
-} // namespace tetris
\ No newline at end of file
+} // namespace tetris
@@ -0,0 +1,139 @@
+#include "TetrisEngine/GameEvents.h"
+#include "TetrisEngine/Board.h"
+#include <cstdio>
+
+namespace tetris {
+    namespace {
+        char PieceLetter(PieceType piece) {
+            constexpr char LETTERS[] = " IJLOSTZG";
+            const size_t index = static_cast<size_t>(piece);
+            return index < sizeof(LETTERS) - 1 ? LETTERS[index] : '?';
+        }
+
+        const char* RotationName(uint8_t rotation) {
+            constexpr const char* NAMES[] = {"0", "R", "2", "L"};
+            return NAMES[rotation & 3];
+        }
+
+        const char* SpinName(SpinType spin) {
+            switch (spin) {
+                case SpinType::MINI:        return "mini-spin ";
+                case SpinType::T_SPIN_MINI: return "T-spin mini ";
+                case SpinType::T_SPIN:      return "T-spin ";
+                default:                    return "";
+            }
+        }
+
+        const char* ClearName(int lines) {
+            constexpr const char* NAMES[] = {"zero", "single", "double", "triple", "quad"};
+            return lines >= 0 && lines <= 4 ? NAMES[lines] : "clear";
+        }
+    }
+
+    void BoardHud::Apply(const GameEvent& event) noexcept {
+        switch (event.type) {
+            case GameEventType::RESET:
+                *this = BoardHud{};
+                break;
+            case GameEventType::SPAWN:
+                for (size_t i = 0; i < EVENT_NEXT_PIECES; ++i) next[i] = event.NextPiece(i);
+                break;
+            case GameEventType::HOLD:
+                held = event.piece;
+                canHold = false;
+                break;
+            case GameEventType::LOCK:
+                canHold = true;
+                pending = event.pending;
+                if (event.lines == 0) combo = 0;    // a lock without a clear breaks the combo and emits no CLEAR
+                break;
+            case GameEventType::CLEAR:
+                lines += event.lines;
+                combo = event.combo;
+                b2b = event.b2b;
+                break;
+            case GameEventType::GARBAGE_SENT:
+            case GameEventType::GARBAGE_CANCELLED:
+                attack += event.lines;
+                pending = event.pending;
+                break;
+            case GameEventType::GARBAGE_RECEIVED:
+                pending = event.pending;
+                break;
+            case GameEventType::GAME_OVER:
+                for (size_t i = 0; i < EVENT_NEXT_PIECES; ++i) next[i] = event.NextPiece(i);
+                gameOver = true;
+                break;
+            case GameEventType::MOVE:
+            case GameEventType::ROTATE:
+                break;
+        }
+    }
+
+    void BoardHud::Sync(const Board& board) {
+        held = board.GetHeldPieceType();
+        canHold = board.CanHold();
+        const std::vector<PieceType> queue = board.GetNextQueue();
+        for (size_t i = 0; i < EVENT_NEXT_PIECES; ++i) next[i] = i < queue.size() ? queue[i] : PieceType::EMPTY;
+        pending = board.GetGarbageQueue();
+        combo = board.GetCombo();
+        b2b = board.GetB2BChain();
+        lines = board.GetLinesCleared();
+        attack = board.GetAttackTotal();
+        gameOver = board.IsGameOver();
+    }
+
+    bool BoardEventReader::Update(const GameEventRing& ring, const Board& fallback) {
+        const uint64_t before = m_cursor;
+        const uint64_t lost = ring.Drain(m_cursor, [this](const GameEvent& event) {
+            m_hud.Apply(event);
+
+            // Falls are left out of the log so gravity does not flush everything else from it
+            if (event.type == GameEventType::MOVE && event.dy < 0) return;
+            if (m_recentCount < RECENT) {
+                m_recent[(m_recentStart + m_recentCount++) % RECENT] = event;
+            } else {
+                m_recent[m_recentStart] = event;
+                m_recentStart = (m_recentStart + 1) % RECENT;
+            }
+        });
+
+        if (lost > 0) {
+            m_lost += lost;
+            m_hud.Sync(fallback);
+        }
+        return m_cursor != before;
+    }
+
+    int FormatGameEvent(const GameEvent& event, char* out, size_t size) {
+        const char piece = PieceLetter(event.piece);
+        switch (event.type) {
+            case GameEventType::RESET:
+                return std::snprintf(out, size, "Reset");
+            case GameEventType::SPAWN:
+                return std::snprintf(out, size, "Spawn %c", piece);
+            case GameEventType::MOVE:
+                if (event.dx < 0) return std::snprintf(out, size, "Move left");
+                if (event.dx > 0) return std::snprintf(out, size, "Move right");
+                return std::snprintf(out, size, "Drop %d", -event.dy);
+            case GameEventType::ROTATE:
+                return std::snprintf(out, size, "Rotate %c to %s", piece, RotationName(event.rotation));
+            case GameEventType::HOLD:
+                return std::snprintf(out, size, "Hold %c", piece);
+            case GameEventType::LOCK:
+                return std::snprintf(out, size, "Lock %c at (%d, %d)", piece, event.x, event.y);
+            case GameEventType::CLEAR:
+                return std::snprintf(out, size, "Clear %s%s (combo %d, B2B %d)",
+                                     SpinName(event.spin), ClearName(event.lines), event.combo, event.b2b);
+            case GameEventType::GARBAGE_SENT:
+                return std::snprintf(out, size, "Sent %d lines", event.lines);
+            case GameEventType::GARBAGE_RECEIVED:
+                return std::snprintf(out, size, "Received %d lines (%d pending)", event.lines, event.pending);
+            case GameEventType::GARBAGE_CANCELLED:
+                return std::snprintf(out, size, "Cancelled %d lines (%d pending)", event.lines, event.pending);
+            case GameEventType::GAME_OVER:
+                return std::snprintf(out, size, "Game over");
+        }
+        return std::snprintf(out, size, "Unknown event");
+    }
+}
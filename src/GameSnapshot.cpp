@@ -0,0 +1,106 @@
+#include "TetrisEngine/GameSnapshot.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace tetris {
+    namespace {
+        // Game::SaveState into a scratch buffer, reused per thread so checkpointing many games does not allocate
+        const ByteWriter& EncodePayload(const Game& game) {
+            thread_local ByteWriter payload;
+            payload.Clear();
+            game.SaveState(payload);
+            return payload;
+        }
+
+        // Consumes one snapshot from the reader and returns a reader over its verified payload
+        ByteReader ReadPayload(ByteReader& in, SnapshotInfo& info) {
+            info = PeekSnapshot(in);
+            in.Skip(SNAPSHOT_HEADER_SIZE);
+            if (in.Remaining() < info.payloadSize) throw std::runtime_error("Snapshot is truncated");
+
+            const uint8_t* payload = in.Current();
+            in.Skip(info.payloadSize);
+            if (HashBytes(payload, info.payloadSize) != info.checksum) throw std::runtime_error("Snapshot checksum mismatch");
+            return ByteReader(payload, info.payloadSize);
+        }
+    }
+
+    void SaveSnapshot(const Game& game, ByteWriter& out) {
+        const ByteWriter& payload = EncodePayload(game);
+        out.PutBytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        out.PutU16(SNAPSHOT_FORMAT_VERSION);
+        out.PutU16(static_cast<uint16_t>(game.playerCount()));
+        out.PutU32(GAME_RULES_VERSION);
+        out.PutU32(game.getRNG());
+        out.PutU64(game.GetFrame());
+        out.PutU32(static_cast<uint32_t>(payload.Size()));
+        out.PutU64(HashBytes(payload.Data(), payload.Size()));
+        out.PutBytes(payload.Data(), payload.Size());
+    }
+
+    std::vector<uint8_t> SaveSnapshot(const Game& game) {
+        ByteWriter out;
+        SaveSnapshot(game, out);
+        return out.GetBuffer();
+    }
+
+    SnapshotInfo PeekSnapshot(const ByteReader& reader) {
+        ByteReader in = reader;
+        char magic[sizeof(SNAPSHOT_MAGIC)];
+        in.GetBytes(magic, sizeof(magic));
+        if (std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0) throw std::runtime_error("Not a game snapshot");
+
+        SnapshotInfo info;
+        info.version = in.GetU16();
+        if (info.version != SNAPSHOT_FORMAT_VERSION) throw std::runtime_error("Unsupported snapshot format version");
+        info.playerCount = in.GetU16();
+        info.rulesVersion = in.GetU32();
+        if (info.rulesVersion != GAME_RULES_VERSION) throw std::runtime_error("Snapshot was saved under different game rules");
+        info.seed = in.GetU32();
+        info.frame = in.GetU64();
+        info.payloadSize = in.GetU32();
+        info.checksum = in.GetU64();
+        return info;
+    }
+
+    void RestoreSnapshot(Game& game, ByteReader& in) {
+        SnapshotInfo info;
+        ByteReader payload = ReadPayload(in, info);
+        if (info.playerCount != game.playerCount()) throw std::runtime_error("Snapshot has a different number of players");
+
+        game.LoadState(payload);
+        if (!payload.AtEnd() || game.GetFrame() != info.frame) throw std::runtime_error("Snapshot payload does not match its header");
+    }
+
+    std::unique_ptr<Game> LoadSnapshot(ByteReader& in) {
+        SnapshotInfo info = PeekSnapshot(in);
+        auto game = std::make_unique<Game>(info.playerCount, info.seed);
+        RestoreSnapshot(*game, in);
+        return game;
+    }
+
+    void SaveSnapshotFile(const std::filesystem::path& path, const std::vector<const Game*>& games) {
+        ByteWriter out;
+        for (const Game* game : games) {
+            SaveSnapshot(*game, out);
+        }
+
+        WriteFileAtomically(path, out);
+    }
+
+    std::vector<std::unique_ptr<Game>> LoadSnapshotFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) throw std::runtime_error("Cannot open snapshot file " + path.string());
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        std::vector<std::unique_ptr<Game>> games;
+        ByteReader in(bytes.data(), bytes.size());
+        while (!in.AtEnd()) {
+            games.push_back(LoadSnapshot(in));
+        }
+        return games;
+    }
+
+} // namespace tetris
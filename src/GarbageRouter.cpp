@@ -0,0 +1,314 @@
+#include "TetrisEngine/GarbageRouter.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+namespace tetris {
+    namespace {
+        // NO_TARGET saves as 0, player p as p + 1
+        void PutPlayer(ByteWriter& out, size_t player) {
+            out.PutVarint(player == NO_TARGET ? 0 : player + 1);
+        }
+
+        size_t GetPlayer(ByteReader& in, size_t playerCount) {
+            uint64_t value = in.GetVarint();
+            if (value > playerCount) throw std::runtime_error("Corrupt garbage router state");
+            return value == 0 ? NO_TARGET : static_cast<size_t>(value - 1);
+        }
+    }
+
+    GarbageRouter::GarbageRouter(uint32_t seed, uint32_t delayFrames) : m_rng(seed), m_delayFrames(delayFrames) {}
+
+    size_t GarbageRouter::AddPlayer() {
+        size_t player = m_players.size();
+        m_players.emplace_back();
+        m_players.back().alivePosition = static_cast<uint32_t>(m_alive.size());
+        m_alive.push_back(static_cast<uint32_t>(player));
+        return player;
+    }
+
+    void GarbageRouter::SetStrategy(size_t player, TargetingStrategy strategy) {
+        Player& p = m_players.at(player);
+        m_knockoutPlayers -= (p.strategy == TargetingStrategy::KOS);
+        p.strategy = strategy;
+        m_knockoutPlayers += (p.strategy == TargetingStrategy::KOS);
+    }
+
+    void GarbageRouter::SetManualTarget(size_t player, size_t target) {
+        if (target != NO_TARGET && target >= m_players.size()) throw std::out_of_range("Invalid target player");
+        m_players.at(player).manualTarget = target;
+    }
+
+    void GarbageRouter::SetDanger(size_t player, int danger) {
+        m_players.at(player).danger = danger;
+    }
+
+    void GarbageRouter::SetAlive(size_t player, bool alive) {
+        Player& p = m_players.at(player);
+        if (alive == (p.alivePosition != NOT_ALIVE)) return;
+
+        // Either way the set of KOS candidates changed
+        m_knockoutFrame = std::numeric_limits<uint64_t>::max();
+
+        if (alive) {
+            p.alivePosition = static_cast<uint32_t>(m_alive.size());
+            m_alive.push_back(static_cast<uint32_t>(player));
+            return;
+        }
+
+        // Swap-remove from the alive list
+        uint32_t moved = m_alive.back();
+        m_alive[p.alivePosition] = moved;
+        m_players[moved].alivePosition = p.alivePosition;
+        m_alive.pop_back();
+        p.alivePosition = NOT_ALIVE;
+
+        // Knocked out: stop attacking, stop being attacked, drop what was on its way
+        _setTarget(player, NO_TARGET);
+        for (uint32_t attacker : p.attackers) {
+            m_players[attacker].target = NO_TARGET;
+        }
+        p.attackers.clear();
+        _clearPending(player);
+    }
+
+    size_t GarbageRouter::Route(size_t sender, int lines, uint64_t frame) {
+        if (lines <= 0) return NO_TARGET;
+        Player& s = m_players.at(sender);
+
+        // Cancel the oldest incoming garbage first
+        while (lines > 0 && !s.pending.empty()) {
+            GarbagePacket& packet = s.pending.front();
+            int cancelled = std::min(lines, packet.lines);
+            packet.lines -= cancelled;
+            s.incoming -= cancelled;
+            lines -= cancelled;
+            if (packet.lines == 0) {
+                s.pending.pop_front();
+                --m_inFlightPackets;
+            }
+        }
+        if (lines == 0) return NO_TARGET;
+
+        size_t target = _pickTarget(sender, frame);
+        if (target == NO_TARGET) return NO_TARGET;
+
+        _setTarget(sender, target);
+        Player& t = m_players[target];
+        t.pending.push_back({static_cast<uint32_t>(sender), lines, frame + m_delayFrames, frame});
+        t.incoming += lines;
+        ++m_inFlightPackets;
+        return target;
+    }
+
+    size_t GarbageRouter::_pickTarget(size_t sender, uint64_t frame) {
+        Player& s = m_players[sender];
+        switch (s.strategy) {
+            case TargetingStrategy::EVEN:
+                return _pickEven(sender);
+            case TargetingStrategy::RANDOM:
+                return _pickRandom(sender);
+            case TargetingStrategy::ATTACKERS:
+                if (s.attackers.empty()) return _pickRandom(sender);
+                return s.attackers[s.cursor++ % s.attackers.size()];
+            case TargetingStrategy::KOS:
+                return _pickKnockout(sender, frame);
+            case TargetingStrategy::MANUAL:
+                if (s.manualTarget != NO_TARGET && s.manualTarget != sender && IsAlive(s.manualTarget)) return s.manualTarget;
+                return _pickEven(sender);
+        }
+        return NO_TARGET;
+    }
+
+    size_t GarbageRouter::_pickEven(size_t sender) {
+        size_t opponents = m_alive.size() - IsAlive(sender);
+        if (opponents == 0) return NO_TARGET;
+
+        // The sender occupies at most one slot, so this takes at most two steps
+        Player& s = m_players[sender];
+        for (;;) {
+            size_t candidate = m_alive[s.cursor++ % m_alive.size()];
+            if (candidate != sender) return candidate;
+        }
+    }
+
+    size_t GarbageRouter::_pickRandom(size_t sender) {
+        bool senderAlive = IsAlive(sender);
+        size_t opponents = m_alive.size() - senderAlive;
+        if (opponents == 0) return NO_TARGET;
+
+        // Draw from every living slot but the last; the sender's slot stands in for it
+        size_t slot = std::uniform_int_distribution<size_t>(0, opponents - 1)(m_rng);
+        if (senderAlive && m_alive[slot] == sender) slot = m_alive.size() - 1;
+        return m_alive[slot];
+    }
+
+    size_t GarbageRouter::_pickKnockout(size_t sender, uint64_t frame) {
+        if (frame != m_knockoutFrame) {
+            m_knockoutFrame = frame;
+            m_mostInDanger = NO_TARGET;
+            m_secondMostInDanger = NO_TARGET;
+            int best = 0;
+            int second = 0;
+            for (uint32_t player : m_alive) {
+                int danger = m_players[player].danger + m_players[player].incoming;
+                bool beatsBest = m_mostInDanger == NO_TARGET || danger > best || (danger == best && player < m_mostInDanger);
+                if (beatsBest) {
+                    m_secondMostInDanger = m_mostInDanger;
+                    second = best;
+                    m_mostInDanger = player;
+                    best = danger;
+                } else if (m_secondMostInDanger == NO_TARGET || danger > second || (danger == second && player < m_secondMostInDanger)) {
+                    m_secondMostInDanger = player;
+                    second = danger;
+                }
+            }
+        }
+        return m_mostInDanger != sender ? m_mostInDanger : m_secondMostInDanger;
+    }
+
+    void GarbageRouter::_setTarget(size_t player, size_t target) {
+        Player& p = m_players[player];
+        if (p.target == target) return;
+
+        if (p.target != NO_TARGET) {
+            std::vector<uint32_t>& old = m_players[p.target].attackers;
+            uint32_t moved = old.back();
+            old[p.attackerPosition] = moved;
+            m_players[moved].attackerPosition = p.attackerPosition;
+            old.pop_back();
+        }
+
+        p.target = target;
+        if (target != NO_TARGET) {
+            std::vector<uint32_t>& attackers = m_players[target].attackers;
+            p.attackerPosition = static_cast<uint32_t>(attackers.size());
+            attackers.push_back(static_cast<uint32_t>(player));
+        }
+    }
+
+    void GarbageRouter::_clearPending(size_t player) {
+        Player& p = m_players[player];
+        m_inFlightPackets -= p.pending.size();
+        p.pending.clear();
+        p.incoming = 0;
+    }
+
+    void GarbageRouter::Reset() {
+        m_alive.clear();
+        for (size_t player = 0; player < m_players.size(); ++player) {
+            Player& p = m_players[player];
+            _clearPending(player);
+            p.target = NO_TARGET;
+            p.attackers.clear();
+            p.cursor = 0;
+            p.danger = 0;
+            p.alivePosition = static_cast<uint32_t>(m_alive.size());
+            m_alive.push_back(static_cast<uint32_t>(player));
+        }
+        m_knockoutFrame = std::numeric_limits<uint64_t>::max();
+    }
+
+    void GarbageRouter::Reset(uint32_t seed) {
+        m_rng.Restore(seed, 0);
+        for (Player& p : m_players) p.manualTarget = NO_TARGET;
+        Reset();
+    }
+
+    void GarbageRouter::SaveState(ByteWriter& out) const {
+        out.PutVarint(m_delayFrames);
+        out.PutVarint(m_rng.GetSeed());
+        out.PutVarint(m_rng.GetDraws());
+        out.PutVarint(m_players.size());
+        for (const Player& p : m_players) {
+            out.PutU8(static_cast<uint8_t>(p.strategy));
+            PutPlayer(out, p.manualTarget);
+            out.PutVarint(p.cursor);
+            out.PutSigned(p.danger);
+            out.PutVarint(p.pending.size());
+            for (const GarbagePacket& packet : p.pending) {
+                out.PutVarint(packet.sender);
+                out.PutSigned(packet.lines);
+                out.PutVarint(packet.deliverFrame);
+            }
+            // Attack lists in order, since round-robin and swap-removal depend on it
+            out.PutVarint(p.attackers.size());
+            for (uint32_t attacker : p.attackers) out.PutVarint(attacker);
+        }
+        out.PutVarint(m_alive.size());
+        for (uint32_t player : m_alive) out.PutVarint(player);
+
+        out.PutVarint(m_knockoutFrame + 1);  // "never" wraps to 0
+        PutPlayer(out, m_mostInDanger);
+        PutPlayer(out, m_secondMostInDanger);
+    }
+
+    void GarbageRouter::LoadState(ByteReader& in) {
+        auto fail = [] { throw std::runtime_error("Corrupt garbage router state"); };
+
+        m_delayFrames = static_cast<uint32_t>(in.GetVarint());
+        auto seed = static_cast<SeekableRng::result_type>(in.GetVarint());
+        m_rng.Restore(seed, in.GetVarint());
+        if (in.GetVarint() != m_players.size()) throw std::runtime_error("Saved garbage router has a different number of players");
+
+        const size_t count = m_players.size();
+        m_inFlightPackets = 0;
+        m_knockoutPlayers = 0;
+        for (Player& p : m_players) {
+            uint8_t strategy = in.GetU8();
+            if (strategy > static_cast<uint8_t>(TargetingStrategy::MANUAL)) fail();
+            p.strategy = static_cast<TargetingStrategy>(strategy);
+            m_knockoutPlayers += (p.strategy == TargetingStrategy::KOS);
+            p.manualTarget = GetPlayer(in, count);
+            p.cursor = in.GetVarint();
+            p.danger = static_cast<int>(in.GetSigned());
+
+            p.pending.clear();
+            p.incoming = 0;
+            for (uint64_t n = in.GetVarint(); n > 0; --n) {
+                GarbagePacket packet;
+                packet.sender = static_cast<uint32_t>(in.GetVarint());
+                packet.lines = static_cast<int>(in.GetSigned());
+                packet.deliverFrame = in.GetVarint();
+                packet.sentFrame = packet.deliverFrame - std::min<uint64_t>(packet.deliverFrame, m_delayFrames);
+                if (packet.sender >= count || packet.lines <= 0) fail();
+                p.pending.push_back(packet);
+                p.incoming += packet.lines;
+                ++m_inFlightPackets;
+            }
+
+            p.attackers.clear();
+            for (uint64_t n = in.GetVarint(); n > 0; --n) {
+                uint64_t attacker = in.GetVarint();
+                if (attacker >= count) fail();
+                p.attackers.push_back(static_cast<uint32_t>(attacker));
+            }
+            p.target = NO_TARGET;
+            p.alivePosition = NOT_ALIVE;
+        }
+
+        // Targets follow from the attacker lists
+        for (size_t target = 0; target < count; ++target) {
+            const std::vector<uint32_t>& attackers = m_players[target].attackers;
+            for (size_t i = 0; i < attackers.size(); ++i) {
+                Player& attacker = m_players[attackers[i]];
+                if (attacker.target != NO_TARGET) fail();
+                attacker.target = target;
+                attacker.attackerPosition = static_cast<uint32_t>(i);
+            }
+        }
+
+        m_alive.clear();
+        for (uint64_t n = in.GetVarint(); n > 0; --n) {
+            uint64_t player = in.GetVarint();
+            if (player >= count || m_players[player].alivePosition != NOT_ALIVE) fail();
+            m_players[player].alivePosition = static_cast<uint32_t>(m_alive.size());
+            m_alive.push_back(static_cast<uint32_t>(player));
+        }
+
+        m_knockoutFrame = in.GetVarint() - 1;
+        m_mostInDanger = GetPlayer(in, count);
+        m_secondMostInDanger = GetPlayer(in, count);
+    }
+
+} // namespace tetris
@@ -0,0 +1,143 @@
+#include "TetrisEngine/InputHandler.h"
+#include "TetrisEngine/Piece.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace tetris {
+    namespace {
+        bool IsSetting(double value) { return std::isfinite(value) && value >= 0.0; }
+
+        // Next time on a grid of period after due that is later than time
+        double SkipPast(double due, double period, double time) {
+            return due + period * (std::floor((time - due) / period) + 1.0);
+        }
+
+        // Seconds per row of held soft drop: SDF times the current gravity
+        double SoftDropInterval(const Game& game, double sdf) {
+            const double rowsPerSecond = game.getGravityClock().getCurrentGravity() * sdf * Game::FRAMES_PER_SECOND;
+            return rowsPerSecond > 0.0 ? 1.0 / rowsPerSecond : InputHandler::NEVER;
+        }
+    }
+
+    InputHandler::InputHandler(size_t player, const HandlingSettings& settings)
+        : m_player(player), m_settings(settings), m_das(settings.dasMs / 1000.0), m_arr(settings.arrMs / 1000.0) {
+        if (!IsSetting(settings.dasMs) || !IsSetting(settings.arrMs) || !IsSetting(settings.sdf)) {
+            throw std::invalid_argument("DAS, ARR and SDF must be finite and non-negative");
+        }
+    }
+
+    bool InputHandler::_step(Game& game, int dx, int dy) {
+        const Board& board = game.getBoard(m_player);
+        const Piece* piece = board.GetCurrentPiece();
+        if (!piece || board.IsGameOver()) return false;
+
+        // Only moves that succeed reach the game, so a piece held against a wall records nothing
+        if (!board.IsValidPosition(piece->GetCurrentRepresentation(), board.GetCurrentPiecePosition() + Point{dx, dy})) return false;
+        game.ApplyInput(m_player, dx < 0 ? InputType::MOVE_LEFT : dx > 0 ? InputType::MOVE_RIGHT : InputType::SOFT_DROP);
+        ++m_inputsSent;
+        return true;
+    }
+
+    void InputHandler::_shiftToWall(Game& game) {
+        while (_step(game, m_direction, 0)) {}
+    }
+
+    void InputHandler::_dropToFloor(Game& game) {
+        while (_step(game, 0, -1)) {}
+    }
+
+    void InputHandler::_restartShift(double time) {
+        m_charged = false;
+        m_nextShift = m_direction != 0 ? time + m_das : NEVER;
+    }
+
+    void InputHandler::OnKey(Game& game, InputType input, bool pressed, double time) {
+        Advance(game, time);
+        time = m_time;
+
+        switch (input) {
+            case InputType::MOVE_LEFT:
+            case InputType::MOVE_RIGHT: {
+                const int direction = input == InputType::MOVE_LEFT ? -1 : 1;
+                (direction < 0 ? m_leftHeld : m_rightHeld) = pressed;
+                if (pressed) {
+                    m_direction = direction;
+                    _step(game, direction, 0);
+                    _restartShift(time);
+                } else if (m_direction == direction) {
+                    m_direction = m_leftHeld ? -1 : m_rightHeld ? 1 : 0;
+                    _restartShift(time);
+                }
+                break;
+            }
+            case InputType::SOFT_DROP:
+                m_softDropHeld = pressed;
+                m_nextDrop = NEVER;
+                if (!pressed) break;
+                if (m_settings.sdf == 0.0) {
+                    _dropToFloor(game);
+                } else {
+                    _step(game, 0, -1);
+                    m_nextDrop = time + SoftDropInterval(game, m_settings.sdf);
+                }
+                break;
+            default:
+                if (!pressed) break;
+                game.ApplyInput(m_player, input);
+                ++m_inputsSent;
+                break;
+        }
+
+        // Repeats due right now (DAS 0) and instant handling for whatever piece is now active
+        Advance(game, time);
+    }
+
+    void InputHandler::Advance(Game& game, double time) {
+        time = std::max(time, m_time);
+
+        // Shifts and drops interleave in the order they fall due
+        for (;;) {
+            const bool shiftFirst = m_nextShift <= m_nextDrop;
+            const double due = shiftFirst ? m_nextShift : m_nextDrop;
+            if (due > time) break;
+            m_time = due;
+
+            if (shiftFirst) {
+                m_charged = true;
+                if (m_arr == 0.0) {
+                    m_nextShift = NEVER;   // kept against the wall below from now on
+                } else if (_step(game, m_direction, 0)) {
+                    m_nextShift += m_arr;
+                } else {
+                    m_nextShift = SkipPast(m_nextShift, m_arr, time);
+                }
+            } else {
+                if (m_settings.sdf == 0.0) {
+                    m_nextDrop = NEVER;
+                    continue;
+                }
+                const double interval = SoftDropInterval(game, m_settings.sdf);
+                if (interval == NEVER) m_nextDrop = NEVER;
+                else if (_step(game, 0, -1)) m_nextDrop += interval;
+                else m_nextDrop = SkipPast(m_nextDrop, interval, time);
+            }
+        }
+        m_time = time;
+
+        // Instant handling holds every new piece against the wall or the floor as well
+        if (m_charged && m_arr == 0.0 && m_direction != 0) _shiftToWall(game);
+        if (m_softDropHeld && m_settings.sdf == 0.0) _dropToFloor(game);
+    }
+
+    double InputHandler::NextDeadline() const noexcept {
+        return std::min(m_nextShift, m_nextDrop);
+    }
+
+    void InputHandler::ReleaseAll() noexcept {
+        m_leftHeld = m_rightHeld = m_softDropHeld = false;
+        m_direction = 0;
+        m_charged = false;
+        m_nextShift = m_nextDrop = NEVER;
+    }
+}
@@ -0,0 +1,113 @@
+#include "TetrisEngine/MappedFile.h"
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace tetris {
+    MappedFile::MappedFile(const std::filesystem::path& path) : m_path(path) {
+#ifdef _WIN32
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Could not open " + path.string());
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("Could not stat " + path.string());
+        }
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+
+        // Empty files cannot be mapped on Windows; leave data as nullptr
+        if (m_size == 0) {
+            CloseHandle(file);
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) {
+            throw std::runtime_error("Could not map " + path.string());
+        }
+
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping); // the view keeps the mapping alive
+        if (!m_data) {
+            throw std::runtime_error("Could not map view of " + path.string());
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open " + path.string());
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not stat " + path.string());
+        }
+        m_size = static_cast<size_t>(st.st_size);
+
+        if (m_size == 0) {
+            ::close(fd);
+            return;
+        }
+
+        void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // the mapping keeps the file alive
+        if (addr == MAP_FAILED) {
+            throw std::runtime_error("Could not map " + path.string());
+        }
+        m_data = static_cast<const uint8_t*>(addr);
+#endif
+    }
+
+    MappedFile::~MappedFile() {
+        _release();
+    }
+
+    void MappedFile::AdviseRandomAccess() const noexcept {
+#ifndef _WIN32
+        if (m_data) ::madvise(const_cast<uint8_t*>(m_data), m_size, MADV_RANDOM);
+#endif
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_path(std::move(other.m_path)),
+          m_data(std::exchange(other.m_data, nullptr)),
+          m_size(std::exchange(other.m_size, 0))
+    {}
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            _release();
+            m_path = std::move(other.m_path);
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+
+    void MappedFile::_release() noexcept {
+        if (!m_data) return;
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+#else
+        ::munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
@@ -0,0 +1,336 @@
+#include "TetrisEngine/Metrics.h"
+#include "TetrisEngine/ByteStream.h"
+#include "TetrisEngine/Profiler.h"
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+namespace tetris::metrics {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        struct Description {
+            const char* name;
+            const char* help;
+        };
+
+        constexpr Description LATENCIES[LATENCY_COUNT] = {
+            {"input_to_display", "Key change to the submission of the first frame drawn with it applied"},
+            {"bot_decision", "Time a bot took to score every action of a position"},
+            {"inference", "Time of one neural network batch"},
+            {"garbage_delay", "Game time from an attack being sent to its lines rising into the target's stack"},
+        };
+
+        constexpr Description COUNTERS[COUNTER_COUNT] = {
+            {"games", "Bot matches finished"},
+            {"pieces", "Pieces locked on any board"},
+            {"positions", "Positions evaluated by bots and the network"},
+        };
+
+        constexpr double PERCENTILES[] = {50.0, 90.0, 99.0, 99.9};
+
+        // One thread's metrics. Only that thread writes, so a bump is a plain load and
+        // store; the atomics are there for Collect, which reads from another thread.
+        struct ThreadBlock {
+            std::array<std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKET_COUNT>, LATENCY_COUNT> buckets{};
+            std::array<std::atomic<uint64_t>, LATENCY_COUNT> sums{};
+            std::array<std::atomic<uint64_t>, LATENCY_COUNT> maxes{};
+            std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters{};
+        };
+
+        struct Registry {
+            Clock::time_point start = Clock::now();
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ThreadBlock>> blocks;
+            std::vector<ThreadBlock*> retired;   ///< Blocks of exited threads, waiting for a new owner
+        };
+
+        // Never destroyed: threads may still record while statics are torn down at exit
+        Registry& GetRegistry() {
+            static Registry* registry = new Registry;
+            return *registry;
+        }
+
+        // Blocks outlive their threads, so the totals keep what exited threads recorded. An exited
+        // thread's block (about 76 KB) is retired and the next new thread adds on top of it, which
+        // leaves the sums unchanged and keeps memory to the most threads alive at once.
+        struct BlockLease {
+            ThreadBlock* block = nullptr;
+
+            ~BlockLease() {
+                if (!block) return;
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.retired.push_back(block);
+            }
+        };
+
+        ThreadBlock* AcquireBlock() {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            if (!registry.retired.empty()) {
+                ThreadBlock* reused = registry.retired.back();
+                registry.retired.pop_back();
+                return reused;
+            }
+            // Room for every block to retire, so ~BlockLease never allocates
+            registry.retired.reserve(registry.blocks.size() + 1);
+            auto block = std::make_unique<ThreadBlock>();
+            registry.blocks.push_back(std::move(block));
+            return registry.blocks.back().get();
+        }
+
+        ThreadBlock& CurrentBlock() noexcept {
+            thread_local BlockLease lease;
+            if (!lease.block) {
+                try {
+                    lease.block = AcquireBlock();
+                } catch (const std::exception&) {
+                    // Out of memory: drop this sample into a block Collect never reads rather than
+                    // terminate through the noexcept callers, and try for a real block next time
+                    static ThreadBlock sink;
+                    return sink;
+                }
+            }
+            return *lease.block;
+        }
+
+        void Bump(std::atomic<uint64_t>& slot, uint64_t amount) noexcept {
+            slot.store(slot.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        // Nine significant digits with a '.' decimal point, whatever locale the stream has
+        std::string FormatNumber(double value) {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.9g", value);
+            return text;
+        }
+
+        void WriteFile(const std::string& path, void (*write)(std::ostream&, const MetricsSnapshot&),
+                       const MetricsSnapshot& snapshot) {
+            WriteFileAtomically(path, [&](std::ostream& out) { write(out, snapshot); });
+        }
+    }
+
+    const char* GetName(Latency latency) noexcept {
+        return LATENCIES[static_cast<size_t>(latency)].name;
+    }
+
+    const char* GetName(Counter counter) noexcept {
+        return COUNTERS[static_cast<size_t>(counter)].name;
+    }
+
+    size_t LatencyHistogram::BucketFor(uint64_t value) noexcept {
+        if (value < EXACT_LIMIT) return static_cast<size_t>(value);
+        if (value >> MAX_VALUE_BITS) return BUCKET_COUNT - 1;
+
+        // The top seven bits pick the bucket: 64 of them per power of two
+        const int shift = std::bit_width(value) - 7;
+        return static_cast<size_t>(EXACT_LIMIT + (shift - 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS));
+    }
+
+    uint64_t LatencyHistogram::BucketLow(size_t bucket) noexcept {
+        if (bucket < EXACT_LIMIT) return bucket;
+        const uint64_t shift = (bucket - EXACT_LIMIT) / SUB_BUCKETS + 1;
+        return ((bucket - EXACT_LIMIT) % SUB_BUCKETS + SUB_BUCKETS) << shift;
+    }
+
+    uint64_t LatencyHistogram::BucketHigh(size_t bucket) noexcept {
+        if (bucket < EXACT_LIMIT) return bucket;
+        const uint64_t shift = (bucket - EXACT_LIMIT) / SUB_BUCKETS + 1;
+        return BucketLow(bucket) + (uint64_t{1} << shift) - 1;
+    }
+
+    void LatencyHistogram::Record(uint64_t value, uint64_t count) noexcept {
+        AddBucket(BucketFor(value), count);
+        AddTotals(value * count, value);
+    }
+
+    void LatencyHistogram::Merge(const LatencyHistogram& other) noexcept {
+        for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) m_counts[bucket] += other.m_counts[bucket];
+        m_total += other.m_total;
+        AddTotals(other.m_sum, other.m_max);
+    }
+
+    uint64_t LatencyHistogram::GetPercentile(double percentile) const noexcept {
+        if (m_total == 0) return 0;
+        const double clamped = std::clamp(percentile, 0.0, 100.0);
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * m_total)));
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+            seen += m_counts[bucket];
+            if (seen >= rank) return std::min(BucketHigh(bucket), m_max);
+        }
+        return m_max;
+    }
+
+    void RecordLatency(Latency latency, uint64_t nanoseconds) noexcept {
+        ThreadBlock& block = CurrentBlock();
+        const size_t index = static_cast<size_t>(latency);
+        Bump(block.buckets[index][LatencyHistogram::BucketFor(nanoseconds)], 1);
+        Bump(block.sums[index], nanoseconds);
+        if (nanoseconds > block.maxes[index].load(std::memory_order_relaxed)) {
+            block.maxes[index].store(nanoseconds, std::memory_order_relaxed);
+        }
+    }
+
+    void Increment(Counter counter, uint64_t amount) noexcept {
+        Bump(CurrentBlock().counters[static_cast<size_t>(counter)], amount);
+    }
+
+    MetricsSnapshot Collect(const MetricsSnapshot* previous) {
+        MetricsSnapshot snapshot;
+        Registry& registry = GetRegistry();
+        {
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (const std::unique_ptr<ThreadBlock>& block : registry.blocks) {
+                for (size_t latency = 0; latency < LATENCY_COUNT; ++latency) {
+                    LatencyHistogram& histogram = snapshot.latencies[latency];
+                    for (size_t bucket = 0; bucket < LatencyHistogram::BUCKET_COUNT; ++bucket) {
+                        const uint64_t count = block->buckets[latency][bucket].load(std::memory_order_relaxed);
+                        if (count) histogram.AddBucket(bucket, count);
+                    }
+                    histogram.AddTotals(block->sums[latency].load(std::memory_order_relaxed),
+                                        block->maxes[latency].load(std::memory_order_relaxed));
+                }
+                for (size_t counter = 0; counter < COUNTER_COUNT; ++counter) {
+                    snapshot.counters[counter] += block->counters[counter].load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        snapshot.uptimeSeconds = std::chrono::duration<double>(Clock::now() - registry.start).count();
+        snapshot.rateSeconds = snapshot.uptimeSeconds - (previous ? previous->uptimeSeconds : 0.0);
+        for (size_t counter = 0; counter < COUNTER_COUNT; ++counter) {
+            const uint64_t before = previous ? previous->counters[counter] : 0;
+            snapshot.rates[counter] = snapshot.rateSeconds > 0.0 ? (snapshot.counters[counter] - before) / snapshot.rateSeconds : 0.0;
+        }
+        return snapshot;
+    }
+
+    void WritePrometheus(std::ostream& out, const MetricsSnapshot& snapshot) {
+        for (size_t latency = 0; latency < LATENCY_COUNT; ++latency) {
+            const LatencyHistogram& histogram = snapshot.latencies[latency];
+            const std::string name = std::string("tetris_") + LATENCIES[latency].name + "_seconds";
+            out << "# HELP " << name << ' ' << LATENCIES[latency].help << "\n# TYPE " << name << " summary\n";
+            for (double percentile : PERCENTILES) {
+                out << name << "{quantile=\"" << FormatNumber(percentile / 100.0) << "\"} "
+                    << FormatNumber(histogram.GetPercentile(percentile) / 1e9) << '\n';
+            }
+            out << name << "_sum " << FormatNumber(histogram.GetSum() / 1e9) << '\n'
+                << name << "_count " << histogram.GetCount() << '\n'
+                << "# HELP " << name << "_max Largest value recorded\n# TYPE " << name << "_max gauge\n"
+                << name << "_max " << FormatNumber(histogram.GetMax() / 1e9) << '\n';
+        }
+        for (size_t counter = 0; counter < COUNTER_COUNT; ++counter) {
+            const std::string name = std::string("tetris_") + COUNTERS[counter].name;
+            out << "# HELP " << name << "_total " << COUNTERS[counter].help << "\n# TYPE " << name << "_total counter\n"
+                << name << "_total " << snapshot.counters[counter] << '\n'
+                << "# HELP " << name << "_per_second " << COUNTERS[counter].help << ", per second since the last export\n"
+                << "# TYPE " << name << "_per_second gauge\n"
+                << name << "_per_second " << FormatNumber(snapshot.rates[counter]) << '\n';
+        }
+        out << "# HELP tetris_uptime_seconds Time since metrics were first recorded\n# TYPE tetris_uptime_seconds gauge\n"
+            << "tetris_uptime_seconds " << FormatNumber(snapshot.uptimeSeconds) << '\n';
+    }
+
+    void WriteJson(std::ostream& out, const MetricsSnapshot& snapshot) {
+        out << "{\"uptime_seconds\":" << FormatNumber(snapshot.uptimeSeconds)
+            << ",\"rate_seconds\":" << FormatNumber(snapshot.rateSeconds) << ",\"counters\":{";
+        for (size_t counter = 0; counter < COUNTER_COUNT; ++counter) {
+            out << (counter ? "," : "") << '"' << COUNTERS[counter].name << "\":{\"total\":" << snapshot.counters[counter]
+                << ",\"per_second\":" << FormatNumber(snapshot.rates[counter]) << '}';
+        }
+        out << "},\"latencies_ns\":{";
+        for (size_t latency = 0; latency < LATENCY_COUNT; ++latency) {
+            const LatencyHistogram& histogram = snapshot.latencies[latency];
+            out << (latency ? "," : "") << "\n\"" << LATENCIES[latency].name << "\":{\"count\":" << histogram.GetCount()
+                << ",\"mean\":" << FormatNumber(histogram.GetMean()) << ",\"max\":" << histogram.GetMax();
+            for (double percentile : PERCENTILES) {
+                out << ",\"p" << FormatNumber(percentile) << "\":" << histogram.GetPercentile(percentile);
+            }
+
+            // Non-empty buckets as [low, high, count], enough to rebuild the histogram
+            out << ",\"buckets\":[";
+            bool first = true;
+            for (size_t bucket = 0; bucket < LatencyHistogram::BUCKET_COUNT; ++bucket) {
+                const uint64_t count = histogram.GetBucketCount(bucket);
+                if (!count) continue;
+                out << (first ? "" : ",") << '[' << LatencyHistogram::BucketLow(bucket) << ','
+                    << LatencyHistogram::BucketHigh(bucket) << ',' << count << ']';
+                first = false;
+            }
+            out << "]}";
+        }
+        out << "\n}}\n";
+    }
+
+    MetricsExporter::MetricsExporter(MetricsExportOptions options) : m_options(std::move(options)) {
+        if (m_options.prometheusPath.empty() && m_options.jsonPath.empty()) {
+            throw std::invalid_argument("MetricsExporter needs a Prometheus or JSON path");
+        }
+        if (!(m_options.intervalSeconds > 0.0)) throw std::invalid_argument("Metrics export interval must be positive");
+        m_thread = std::thread(&MetricsExporter::_run, this);
+    }
+
+    MetricsExporter::~MetricsExporter() {
+        Stop();
+    }
+
+    void MetricsExporter::ExportNow() {
+        std::lock_guard<std::mutex> lock(m_exportMutex);
+        MetricsSnapshot snapshot = Collect(m_hasPrevious ? &m_previous : nullptr);
+        if (!m_options.prometheusPath.empty()) WriteFile(m_options.prometheusPath, WritePrometheus, snapshot);
+        if (!m_options.jsonPath.empty()) WriteFile(m_options.jsonPath, WriteJson, snapshot);
+        m_previous = std::move(snapshot);
+        m_hasPrevious = true;
+    }
+
+    void MetricsExporter::Stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop) return;
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+
+        try {
+            ExportNow();
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_lastError = e.what();
+        }
+    }
+
+    std::string MetricsExporter::GetLastError() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_lastError;
+    }
+
+    void MetricsExporter::_run() {
+        TETRIS_PROFILE_THREAD("metrics exporter");
+        const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_options.intervalSeconds));
+        auto next = Clock::now() + interval;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_wake.wait_until(lock, next, [this] { return m_stop; })) return;
+            }
+            next += interval;
+
+            // A failed export is reported and retried at the next interval
+            try {
+                ExportNow();
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_lastError = e.what();
+            }
+        }
+    }
+}
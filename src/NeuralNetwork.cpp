@@ -0,0 +1,452 @@
+#include "TetrisEngine/NeuralNetwork.h"
+#include "TetrisEngine/Board.h"
+#include "TetrisEngine/ByteStream.h"
+#include "TetrisEngine/EvalCache.h"
+#include "TetrisEngine/Features.h"
+#include "TetrisEngine/Metrics.h"
+#include "TetrisEngine/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#ifdef TETRIS_ENABLE_NN
+#include "TetrisEngine/OnnxRuntime.h"
+#include <onnxruntime_session_options_config_keys.h>
+#include <cctype>
+#include <cstdio>
+#include <system_error>
+
+#ifdef _WIN32
+    #include <process.h>
+    #define TETRIS_GETPID _getpid
+#else
+    #include <unistd.h>
+    #define TETRIS_GETPID getpid
+#endif
+
+namespace tetris {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        double SecondsSince(Clock::time_point start) {
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        std::vector<std::filesystem::path> ResolveExternalDataFiles(const std::filesystem::path& modelPath, const ModelLoadOptions& options) {
+            if (!options.externalDataFiles.empty()) return options.externalDataFiles;
+
+            // PyTorch / onnx.save_model default naming when weights are split out
+            std::filesystem::path conventional = modelPath.filename();
+            conventional += ".data";
+            if (std::filesystem::exists(modelPath.parent_path() / conventional)) return {conventional};
+            return {};
+        }
+
+        uint64_t HashModel(const MappedFile& model, const std::filesystem::path& modelDir, const std::vector<std::filesystem::path>& externalFiles) {
+            uint64_t hash = HashBytes(model.data(), model.size());
+
+            // Hashing gigabytes of weights on every start would defeat the point of the
+            // cache, so external data only contributes its name, size and timestamp.
+            for (const std::filesystem::path& file : externalFiles) {
+                std::string name = file.generic_string();
+                hash = HashBytes(name.data(), name.size(), hash);
+
+                std::filesystem::path full = modelDir / file;
+                uint64_t size = std::filesystem::file_size(full);
+                int64_t mtime = std::filesystem::last_write_time(full).time_since_epoch().count();
+                hash = HashBytes(&size, sizeof(size), hash);
+                hash = HashBytes(&mtime, sizeof(mtime), hash);
+            }
+            return hash;
+        }
+
+        // Delete the caches of earlier versions of this model ("<stem>-<16 hex>-ort<version>.ort"),
+        // keeping `keep`. A process still mapping one keeps its pages; where the OS refuses
+        // to delete an open file (Windows) it is left for a later prune.
+        void PruneStaleCaches(const std::filesystem::path& modelPath, const std::filesystem::path& keep) {
+            const std::string prefix = modelPath.stem().string() + "-";
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator(keep.parent_path(), ec)) {
+                const std::filesystem::path& path = entry.path();
+                const std::string name = path.filename().string();
+                if (path == keep || path.extension() != ".ort" || name.size() < prefix.size() + 20) continue;
+                if (name.compare(0, prefix.size(), prefix) != 0) continue;
+
+                const std::string hex = name.substr(prefix.size(), 16);
+                const bool isHash = std::all_of(hex.begin(), hex.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); });
+                if (!isHash || name.compare(prefix.size() + 16, 4, "-ort") != 0) continue;
+
+                std::error_code removeError;
+                std::filesystem::remove(path, removeError);
+            }
+        }
+
+        std::filesystem::path CachePathForHash(const std::filesystem::path& modelPath, const ModelLoadOptions& options, uint64_t hash) {
+            std::filesystem::path dir = options.cacheDirectory.empty() ? modelPath.parent_path() / ".ort_cache" : options.cacheDirectory;
+
+            char hex[17];
+            std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+            std::string name = modelPath.stem().string() + "-" + hex + "-ort" + GetOnnxRuntimeVersion() + ".ort";
+            return dir / name;
+        }
+
+        void ReadModelSignature(ModelSession& model) {
+            Ort::AllocatorWithDefaultOptions allocator;
+            Ort::Session& session = *model.session;
+            model.inputName = session.GetInputNameAllocated(0, allocator).get();
+            model.outputName = session.GetOutputNameAllocated(0, allocator).get();
+
+            // Shapes are [batch, ...]; everything past the batch dimension is one entry
+            auto entrySize = [](const std::vector<int64_t>& shape) {
+                size_t size = 1;
+                for (size_t i = 1; i < shape.size(); ++i) {
+                    if (shape[i] > 0) size *= static_cast<size_t>(shape[i]);
+                }
+                return size;
+            };
+            model.inputSize = entrySize(session.GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape());
+            model.outputSize = entrySize(session.GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape());
+        }
+
+        Ort::SessionOptions BaseOptions(const ModelLoadOptions& options) {
+            Ort::SessionOptions sessionOptions;
+            sessionOptions.SetIntraOpNumThreads(options.intraOpThreads);
+            // EXTENDED rather than ALL: the saved graph must not bake in layout choices
+            // for one particular CPU, and re-applying it to a cached graph is a no-op.
+            sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+            return sessionOptions;
+        }
+
+        // Run the optimizer once (at BaseOptions' EXTENDED level) and have ORT serialize
+        // the result in ORT format. Written to a per-process temporary and renamed so that
+        // concurrently starting workers never observe a half-written cache file.
+        bool WriteOptimizedCache(Ort::Env& env, const std::filesystem::path& modelPath, const std::filesystem::path& modelDir,
+                                 const std::vector<std::filesystem::path>& externalFiles, const ModelLoadOptions& options,
+                                 const std::filesystem::path& cachePath) {
+            std::error_code ec;
+            std::filesystem::create_directories(cachePath.parent_path(), ec);
+            if (ec) return false;
+
+            std::vector<MappedFile> externalMappings;
+            std::vector<std::basic_string<ORTCHAR_T>> names;
+            std::vector<char*> buffers;
+            std::vector<size_t> lengths;
+            for (const std::filesystem::path& file : externalFiles) {
+                externalMappings.emplace_back(modelDir / file);
+                names.push_back(file.native());
+                buffers.push_back(reinterpret_cast<char*>(const_cast<uint8_t*>(externalMappings.back().data())));
+                lengths.push_back(externalMappings.back().size());
+            }
+
+            try {
+                WriteFileAtomically(cachePath, [&](const std::filesystem::path& tmpPath) {
+                    Ort::SessionOptions sessionOptions = BaseOptions(options);
+                    sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigSaveModelFormat, "ORT");
+                    sessionOptions.SetOptimizedModelFilePath(tmpPath.c_str());
+                    if (!names.empty()) {
+                        sessionOptions.AddExternalInitializersFromFilesInMemory(names, buffers, lengths);
+                    }
+
+                    Ort::Session writer(env, modelPath.c_str(), sessionOptions);
+                }, ".tmp" + std::to_string(TETRIS_GETPID()));
+            } catch (const Ort::Exception&) {
+                return false;
+            } catch (const std::runtime_error&) {
+                return std::filesystem::exists(cachePath); // another worker may have won the race
+            }
+            PruneStaleCaches(modelPath, cachePath);
+            return true;
+        }
+    }
+
+    std::filesystem::path GetModelCachePath(const std::filesystem::path& modelPath, const ModelLoadOptions& options) {
+        MappedFile model(modelPath);
+        std::vector<std::filesystem::path> externalFiles = ResolveExternalDataFiles(modelPath, options);
+        return CachePathForHash(modelPath, options, HashModel(model, modelPath.parent_path(), externalFiles));
+    }
+
+    std::shared_ptr<ModelSession> LoadModel(Ort::Env& env, const std::filesystem::path& modelPath, const ModelLoadOptions& options) {
+        const Clock::time_point start = Clock::now();
+        auto model = std::make_shared<ModelSession>();
+        ModelLoadStats& stats = model->stats;
+
+        const std::filesystem::path modelDir = modelPath.parent_path();
+        std::vector<std::filesystem::path> externalFiles = ResolveExternalDataFiles(modelPath, options);
+
+        std::filesystem::path cachePath;
+        if (options.useCache) {
+            MappedFile graph(modelPath);
+            cachePath = CachePathForHash(modelPath, options, HashModel(graph, modelDir, externalFiles));
+            stats.hashSeconds = SecondsSince(start);
+
+            if (!std::filesystem::exists(cachePath)) {
+                WriteOptimizedCache(env, modelPath, modelDir, externalFiles, options, cachePath);
+            } else {
+                stats.cacheHit = true;
+            }
+        }
+
+        const Clock::time_point sessionStart = Clock::now();
+        if (!cachePath.empty() && std::filesystem::exists(cachePath)) {
+            // Run directly from the mapped ORT-format bytes, initializers included.
+            // Prepacking would copy weights into private memory, so it is disabled.
+            model->mappings.emplace_back(cachePath);
+            const MappedFile& cached = model->mappings.back();
+
+            Ort::SessionOptions sessionOptions = BaseOptions(options);
+            sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigLoadModelFormat, "ORT");
+            sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigUseORTModelBytesDirectly, "1");
+            sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigUseORTModelBytesForInitializers, "1");
+            sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigDisablePrepacking, "1");
+
+            model->session = std::make_unique<Ort::Session>(env, cached.data(), cached.size(), sessionOptions);
+            stats.cachePath = cachePath;
+        } else {
+            // No usable cache: optimize in-process, still serving weights from mappings
+            std::vector<std::basic_string<ORTCHAR_T>> names;
+            std::vector<char*> buffers;
+            std::vector<size_t> lengths;
+            for (const std::filesystem::path& file : externalFiles) {
+                model->mappings.emplace_back(modelDir / file);
+                names.push_back(file.native());
+                buffers.push_back(reinterpret_cast<char*>(const_cast<uint8_t*>(model->mappings.back().data())));
+                lengths.push_back(model->mappings.back().size());
+            }
+
+            Ort::SessionOptions sessionOptions = BaseOptions(options);
+            if (!names.empty()) {
+                sessionOptions.AddExternalInitializersFromFilesInMemory(names, buffers, lengths);
+            }
+            model->session = std::make_unique<Ort::Session>(env, modelPath.c_str(), sessionOptions);
+        }
+        stats.sessionSeconds = SecondsSince(sessionStart);
+
+        for (const MappedFile& mapping : model->mappings) {
+            stats.mappedBytes += mapping.size();
+        }
+
+        ReadModelSignature(*model);
+        stats.totalSeconds = SecondsSince(start);
+        return model;
+    }
+
+    namespace {
+        class OnnxInferenceBackend : public InferenceBackend {
+            public:
+                explicit OnnxInferenceBackend(std::shared_ptr<ModelSession> model)
+                    : m_model(std::move(model)),
+                      m_memoryInfo(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault))
+                {}
+
+                void Run(const float* input, size_t batchSize, float* output) const override {
+                    const int64_t inputShape[2] = {static_cast<int64_t>(batchSize), static_cast<int64_t>(m_model->inputSize)};
+                    const int64_t outputShape[2] = {static_cast<int64_t>(batchSize), static_cast<int64_t>(m_model->outputSize)};
+
+                    // ORT never writes to inputs, the const_cast only satisfies the tensor API
+                    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(m_memoryInfo, const_cast<float*>(input), batchSize * m_model->inputSize, inputShape, 2);
+                    Ort::Value outputTensor = Ort::Value::CreateTensor<float>(m_memoryInfo, output, batchSize * m_model->outputSize, outputShape, 2);
+
+                    const char* inputNames[] = {m_model->inputName.c_str()};
+                    const char* outputNames[] = {m_model->outputName.c_str()};
+                    m_model->session->Run(Ort::RunOptions{nullptr}, inputNames, &inputTensor, 1, outputNames, &outputTensor, 1);
+                }
+
+                size_t GetInputSize() const override { return m_model->inputSize; }
+                size_t GetOutputSize() const override { return m_model->outputSize; }
+                const ModelLoadStats& GetLoadStats() const override { return m_model->stats; }
+
+            private:
+                std::shared_ptr<ModelSession> m_model;
+                Ort::MemoryInfo m_memoryInfo;
+        };
+    }
+
+    std::unique_ptr<InferenceBackend> CreateOnnxBackend(const std::filesystem::path& modelPath, const ModelLoadOptions& options) {
+        const auto start = std::chrono::steady_clock::now();
+        bool firstLoad = !IsOnnxRuntimeLoaded();
+        Ort::Env& env = GetOrtEnv();
+        double libraryLoadSeconds = firstLoad ? SecondsSince(start) : 0.0;
+
+        std::shared_ptr<ModelSession> model = LoadModel(env, modelPath, options);
+        model->stats.libraryLoadSeconds = libraryLoadSeconds;
+        model->stats.totalSeconds += libraryLoadSeconds;
+        return std::make_unique<OnnxInferenceBackend>(std::move(model));
+    }
+}
+
+#else // TETRIS_ENABLE_NN
+
+namespace tetris {
+    std::unique_ptr<InferenceBackend> CreateOnnxBackend(const std::filesystem::path&, const ModelLoadOptions&) {
+        throw std::runtime_error("TetrisEngine was built with ENABLE_NN=OFF; neural network models are unavailable.");
+    }
+}
+
+#endif // TETRIS_ENABLE_NN
+
+namespace tetris {
+    NeuralNetwork::NeuralNetwork(const std::filesystem::path& modelPath, ModelLoadOptions options)
+        : NeuralNetwork(modelPath, BackendFactory(CreateOnnxBackend), std::move(options))
+    {}
+
+    NeuralNetwork::NeuralNetwork(const std::filesystem::path& modelPath, BackendFactory factory, ModelLoadOptions options)
+        : m_modelPath(modelPath),
+          m_loadOptions(std::move(options)),
+          m_factory(std::move(factory)),
+          m_backend(m_factory(m_modelPath, m_loadOptions))
+    {}
+
+    NeuralNetwork::~NeuralNetwork() {
+        StopWatching();
+    }
+
+    std::shared_ptr<const InferenceBackend> NeuralNetwork::GetBackend() const {
+        std::lock_guard<std::mutex> lock(m_backendMutex);
+        return m_backend;
+    }
+
+    size_t NeuralNetwork::Evaluate(const Board* const* boards, size_t count, float* output, EvalCache* cache) const {
+        TETRIS_PROFILE_ZONE("NeuralNetwork::Evaluate");
+        // Version first: a swap lands between the two reads at worst as new outputs
+        // filed under the old version, which no longer matches anything
+        const uint64_t version = GetModelVersion();
+        std::shared_ptr<const InferenceBackend> backend = GetBackend();
+
+        const size_t inputSize = backend->GetInputSize();
+        const size_t outputSize = backend->GetOutputSize();
+        if (inputSize != BOARD_FEATURE_SIZE) {
+            throw std::runtime_error("Model expects " + std::to_string(inputSize) + " inputs, board features have "
+                + std::to_string(BOARD_FEATURE_SIZE));
+        }
+        if (cache && cache->GetValueSize() != outputSize) {
+            throw std::invalid_argument("EvalCache value size does not match the model output size");
+        }
+
+        std::vector<size_t> missing;
+        std::vector<uint64_t> keys;
+        missing.reserve(count);
+        keys.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            if (cache) {
+                uint64_t key = EvalCache::MakeKey(boards[i]->Hash(), version);
+                if (cache->Lookup(key, output + i * outputSize)) continue;
+                keys.push_back(key);
+            }
+            missing.push_back(i);
+        }
+        if (missing.empty()) return 0;
+
+        std::vector<float> input(missing.size() * inputSize);
+        std::vector<float> results(missing.size() * outputSize);
+        for (size_t m = 0; m < missing.size(); ++m) {
+            EncodeBoard(*boards[missing[m]], &input[m * inputSize]);
+        }
+        {
+            TETRIS_PROFILE_ZONE("InferenceBackend::Run");
+            const auto start = std::chrono::steady_clock::now();
+            backend->Run(input.data(), missing.size(), results.data());
+            metrics::RecordLatency(metrics::Latency::INFERENCE, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+        }
+        metrics::Increment(metrics::Counter::POSITIONS, missing.size());
+
+        for (size_t m = 0; m < missing.size(); ++m) {
+            const float* result = &results[m * outputSize];
+            std::copy_n(result, outputSize, output + missing[m] * outputSize);
+            if (cache) cache->Insert(keys[m], result);
+        }
+        return missing.size();
+    }
+
+    void NeuralNetwork::WatchForUpdates(ModelWatchOptions options) {
+        StopWatching();
+        m_stopWatching = false;
+
+        // Stamped here rather than on the new thread, so a checkpoint written right after this call is not missed
+        FileStamp loaded;
+        _stampModel(loaded);
+        m_watcher = std::thread(&NeuralNetwork::_watchLoop, this, std::move(options), loaded);
+    }
+
+    void NeuralNetwork::StopWatching() {
+        if (!m_watcher.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(m_watchMutex);
+            m_stopWatching = true;
+        }
+        m_watchSignal.notify_all();
+        m_watcher.join();
+    }
+
+    std::string NeuralNetwork::GetLastReloadError() const {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        return m_lastReloadError;
+    }
+
+    bool NeuralNetwork::_stampModel(FileStamp& stamp) const {
+        std::error_code ec;
+        stamp.time = std::filesystem::last_write_time(m_modelPath, ec);
+        if (ec) return false;
+        stamp.size = std::filesystem::file_size(m_modelPath, ec);
+        return !ec;
+    }
+
+    void NeuralNetwork::_watchLoop(ModelWatchOptions options, FileStamp loaded) {
+        FileStamp pending = loaded;
+        FileStamp failed = loaded;   // a file that failed to load is skipped until it changes again
+
+        std::unique_lock<std::mutex> lock(m_watchMutex);
+        while (!m_watchSignal.wait_for(lock, options.pollInterval, [this] { return m_stopWatching; })) {
+            FileStamp current;
+            if (!_stampModel(current) || current == loaded || current == failed) continue;
+
+            // Only reload once the file has stopped changing for a whole poll interval,
+            // so a checkpoint that is still being written is never picked up
+            if (!(current == pending)) {
+                pending = current;
+                continue;
+            }
+
+            lock.unlock();
+            if (_reload(options)) {
+                loaded = current;
+            } else {
+                failed = current;
+            }
+            lock.lock();
+        }
+    }
+
+    bool NeuralNetwork::_reload(const ModelWatchOptions& options) {
+        std::shared_ptr<const InferenceBackend> next;
+        try {
+            next = m_factory(m_modelPath, m_loadOptions);
+
+            // First Run() allocates arenas and initializes kernels; pay for it here, not in the game loop
+            size_t batch = std::max<size_t>(options.warmupBatchSize, 1);
+            std::vector<float> input(batch * next->GetInputSize(), 0.0f);
+            std::vector<float> output(batch * next->GetOutputSize());
+            next->Run(input.data(), batch, output.data());
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            m_lastReloadError = e.what();
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_backendMutex);
+            m_backend.swap(next);
+        }
+        uint64_t version = m_version.fetch_add(1, std::memory_order_acq_rel) + 1;
+        {
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            m_lastReloadError.clear();
+        }
+
+        // `next` now holds the previous backend; it is released here unless a Run() still uses it
+        next.reset();
+
+        if (options.onReload) options.onReload(version, GetBackend()->GetLoadStats());
+        return true;
+    }
+}
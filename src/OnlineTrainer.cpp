@@ -0,0 +1,155 @@
+#include "TetrisEngine/OnlineTrainer.h"
+#include "TetrisEngine/ByteStream.h"
+#include <limits>
+#include <stdexcept>
+
+#ifdef TETRIS_ENABLE_NN
+// The training header forward-declares its release functions and must precede onnxruntime_cxx_api.h
+#include <onnxruntime_training_cxx_api.h>
+#include "TetrisEngine/OnnxRuntime.h"
+#include <optional>
+#include <random>
+
+namespace tetris {
+    namespace {
+        Ort::CheckpointState LoadCheckpointChecked(const std::filesystem::path& path) {
+            EnsureOnnxRuntimeLoaded();
+            if (!Ort::GetApi().GetTrainingApi(ORT_API_VERSION)) {
+                throw std::runtime_error("The loaded ONNX Runtime (" + GetOnnxRuntimeVersion()
+                    + ") was built without training support; OnlineTrainer needs an onnxruntime-training library.");
+            }
+            return Ort::CheckpointState::LoadCheckpoint(path.native());
+        }
+
+        Ort::SessionOptions TrainingSessionOptions(const OnlineTrainerOptions& options) {
+            Ort::SessionOptions sessionOptions;
+            sessionOptions.SetIntraOpNumThreads(options.intraOpThreads);
+            return sessionOptions;
+        }
+
+        std::optional<std::basic_string<ORTCHAR_T>> OptionalPath(const std::filesystem::path& path) {
+            if (path.empty()) return std::nullopt;
+            return path.native();
+        }
+    }
+
+    struct OnlineTrainer::Impl {
+        Impl(const TrainingArtifacts& artifacts, OnlineTrainerOptions trainerOptions)
+            : options(std::move(trainerOptions)),
+              hasEvalModel(!artifacts.evalModel.empty()),
+              checkpoint(LoadCheckpointChecked(artifacts.checkpoint)),
+              session(GetOrtEnv(), TrainingSessionOptions(options), checkpoint,
+                      artifacts.trainingModel.native(), OptionalPath(artifacts.evalModel), OptionalPath(artifacts.optimizerModel)),
+              memoryInfo(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)),
+              rng(options.seed)
+        {
+            if (session.InputNames(true).size() != 2) {
+                throw std::runtime_error("OnlineTrainer expects a training model with exactly two inputs (features, targets)");
+            }
+            if (options.learningRate > 0.0f) {
+                session.SetLearningRate(options.learningRate);
+            }
+        }
+
+        // Sample a minibatch into the reusable buffers and wrap them as ORT tensors
+        bool FillBatch(const ReplayBuffer& buffer, std::vector<Ort::Value>& inputs) {
+            const size_t batch = options.batchSize;
+            features.resize(batch * buffer.GetFeatureSize());
+            targets.resize(batch * buffer.GetTargetSize());
+            if (!buffer.Sample(batch, rng, features.data(), targets.data())) return false;
+
+            const int64_t featureShape[2] = {static_cast<int64_t>(batch), static_cast<int64_t>(buffer.GetFeatureSize())};
+            const int64_t targetShape[2] = {static_cast<int64_t>(batch), static_cast<int64_t>(buffer.GetTargetSize())};
+            inputs.clear();
+            inputs.push_back(Ort::Value::CreateTensor<float>(memoryInfo, features.data(), features.size(), featureShape, 2));
+            inputs.push_back(Ort::Value::CreateTensor<float>(memoryInfo, targets.data(), targets.size(), targetShape, 2));
+            return true;
+        }
+
+        static float LossOf(std::vector<Ort::Value>& outputs) {
+            if (outputs.empty()) return std::numeric_limits<float>::quiet_NaN();
+            return *outputs.front().GetTensorData<float>();
+        }
+
+        OnlineTrainerOptions options;
+        bool hasEvalModel;
+        Ort::CheckpointState checkpoint; // must be constructed before (and outlive) the session
+        Ort::TrainingSession session;
+        Ort::MemoryInfo memoryInfo;
+        std::mt19937_64 rng;
+        std::vector<float> features;
+        std::vector<float> targets;
+        uint64_t steps = 0;
+        float lastLoss = std::numeric_limits<float>::quiet_NaN();
+    };
+
+    OnlineTrainer::OnlineTrainer(const TrainingArtifacts& artifacts, OnlineTrainerOptions options)
+        : m_impl(std::make_unique<Impl>(artifacts, std::move(options)))
+    {}
+
+    OnlineTrainer::~OnlineTrainer() = default;
+
+    float OnlineTrainer::TrainStep(const ReplayBuffer& buffer) {
+        std::vector<Ort::Value> inputs;
+        if (!m_impl->FillBatch(buffer, inputs)) return std::numeric_limits<float>::quiet_NaN();
+
+        std::vector<Ort::Value> outputs = m_impl->session.TrainStep(inputs);
+        m_impl->session.OptimizerStep();
+        m_impl->session.LazyResetGrad();
+
+        ++m_impl->steps;
+        m_impl->lastLoss = Impl::LossOf(outputs);
+        return m_impl->lastLoss;
+    }
+
+    float OnlineTrainer::EvalStep(const ReplayBuffer& buffer) {
+        if (!m_impl->hasEvalModel) throw std::logic_error("OnlineTrainer::EvalStep needs an eval model");
+
+        std::vector<Ort::Value> inputs;
+        if (!m_impl->FillBatch(buffer, inputs)) return std::numeric_limits<float>::quiet_NaN();
+
+        std::vector<Ort::Value> outputs = m_impl->session.EvalStep(inputs);
+        return Impl::LossOf(outputs);
+    }
+
+    void OnlineTrainer::ExportInferenceModel(const std::filesystem::path& path) {
+        if (!m_impl->hasEvalModel) throw std::logic_error("OnlineTrainer::ExportInferenceModel needs an eval model");
+
+        // Through a temporary so a watcher never sees a half-written model
+        WriteFileAtomically(path, [this](const std::filesystem::path& tmpPath) {
+            m_impl->session.ExportModelForInferencing(tmpPath.native(), m_impl->options.inferenceOutputs);
+        });
+    }
+
+    void OnlineTrainer::SaveCheckpoint(const std::filesystem::path& path, bool includeOptimizerState) {
+        Ort::CheckpointState::SaveCheckpoint(m_impl->checkpoint, path.native(), includeOptimizerState);
+    }
+
+    uint64_t OnlineTrainer::GetStepCount() const noexcept {
+        return m_impl->steps;
+    }
+
+    float OnlineTrainer::GetLastLoss() const noexcept {
+        return m_impl->lastLoss;
+    }
+}
+
+#else // TETRIS_ENABLE_NN
+
+namespace tetris {
+    struct OnlineTrainer::Impl {};
+
+    OnlineTrainer::OnlineTrainer(const TrainingArtifacts&, OnlineTrainerOptions) {
+        throw std::runtime_error("TetrisEngine was built with ENABLE_NN=OFF; OnlineTrainer is unavailable.");
+    }
+
+    OnlineTrainer::~OnlineTrainer() = default;
+    float OnlineTrainer::TrainStep(const ReplayBuffer&) { return std::numeric_limits<float>::quiet_NaN(); }
+    float OnlineTrainer::EvalStep(const ReplayBuffer&) { return std::numeric_limits<float>::quiet_NaN(); }
+    void OnlineTrainer::ExportInferenceModel(const std::filesystem::path&) {}
+    void OnlineTrainer::SaveCheckpoint(const std::filesystem::path&, bool) {}
+    uint64_t OnlineTrainer::GetStepCount() const noexcept { return 0; }
+    float OnlineTrainer::GetLastLoss() const noexcept { return std::numeric_limits<float>::quiet_NaN(); }
+}
+
+#endif // TETRIS_ENABLE_NN
@@ -0,0 +1,154 @@
+#include "TetrisEngine/OnnxRuntime.h"
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <dlfcn.h>
+#endif
+
+namespace tetris {
+    namespace {
+        using GetApiBaseFn = const OrtApiBase* (ORT_API_CALL*)();
+
+#ifdef _WIN32
+        constexpr const char* DefaultLibraryName = "onnxruntime.dll";
+#elif defined(__APPLE__)
+        constexpr const char* DefaultLibraryName = "libonnxruntime.dylib";
+#else
+        constexpr const char* DefaultLibraryName = "libonnxruntime.so";
+#endif
+
+        std::mutex loadMutex;
+        bool loaded = false;
+        std::string runtimeVersion;
+
+        std::vector<std::string> CandidatePaths() {
+            std::vector<std::string> candidates;
+            if (const char* overridePath = std::getenv("TETRIS_ONNXRUNTIME_PATH")) {
+                candidates.emplace_back(overridePath);
+            }
+#ifdef TETRIS_ONNXRUNTIME_LIBRARY
+            candidates.emplace_back(TETRIS_ONNXRUNTIME_LIBRARY);
+#endif
+            candidates.emplace_back(DefaultLibraryName);
+#if !defined(_WIN32) && !defined(__APPLE__)
+            candidates.emplace_back("libonnxruntime.so.1");
+#endif
+            return candidates;
+        }
+
+        struct OpenedLibrary {
+            void* handle = nullptr;
+            GetApiBaseFn getApiBase = nullptr;
+        };
+
+        void CloseLibrary(void* handle) {
+#ifdef _WIN32
+            FreeLibrary(static_cast<HMODULE>(handle));
+#else
+            dlclose(handle);
+#endif
+        }
+
+        // Returns the library with its OrtGetApiBase entry point, or an empty result with `error` filled in
+        OpenedLibrary OpenLibrary(const std::string& path, std::string& error) {
+            OpenedLibrary library;
+#ifdef _WIN32
+            HMODULE handle = LoadLibraryA(path.c_str());
+            if (!handle) {
+                error = "LoadLibrary error " + std::to_string(GetLastError());
+                return library;
+            }
+            library.getApiBase = reinterpret_cast<GetApiBaseFn>(GetProcAddress(handle, "OrtGetApiBase"));
+#else
+            void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+            if (!handle) {
+                const char* message = dlerror();
+                error = message ? message : "dlopen failed";
+                return library;
+            }
+            library.getApiBase = reinterpret_cast<GetApiBaseFn>(dlsym(handle, "OrtGetApiBase"));
+#endif
+            if (!library.getApiBase) {
+                error = "OrtGetApiBase not exported";
+                CloseLibrary(handle);
+                return library;
+            }
+            library.handle = handle;
+            return library;
+        }
+
+        // Caller holds loadMutex. On success the handle is intentionally never closed:
+        // ORT cannot be safely unloaded.
+        bool LoadLocked(const std::string& path, std::string& error) {
+            OpenedLibrary library = OpenLibrary(path, error);
+            if (!library.handle) return false;
+
+            const OrtApiBase* base = library.getApiBase();
+            const OrtApi* api = base ? base->GetApi(ORT_API_VERSION) : nullptr;
+            if (!api) {
+                error = std::string("runtime version ") + (base ? base->GetVersionString() : "?")
+                      + " does not provide API version " + std::to_string(ORT_API_VERSION);
+                CloseLibrary(library.handle);
+                return false;
+            }
+
+            Ort::InitApi(api);
+            runtimeVersion = base->GetVersionString();
+            loaded = true;
+            return true;
+        }
+    }
+
+    void EnsureOnnxRuntimeLoaded() {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        if (loaded) return;
+
+        std::string attempts;
+        for (const std::string& candidate : CandidatePaths()) {
+            std::string error;
+            if (LoadLocked(candidate, error)) return;
+            attempts += "\n  " + candidate + ": " + error;
+        }
+
+        throw std::runtime_error(
+            "Neural network support needs the ONNX Runtime shared library, which could not be loaded."
+            " Set TETRIS_ONNXRUNTIME_PATH to the library file, or run without a model. Tried:" + attempts);
+    }
+
+    bool LoadOnnxRuntimeFrom(const std::string& path, std::string* error) {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        if (loaded) return true;
+
+        std::string message;
+        const bool ok = LoadLocked(path, message);
+        if (!ok && error) *error = message;
+        return ok;
+    }
+
+    bool IsOnnxRuntimeLoaded() noexcept {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        return loaded;
+    }
+
+    std::string GetOnnxRuntimeVersion() {
+        EnsureOnnxRuntimeLoaded();
+        std::lock_guard<std::mutex> lock(loadMutex);
+        return runtimeVersion;
+    }
+
+    Ort::Env& GetOrtEnv() {
+        EnsureOnnxRuntimeLoaded();
+        // Leaked on purpose: tearing down the env during static destruction races ORT's own globals
+        static Ort::Env* env = new Ort::Env(ORT_LOGGING_LEVEL_WARNING, "TetrisEngine");
+        return *env;
+    }
+}
@@ -0,0 +1,48 @@
+#include "TetrisEngine/PerfStats.h"
+#include <cstdlib>
+#include <new>
+
+// Replacement global allocation functions: the standard lets a program supply
+// these, and every operator new / new[] in the process then comes through here.
+// Over-aligned allocations keep the library's own functions and are not counted.
+
+namespace {
+    // Constant-initialized, so touching it from inside operator new never allocates
+    thread_local uint64_t threadAllocations = 0;
+
+    void* Allocate(std::size_t size) noexcept {
+        ++threadAllocations;
+        return std::malloc(size ? size : 1);
+    }
+}
+
+namespace tetris {
+    uint64_t GetThreadAllocations() noexcept {
+        return threadAllocations;
+    }
+}
+
+void* operator new(std::size_t size) {
+    if (void* memory = Allocate(size)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* memory = Allocate(size)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size);
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
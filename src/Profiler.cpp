@@ -0,0 +1,161 @@
+#include "TetrisEngine/Profiler.h"
+#include "TetrisEngine/EventRing.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace tetris::profile {
+    namespace {
+        struct ZoneRecord {
+            const char* name;
+            int64_t startNs;
+            int64_t endNs;
+        };
+
+        struct ThreadTrace {
+            uint32_t id = 0;
+            std::string name;   ///< Guarded by the registry mutex
+            EventRing<ZoneRecord, RING_CAPACITY> zones;
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ThreadTrace>> threads;
+            std::deque<ThreadTrace*> retired;   ///< Traces of exited threads, earliest exit first
+        };
+
+        // Never destroyed: threads may still finish zones while statics are torn down at exit
+        Registry& GetRegistry() {
+            static Registry* registry = new Registry;
+            return *registry;
+        }
+
+        // Traces outlive their threads, so a dump still shows threads that have exited. An exited
+        // thread's trace goes on the retired list and the next new thread takes it over, keeping
+        // its id and the older zones, so ring memory tracks the most threads alive at once rather
+        // than every thread ever started.
+        struct TraceLease {
+            ThreadTrace* trace = nullptr;
+
+            ~TraceLease() {
+                if (!trace) return;
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.retired.push_back(trace);
+            }
+        };
+
+        ThreadTrace* AcquireTrace() {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            if (!registry.retired.empty()) {
+                ThreadTrace* reused = registry.retired.front();
+                registry.retired.pop_front();
+                reused->name = "thread " + std::to_string(reused->id);
+                return reused;
+            }
+            auto created = std::make_unique<ThreadTrace>();
+            created->id = static_cast<uint32_t>(registry.threads.size());
+            created->name = "thread " + std::to_string(created->id);
+            registry.threads.push_back(std::move(created));
+            return registry.threads.back().get();
+        }
+
+        ThreadTrace& CurrentThread() {
+            thread_local TraceLease lease;
+            if (!lease.trace) lease.trace = AcquireTrace();
+            return *lease.trace;
+        }
+
+        int64_t NowNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        void WriteJsonString(std::ostream& out, const char* text) {
+            out << '"';
+            for (const char* c = text; *c; ++c) {
+                if (*c == '"' || *c == '\\') out << '\\' << *c;
+                else if (static_cast<unsigned char>(*c) >= 0x20) out << *c;
+            }
+            out << '"';
+        }
+    }
+
+    Zone::Zone(const char* name) noexcept : m_name(name), m_startNs(NowNs()) {}
+
+    Zone::~Zone() {
+        RecordZone(m_name, m_startNs, NowNs());
+    }
+
+    void RecordZone(const char* name, int64_t startNs, int64_t endNs) noexcept {
+        CurrentThread().zones.Push(ZoneRecord{name, startNs, endNs});
+    }
+
+    void SetThreadName(const char* name) {
+        ThreadTrace& trace = CurrentThread();
+        std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+        trace.name = name;
+    }
+
+    size_t WriteChromeTrace(const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) throw std::runtime_error("Cannot open trace file " + path);
+
+        struct ThreadZones {
+            uint32_t id;
+            std::string name;
+            std::vector<ZoneRecord> zones;
+        };
+        std::vector<ThreadZones> threads;
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (const std::unique_ptr<ThreadTrace>& trace : registry.threads) {
+                ThreadZones copy{trace->id, trace->name, {}};
+                uint64_t cursor = 0;
+                trace->zones.Drain(cursor, [&](const ZoneRecord& zone) { copy.zones.push_back(zone); });
+                threads.push_back(std::move(copy));
+            }
+        }
+
+        // Timestamps start at the earliest zone kept
+        int64_t epoch = std::numeric_limits<int64_t>::max();
+        for (const ThreadZones& thread : threads) {
+            for (const ZoneRecord& zone : thread.zones) epoch = std::min(epoch, zone.startNs);
+        }
+
+        size_t written = 0;
+        char numbers[96];
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        for (const ThreadZones& thread : threads) {
+            out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.id
+                << ",\"args\":{\"name\":";
+            WriteJsonString(out, thread.name.c_str());
+            out << "}}";
+            first = false;
+
+            for (const ZoneRecord& zone : thread.zones) {
+                out << ",\n{\"name\":";
+                WriteJsonString(out, zone.name);
+                std::snprintf(numbers, sizeof(numbers), ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                              thread.id, (zone.startNs - epoch) / 1000.0, (zone.endNs - zone.startNs) / 1000.0);
+                out << numbers;
+                ++written;
+            }
+        }
+        out << "\n]}\n";
+
+        out.flush();
+        if (!out) throw std::runtime_error("Failed writing trace file " + path);
+        return written;
+    }
+}
@@ -0,0 +1,255 @@
+#include "TetrisEngine/Replay.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace tetris {
+    namespace {
+        // Event tag = player * 16 + kind; kinds below INPUT_TYPE_COUNT are InputType values
+        constexpr uint8_t EVENT_GARBAGE = 14;
+        constexpr uint8_t EVENT_GAME_RESET = 15;
+        constexpr uint64_t KINDS_PER_PLAYER = 16;
+        constexpr uint64_t NO_EVENT = std::numeric_limits<uint64_t>::max();
+
+        static_assert(INPUT_TYPE_COUNT <= EVENT_GARBAGE, "Input types collide with replay event kinds");
+    }
+
+    ReplayRecorder::ReplayRecorder(Game& game, uint32_t keyframeInterval) : m_game(game) {
+        if (keyframeInterval == 0) throw std::invalid_argument("Replay keyframe interval must be positive");
+
+        const GravityClock& gravity = game.getGravityClock();
+        m_info.seed = game.getRNG();
+        m_info.playerCount = static_cast<uint16_t>(game.playerCount());
+        m_info.rulesVersion = GAME_RULES_VERSION;
+        m_info.framesPerSecond = Game::FRAMES_PER_SECOND;
+        m_info.initialGravity = gravity.getInitialGravity();
+        m_info.gravityRampUpDelay = gravity.getRampUpDelay();
+        m_info.gravityIncrement = gravity.getGravityIncrement();
+        m_info.keyframeInterval = keyframeInterval;
+        m_info.startFrame = game.GetFrame();
+        m_lastEventFrame = m_info.startFrame;
+
+        _takeKeyframe();
+        m_game.SetRecorder(this);
+    }
+
+    ReplayRecorder::~ReplayRecorder() {
+        m_game.SetRecorder(nullptr);
+    }
+
+    void ReplayRecorder::_writeEventHeader(size_t player, uint8_t kind) {
+        uint64_t frame = m_game.GetFrame();
+        m_events.PutVarint(frame - m_lastEventFrame);
+        m_events.PutVarint(player * KINDS_PER_PLAYER + kind);
+        m_lastEventFrame = frame;
+        ++m_eventCount;
+    }
+
+    void ReplayRecorder::OnInput(size_t player, InputType input) {
+        _writeEventHeader(player, static_cast<uint8_t>(input));
+    }
+
+    void ReplayRecorder::OnGarbage(size_t player, int lines) {
+        _writeEventHeader(player, EVENT_GARBAGE);
+        m_events.PutVarint(static_cast<uint64_t>(lines));
+    }
+
+    void ReplayRecorder::OnReset() {
+        _writeEventHeader(0, EVENT_GAME_RESET);
+    }
+
+    void ReplayRecorder::OnFrame() {
+        if ((m_game.GetFrame() - m_info.startFrame) % m_info.keyframeInterval == 0) {
+            _takeKeyframe();
+        }
+    }
+
+    void ReplayRecorder::_takeKeyframe() {
+        size_t before = m_states.Size();
+        m_game.SaveState(m_states);
+        m_keyframes.push_back({m_game.GetFrame(), m_events.Size(), m_lastEventFrame, m_states.Size() - before});
+    }
+
+    std::vector<uint8_t> ReplayRecorder::Serialize() const {
+        ByteWriter out;
+        out.PutBytes(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+        out.PutU16(REPLAY_FORMAT_VERSION);
+        out.PutU16(m_info.playerCount);
+        out.PutU32(m_info.rulesVersion);
+        out.PutU32(m_info.framesPerSecond);
+        out.PutU32(m_info.seed);
+        out.PutDouble(m_info.initialGravity);
+        out.PutDouble(m_info.gravityRampUpDelay);
+        out.PutDouble(m_info.gravityIncrement);
+        out.PutU32(m_info.keyframeInterval);
+        out.PutU64(m_info.startFrame);
+        out.PutU64(m_game.GetFrame());
+        out.PutU32(static_cast<uint32_t>(m_keyframes.size()));
+        out.PutU64(m_eventCount);
+        out.PutU64(m_events.Size());
+        out.PutU64(m_states.Size());
+
+        // Keyframe index as varints; frames are stored relative to the start frame
+        for (const Keyframe& keyframe : m_keyframes) {
+            out.PutVarint(keyframe.frame - m_info.startFrame);
+            out.PutVarint(keyframe.eventOffset);
+            out.PutVarint(keyframe.frame - keyframe.eventBaseFrame);
+            out.PutVarint(keyframe.stateSize);
+        }
+
+        out.PutBytes(m_events.Data(), m_events.Size());
+        out.PutBytes(m_states.Data(), m_states.Size());
+        return out.GetBuffer();
+    }
+
+    void ReplayRecorder::Save(const std::filesystem::path& path) const {
+        std::vector<uint8_t> bytes = Serialize();
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file) throw std::runtime_error("Failed to write replay " + path.string());
+    }
+
+    ReplayPlayer::ReplayPlayer(std::vector<uint8_t> data) : m_data(std::move(data)) {
+        _parse();
+        m_game = std::make_unique<Game>(m_info.playerCount, m_info.seed);
+        _loadKeyframe(0);
+    }
+
+    ReplayPlayer::ReplayPlayer(const std::filesystem::path& path)
+        : ReplayPlayer([&path] {
+              std::ifstream file(path, std::ios::binary);
+              if (!file) throw std::runtime_error("Cannot open replay " + path.string());
+              return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+          }())
+    {}
+
+    void ReplayPlayer::_parse() {
+        ByteReader in(m_data.data(), m_data.size());
+        char magic[sizeof(REPLAY_MAGIC)];
+        in.GetBytes(magic, sizeof(magic));
+        if (std::memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0) throw std::runtime_error("Not a replay file");
+        if (in.GetU16() != REPLAY_FORMAT_VERSION) throw std::runtime_error("Unsupported replay format version");
+
+        m_info.playerCount = in.GetU16();
+        m_info.rulesVersion = in.GetU32();
+        m_info.framesPerSecond = in.GetU32();
+        m_info.seed = in.GetU32();
+        m_info.initialGravity = in.GetDouble();
+        m_info.gravityRampUpDelay = in.GetDouble();
+        m_info.gravityIncrement = in.GetDouble();
+        m_info.keyframeInterval = in.GetU32();
+        m_info.startFrame = in.GetU64();
+        m_info.endFrame = in.GetU64();
+        m_info.keyframeCount = in.GetU32();
+        m_info.eventCount = in.GetU64();
+        uint64_t eventBytes = in.GetU64();
+        uint64_t stateBytes = in.GetU64();
+
+        if (m_info.rulesVersion != GAME_RULES_VERSION || m_info.framesPerSecond != Game::FRAMES_PER_SECOND) {
+            throw std::runtime_error("Replay was recorded under different game rules");
+        }
+        if (m_info.playerCount == 0 || m_info.keyframeCount == 0 || m_info.endFrame < m_info.startFrame) {
+            throw std::runtime_error("Corrupt replay header");
+        }
+
+        uint64_t stateOffset = 0;
+        m_keyframes.reserve(m_info.keyframeCount);
+        for (uint32_t i = 0; i < m_info.keyframeCount; ++i) {
+            Keyframe keyframe;
+            keyframe.frame = m_info.startFrame + in.GetVarint();
+            keyframe.eventOffset = in.GetVarint();
+            uint64_t sinceLastEvent = in.GetVarint();
+            keyframe.eventBaseFrame = keyframe.frame - sinceLastEvent;
+            keyframe.stateOffset = stateOffset;
+            keyframe.stateSize = in.GetVarint();
+            stateOffset += keyframe.stateSize;
+
+            bool ordered = m_keyframes.empty() ? keyframe.frame == m_info.startFrame
+                                               : keyframe.frame > m_keyframes.back().frame;
+            if (!ordered || sinceLastEvent > keyframe.frame || keyframe.eventOffset > eventBytes || stateOffset > stateBytes) {
+                throw std::runtime_error("Corrupt replay keyframe index");
+            }
+            m_keyframes.push_back(keyframe);
+        }
+
+        if (in.Remaining() != eventBytes + stateBytes) throw std::runtime_error("Replay size does not match its header");
+        m_eventsBegin = in.Position();
+        m_eventsEnd = m_eventsBegin + eventBytes;
+        m_statesBegin = m_eventsEnd;
+    }
+
+    void ReplayPlayer::_loadKeyframe(size_t index) {
+        const Keyframe& keyframe = m_keyframes[index];
+        ByteReader state(m_data.data() + m_statesBegin + keyframe.stateOffset, keyframe.stateSize);
+        m_game->LoadState(state);
+        if (m_game->GetFrame() != keyframe.frame) throw std::runtime_error("Replay keyframe is for the wrong frame");
+
+        m_cursor = m_eventsBegin + keyframe.eventOffset;
+        m_nextEventFrame = keyframe.eventBaseFrame;
+        _readNextEventFrame();
+        _applyEvents();
+    }
+
+    // Turns the delta in front of the cursor into m_nextEventFrame (relative to the previous event)
+    void ReplayPlayer::_readNextEventFrame() {
+        if (m_cursor == m_eventsEnd) {
+            m_nextEventFrame = NO_EVENT;
+            return;
+        }
+        ByteReader in(m_data.data() + m_cursor, m_eventsEnd - m_cursor);
+        m_nextEventFrame += in.GetVarint();
+        m_cursor += in.Position();
+    }
+
+    void ReplayPlayer::_applyEvents() {
+        const uint64_t frame = m_game->GetFrame();
+        while (m_nextEventFrame == frame) {
+            ByteReader in(m_data.data() + m_cursor, m_eventsEnd - m_cursor);
+            uint64_t tag = in.GetVarint();
+            size_t player = static_cast<size_t>(tag / KINDS_PER_PLAYER);
+            uint8_t kind = static_cast<uint8_t>(tag % KINDS_PER_PLAYER);
+            if (player >= m_info.playerCount) throw std::runtime_error("Corrupt replay event");
+
+            if (kind == EVENT_GARBAGE) {
+                m_game->AddGarbage(player, static_cast<int>(in.GetVarint()));
+            } else if (kind == EVENT_GAME_RESET) {
+                m_game->Reset();
+            } else if (kind < INPUT_TYPE_COUNT) {
+                m_game->ApplyInput(player, static_cast<InputType>(kind));
+            } else {
+                throw std::runtime_error("Corrupt replay event");
+            }
+            m_cursor += in.Position();
+            _readNextEventFrame();
+        }
+    }
+
+    void ReplayPlayer::Seek(uint64_t frame) {
+        if (frame < m_info.startFrame || frame > m_info.endFrame) throw std::out_of_range("Seek outside the replay");
+
+        auto after = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), frame,
+                                      [](uint64_t f, const Keyframe& keyframe) { return f < keyframe.frame; });
+        size_t nearest = static_cast<size_t>(after - m_keyframes.begin()) - 1;
+
+        // Going forward within reach of the current position is cheaper than a reload
+        uint64_t current = m_game->GetFrame();
+        if (frame < current || m_keyframes[nearest].frame > current) {
+            _loadKeyframe(nearest);
+        }
+        while (m_game->GetFrame() < frame) {
+            m_game->StepFrame();
+            _applyEvents();
+        }
+    }
+
+    bool ReplayPlayer::Step() {
+        if (m_game->GetFrame() >= m_info.endFrame) return false;
+        m_game->StepFrame();
+        _applyEvents();
+        return true;
+    }
+
+} // namespace tetris
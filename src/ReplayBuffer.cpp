@@ -0,0 +1,73 @@
+#include "TetrisEngine/ReplayBuffer.h"
+#include "TetrisEngine/Board.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace tetris {
+    ReplayBuffer::ReplayBuffer(size_t capacity, size_t featureSize, size_t targetSize)
+        : m_capacity(capacity),
+          m_featureSize(featureSize),
+          m_targetSize(targetSize)
+    {
+        if (capacity == 0) throw std::invalid_argument("ReplayBuffer capacity must be positive");
+        m_samples.resize(capacity);
+    }
+
+    void ReplayBuffer::Push(const float* features, const float* targets) {
+        std::shared_ptr<float[]> block = std::make_shared_for_overwrite<float[]>(m_featureSize + m_targetSize);
+        std::copy_n(features, m_featureSize, block.get());
+        std::copy_n(targets, m_targetSize, block.get() + m_featureSize);
+
+        // The overwritten sample is released after unlocking; a Sample still copying it keeps it alive
+        Block evicted(std::move(block));
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_samples[m_next].swap(evicted);
+            m_next = (m_next + 1) % m_capacity;
+            m_size = std::min(m_size + 1, m_capacity);
+            ++m_pushed;
+        }
+    }
+
+    void ReplayBuffer::Push(const Board& board, float target) {
+        if (m_featureSize != BOARD_FEATURE_SIZE || m_targetSize != 1) {
+            throw std::logic_error("ReplayBuffer::Push(Board) needs BOARD_FEATURE_SIZE features and a scalar target");
+        }
+        float features[BOARD_FEATURE_SIZE];
+        EncodeBoard(board, features);
+        Push(features, &target);
+    }
+
+    bool ReplayBuffer::Sample(size_t batchSize, std::mt19937_64& rng, float* features, float* targets) const {
+        // Pick under the lock, copy outside it
+        thread_local std::vector<Block> picked;
+        picked.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_size == 0) return false;
+
+            std::uniform_int_distribution<size_t> pick(0, m_size - 1);
+            for (size_t i = 0; i < batchSize; ++i) {
+                picked.push_back(m_samples[pick(rng)]);
+            }
+        }
+
+        for (size_t i = 0; i < batchSize; ++i) {
+            const float* sample = picked[i].get();
+            std::copy_n(sample, m_featureSize, features + i * m_featureSize);
+            std::copy_n(sample + m_featureSize, m_targetSize, targets + i * m_targetSize);
+        }
+        picked.clear();
+        return true;
+    }
+
+    size_t ReplayBuffer::Size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_size;
+    }
+
+    uint64_t ReplayBuffer::TotalPushed() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pushed;
+    }
+}
@@ -0,0 +1,177 @@
+#include "TetrisEngine/Rules.h"
+#include <algorithm>
+#include <cmath>
+
+namespace tetris {
+    namespace {
+        std::array<std::array<PieceShape, 4>, 7> BuildShapeTable() {
+            const PieceI i; const PieceJ j; const PieceL l; const PieceO o;
+            const PieceS s; const PieceT t; const PieceZ z;
+            const std::array<const Piece*, 7> pieces = {&i, &j, &l, &o, &s, &t, &z};
+
+            std::array<std::array<PieceShape, 4>, 7> table{};
+            for (size_t p = 0; p < pieces.size(); ++p) {
+                for (uint8_t rot = 0; rot < 4; ++rot) {
+                    uint16_t repr = pieces[p]->GetRepresentation(static_cast<RotationState>(rot));
+                    PieceShape& shape = table[p][rot];
+                    shape.minCol = 3; shape.maxCol = 0; shape.minRow = 3;
+                    for (int cell = 0; cell < 16; ++cell) {
+                        if (!(repr & (1 << (15 - cell)))) continue;
+                        int r = cell / 4, c = cell % 4;
+                        shape.rows[r] |= static_cast<uint16_t>(1u << c);
+                        shape.minCol = static_cast<int8_t>(std::min<int>(shape.minCol, c));
+                        shape.maxCol = static_cast<int8_t>(std::max<int>(shape.maxCol, c));
+                        shape.minRow = static_cast<int8_t>(std::min<int>(shape.minRow, r));
+                    }
+                }
+            }
+            return table;
+        }
+
+        inline int RotationCount(PieceType type) {
+            return type == PieceType::O ? 1 : 4; // O placements repeat in every rotation
+        }
+
+        // x is known to keep the shape inside the walls, so only the sign of the shift varies
+        inline uint16_t ShiftRow(uint16_t bits, int x) {
+            return static_cast<uint16_t>(x >= 0 ? bits << x : bits >> -x);
+        }
+    }
+
+    const PieceShape& GetPieceShape(PieceType type, RotationState rotation) {
+        static const std::array<std::array<PieceShape, 4>, 7> table = BuildShapeTable();
+        return table[static_cast<size_t>(type) - 1][static_cast<size_t>(rotation)];
+    }
+
+    Point GetSpawnPosition(PieceType type) {
+        int row = (type == PieceType::I) ? 19 : 20;
+        return {3, row}; // Centered at column 3
+    }
+
+    bool PieceFits(const uint16_t* rows, const PieceShape& shape, int x, int y) {
+        if (x + shape.minCol < 0 || x + shape.maxCol >= BOARD_WIDTH) return false;
+        for (int r = shape.minRow; r < 4; ++r) {
+            if (!shape.rows[r]) continue;
+            int row = y + r;
+            if (row < 0 || row >= TOTAL_BOARD_HEIGHT) return false;
+            if (rows[row] & ShiftRow(shape.rows[r], x)) return false;
+        }
+        return true;
+    }
+
+    int DropPiece(const uint16_t* rows, const PieceShape& shape, int x, int y) {
+        while (PieceFits(rows, shape, x, y - 1)) --y;
+        return y;
+    }
+
+    void PlacePiece(uint16_t* rows, const PieceShape& shape, int x, int y) {
+        for (int r = shape.minRow; r < 4; ++r) {
+            int row = y + r;
+            if (!shape.rows[r] || row < 0 || row >= TOTAL_BOARD_HEIGHT) continue;
+            rows[row] |= static_cast<uint16_t>(ShiftRow(shape.rows[r], x) & FULL_ROW_MASK);
+        }
+    }
+
+    bool FindPlacement(const uint16_t* rows, PieceType type, int placement, int& x, int& y) {
+        const int rotation = placement / BOARD_WIDTH;
+        if (type == PieceType::EMPTY || placement < 0 || rotation >= RotationCount(type)) return false;
+
+        const PieceShape& shape = GetPieceShape(type, static_cast<RotationState>(rotation));
+        const Point spawn = GetSpawnPosition(type);
+        const int target = placement % BOARD_WIDTH - shape.minCol;
+
+        // Rotate in place, then slide one column at a time at spawn height
+        const int step = target < spawn.x ? -1 : 1;
+        for (int cx = spawn.x; ; cx += step) {
+            if (!PieceFits(rows, shape, cx, spawn.y)) return false;
+            if (cx == target) break;
+        }
+
+        x = target;
+        y = DropPiece(rows, shape, target, spawn.y);
+        return true;
+    }
+
+    void LegalPlacements(const uint16_t* rows, PieceType type, uint8_t* mask) {
+        std::fill_n(mask, PLACEMENT_COUNT, uint8_t{0});
+        if (type == PieceType::EMPTY) return;
+
+        const Point spawn = GetSpawnPosition(type);
+        for (int rotation = 0; rotation < RotationCount(type); ++rotation) {
+            const PieceShape& shape = GetPieceShape(type, static_cast<RotationState>(rotation));
+            uint8_t* rotationMask = mask + rotation * BOARD_WIDTH;
+            for (int x = spawn.x; PieceFits(rows, shape, x, spawn.y); --x) rotationMask[x + shape.minCol] = 1;
+            for (int x = spawn.x + 1; PieceFits(rows, shape, x, spawn.y); ++x) rotationMask[x + shape.minCol] = 1;
+        }
+    }
+
+    int ClearLines(uint16_t* rows) {
+        int write = 0;
+        for (int read = 0; read < TOTAL_BOARD_HEIGHT; ++read) {
+            // A row clears if it is full once it has shifted into the visible area,
+            // same as Board::ClearFullLines
+            if (write < VISIBLE_BOARD_HEIGHT && rows[read] == FULL_ROW_MASK) continue;
+            rows[write++] = rows[read];
+        }
+        int lines = TOTAL_BOARD_HEIGHT - write;
+        std::fill(rows + write, rows + TOTAL_BOARD_HEIGHT, uint16_t{0});
+        return lines;
+    }
+
+    AttackResult ComputeAttack(int tSpin, bool allMiniSpin, int lines, int& backToBack, int& combo) {
+        AttackResult attack;
+        int baseGarbage = 0;
+        bool isB2BEligible = false;
+
+        if (tSpin == 2) {         // full t-spin
+            if (lines > 0){
+                baseGarbage = 2*lines;
+                isB2BEligible = true;
+            }
+        } else if (tSpin == 1) {  // t-spin mini
+            if (lines > 0){
+                baseGarbage = lines - 1;
+                isB2BEligible = true;
+            }
+        } else {
+            if (lines > 1){
+                baseGarbage = 1<<(lines-2);
+                if (lines == 4) isB2BEligible = true;
+            }
+            if (allMiniSpin && lines > 0) {
+                isB2BEligible = true;
+            }
+        }
+
+        // Apply B2B bonus
+        if (isB2BEligible) {
+            if (backToBack > 0) {
+                baseGarbage++;
+            }
+            backToBack++;
+        } else if (lines > 0) {
+            // B2B Charging
+            if (backToBack >= 4){
+                for (int i = 0; i < 3; i++){
+                    attack.sends[attack.count++] = (backToBack%3 > i) ? backToBack/3 + 1 : backToBack/3;
+                }
+            }
+            backToBack = 0;
+        }
+
+        // Apply Combo bonus
+        if (lines > 0){
+            if (baseGarbage == 0){
+                baseGarbage = static_cast<int>(std::log(1.0 + (1.25*combo)));
+            } else {
+                baseGarbage *= static_cast<int>(1 + (0.25*combo));
+            }
+            combo++;
+        } else {
+            combo = 0;
+        }
+
+        if (baseGarbage > 0) attack.sends[attack.count++] = baseGarbage;
+        return attack;
+    }
+}
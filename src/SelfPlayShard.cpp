@@ -0,0 +1,200 @@
+#include "TetrisEngine/SelfPlayShard.h"
+#include "TetrisEngine/ByteStream.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace tetris {
+    namespace {
+        constexpr const char* SHARD_EXTENSION = ".tsp";
+
+        std::string ShardName(const std::string& prefix, uint32_t index) {
+            char number[16];
+            std::snprintf(number, sizeof(number), "%06u", index);
+            return prefix + "-" + number + SHARD_EXTENSION;
+        }
+
+        // First index after every existing prefix-NNNNNN.tsp, so a second run adds to a dataset
+        uint32_t FirstFreeShard(const std::filesystem::path& directory, const std::string& prefix) {
+            uint32_t next = 0;
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+                const std::string name = entry.path().filename().string();
+                if (entry.path().extension() != SHARD_EXTENSION || name.rfind(prefix + "-", 0) != 0) continue;
+                try {
+                    next = std::max(next, static_cast<uint32_t>(std::stoul(name.substr(prefix.size() + 1))) + 1);
+                } catch (const std::exception&) {
+                    // Not one of ours
+                }
+            }
+            return next;
+        }
+    }
+
+    ShardWriter::ShardWriter(std::filesystem::path directory, size_t recordsPerShard, std::string prefix)
+        : m_directory(std::move(directory)),
+          m_prefix(std::move(prefix)),
+          m_recordsPerShard(recordsPerShard)
+    {
+        if (m_recordsPerShard == 0) throw std::invalid_argument("ShardWriter needs at least one record per shard");
+
+        std::error_code ec;
+        std::filesystem::create_directories(m_directory, ec);
+        if (ec) throw std::runtime_error("Cannot create shard directory " + m_directory.string() + ": " + ec.message());
+
+        m_nextShard = FirstFreeShard(m_directory, m_prefix);
+        m_filling.reserve(m_recordsPerShard);
+        m_writing.reserve(m_recordsPerShard);
+        m_thread = std::thread(&ShardWriter::_writerLoop, this);
+    }
+
+    ShardWriter::~ShardWriter() {
+        try {
+            Close();
+        } catch (const std::exception&) {
+            // Destructors must not throw; call Close() directly to see write errors
+        }
+    }
+
+    void ShardWriter::Append(const SelfPlayRecord* records, size_t count) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (count > 0 || m_filling.size() == m_recordsPerShard) {
+            if (!m_error.empty()) throw std::runtime_error("Shard writer failed: " + m_error);
+            if (m_closing) throw std::runtime_error("Shard writer is closed");
+
+            if (m_filling.size() == m_recordsPerShard) {
+                // Both buffers full: this wait is the backpressure the writer puts on generation.
+                // Another producer or Close() may hand the shard over meanwhile, so look again after it.
+                if (!m_writing.empty()) {
+                    auto waitStart = std::chrono::steady_clock::now();
+                    m_producerWake.wait(lock, [this] { return m_writing.empty() || !m_error.empty(); });
+                    m_stats.producerWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+                    continue;
+                }
+                m_filling.swap(m_writing);
+                m_writerWake.notify_one();
+                continue;
+            }
+
+            size_t take = std::min(count, m_recordsPerShard - m_filling.size());
+            m_filling.insert(m_filling.end(), records, records + take);
+            records += take;
+            count -= take;
+        }
+    }
+
+    void ShardWriter::Close() {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_closed) return;
+            // Hand over the partial shard before m_closing lets the writer exit
+            m_producerWake.wait(lock, [this] { return m_writing.empty() || !m_error.empty(); });
+            if (m_error.empty() && !m_filling.empty()) m_filling.swap(m_writing);
+            m_closing = true;
+            m_writerWake.notify_one();
+        }
+        if (m_thread.joinable()) m_thread.join();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        if (!m_error.empty()) throw std::runtime_error("Shard writer failed: " + m_error);
+    }
+
+    ShardWriterStats ShardWriter::GetStats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ShardWriterStats stats = m_stats;
+        stats.bufferedRecords = m_filling.size() + m_writing.size();
+        return stats;
+    }
+
+    void ShardWriter::_writerLoop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_writerWake.wait(lock, [this] { return !m_writing.empty() || m_closing; });
+            if (m_writing.empty()) break;
+
+            // m_writing belongs to this thread until it is cleared, so write without the lock
+            lock.unlock();
+            auto writeStart = std::chrono::steady_clock::now();
+            std::string error;
+            try {
+                _writeShard(m_writing);
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count();
+            lock.lock();
+
+            m_stats.writeSeconds += seconds;
+            if (error.empty()) {
+                m_stats.recordsWritten += m_writing.size();
+                m_stats.shardsWritten += 1;
+                m_stats.bytesWritten += sizeof(ShardHeader) + m_writing.size() * sizeof(SelfPlayRecord);
+            } else {
+                m_error = error;
+            }
+            m_writing.clear();
+            m_producerWake.notify_all();
+            if (!m_error.empty()) break;
+        }
+    }
+
+    void ShardWriter::_writeShard(const std::vector<SelfPlayRecord>& records) {
+        ShardHeader header;
+        header.recordSize = sizeof(SelfPlayRecord);
+        header.recordCount = records.size();
+        header.createdUnixSeconds = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+        WriteFileAtomically(m_directory / ShardName(m_prefix, m_nextShard), [&](std::ostream& file) {
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(SelfPlayRecord)));
+        });
+        ++m_nextShard;
+    }
+
+    void CheckShardHeader(const ShardHeader& header, uint64_t fileSize, const std::filesystem::path& path) {
+        if (header.magic != SHARD_MAGIC) throw std::runtime_error(path.string() + " is not a self-play shard");
+        auto check = [&path](const char* field, uint64_t value, uint64_t expected) {
+            if (value != expected) {
+                throw std::runtime_error("Shard " + path.string() + " has " + field + " " + std::to_string(value)
+                    + ", expected " + std::to_string(expected));
+            }
+        };
+        check("format version", header.version, SHARD_FORMAT_VERSION);
+        check("header size", header.headerSize, sizeof(ShardHeader));
+        check("record size", header.recordSize, sizeof(SelfPlayRecord));
+
+        // Divide rather than multiply: a corrupt count must not overflow its way past the check
+        if (fileSize < sizeof(ShardHeader)
+            || header.recordCount > (fileSize - sizeof(ShardHeader)) / sizeof(SelfPlayRecord)) {
+            throw std::runtime_error("Shard " + path.string() + " is truncated");
+        }
+    }
+
+    std::vector<SelfPlayRecord> ReadShard(const std::filesystem::path& path, ShardHeader* header) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) throw std::runtime_error("Cannot open shard " + path.string());
+
+        ShardHeader fileHeader;
+        if (!file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader))) {
+            throw std::runtime_error("Shard " + path.string() + " is shorter than its header");
+        }
+
+        // Size the read from the file, not from a count a corrupt header could inflate
+        std::error_code error;
+        const uintmax_t fileSize = std::filesystem::file_size(path, error);
+        if (error) throw std::runtime_error("Cannot stat shard " + path.string() + ": " + error.message());
+        CheckShardHeader(fileHeader, fileSize, path);
+
+        std::vector<SelfPlayRecord> records(fileHeader.recordCount);
+        if (!file.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(SelfPlayRecord)))) {
+            throw std::runtime_error("Shard " + path.string() + " is truncated");
+        }
+        if (header) *header = fileHeader;
+        return records;
+    }
+}
@@ -0,0 +1,316 @@
+#include "TetrisEngine/ShardDataset.h"
+#include "TetrisEngine/ByteStream.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace tetris {
+    namespace {
+        constexpr std::array<char, 4> INDEX_MAGIC = {'T', 'S', 'P', 'I'};
+        constexpr uint32_t INDEX_VERSION = 1;
+
+        struct IndexHeader {
+            std::array<char, 4> magic = INDEX_MAGIC;
+            uint32_t version = INDEX_VERSION;
+            uint32_t shardFormatVersion = SHARD_FORMAT_VERSION;
+            uint32_t shardCount = 0;
+        };
+
+        struct IndexEntry {
+            uint64_t recordCount = 0;
+            uint64_t fileSize = 0;
+            uint64_t nameLength = 0;  // followed by the file name, not terminated
+        };
+
+        inline uint64_t Mix(uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        // Keyed bijection on [0, n): a 4-round Feistel network on the smallest even
+        // bit width covering n, cycle-walking until the result lands inside [0, n).
+        // The domain is under 4n, so that takes fewer than four passes on average.
+        uint64_t Permute(uint64_t x, uint64_t n, uint64_t key) {
+            if (n <= 1) return 0;
+            const int half = (std::bit_width(n - 1) + 1) / 2;
+            const uint64_t mask = (uint64_t{1} << half) - 1;
+            do {
+                uint64_t left = x >> half;
+                uint64_t right = x & mask;
+                for (uint64_t round = 0; round < 4; ++round) {
+                    uint64_t next = left ^ (Mix(right ^ (key + round * 0x9e3779b97f4a7c15ull)) & mask);
+                    left = right;
+                    right = next;
+                }
+                x = (left << half) | right;
+            } while (x >= n);
+            return x;
+        }
+
+        ShardHeader ReadShardHeader(const std::filesystem::path& path) {
+            std::ifstream file(path, std::ios::binary);
+            ShardHeader header;
+            if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+                throw std::runtime_error("Shard " + path.string() + " is shorter than its header");
+            }
+            return header;
+        }
+    }
+
+    struct ShardDataset::Shard {
+        std::filesystem::path path;
+        uint64_t fileSize = 0;
+        uint64_t recordCount = 0;
+
+        std::once_flag mapOnce;
+        MappedFile file;
+        const SelfPlayRecord* records = nullptr;
+    };
+
+    ShardDataset::ShardDataset(const std::filesystem::path& directory)
+        : m_directory(directory)
+    {
+        std::vector<std::filesystem::path> paths;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".tsp") paths.push_back(entry.path());
+        }
+        if (ec) throw std::runtime_error("Cannot list " + directory.string() + ": " + ec.message());
+        if (paths.empty()) throw std::runtime_error("No .tsp shards in " + directory.string());
+        std::sort(paths.begin(), paths.end());
+
+        m_indexLoaded = _loadIndex(paths);
+        if (!m_indexLoaded) _buildIndex(paths);
+
+        m_offsets.assign(1, 0);
+        for (const auto& shard : m_shards) m_offsets.push_back(m_offsets.back() + shard->recordCount);
+    }
+
+    ShardDataset::~ShardDataset() = default;
+
+    bool ShardDataset::_loadIndex(const std::vector<std::filesystem::path>& paths) {
+        std::ifstream file(m_directory / DATASET_INDEX_FILE, std::ios::binary);
+        IndexHeader header;
+        if (!file || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+        if (header.magic != INDEX_MAGIC || header.version != INDEX_VERSION
+            || header.shardFormatVersion != SHARD_FORMAT_VERSION || header.shardCount != paths.size()) {
+            return false;
+        }
+
+        std::vector<std::unique_ptr<Shard>> shards;
+        shards.reserve(paths.size());
+        for (const std::filesystem::path& path : paths) {
+            IndexEntry entry;
+            if (!file.read(reinterpret_cast<char*>(&entry), sizeof(entry)) || entry.nameLength > 4096) return false;
+            std::string name(entry.nameLength, '\0');
+            if (!file.read(name.data(), entry.nameLength)) return false;
+
+            // Same name and size as on disk; shards are immutable once renamed into place
+            std::error_code ec;
+            if (name != path.filename().string() || std::filesystem::file_size(path, ec) != entry.fileSize || ec) return false;
+
+            auto shard = std::make_unique<Shard>();
+            shard->path = path;
+            shard->fileSize = entry.fileSize;
+            shard->recordCount = entry.recordCount;
+            shards.push_back(std::move(shard));
+        }
+        m_shards = std::move(shards);
+        return true;
+    }
+
+    void ShardDataset::_buildIndex(const std::vector<std::filesystem::path>& paths) {
+        m_shards.clear();
+        for (const std::filesystem::path& path : paths) {
+            auto shard = std::make_unique<Shard>();
+            shard->path = path;
+            shard->fileSize = std::filesystem::file_size(path);
+            ShardHeader header = ReadShardHeader(path);
+            CheckShardHeader(header, shard->fileSize, path);
+            shard->recordCount = header.recordCount;
+            m_shards.push_back(std::move(shard));
+        }
+
+        // Best effort: a read-only dataset just rebuilds the index on every open
+        try {
+            WriteFileAtomically(m_directory / DATASET_INDEX_FILE, [this](std::ostream& file) {
+                IndexHeader header;
+                header.shardCount = static_cast<uint32_t>(m_shards.size());
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                for (const auto& shard : m_shards) {
+                    const std::string name = shard->path.filename().string();
+                    IndexEntry entry;
+                    entry.recordCount = shard->recordCount;
+                    entry.fileSize = shard->fileSize;
+                    entry.nameLength = name.size();
+                    file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+                    file.write(name.data(), static_cast<std::streamsize>(name.size()));
+                }
+            });
+        } catch (const std::exception&) {
+            // Not writable; rebuilt next time
+        }
+    }
+
+    const SelfPlayRecord* ShardDataset::_mapShard(size_t index) const {
+        Shard& shard = *m_shards[index];
+        // A throw leaves the flag unset, so the next access retries and reports again
+        std::call_once(shard.mapOnce, [&] {
+            MappedFile file(shard.path);
+            if (file.size() < sizeof(ShardHeader)) throw std::runtime_error("Shard " + shard.path.string() + " is shorter than its header");
+            ShardHeader header;
+            std::memcpy(&header, file.data(), sizeof(header));
+            CheckShardHeader(header, file.size(), shard.path);
+            if (header.recordCount != shard.recordCount) {
+                throw std::runtime_error("Shard " + shard.path.string() + " changed since it was indexed");
+            }
+            file.AdviseRandomAccess();
+            shard.records = reinterpret_cast<const SelfPlayRecord*>(file.data() + sizeof(ShardHeader));
+            shard.file = std::move(file);
+        });
+        return shard.records;
+    }
+
+    const SelfPlayRecord& ShardDataset::GetRecord(uint64_t index) const {
+        if (index >= Size()) throw std::out_of_range("Record " + std::to_string(index) + " past the end of the dataset");
+        size_t shard = static_cast<size_t>(std::upper_bound(m_offsets.begin(), m_offsets.end(), index) - m_offsets.begin()) - 1;
+        return _mapShard(shard)[index - m_offsets[shard]];
+    }
+
+    void ShardDataset::Decode(const uint64_t* indices, size_t count, float* observations, float* policies, float* values) const {
+        for (size_t i = 0; i < count; ++i) {
+            const SelfPlayRecord& record = GetRecord(indices[i]);
+
+            PieceType next[FEATURE_NEXT_PIECES];
+            for (size_t k = 0; k < FEATURE_NEXT_PIECES; ++k) next[k] = static_cast<PieceType>(record.pieces[2 + k]);
+            EncodeFeatures(record.rows.data(), static_cast<PieceType>(record.pieces[0]), static_cast<PieceType>(record.pieces[1]),
+                           next, observations + i * BOARD_FEATURE_SIZE);
+
+            if (policies) {
+                float* policy = policies + i * DATASET_POLICY_SIZE;
+                for (size_t a = 0; a < DATASET_POLICY_SIZE; ++a) policy[a] = record.policy[a] * (1.0f / 65535.0f);
+            }
+            if (values) values[i] = record.outcome;
+        }
+    }
+
+    struct DatasetLoader::Slot {
+        std::vector<uint64_t> indices;
+        std::vector<float> observations;
+        std::vector<float> policies;
+        std::vector<float> values;
+        uint64_t batch = 0;
+        bool ready = false;
+    };
+
+    DatasetLoader::DatasetLoader(const ShardDataset& dataset, DatasetLoaderOptions options)
+        : m_dataset(dataset),
+          m_options(options)
+    {
+        if (m_options.batchSize == 0) throw std::invalid_argument("DatasetLoader needs a batch size of at least 1");
+        if (dataset.Size() == 0) throw std::invalid_argument("DatasetLoader needs a non-empty dataset");
+        m_options.threads = std::max<size_t>(m_options.threads, 1);
+        m_options.prefetchBatches = std::max(m_options.prefetchBatches, m_options.threads);
+
+        for (size_t i = 0; i < m_options.prefetchBatches; ++i) {
+            auto slot = std::make_unique<Slot>();
+            slot->indices.resize(m_options.batchSize);
+            slot->observations.resize(m_options.batchSize * BOARD_FEATURE_SIZE);
+            slot->policies.resize(m_options.batchSize * DATASET_POLICY_SIZE);
+            slot->values.resize(m_options.batchSize);
+            m_slots.push_back(std::move(slot));
+        }
+        for (size_t i = 0; i < m_options.threads; ++i) m_workers.emplace_back(&DatasetLoader::_workerLoop, this);
+    }
+
+    DatasetLoader::~DatasetLoader() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_slotFree.notify_all();
+        for (std::thread& worker : m_workers) worker.join();
+    }
+
+    void DatasetLoader::Next(float* observations, float* policies, float* values) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const uint64_t batch = m_nextToServe;
+        Slot& slot = *m_slots[batch % m_slots.size()];
+        auto ready = [&] { return m_error || (slot.ready && slot.batch == batch); };
+        if (!ready()) {
+            auto waitStart = std::chrono::steady_clock::now();
+            m_slotReady.wait(lock, ready);
+            m_waitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+        }
+        if (m_error) std::rethrow_exception(m_error);
+
+        // Workers never touch a ready slot, so copy out without the lock
+        lock.unlock();
+        std::copy(slot.observations.begin(), slot.observations.end(), observations);
+        if (policies) std::copy(slot.policies.begin(), slot.policies.end(), policies);
+        if (values) std::copy(slot.values.begin(), slot.values.end(), values);
+        lock.lock();
+
+        slot.ready = false;
+        ++m_nextToServe;
+        m_slotFree.notify_all();
+    }
+
+    DatasetLoaderStats DatasetLoader::GetStats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        DatasetLoaderStats stats;
+        stats.batchesServed = m_nextToServe;
+        stats.epoch = m_nextToServe * m_options.batchSize / m_dataset.Size();
+        stats.consumerWaitSeconds = m_waitSeconds;
+        return stats;
+    }
+
+    void DatasetLoader::_workerLoop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop && !m_error) {
+            const uint64_t batch = m_nextToFill++;
+            m_slotFree.wait(lock, [&] { return m_stop || m_error || batch < m_nextToServe + m_slots.size(); });
+            if (m_stop || m_error) break;
+
+            Slot& slot = *m_slots[batch % m_slots.size()];
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                _fill(slot, batch);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+
+            if (error) {
+                if (!m_error) m_error = error;
+            } else {
+                slot.batch = batch;
+                slot.ready = true;
+            }
+            m_slotReady.notify_all();
+        }
+        m_slotReady.notify_all();
+    }
+
+    void DatasetLoader::_fill(Slot& slot, uint64_t batch) {
+        const uint64_t size = m_dataset.Size();
+        const uint64_t first = batch * m_options.batchSize;
+        for (size_t i = 0; i < m_options.batchSize; ++i) {
+            const uint64_t position = first + i;
+            const uint64_t epoch = position / size;
+            slot.indices[i] = Permute(position % size, size, Mix(m_options.seed ^ Mix(epoch + 1)));
+        }
+
+        // Decoding in index order keeps page faults within a shard sequential-ish
+        std::sort(slot.indices.begin(), slot.indices.end());
+        m_dataset.Decode(slot.indices.data(), slot.indices.size(),
+                         slot.observations.data(), slot.policies.data(), slot.values.data());
+    }
+}
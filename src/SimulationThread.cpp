@@ -0,0 +1,272 @@
+#include "TetrisEngine/SimulationThread.h"
+#include "TetrisEngine/PerfStats.h"
+#include "TetrisEngine/Piece.h"
+#include "TetrisEngine/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+namespace tetris {
+    namespace {
+        // Behind by more than this, the simulation skips ahead instead of fast-forwarding
+        constexpr uint64_t MAX_FRAME_BACKLOG = 10;
+
+        // Room for a burst of key changes between two wake-ups
+        constexpr size_t KEY_QUEUE_CAPACITY = 256;
+
+        using Clock = std::chrono::steady_clock;
+
+        Clock::duration ToDuration(double seconds) {
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        }
+
+        Clock::time_point ToTimePoint(int64_t nanoseconds) {
+            return Clock::time_point(std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(nanoseconds)));
+        }
+
+        // Hash of everything the game window draws; timers and accumulators are left out
+        uint64_t ShownSignature(const Game& game) {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            auto mix = [&](uint64_t value) { hash = (hash ^ value) * 0x100000001b3ull; };
+            for (size_t i = 0; i < game.playerCount(); ++i) {
+                const Board& board = game.getBoard(i);
+                mix(board.GetGridVersion());
+                if (const Piece* piece = board.GetCurrentPiece()) {
+                    mix(static_cast<uint64_t>(piece->GetType()));
+                    mix(static_cast<uint64_t>(piece->GetCurrentRotation()));
+                }
+                const Point position = board.GetCurrentPiecePosition();
+                mix(static_cast<uint32_t>(position.x));
+                mix(static_cast<uint32_t>(position.y));
+                mix(static_cast<uint64_t>(board.GetHeldPieceType()));
+                mix(board.CanHold());
+                mix(static_cast<uint32_t>(board.GetGarbageQueue()));
+                mix(static_cast<uint32_t>(board.GetScore()));
+                mix(static_cast<uint32_t>(board.GetLinesCleared()));
+                mix(board.IsGameOver());
+            }
+            return hash;
+        }
+    }
+
+    SimulationThread::SimulationThread(Game& game, const HandlingSettings& handling)
+        : m_game(game), m_stats(SimulationStats{0, 0.0, 0.0, std::vector<float>(game.playerCount(), 0.0f)}),
+          m_keys(KEY_QUEUE_CAPACITY) {
+        for (size_t player = 0; player < game.playerCount(); ++player) m_handlers.emplace_back(player, handling);
+        m_shownSignature = ShownSignature(game);
+        _publish();
+    }
+
+    SimulationThread::~SimulationThread() {
+        Stop();
+    }
+
+    void SimulationThread::Start() {
+        if (m_thread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = false;
+        }
+        m_thread = std::thread(&SimulationThread::_run, this);
+    }
+
+    void SimulationThread::Stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    void SimulationThread::Submit(const GameCommand& command) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_commands.push_back(command);
+        }
+        m_wake.notify_one();
+    }
+
+    bool SimulationThread::PushKey(const KeyEvent& event) {
+        if (event.player >= m_handlers.size()) throw std::out_of_range("Invalid player for key event");
+        if (!m_keys.TryPush(event)) return false;
+
+        // The queue needs no lock, but taking the mutex once orders this push against the
+        // simulation's check-then-sleep, so the wake-up cannot fall in between and be lost
+        { std::lock_guard<std::mutex> lock(m_mutex); }
+        m_wake.notify_one();
+        return true;
+    }
+
+    bool SimulationThread::UpdateView(Game& view) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_error) std::rethrow_exception(std::exchange(m_error, nullptr));
+        }
+        if (!m_snapshots.Update()) return false;
+
+        const Publication& publication = m_snapshots.Read();
+        ByteReader in(publication.state.data(), publication.state.size());
+        view.LoadState(in);
+        m_viewInputNs = publication.inputNs;
+        return true;
+    }
+
+    int64_t SimulationThread::TakeViewInputNs() {
+        if (m_viewInputNs <= m_reportedInputNs) return 0;
+        m_reportedInputNs = m_viewInputNs;
+        return m_viewInputNs;
+    }
+
+    const SimulationStats& SimulationThread::PollStats() {
+        m_stats.Update();
+        return m_stats.Read();
+    }
+
+    void SimulationThread::_apply(const GameCommand& command) {
+        switch (command.kind) {
+            case GameCommand::Kind::INPUT:       m_game.ApplyInput(command.player, command.input); break;
+            case GameCommand::Kind::ADD_GARBAGE: m_game.AddGarbage(command.player, command.lines); break;
+            case GameCommand::Kind::RESET_GAME:  m_game.Reset(); break;
+            case GameCommand::Kind::RELEASE_KEYS:
+                for (InputHandler& handler : m_handlers) handler.ReleaseAll();
+                break;
+        }
+    }
+
+    void SimulationThread::_publish() {
+        m_writer.Clear();
+        m_game.SaveState(m_writer);
+        Publication& out = m_snapshots.WriteBuffer();
+        out.state.assign(m_writer.Data(), m_writer.Data() + m_writer.Size());
+        out.inputNs = m_appliedInputNs;
+        m_snapshots.Publish();
+    }
+
+    void SimulationThread::_publishStats(uint64_t frames, int64_t stepNs, uint64_t allocations) {
+        SimulationStats& stats = m_stats.WriteBuffer();
+        stats.frames = m_framesSimulated.load(std::memory_order_relaxed);
+        stats.stepMs = stepNs / 1e6 / frames;
+        stats.allocationsPerFrame = static_cast<double>(allocations) / frames;
+        for (size_t player = 0; player < stats.boardUs.size(); ++player) {
+            stats.boardUs[player] = m_game.GetBoardStepNs(player) / 1e3f;
+        }
+        m_stats.Publish();
+    }
+
+    void SimulationThread::_notifyIfChanged() {
+        const uint64_t signature = ShownSignature(m_game);
+        if (signature == m_shownSignature) return;
+        m_shownSignature = signature;
+        if (m_onChange) m_onChange();
+    }
+
+    void SimulationThread::_run() {
+        TETRIS_PROFILE_THREAD("simulation");
+        const auto frameTime = ToDuration(Game::FRAME_SECONDS);
+        auto nextFrame = Clock::now() + frameTime;
+
+        // Logical time of a wall-clock instant: the step due at nextFrame ends frame GetFrame() + 1
+        auto logicalTime = [&](Clock::time_point wall) {
+            return (m_game.GetFrame() + 1) * Game::FRAME_SECONDS - std::chrono::duration<double>(nextFrame - wall).count();
+        };
+        auto inputsSent = [&] {
+            uint64_t sent = 0;
+            for (const InputHandler& handler : m_handlers) sent += handler.GetInputsSent();
+            return sent;
+        };
+
+        // Allocations are charged to the frames that follow them, commands and keys included
+        uint64_t allocationsAt = GetThreadAllocations();
+
+        try {
+            for (;;) {
+                // Sleep until the next frame, the next key repeat or something to apply
+                const double frameEnd = (m_game.GetFrame() + 1) * Game::FRAME_SECONDS;
+                auto deadline = nextFrame;
+                for (const InputHandler& handler : m_handlers) {
+                    const double due = handler.NextDeadline();
+                    if (due < frameEnd) deadline = std::min(deadline, nextFrame - ToDuration(frameEnd - due));
+                }
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_wake.wait_until(lock, deadline, [this] { return m_stop || !m_commands.empty() || !m_keys.Empty(); });
+                    if (m_stop) return;
+                    m_applying.swap(m_commands);
+                }
+
+                // Commands take effect at once; a frame only runs when its time has come
+                bool changed = !m_applying.empty();
+                for (const GameCommand& command : m_applying) _apply(command);
+                m_applying.clear();
+
+                const auto now = Clock::now();
+                const double logicalNow = logicalTime(now);
+                KeyEvent event;
+                while (m_keys.TryPop(event)) {
+                    m_pendingKeys.emplace_back(std::min(logicalTime(ToTimePoint(event.timeNs)), logicalNow), event);
+                }
+
+                uint64_t due = 0;
+                bool dropped = false;
+                if (now >= nextFrame) {
+                    due = static_cast<uint64_t>((now - nextFrame) / frameTime) + 1;
+                    if (due > MAX_FRAME_BACKLOG) {
+                        m_framesDropped.fetch_add(due - MAX_FRAME_BACKLOG, std::memory_order_relaxed);
+                        due = MAX_FRAME_BACKLOG;
+                        dropped = true;
+                    }
+                }
+
+                // Keys and repeats that belong before a frame boundary are handled before that frame's gravity
+                const uint64_t sentBefore = inputsSent();
+                size_t key = 0;
+                int64_t stepNs = 0;
+                for (uint64_t frame = 0; frame < due; ++frame) {
+                    const double boundary = (m_game.GetFrame() + 1) * Game::FRAME_SECONDS;
+                    for (; key < m_pendingKeys.size() && m_pendingKeys[key].first <= boundary; ++key) {
+                        const KeyEvent& pending = m_pendingKeys[key].second;
+                        m_handlers[pending.player].OnKey(m_game, pending.input, pending.pressed, m_pendingKeys[key].first);
+                        if (pending.pressed) m_appliedInputNs = std::max(m_appliedInputNs, pending.timeNs);
+                    }
+                    for (InputHandler& handler : m_handlers) handler.Advance(m_game, boundary);
+                    const auto stepStart = Clock::now();
+                    m_game.StepFrame();
+                    stepNs += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - stepStart).count();
+                }
+
+                if (due > 0) {
+                    // Time beyond the backlog cap is dropped: real time now is the start of the next frame
+                    nextFrame = dropped ? now + frameTime : nextFrame + frameTime * static_cast<Clock::rep>(due);
+                    m_framesSimulated.fetch_add(due, std::memory_order_relaxed);
+                }
+
+                const double settled = std::min(logicalNow, logicalTime(now));
+                for (; key < m_pendingKeys.size(); ++key) {
+                    const KeyEvent& pending = m_pendingKeys[key].second;
+                    m_handlers[pending.player].OnKey(m_game, pending.input, pending.pressed, std::min(m_pendingKeys[key].first, settled));
+                    if (pending.pressed) m_appliedInputNs = std::max(m_appliedInputNs, pending.timeNs);
+                }
+                m_pendingKeys.clear();
+                for (InputHandler& handler : m_handlers) handler.Advance(m_game, settled);
+
+                if (changed || due > 0 || inputsSent() != sentBefore) {
+                    _publish();
+                    _notifyIfChanged();
+                }
+                if (due > 0) {
+                    const uint64_t allocations = GetThreadAllocations();
+                    _publishStats(due, stepNs, allocations - allocationsAt);
+                    allocationsAt = allocations;
+                }
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_error = std::current_exception();
+            }
+            if (m_onChange) m_onChange();   // so a sleeping render loop gets to see the error
+        }
+    }
+}
@@ -0,0 +1,171 @@
+#include "TetrisEngine/Spectator.h"
+#include "TetrisEngine/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <utility>
+
+namespace tetris {
+    namespace {
+        // Most frames a thread steps between publications; also how far behind
+        // real time it may fall before it gives up catching up
+        constexpr uint64_t MAX_BATCH_FRAMES = Game::FRAMES_PER_SECOND / 4;
+
+        // Frames per publication when running as fast as possible
+        constexpr uint64_t UNTHROTTLED_BATCH_FRAMES = 4;
+
+        // A finished match stays up this long so it can be seen ending
+        constexpr uint32_t HOLD_FRAMES = Game::FRAMES_PER_SECOND;
+    }
+
+    SpectatorFeed::SpectatorFeed(std::vector<const Bot*> bots, const SpectatorConfig& config)
+        : m_bots(std::move(bots)), m_config(config), m_tileCount(config.matches * config.playersPerMatch)
+    {
+        if (m_bots.empty() || std::find(m_bots.begin(), m_bots.end(), nullptr) != m_bots.end()) {
+            throw std::invalid_argument("SpectatorFeed needs at least one bot");
+        }
+        if (config.matches == 0) throw std::invalid_argument("SpectatorFeed needs at least one match");
+        if (config.playersPerMatch == 0 || config.playersPerMatch > MATCH_MAX_PLAYERS) {
+            throw std::invalid_argument("SpectatorFeed matches need one or two players");
+        }
+
+        size_t threads = config.threads;
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        threads = std::clamp<size_t>(threads, 1, config.matches);
+
+        // Everything is laid out before any thread starts, so nothing moves under one
+        m_workers.resize(threads);
+        for (size_t w = 0; w < threads; ++w) {
+            Worker& worker = m_workers[w];
+            worker.firstSlot = w * config.matches / threads;
+            const size_t slotCount = (w + 1) * config.matches / threads - worker.firstSlot;
+            worker.slots.resize(slotCount);
+            for (size_t i = 0; i < slotCount; ++i) _startMatch(worker.slots[i], worker.firstSlot + i);
+
+            worker.tiles = std::make_unique<TripleBuffer<std::vector<SpectatorTile>>>(
+                std::vector<SpectatorTile>(slotCount * config.playersPerMatch));
+            for (size_t t = 0; t < slotCount * config.playersPerMatch; ++t) m_tileOwners.emplace_back(w, t);
+        }
+        for (Worker& worker : m_workers) worker.thread = std::thread(&SpectatorFeed::_run, this, std::ref(worker));
+    }
+
+    SpectatorFeed::~SpectatorFeed() {
+        m_stop.store(true, std::memory_order_relaxed);
+        for (Worker& worker : m_workers) {
+            if (worker.thread.joinable()) worker.thread.join();
+        }
+    }
+
+    bool SpectatorFeed::Poll() {
+        {
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            if (m_error) std::rethrow_exception(std::exchange(m_error, nullptr));
+        }
+        bool changed = false;
+        for (Worker& worker : m_workers) changed |= worker.tiles->Update();
+        return changed;
+    }
+
+    const SpectatorTile& SpectatorFeed::GetTile(size_t tile) const {
+        const auto& [worker, index] = m_tileOwners.at(tile);
+        return m_workers[worker].tiles->Read()[index];
+    }
+
+    BotSearchStats SpectatorFeed::GetSearchStats() const noexcept {
+        BotSearchStats stats;
+        stats.decisions = m_decisions.load(std::memory_order_relaxed);
+        stats.nodes = m_nodes.load(std::memory_order_relaxed);
+        stats.searchNs = m_searchNs.load(std::memory_order_relaxed);
+        stats.depth = m_searchDepth.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void SpectatorFeed::_startMatch(Slot& slot, size_t slotIndex) {
+        const size_t players = m_config.playersPerMatch;
+        const Bot* seats[MATCH_MAX_PLAYERS] = {};
+        for (size_t seat = 0; seat < players; ++seat) seats[seat] = m_bots[(slotIndex * players + seat) % m_bots.size()];
+
+        slot.arena.Start(seats, players, MatchSeed(m_config.seed, slot.match * m_config.matches + slotIndex), m_config.match);
+        ++slot.match;
+    }
+
+    void SpectatorFeed::_run(Worker& worker) {
+        TETRIS_PROFILE_THREAD("spectator worker");
+        using Clock = std::chrono::steady_clock;
+        const double framesPerSecond = Game::FRAMES_PER_SECOND * m_config.speed;
+        const auto start = Clock::now();
+        uint64_t frames = 0;
+
+        try {
+            while (!m_stop.load(std::memory_order_relaxed)) {
+                uint64_t batch = UNTHROTTLED_BATCH_FRAMES;
+                if (m_config.speed > 0.0) {
+                    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+                    const uint64_t target = static_cast<uint64_t>(elapsed * framesPerSecond);
+                    if (target <= frames) {
+                        std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(
+                            std::chrono::duration<double>((frames + 1) / framesPerSecond)));
+                        continue;
+                    }
+                    // Too slow for real time: run behind rather than spiral
+                    frames = std::max(frames, target - std::min(target, MAX_BATCH_FRAMES));
+                    batch = target - frames;
+                }
+
+                for (uint64_t frame = 0; frame < batch; ++frame) {
+                    for (size_t i = 0; i < worker.slots.size(); ++i) {
+                        Slot& slot = worker.slots[i];
+                        if (slot.holdFrames > 0) {
+                            if (--slot.holdFrames == 0) _startMatch(slot, worker.firstSlot + i);
+                        } else if (!slot.arena.Step()) {
+                            slot.holdFrames = HOLD_FRAMES;
+                            ++slot.finished;
+                            m_matchesPlayed.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                }
+                frames += batch;
+                m_framesSimulated.fetch_add(batch * worker.slots.size(), std::memory_order_relaxed);
+                _publish(worker);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_errorMutex);
+            if (!m_error) m_error = std::current_exception();
+        }
+    }
+
+    void SpectatorFeed::_publish(Worker& worker) {
+        std::vector<SpectatorTile>& tiles = worker.tiles->WriteBuffer();
+        const size_t players = m_config.playersPerMatch;
+        for (size_t i = 0; i < worker.slots.size(); ++i) {
+            const Slot& slot = worker.slots[i];
+            const MatchResult result = slot.arena.GetResult();
+            for (size_t seat = 0; seat < players; ++seat) {
+                SpectatorTile& tile = tiles[i * players + seat];
+                slot.arena.GetGame().getBoard(seat).GetRenderableState(tile.cells.data());
+                tile.pieces = result.players[seat].pieces;
+                tile.lines = result.players[seat].lines;
+                tile.attack = result.players[seat].attack;
+                tile.toppedOut = result.players[seat].toppedOut;
+                tile.matchesPlayed = slot.finished;
+                tile.lastAction = static_cast<int16_t>(slot.arena.GetLastAction(seat, tile.lastPiece));
+            }
+        }
+        worker.tiles->Publish();
+
+        // Totals only grow, so each thread adds what it has searched since it last published
+        BotSearchStats total;
+        for (const Slot& slot : worker.slots) {
+            const BotSearchStats& stats = slot.arena.GetSearchStats();
+            total.decisions += stats.decisions;
+            total.nodes += stats.nodes;
+            total.searchNs += stats.searchNs;
+            total.depth = std::max(total.depth, stats.depth);
+        }
+        m_decisions.fetch_add(total.decisions - worker.reported.decisions, std::memory_order_relaxed);
+        m_nodes.fetch_add(total.nodes - worker.reported.nodes, std::memory_order_relaxed);
+        m_searchNs.fetch_add(total.searchNs - worker.reported.searchNs, std::memory_order_relaxed);
+        if (total.depth > m_searchDepth.load(std::memory_order_relaxed)) m_searchDepth.store(total.depth, std::memory_order_relaxed);
+        worker.reported = total;
+    }
+}
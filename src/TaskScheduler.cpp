@@ -0,0 +1,137 @@
+#include "TetrisEngine/TaskScheduler.h"
+#include "TetrisEngine/Profiler.h"
+#include <algorithm>
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace tetris {
+    namespace {
+        // Which scheduler and worker the current thread belongs to, if any
+        thread_local const TaskScheduler* CurrentScheduler = nullptr;
+        thread_local size_t CurrentWorker = 0;
+
+        void PinToCpu(std::thread& thread, size_t cpu) {
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);  // best effort
+#else
+            (void)thread;
+            (void)cpu;
+#endif
+        }
+    }
+
+    TaskScheduler::TaskScheduler(size_t threads, bool pinThreads) {
+        const size_t cpus = std::max(1u, std::thread::hardware_concurrency());
+        if (threads == 0) threads = cpus;
+
+        m_queues.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) m_queues.push_back(std::make_unique<WorkerQueue>());
+
+        m_workers.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            m_workers.emplace_back(&TaskScheduler::_workerLoop, this, i);
+            if (pinThreads) PinToCpu(m_workers.back(), i % cpus);
+        }
+    }
+
+    TaskScheduler::~TaskScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& worker : m_workers) worker.join();
+    }
+
+    void TaskScheduler::Submit(Task task) {
+        m_unfinished.fetch_add(1, std::memory_order_relaxed);
+        size_t worker = CurrentScheduler == this ? CurrentWorker : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+        _push(worker, std::move(task));
+    }
+
+    void TaskScheduler::_push(size_t worker, Task&& task) {
+        // Counted before the task is visible, so a thief taking it at once cannot drive m_queued
+        // below zero; under m_mutex, so a worker about to sleep cannot miss it
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queued.fetch_add(1, std::memory_order_relaxed);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_queues[worker]->mutex);
+            m_queues[worker]->tasks.push_back(std::move(task));
+        }
+        m_wake.notify_one();
+    }
+
+    void TaskScheduler::Wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_unfinished.load(std::memory_order_acquire) == 0; });
+        if (m_error) {
+            std::exception_ptr error = m_error;
+            m_error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    bool TaskScheduler::_takeTask(size_t worker, Task& task) {
+        // Own deque first, newest task: it is the one most likely still in cache
+        {
+            WorkerQueue& own = *m_queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+
+        // Then the oldest task of the next busy worker
+        for (size_t offset = 1; offset < m_queues.size(); ++offset) {
+            WorkerQueue& victim = *m_queues[(worker + offset) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                m_steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void TaskScheduler::_workerLoop(size_t worker) {
+        TETRIS_PROFILE_THREAD("scheduler worker");
+        CurrentScheduler = this;
+        CurrentWorker = worker;
+
+        for (;;) {
+            Task task;
+            if (!_takeTask(worker, task)) {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this] { return m_stop || m_queued.load(std::memory_order_relaxed) > 0; });
+                if (m_stop) return;
+                continue;
+            }
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+
+            try {
+                task(worker);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error) m_error = std::current_exception();
+            }
+            task = nullptr;  // release captures before reporting completion
+
+            if (m_unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_done.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,182 @@
+#include "TetrisEngine/TetrisSim.h"
+#include "TetrisEngine/ShardDataset.h"
+#include "TetrisEngine/VecEnv.h"
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+struct TetrisSim {
+    tetris::VecEnv env;
+};
+
+struct TetrisDataset {
+    std::unique_ptr<tetris::ShardDataset> dataset;
+    std::unique_ptr<tetris::DatasetLoader> loader;  // declared last: its threads read dataset
+};
+
+namespace {
+    thread_local std::string lastError;
+
+    // No exception may cross the C boundary
+    template <typename F>
+    int Guarded(F&& body) {
+        try {
+            body();
+            lastError.clear();
+            return 0;
+        } catch (const std::exception& e) {
+            lastError = e.what();
+        } catch (...) {
+            lastError = "unknown error";
+        }
+        return -1;
+    }
+
+    bool CheckSim(const TetrisSim* sim) {
+        if (!sim) lastError = "null TetrisSim handle";
+        return sim != nullptr;
+    }
+
+    bool CheckDataset(const TetrisDataset* dataset) {
+        if (!dataset) lastError = "null TetrisDataset handle";
+        return dataset != nullptr;
+    }
+
+    bool CheckBuffer(const void* buffer, const char* name) {
+        if (!buffer) lastError = std::string("null ") + name + " buffer";
+        return buffer != nullptr;
+    }
+}
+
+extern "C" {
+
+uint32_t tetris_sim_abi_version(void) {
+    return TETRIS_SIM_ABI_VERSION;
+}
+
+uint32_t tetris_sim_observation_size(void) {
+    return static_cast<uint32_t>(tetris::VecEnv::OBSERVATION_SIZE);
+}
+
+uint32_t tetris_sim_action_count(void) {
+    return static_cast<uint32_t>(tetris::VecEnv::ACTION_COUNT);
+}
+
+TetrisSim* tetris_sim_create(uint32_t num_envs, uint32_t threads, uint32_t max_pieces, float top_out_reward) {
+    TetrisSim* sim = nullptr;
+    Guarded([&] {
+        tetris::VecEnvConfig config;
+        config.numEnvs = num_envs;
+        config.threads = threads;
+        config.maxPieces = max_pieces;
+        config.topOutReward = top_out_reward;
+        sim = new TetrisSim{tetris::VecEnv(config)};
+    });
+    return sim;
+}
+
+void tetris_sim_destroy(TetrisSim* sim) {
+    delete sim;
+}
+
+uint32_t tetris_sim_num_envs(const TetrisSim* sim) {
+    return sim ? static_cast<uint32_t>(sim->env.Size()) : 0;
+}
+
+int tetris_sim_reset(TetrisSim* sim, const uint64_t* seeds, float* observations, uint8_t* masks) {
+    if (!CheckSim(sim) || !CheckBuffer(seeds, "seeds")) return -1;
+    return Guarded([&] { sim->env.Reset(seeds, observations, masks); });
+}
+
+int tetris_sim_step(TetrisSim* sim, const int32_t* actions, float* observations, float* rewards, uint8_t* dones, uint8_t* masks) {
+    if (!CheckSim(sim) || !CheckBuffer(actions, "actions") || !CheckBuffer(rewards, "rewards") || !CheckBuffer(dones, "dones")) {
+        return -1;
+    }
+    return Guarded([&] { sim->env.Step(actions, observations, rewards, dones, masks); });
+}
+
+int tetris_sim_legal_moves(const TetrisSim* sim, uint8_t* masks) {
+    if (!CheckSim(sim) || !CheckBuffer(masks, "masks")) return -1;
+    return Guarded([&] { sim->env.Observe(nullptr, masks); });
+}
+
+int tetris_sim_encode(const TetrisSim* sim, float* observations) {
+    if (!CheckSim(sim) || !CheckBuffer(observations, "observations")) return -1;
+    return Guarded([&] { sim->env.Observe(observations, nullptr); });
+}
+
+int tetris_sim_get_state(const TetrisSim* sim, uint16_t* rows, uint8_t* pieces) {
+    if (!CheckSim(sim)) return -1;
+    return Guarded([&] {
+        const tetris::VecEnv& env = sim->env;
+        for (size_t e = 0; e < env.Size(); ++e) {
+            if (rows) {
+                const uint16_t* src = env.GetRows(e);
+                std::copy(src, src + tetris::TOTAL_BOARD_HEIGHT, rows + e * tetris::TOTAL_BOARD_HEIGHT);
+            }
+            if (pieces) {
+                uint8_t* out = pieces + e * (2 + tetris::FEATURE_NEXT_PIECES);
+                tetris::PieceType next[tetris::FEATURE_NEXT_PIECES];
+                env.GetNextQueue(e, next);
+                out[0] = static_cast<uint8_t>(env.GetCurrentPiece(e));
+                out[1] = static_cast<uint8_t>(env.GetHeldPiece(e));
+                for (size_t i = 0; i < tetris::FEATURE_NEXT_PIECES; ++i) out[2 + i] = static_cast<uint8_t>(next[i]);
+            }
+        }
+    });
+}
+
+int tetris_sim_encode_positions(const uint16_t* rows, const uint8_t* pieces, uint32_t count, float* observations) {
+    if (count > 0 && (!CheckBuffer(rows, "rows") || !CheckBuffer(pieces, "pieces") || !CheckBuffer(observations, "observations"))) {
+        return -1;
+    }
+    return Guarded([&] {
+        constexpr size_t PIECES = 2 + tetris::FEATURE_NEXT_PIECES;
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint8_t* p = pieces + i * PIECES;
+            tetris::PieceType next[tetris::FEATURE_NEXT_PIECES];
+            for (size_t k = 0; k < tetris::FEATURE_NEXT_PIECES; ++k) next[k] = static_cast<tetris::PieceType>(p[2 + k]);
+            tetris::EncodeFeatures(rows + i * tetris::VISIBLE_BOARD_HEIGHT,
+                                   static_cast<tetris::PieceType>(p[0]), static_cast<tetris::PieceType>(p[1]),
+                                   next, observations + i * tetris::BOARD_FEATURE_SIZE);
+        }
+    });
+}
+
+TetrisDataset* tetris_dataset_open(const char* directory, uint32_t batch_size, uint32_t threads, uint64_t seed) {
+    TetrisDataset* handle = nullptr;
+    Guarded([&] {
+        if (!directory) throw std::invalid_argument("null dataset directory");
+        auto dataset = std::make_unique<TetrisDataset>();
+        dataset->dataset = std::make_unique<tetris::ShardDataset>(directory);
+
+        tetris::DatasetLoaderOptions options;
+        options.batchSize = batch_size;
+        options.threads = threads;
+        options.seed = seed;
+        dataset->loader = std::make_unique<tetris::DatasetLoader>(*dataset->dataset, options);
+        handle = dataset.release();
+    });
+    return handle;
+}
+
+void tetris_dataset_close(TetrisDataset* dataset) {
+    delete dataset;
+}
+
+uint64_t tetris_dataset_size(const TetrisDataset* dataset) {
+    return dataset ? dataset->dataset->Size() : 0;
+}
+
+int tetris_dataset_next(TetrisDataset* dataset, float* observations, float* policies, float* values) {
+    if (!CheckDataset(dataset) || !CheckBuffer(observations, "observations")) return -1;
+    return Guarded([&] { dataset->loader->Next(observations, policies, values); });
+}
+
+const char* tetris_sim_last_error(void) {
+    return lastError.c_str();
+}
+
+}
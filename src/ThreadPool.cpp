@@ -0,0 +1,85 @@
+#include "TetrisEngine/ThreadPool.h"
+#include "TetrisEngine/Profiler.h"
+#include <algorithm>
+
+namespace tetris {
+    ThreadPool::ThreadPool(size_t threads) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        m_workers.reserve(threads - 1);
+        for (size_t i = 1; i < threads; ++i) {
+            m_workers.emplace_back(&ThreadPool::_workerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& worker : m_workers) worker.join();
+    }
+
+    void ThreadPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& body) {
+        if (count == 0) return;
+        grain = std::max<size_t>(grain, 1);
+
+        // Not worth waking anyone for a single chunk
+        if (m_workers.empty() || count <= grain) {
+            body(0, count);
+            return;
+        }
+
+        std::lock_guard<std::mutex> call(m_callMutex);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_body = &body;
+            m_count = count;
+            m_grain = grain;
+            m_next.store(0, std::memory_order_relaxed);
+            m_error = nullptr;
+            m_busy = m_workers.size();
+            ++m_generation;
+        }
+        m_wake.notify_all();
+
+        _runChunks();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_busy == 0; });
+        m_body = nullptr;
+        if (m_error) std::rethrow_exception(m_error);
+    }
+
+    void ThreadPool::_runChunks() {
+        for (;;) {
+            size_t begin = m_next.fetch_add(m_grain, std::memory_order_relaxed);
+            if (begin >= m_count) return;
+            try {
+                (*m_body)(begin, std::min(begin + m_grain, m_count));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error) m_error = std::current_exception();
+                m_next.store(m_count, std::memory_order_relaxed); // skip the remaining chunks
+            }
+        }
+    }
+
+    void ThreadPool::_workerLoop() {
+        TETRIS_PROFILE_THREAD("pool worker");
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+                if (m_stop) return;
+                seen = m_generation;
+            }
+
+            _runChunks();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_busy == 0) m_done.notify_one();
+        }
+    }
+}
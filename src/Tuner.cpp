@@ -0,0 +1,373 @@
+#include "TetrisEngine/Tuner.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace tetris {
+    namespace {
+        constexpr char CHECKPOINT_MAGIC[4] = {'T', 'T', 'U', 'N'};
+        constexpr uint16_t CHECKPOINT_VERSION = 1;
+        constexpr size_t MAX_DIMENSION = 64;
+
+        // Games handed to a worker at a time
+        constexpr uint32_t GAMES_PER_TASK = 8;
+
+        float HeuristicWeights::* const TUNED_FIELDS[TUNED_WEIGHT_COUNT] = {
+            &HeuristicWeights::aggregateHeight,
+            &HeuristicWeights::lines,
+            &HeuristicWeights::holes,
+            &HeuristicWeights::bumpiness,
+            &HeuristicWeights::attack,
+        };
+
+        // Standard normal draws from a generator the standard fully specifies, so the
+        // same seed samples the same candidates with every standard library
+        class NormalSource {
+            public:
+                explicit NormalSource(uint64_t seed) : m_engine(seed) {}
+
+                double Next() {
+                    if (m_hasSpare) {
+                        m_hasSpare = false;
+                        return m_spare;
+                    }
+                    // Box-Muller; u1 in (0, 1] keeps the log finite
+                    const double u1 = ((m_engine() >> 11) + 1) * 0x1.0p-53;
+                    const double u2 = (m_engine() >> 11) * 0x1.0p-53;
+                    const double radius = std::sqrt(-2.0 * std::log(u1));
+                    const double angle = 2.0 * 3.14159265358979323846 * u2;
+                    m_spare = radius * std::sin(angle);
+                    m_hasSpare = true;
+                    return radius * std::cos(angle);
+                }
+
+            private:
+                std::mt19937_64 m_engine;
+                double m_spare = 0.0;
+                bool m_hasSpare = false;
+        };
+
+        // Cyclic Jacobi eigendecomposition of a symmetric n x n matrix. Plenty for the
+        // handful of dimensions tuned here, and it never fails to converge.
+        void SymmetricEigen(std::vector<double> a, size_t n, std::vector<double>& values, std::vector<double>& vectors) {
+            vectors.assign(n * n, 0.0);
+            for (size_t i = 0; i < n; ++i) vectors[i * n + i] = 1.0;
+
+            for (int sweep = 0; sweep < 100; ++sweep) {
+                double diagonal = 0.0, offDiagonal = 0.0;
+                for (size_t p = 0; p < n; ++p) {
+                    diagonal += a[p * n + p] * a[p * n + p];
+                    for (size_t q = p + 1; q < n; ++q) offDiagonal += a[p * n + q] * a[p * n + q];
+                }
+                if (offDiagonal <= 1e-30 * diagonal) break;
+
+                for (size_t p = 0; p < n; ++p) {
+                    for (size_t q = p + 1; q < n; ++q) {
+                        const double apq = a[p * n + q];
+                        if (apq == 0.0) continue;
+                        const double theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+                        const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                        const double c = 1.0 / std::sqrt(t * t + 1.0);
+                        const double s = t * c;
+
+                        for (size_t k = 0; k < n; ++k) {
+                            const double akp = a[k * n + p], akq = a[k * n + q];
+                            a[k * n + p] = c * akp - s * akq;
+                            a[k * n + q] = s * akp + c * akq;
+                        }
+                        for (size_t k = 0; k < n; ++k) {
+                            const double apk = a[p * n + k], aqk = a[q * n + k];
+                            a[p * n + k] = c * apk - s * aqk;
+                            a[q * n + k] = s * apk + c * aqk;
+                        }
+                        for (size_t k = 0; k < n; ++k) {
+                            const double vkp = vectors[k * n + p], vkq = vectors[k * n + q];
+                            vectors[k * n + p] = c * vkp - s * vkq;
+                            vectors[k * n + q] = s * vkp + c * vkq;
+                        }
+                    }
+                }
+            }
+
+            values.resize(n);
+            for (size_t i = 0; i < n; ++i) values[i] = a[i * n + i];
+        }
+
+        void PutVector(ByteWriter& out, const std::vector<double>& values) {
+            for (double value : values) out.PutDouble(value);
+        }
+
+        std::vector<double> GetVector(ByteReader& in, size_t size) {
+            std::vector<double> values(size);
+            for (double& value : values) value = in.GetDouble();
+            return values;
+        }
+    }
+
+    std::vector<double> WeightsToVector(const HeuristicWeights& weights) {
+        std::vector<double> vector(TUNED_WEIGHT_COUNT);
+        for (size_t i = 0; i < TUNED_WEIGHT_COUNT; ++i) vector[i] = weights.*TUNED_FIELDS[i];
+        return vector;
+    }
+
+    HeuristicWeights VectorToWeights(const std::vector<double>& vector) {
+        if (vector.size() != TUNED_WEIGHT_COUNT) throw std::invalid_argument("Expected one value per tuned weight");
+        HeuristicWeights weights;
+        for (size_t i = 0; i < TUNED_WEIGHT_COUNT; ++i) weights.*TUNED_FIELDS[i] = static_cast<float>(vector[i]);
+        return weights;
+    }
+
+    WeightEvaluator::WeightEvaluator(TaskScheduler& scheduler, const TuneConfig& config)
+        : m_scheduler(scheduler), m_config(config), m_arenas(scheduler.Size())
+    {
+    }
+
+    std::vector<double> WeightEvaluator::Evaluate(const std::vector<HeuristicWeights>& candidates) {
+        std::vector<HeuristicBot> bots;
+        bots.reserve(candidates.size());
+        for (const HeuristicWeights& weights : candidates) bots.emplace_back(weights);
+
+        const uint32_t games = m_config.games;
+        m_scores.assign(candidates.size() * games, 0.0);
+        for (size_t candidate = 0; candidate < candidates.size(); ++candidate) {
+            for (uint32_t begin = 0; begin < games; begin += GAMES_PER_TASK) {
+                const uint32_t end = std::min(begin + GAMES_PER_TASK, games);
+                m_scheduler.Submit([this, &bots, candidate, begin, end, games](size_t worker) {
+                    const Bot* seat = &bots[candidate];
+                    for (uint32_t game = begin; game < end; ++game) {
+                        MatchResult result = m_arenas[worker].Play(&seat, 1, MatchSeed(m_config.seed, game), m_config.match);
+                        const MatchPlayerResult& player = result.players[0];
+                        m_scores[candidate * games + game] = m_config.objective == TuneObjective::LINES ? player.lines : player.attack;
+                    }
+                });
+            }
+        }
+        m_scheduler.Wait();
+
+        // Summed in game order, so the thread count never changes a result
+        std::vector<double> means(candidates.size(), 0.0);
+        if (games == 0) return means;
+        for (size_t candidate = 0; candidate < candidates.size(); ++candidate) {
+            const double* scores = m_scores.data() + candidate * games;
+            means[candidate] = std::accumulate(scores, scores + games, 0.0) / games;
+        }
+        return means;
+    }
+
+    CmaEs::CmaEs(std::vector<double> mean, double sigma, size_t populationSize, uint64_t seed)
+        : m_lambda(populationSize), m_seed(seed), m_sigma(sigma), m_mean(std::move(mean))
+    {
+        const size_t n = m_mean.size();
+        if (n == 0 || n > MAX_DIMENSION) throw std::invalid_argument("CMA-ES needs 1 to 64 dimensions");
+        if (!(sigma > 0.0)) throw std::invalid_argument("CMA-ES step size must be positive");
+        if (m_lambda == 0) m_lambda = 4 + static_cast<size_t>(3.0 * std::log(static_cast<double>(n)));
+        if (m_lambda < 2) throw std::invalid_argument("CMA-ES needs at least two candidates per generation");
+
+        m_covariance.assign(n * n, 0.0);
+        for (size_t i = 0; i < n; ++i) m_covariance[i * n + i] = 1.0;
+        m_pathSigma.assign(n, 0.0);
+        m_pathCovariance.assign(n, 0.0);
+
+        _setStrategyParameters();
+        _updateEigensystem();
+    }
+
+    void CmaEs::_setStrategyParameters() {
+        const double n = static_cast<double>(m_mean.size());
+
+        // Log-linear recombination weights over the better half
+        m_mu = m_lambda / 2;
+        m_weights.resize(m_mu);
+        for (size_t i = 0; i < m_mu; ++i) m_weights[i] = std::log(m_mu + 0.5) - std::log(i + 1.0);
+        const double sum = std::accumulate(m_weights.begin(), m_weights.end(), 0.0);
+        double squares = 0.0;
+        for (double& weight : m_weights) {
+            weight /= sum;
+            squares += weight * weight;
+        }
+        m_muEff = 1.0 / squares;
+
+        m_cSigma = (m_muEff + 2.0) / (n + m_muEff + 5.0);
+        m_dSigma = 1.0 + 2.0 * std::max(0.0, std::sqrt((m_muEff - 1.0) / (n + 1.0)) - 1.0) + m_cSigma;
+        m_cc = (4.0 + m_muEff / n) / (n + 4.0 + 2.0 * m_muEff / n);
+        m_c1 = 2.0 / ((n + 1.3) * (n + 1.3) + m_muEff);
+        m_cMu = std::min(1.0 - m_c1, 2.0 * (m_muEff - 2.0 + 1.0 / m_muEff) / ((n + 2.0) * (n + 2.0) + m_muEff));
+        m_chiN = std::sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+    }
+
+    void CmaEs::_updateEigensystem() {
+        const size_t n = m_mean.size();
+        SymmetricEigen(m_covariance, n, m_scales, m_basis);
+        for (double& scale : m_scales) scale = std::sqrt(std::max(scale, 1e-20));
+    }
+
+    const std::vector<std::vector<double>>& CmaEs::Ask() {
+        if (m_sampled) return m_population;
+
+        const size_t n = m_mean.size();
+        NormalSource normal(MatchSeed(m_seed, m_generation));
+        m_population.assign(m_lambda, std::vector<double>(n));
+        m_steps.assign(m_lambda, std::vector<double>(n));
+
+        std::vector<double> z(n);
+        for (size_t k = 0; k < m_lambda; ++k) {
+            for (double& value : z) value = normal.Next();
+            // y = B D z, x = mean + sigma y
+            for (size_t row = 0; row < n; ++row) {
+                double y = 0.0;
+                for (size_t column = 0; column < n; ++column) y += m_basis[row * n + column] * m_scales[column] * z[column];
+                m_steps[k][row] = y;
+                m_population[k][row] = m_mean[row] + m_sigma * y;
+            }
+        }
+        m_sampled = true;
+        return m_population;
+    }
+
+    void CmaEs::Tell(const std::vector<double>& fitness) {
+        if (!m_sampled) Ask();
+        if (fitness.size() != m_lambda) throw std::invalid_argument("CMA-ES needs one fitness per candidate");
+        const size_t n = m_mean.size();
+
+        for (size_t k = 0; k < m_lambda; ++k) {
+            if (m_best.empty() || fitness[k] > m_bestFitness) {
+                m_best = m_population[k];
+                m_bestFitness = fitness[k];
+            }
+        }
+
+        // Best first; ties keep sampling order
+        std::vector<size_t> order(m_lambda);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return fitness[a] > fitness[b]; });
+
+        std::vector<double> meanStep(n, 0.0);
+        for (size_t i = 0; i < m_mu; ++i) {
+            for (size_t d = 0; d < n; ++d) meanStep[d] += m_weights[i] * m_steps[order[i]][d];
+        }
+        for (size_t d = 0; d < n; ++d) m_mean[d] += m_sigma * meanStep[d];
+
+        // Step-size path uses C^-1/2 * meanStep = B D^-1 B^T meanStep
+        std::vector<double> projected(n, 0.0);
+        for (size_t column = 0; column < n; ++column) {
+            double dot = 0.0;
+            for (size_t row = 0; row < n; ++row) dot += m_basis[row * n + column] * meanStep[row];
+            dot /= m_scales[column];
+            for (size_t row = 0; row < n; ++row) projected[row] += m_basis[row * n + column] * dot;
+        }
+        const double sigmaRate = std::sqrt(m_cSigma * (2.0 - m_cSigma) * m_muEff);
+        double pathNorm = 0.0;
+        for (size_t d = 0; d < n; ++d) {
+            m_pathSigma[d] = (1.0 - m_cSigma) * m_pathSigma[d] + sigmaRate * projected[d];
+            pathNorm += m_pathSigma[d] * m_pathSigma[d];
+        }
+        pathNorm = std::sqrt(pathNorm);
+
+        // Stall the covariance path while the step size is still growing fast
+        const double correction = std::sqrt(1.0 - std::pow(1.0 - m_cSigma, 2.0 * (m_generation + 1)));
+        const bool hSigma = pathNorm / correction < (1.4 + 2.0 / (n + 1.0)) * m_chiN;
+        const double covarianceRate = std::sqrt(m_cc * (2.0 - m_cc) * m_muEff);
+        for (size_t d = 0; d < n; ++d) {
+            m_pathCovariance[d] = (1.0 - m_cc) * m_pathCovariance[d] + (hSigma ? covarianceRate * meanStep[d] : 0.0);
+        }
+
+        // Rank-one update from the path plus rank-mu update from this generation
+        const double keep = 1.0 - m_c1 - m_cMu + (hSigma ? 0.0 : m_c1 * m_cc * (2.0 - m_cc));
+        for (size_t row = 0; row < n; ++row) {
+            for (size_t column = 0; column <= row; ++column) {
+                double rankMu = 0.0;
+                for (size_t i = 0; i < m_mu; ++i) rankMu += m_weights[i] * m_steps[order[i]][row] * m_steps[order[i]][column];
+                const double value = keep * m_covariance[row * n + column]
+                                   + m_c1 * m_pathCovariance[row] * m_pathCovariance[column]
+                                   + m_cMu * rankMu;
+                m_covariance[row * n + column] = value;
+                m_covariance[column * n + row] = value;
+            }
+        }
+
+        m_sigma *= std::exp(m_cSigma / m_dSigma * (pathNorm / m_chiN - 1.0));
+
+        ++m_generation;
+        m_sampled = false;
+        _updateEigensystem();
+    }
+
+    void CmaEs::Save(ByteWriter& out) const {
+        out.PutU32(static_cast<uint32_t>(m_mean.size()));
+        out.PutU32(static_cast<uint32_t>(m_lambda));
+        out.PutU64(m_seed);
+        out.PutU64(m_generation);
+        out.PutDouble(m_sigma);
+        PutVector(out, m_mean);
+        PutVector(out, m_covariance);
+        PutVector(out, m_pathSigma);
+        PutVector(out, m_pathCovariance);
+        out.PutU8(m_best.empty() ? 0 : 1);
+        PutVector(out, m_best);
+        out.PutDouble(m_bestFitness);
+    }
+
+    CmaEs CmaEs::Load(ByteReader& in) {
+        const size_t n = in.GetU32();
+        const size_t lambda = in.GetU32();
+        const uint64_t seed = in.GetU64();
+        const uint64_t generation = in.GetU64();
+        const double sigma = in.GetDouble();
+        if (n == 0 || n > MAX_DIMENSION || lambda < 2 || !(sigma > 0.0)) throw std::runtime_error("Corrupt CMA-ES state");
+
+        CmaEs optimizer(GetVector(in, n), sigma, lambda, seed);
+        optimizer.m_generation = generation;
+        optimizer.m_covariance = GetVector(in, n * n);
+        optimizer.m_pathSigma = GetVector(in, n);
+        optimizer.m_pathCovariance = GetVector(in, n);
+        if (in.GetU8()) optimizer.m_best = GetVector(in, n);
+        optimizer.m_bestFitness = in.GetDouble();
+        optimizer._updateEigensystem();
+        return optimizer;
+    }
+
+    void SaveTunerCheckpoint(const std::filesystem::path& path, const CmaEs& optimizer, const TuneConfig& config) {
+        ByteWriter out;
+        out.PutBytes(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        out.PutU16(CHECKPOINT_VERSION);
+        out.PutDouble(config.match.piecesPerSecond);
+        out.PutU32(config.match.maxFrames);
+        out.PutU32(config.match.garbageDelayFrames);
+        out.PutU32(config.games);
+        out.PutU64(config.seed);
+        out.PutU8(static_cast<uint8_t>(config.objective));
+        optimizer.Save(out);
+
+        WriteFileAtomically(path, out);
+    }
+
+    CmaEs LoadTunerCheckpoint(const std::filesystem::path& path, TuneConfig& config) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) throw std::runtime_error("Cannot open tuner checkpoint " + path.string());
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        ByteReader in(bytes.data(), bytes.size());
+        char magic[sizeof(CHECKPOINT_MAGIC)];
+        in.GetBytes(magic, sizeof(magic));
+        if (!std::equal(magic, magic + sizeof(magic), CHECKPOINT_MAGIC)) throw std::runtime_error(path.string() + " is not a tuner checkpoint");
+        const uint16_t version = in.GetU16();
+        if (version != CHECKPOINT_VERSION) throw std::runtime_error("Unsupported tuner checkpoint version " + std::to_string(version));
+
+        config.match.piecesPerSecond = in.GetDouble();
+        config.match.maxFrames = in.GetU32();
+        config.match.garbageDelayFrames = in.GetU32();
+        config.games = in.GetU32();
+        config.seed = in.GetU64();
+        const uint8_t objective = in.GetU8();
+        if (objective > static_cast<uint8_t>(TuneObjective::LINES)) throw std::runtime_error("Unknown tuning objective in " + path.string());
+        config.objective = static_cast<TuneObjective>(objective);
+
+        CmaEs optimizer = CmaEs::Load(in);
+        if (!in.AtEnd()) throw std::runtime_error("Trailing data in tuner checkpoint " + path.string());
+        return optimizer;
+    }
+}
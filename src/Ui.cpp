@@ -2,6 +2,14 @@
 #include "TetrisEngine/Ui.h"
 #include "TetrisEngine/Board.h"
 #include "TetrisEngine/Game.h"
+#include "TetrisEngine/Piece.h"
+#include "TetrisEngine/Profiler.h"
+#include "TetrisEngine/SimulationThread.h"
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
 #include <raylib.h>
 #include <imgui.h>
 #include <rlImGui.h>
@@ -38,9 +46,39 @@ Color GetColorForPiece(PieceType pt) {
     return colorMap.count(pt) ? colorMap[pt] : RAYWHITE;
 }
 
-bool DrawControlsPanel(Board& board,
+namespace {
+    struct KeyBinding {
+        int key;
+        InputType input;
+    };
+
+    constexpr KeyBinding GAME_KEYS[] = {
+        {KEY_LEFT, InputType::MOVE_LEFT},
+        {KEY_RIGHT, InputType::MOVE_RIGHT},
+        {KEY_DOWN, InputType::SOFT_DROP},
+        {KEY_SPACE, InputType::HARD_DROP},
+        {KEY_LEFT_SHIFT, InputType::HOLD},
+        {KEY_E, InputType::ROTATE_CW},
+        {KEY_Q, InputType::ROTATE_CCW},
+        {KEY_W, InputType::ROTATE_180},
+    };
+}
+
+void PollGameKeys(SimulationThread& sim, size_t players) {
+    // raylib hands over key changes when it polls events, so this is as close to arrival as we can stamp them
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    for (const KeyBinding& binding : GAME_KEYS) {
+        const bool pressed = IsKeyPressed(binding.key);
+        if (!pressed && !IsKeyReleased(binding.key)) continue;
+        for (size_t player = 0; player < players; ++player) {
+            sim.PushKey(KeyEvent{now, static_cast<uint32_t>(player), binding.input, pressed});
+        }
+    }
+}
+
+bool DrawControlsPanel(SimulationThread& sim,
+                       const BoardHud& hud,
                        int playerNum,
-                       std::vector<std::string>& commandHistory,
                        bool gameOver,
                        const ImVec2& SetNextWindowPosVector
                     )
@@ -49,71 +87,43 @@ bool DrawControlsPanel(Board& board,
 
     std::string title = "Controls##" + std::to_string(playerNum);
     ImGui::Begin(title.c_str());
+
+    // Inputs go to the simulation thread, which applies them through the game so they are recorded
+    const size_t player = static_cast<size_t>(playerNum);
+    gameOver = hud.gameOver;
     
     if (!gameOver) {
 
+        // Buttons go straight to the simulation; keys reach it timestamped through PollGameKeys.
+        // Either way the history panel learns what happened from the board's events
+        auto control = [&](const char* label, InputType input) {
+            if (ImGui::Button(label)) sim.Submit(GameCommand::Input(player, input));
+        };
+
         // these controls were also reversed
-        if (ImGui::Button("Left") || IsKeyPressed(KEY_LEFT)) {
-            board.MoveActivePiece(-1, 0);
-            commandHistory.push_back("Move Left");
-        }
+        control("Left", InputType::MOVE_LEFT);
         ImGui::SameLine();
-        if (ImGui::Button("Right") || IsKeyPressed(KEY_RIGHT)){ 
-            board.MoveActivePiece(1, 0);
-            commandHistory.push_back("Move Right");
-        }
-        if (ImGui::Button("Soft Drop") || IsKeyPressed(KEY_DOWN)) {
-            commandHistory.push_back("Drop 1");
-            if (!board.MoveActivePiece(0, -1)) {
-                board.LockActivePiece();
-
-                if (!board.SpawnRandomPiece()) gameOver = true;
-                board.GetNextQueue();
-            }
-        }
+        control("Right", InputType::MOVE_RIGHT);
+        control("Soft Drop", InputType::SOFT_DROP);
         ImGui::SameLine();  
-        if (ImGui::Button("Hard Drop") || IsKeyPressed(KEY_SPACE)) {
-            board.HardDropActivePiece();
-            commandHistory.push_back("Drop X");
-            if (!board.SpawnRandomPiece()) gameOver = true;
-            board.GetNextQueue();
-        }
+        control("Hard Drop", InputType::HARD_DROP);
         ImGui::SameLine();
-        if (ImGui::Button("HOLD") || IsKeyPressed(KEY_LEFT_SHIFT)) {
-            board.HoldPiece();
-            commandHistory.push_back("Hold Piece");
-        }
-        if (ImGui::Button("Rotate CW") || IsKeyPressed(KEY_E)){ 
-            board.RotateActivePiece(RotationDirection::CLOCKWISE);
-            commandHistory.push_back("Rotate CW");
-        }
+        control("HOLD", InputType::HOLD);
+        control("Rotate CW", InputType::ROTATE_CW);
         ImGui::SameLine();
-        if (ImGui::Button("Rotate CCW") || IsKeyPressed(KEY_Q)) {
-            board.RotateActivePiece(RotationDirection::COUNTER_CLOCKWISE);
-            commandHistory.push_back("Rotate CCW");
-        }
+        control("Rotate CCW", InputType::ROTATE_CCW);
         ImGui::SameLine();
-        if (ImGui::Button("Rotate 180") || IsKeyPressed(KEY_W)) {
-            board.RotateActivePiece(RotationDirection::ONE_EIGHTY);
-            commandHistory.push_back("Rotate 180");
-        }
+        control("Rotate 180", InputType::ROTATE_180);
 
         if (ImGui::Button("Reset") || IsKeyPressed(KEY_T)) {
-            board.Reset();
-            commandHistory.push_back("Reset Board");
+            sim.Submit(GameCommand::Input(player, InputType::RESET));
         }
 
         static int garbage_lines = 0;
         ImGui::InputInt("Garbage", &garbage_lines);
 
         if (ImGui::Button("Add Garbage")) {
-            board.AddGarbageToQueue(garbage_lines);
-            commandHistory.push_back("Added garbage lines to queue");
-        }
-        
-        // erase first command if bigger than 10
-        if (commandHistory.size() > 10) {
-            commandHistory.erase(commandHistory.begin());
+            sim.Submit(GameCommand::Garbage(player, garbage_lines));
         }
     }
 
@@ -121,14 +131,14 @@ bool DrawControlsPanel(Board& board,
         ImGui::Text("Game Over!");
     }
 
-    ImGui::Text("Score: %d", board.GetScore());
-    ImGui::Text("Lines: %d", board.GetLinesCleared());
+    ImGui::Text("Lines: %d", hud.lines);
+    ImGui::Text("Attack: %d", hud.attack);
     ImGui::End();
 
     return gameOver;
 }
 
-void DrawQueuePanel(const Board& board,
+void DrawQueuePanel(const BoardHud& hud,
                     int playerNum,
                     const ImVec2& SetNextWindowPosVector,
                     const ImVec2& SetNextWindowSizeVector) {
@@ -136,7 +146,7 @@ void DrawQueuePanel(const Board& board,
     ImGui::SetNextWindowSize(SetNextWindowSizeVector);
     std::string title = "Queue##" + std::to_string(playerNum);
     ImGui::Begin(title.c_str());
-    for (PieceType pt : board.GetNextQueue()) {
+    for (PieceType pt : hud.next) {
         Color c = GetColorForPiece(pt);
         ImGui::ColorButton("##color",
             {c.r/255.f,c.g/255.f,c.b/255.f,1.f},
@@ -148,7 +158,7 @@ void DrawQueuePanel(const Board& board,
     ImGui::End();
 }
 
-void DrawHoldPanel(const Board& board, 
+void DrawHoldPanel(const BoardHud& hud, 
                    int playerNum,
                    const ImVec2& SetNextWindowPosVector,
                    const ImVec2& SetNextWindowSizeVector) {
@@ -156,7 +166,7 @@ void DrawHoldPanel(const Board& board,
     ImGui::SetNextWindowSize(SetNextWindowSizeVector);
     std::string title = "Hold##" + std::to_string(playerNum);
     ImGui::Begin(title.c_str());
-    PieceType held = board.GetHeldPieceType();
+    PieceType held = hud.held;
     if (held != PieceType::EMPTY) {
         Color c = GetColorForPiece(held);
         ImGui::ColorButton("##heldcolor",
@@ -171,21 +181,24 @@ void DrawHoldPanel(const Board& board,
     ImGui::End();
 }
 
-void DrawHistoryPanel(const std::vector<std::string>& history, 
+void DrawHistoryPanel(const BoardEventReader& events, 
                       int playerNum,
                       const ImVec2& SetNextWindowPosVector,
                       const ImVec2& ScrollRegionSizeVector) {
     ImGui::SetNextWindowPos(SetNextWindowPosVector);
-    std::string title = "Command History##" + std::to_string(playerNum);
+    std::string title = "History##" + std::to_string(playerNum);
     ImGui::Begin(title.c_str());
       ImGui::BeginChild("ScrollRegion", ScrollRegionSizeVector, true);
-      for (const std::string& cmd : history)
-        ImGui::TextUnformatted(cmd.c_str());
+      char line[64];
+      for (size_t i = 0; i < events.GetRecentCount(); ++i) {
+        FormatGameEvent(events.GetRecent(i), line, sizeof(line));
+        ImGui::TextUnformatted(line);
+      }
       ImGui::EndChild();
     ImGui::End();
 }
 
-void DrawGarbagePanel(const Board& board, 
+void DrawGarbagePanel(const BoardHud& hud, 
                    int playerNum,
                    const ImVec2& SetNextWindowPosVector,
                    const ImVec2& SetNextWindowSizeVector) {
@@ -193,58 +206,430 @@ void DrawGarbagePanel(const Board& board,
     ImGui::SetNextWindowSize(SetNextWindowSizeVector);
     std::string title = "Garbage Stats##" + std::to_string(playerNum);
     ImGui::Begin(title.c_str());
-    std::string b2b = "Back to Back: " + std::to_string(board.GetB2BChain());
-    std::string combo = "Combo: " + std::to_string(board.GetCombo());
-    std::string garbage = "Garbage in Queue: " + std::to_string(board.GetGarbageQueue());
-    ImGui::TextUnformatted(b2b.c_str());
-    ImGui::TextUnformatted(combo.c_str());
-    ImGui::TextUnformatted(garbage.c_str());
+    ImGui::Text("Back to Back: %d", hud.b2b);
+    ImGui::Text("Combo: %d", hud.combo);
+    ImGui::Text("Garbage in Queue: %d", hud.pending);
     ImGui::End();
 }
 
-void DrawBoardGrid(const Board& board,
-                   int offsetX,
-                   int offsetY,
-                   int cellSize)
+BoardRenderer::BoardRenderer(int cellSize)
+    : m_cellSize(cellSize)
 {
-    std::vector<PieceType> state = board.GetRenderableState();
+}
+
+BoardRenderer::~BoardRenderer() {
+    if (m_texture.id != 0) UnloadRenderTexture(m_texture);
+}
+
+void BoardRenderer::Draw(const Board& board, int offsetX, int offsetY) {
+    TETRIS_PROFILE_ZONE("BoardRenderer::Draw");
+    if (m_texture.id == 0) m_texture = LoadRenderTexture(BOARD_WIDTH * m_cellSize, VISIBLE_BOARD_HEIGHT * m_cellSize);
+    if (board.GetGridVersion() != m_gridVersion) _renderLockedCells(board);
+
+    // Render textures are stored bottom-up, hence the negative source height
+    const float width = static_cast<float>(m_texture.texture.width);
+    const float height = static_cast<float>(m_texture.texture.height);
+    DrawTextureRec(m_texture.texture, Rectangle{0.0f, 0.0f, width, -height},
+                   Vector2{static_cast<float>(offsetX), static_cast<float>(offsetY)}, WHITE);
+
+    const Piece* piece = board.GetCurrentPiece();
+    if (!piece) return;
+    const uint16_t repr = piece->GetCurrentRepresentation();
+    const Color color = GetColorForPiece(piece->GetType());
+    const Point position = board.GetCurrentPiecePosition();
+    const Point ghost = board.GetGhostPosition();
+    if (ghost.y != position.y) _drawPiece(repr, ghost, offsetX, offsetY, Fade(color, 0.3f));
+    _drawPiece(repr, position, offsetX, offsetY, color);
+}
+
+void BoardRenderer::_renderLockedCells(const Board& board) {
+    TETRIS_PROFILE_ZONE("BoardRenderer::RenderLockedCells");
+    BeginTextureMode(m_texture);
+    ClearBackground(BLANK);
     for (int r = 0; r < VISIBLE_BOARD_HEIGHT; ++r) {
         for (int c = 0; c < BOARD_WIDTH; ++c) {
-        PieceType pt = state[r*BOARD_WIDTH + c];
-        Color col = GetColorForPiece(pt);
-        DrawRectangle(
-            offsetX + c*cellSize,
-            offsetY + r*cellSize,
-            cellSize-2, cellSize-2,
-            col);
+            PieceType pt = board.GetCellState(c, VISIBLE_BOARD_HEIGHT - 1 - r);
+            DrawRectangle(c * m_cellSize, r * m_cellSize, m_cellSize - 2, m_cellSize - 2, GetColorForPiece(pt));
         }
     }
+    EndTextureMode();
+
+    m_gridVersion = board.GetGridVersion();
+    ++m_redraws;
+}
+
+void BoardRenderer::_drawPiece(uint16_t repr, Point pos, int offsetX, int offsetY, Color color) const {
+    for (int i = 0; i < 16; ++i) {
+        if (!(repr & (1 << (15 - i)))) continue;
+        int c = pos.x + (i % 4);
+        int gridRow = pos.y + (i / 4);
+        if (c < 0 || c >= BOARD_WIDTH || gridRow < 0 || gridRow >= VISIBLE_BOARD_HEIGHT) continue;
+        int r = VISIBLE_BOARD_HEIGHT - 1 - gridRow;
+        DrawRectangle(offsetX + c * m_cellSize, offsetY + r * m_cellSize, m_cellSize - 2, m_cellSize - 2, color);
+    }
+}
+
+namespace {
+    // Tiles are a board plus a one-pixel gutter on the right and bottom
+    constexpr int TILE_WIDTH = BOARD_WIDTH + 1;
+    constexpr int TILE_HEIGHT = VISIBLE_BOARD_HEIGHT + 1;
+
+    Color Dim(Color color) {
+        return Color{static_cast<unsigned char>(color.r / 3), static_cast<unsigned char>(color.g / 3),
+                     static_cast<unsigned char>(color.b / 3), color.a};
+    }
+}
+
+SpectatorWallRenderer::~SpectatorWallRenderer() {
+    if (m_atlas.id != 0) UnloadTexture(m_atlas);
+}
+
+void SpectatorWallRenderer::_layout(size_t tiles, Rectangle area) {
+    // Try every column count and keep the one with the largest tiles
+    float bestScale = 0.0f;
+    for (int columns = 1; columns <= static_cast<int>(tiles); ++columns) {
+        int rows = static_cast<int>((tiles + columns - 1) / columns);
+        float scale = std::min(area.width / (columns * TILE_WIDTH), area.height / (rows * TILE_HEIGHT));
+        if (scale > bestScale) {
+            bestScale = scale;
+            m_columns = columns;
+            m_rows = rows;
+        }
+    }
+    // Whole pixels per cell keep the wall crisp whenever there is room for them
+    m_scale = bestScale >= 1.0f ? std::floor(bestScale) : bestScale;
+    m_tiles = tiles;
+    m_areaWidth = area.width;
+    m_areaHeight = area.height;
+
+    if (m_atlas.id != 0) UnloadTexture(m_atlas);
+    const int width = m_columns * TILE_WIDTH;
+    const int height = m_rows * TILE_HEIGHT;
+    Image blank = GenImageColor(width, height, BLANK);
+    m_atlas = LoadTextureFromImage(blank);
+    UnloadImage(blank);
+    SetTextureFilter(m_atlas, TEXTURE_FILTER_POINT);
+    m_pixels.assign(static_cast<size_t>(width) * height, BLANK);
+}
+
+void SpectatorWallRenderer::Draw(const SpectatorFeed& feed, Rectangle area) {
+    TETRIS_PROFILE_ZONE("SpectatorWallRenderer::Draw");
+    const size_t tiles = feed.GetTileCount();
+    if (tiles == 0) return;
+    if (m_atlas.id == 0 || tiles != m_tiles || area.width != m_areaWidth || area.height != m_areaHeight) _layout(tiles, area);
+
+    // Palette indexed by PieceType value, live and topped-out
+    Color live[9], dead[9];
+    for (int type = 0; type < 9; ++type) {
+        live[type] = GetColorForPiece(static_cast<PieceType>(type));
+        dead[type] = Dim(live[type]);
+    }
+
+    const int stride = m_columns * TILE_WIDTH;
+    for (size_t t = 0; t < tiles; ++t) {
+        const SpectatorTile& tile = feed.GetTile(t);
+        const Color* palette = tile.toppedOut ? dead : live;
+        Color* origin = m_pixels.data() + (t / m_columns) * TILE_HEIGHT * stride + (t % m_columns) * TILE_WIDTH;
+        for (int r = 0; r < VISIBLE_BOARD_HEIGHT; ++r) {
+            const PieceType* cells = tile.cells.data() + r * BOARD_WIDTH;
+            Color* row = origin + r * stride;
+            for (int c = 0; c < BOARD_WIDTH; ++c) {
+                const uint8_t type = static_cast<uint8_t>(cells[c]);
+                row[c] = type < 9 ? palette[type] : RAYWHITE;
+            }
+        }
+    }
+    UpdateTexture(m_atlas, m_pixels.data());
+
+    const float width = static_cast<float>(m_atlas.width);
+    const float height = static_cast<float>(m_atlas.height);
+    const float drawWidth = width * m_scale;
+    const float drawHeight = height * m_scale;
+    Rectangle destination{area.x + (area.width - drawWidth) / 2.0f, area.y + (area.height - drawHeight) / 2.0f, drawWidth, drawHeight};
+    DrawTexturePro(m_atlas, Rectangle{0.0f, 0.0f, width, height}, destination, Vector2{0.0f, 0.0f}, 0.0f, WHITE);
+}
+
+// raylib's desktop platform links GLFW in; this is the thread-safe way to end its event wait
+extern "C" void glfwPostEmptyEvent(void);
+
+FramePacer::FramePacer(int maxFps) : m_maxFps(std::max(maxFps, 0)) {
+    SetTargetFPS(m_maxFps);
+    EnableEventWaiting();
+    m_timer = std::thread(&FramePacer::_run, this);
+}
+
+FramePacer::~FramePacer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_changed.notify_one();
+    m_timer.join();
+    DisableEventWaiting();
+}
+
+void FramePacer::Wake() {
+    glfwPostEmptyEvent();
+}
+
+void FramePacer::WakeAfter(double seconds) {
+    const auto deadline = std::chrono::steady_clock::now()
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(std::max(seconds, 0.0)));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (deadline >= m_deadline) return;
+        m_deadline = deadline;
+    }
+    m_changed.notify_one();
+}
+
+void FramePacer::_run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        if (m_deadline == std::chrono::steady_clock::time_point::max()) {
+            m_changed.wait(lock);
+        } else if (m_changed.wait_until(lock, m_deadline) == std::cv_status::timeout
+                   && std::chrono::steady_clock::now() >= m_deadline) {
+            m_deadline = std::chrono::steady_clock::time_point::max();
+            glfwPostEmptyEvent();
+        }
+    }
+}
+
+void FramePacer::FrameStart() {
+    m_frameStart = std::chrono::steady_clock::now();
+}
+
+void FramePacer::FrameEnd() {
+    const auto now = std::chrono::steady_clock::now();
+    m_stats.Record(std::chrono::duration<double>(now - m_frameStart).count(),
+                   std::chrono::duration<double>(now.time_since_epoch()).count());
+#ifdef TETRIS_PROFILE
+    using std::chrono::nanoseconds;
+    profile::RecordZone("Frame", std::chrono::duration_cast<nanoseconds>(m_frameStart.time_since_epoch()).count(),
+                        std::chrono::duration_cast<nanoseconds>(now.time_since_epoch()).count());
+#endif
+}
+
+void DrawFrameStatsPanel(const FramePacer& pacer, const ImVec2& SetNextWindowPosVector) {
+    const FrameStats& stats = pacer.GetStats();
+    ImGui::SetNextWindowPos(SetNextWindowPosVector);
+    ImGui::Begin("Frames");
+    if (pacer.GetMaxFps() > 0) ImGui::Text("%.0f frames/s (max %d)", stats.GetFramesPerSecond(), pacer.GetMaxFps());
+    else ImGui::Text("%.0f frames/s (uncapped)", stats.GetFramesPerSecond());
+    ImGui::Text("Work %.2f ms mean, %.2f ms p99, %.2f ms max", stats.GetMeanMs(), stats.GetPercentileMs(99.0), stats.GetMaxMs());
+    ImGui::End();
+}
+
+void PerformanceMonitor::FrameStart() {
+    m_frameStart = Clock::now();
+    m_lastCharge = m_frameStart;
+    m_charged.fill(0.0);
+    m_allocationsAt = GetThreadAllocations();
+}
+
+void PerformanceMonitor::Charge(FramePhase phase) {
+    const Clock::time_point now = Clock::now();
+    m_charged[static_cast<size_t>(phase)] += std::chrono::duration<double, std::milli>(now - m_lastCharge).count();
+    m_lastCharge = now;
+}
+
+void PerformanceMonitor::FrameEnd() {
+    for (size_t phase = 0; phase < FRAME_PHASE_COUNT; ++phase) m_phaseMs[phase].Push(static_cast<float>(m_charged[phase]));
+    m_frameMs.Push(static_cast<float>(std::chrono::duration<double, std::milli>(Clock::now() - m_frameStart).count()));
+    m_allocations.Push(static_cast<float>(GetThreadAllocations() - m_allocationsAt));
+}
+
+void PerformanceMonitor::SetSimulation(const SimulationStats& stats) {
+    if (m_hasSimulation && stats.frames == m_simulationFrames) return;
+    m_hasSimulation = true;
+    m_simulationFrames = stats.frames;
+    m_stepMs.Push(static_cast<float>(stats.stepMs));
+    m_simulationAllocations.Push(static_cast<float>(stats.allocationsPerFrame));
+    if (m_boardUs.size() != stats.boardUs.size()) m_boardUs.assign(stats.boardUs.size(), History());
+    for (size_t i = 0; i < stats.boardUs.size(); ++i) m_boardUs[i].Push(stats.boardUs[i]);
+}
+
+void PerformanceMonitor::SetBots(const BotSearchStats& search, const InferenceStats* inference) {
+    const Clock::time_point now = Clock::now();
+    if (!m_hasBots) {
+        m_hasBots = true;
+        m_botSampleTime = now;
+        m_lastSearch = search;
+        if (inference) m_lastInference = *inference;
+    }
+    m_hasInference = inference != nullptr;
+    m_depth = search.depth;
+
+    const double seconds = std::chrono::duration<double>(now - m_botSampleTime).count();
+    if (seconds < BOT_SAMPLE_SECONDS) return;
+
+    const uint64_t decisions = search.decisions - m_lastSearch.decisions;
+    const uint64_t nodes = search.nodes - m_lastSearch.nodes;
+    m_nodesPerSecond.Push(static_cast<float>(nodes / seconds));
+    m_decisionUs.Push(decisions ? static_cast<float>((search.searchNs - m_lastSearch.searchNs) / 1e3 / decisions) : 0.0f);
+    if (decisions) m_nodesPerDecision = static_cast<double>(nodes) / decisions;
+    if (inference) {
+        const uint64_t batches = inference->batches - m_lastInference.batches;
+        m_batchMs.Push(batches ? static_cast<float>((inference->totalNs - m_lastInference.totalNs) / 1e6 / batches) : 0.0f);
+        m_lastInference = *inference;
+    }
+    m_lastSearch = search;
+    m_botSampleTime = now;
+}
+
+namespace {
+    // Latest and worst in the overlay, scaled from zero so a spike stands out against the usual line
+    void PlotHistory(const char* label, const PerformanceMonitor::History& history, const char* unit) {
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), "%.2f %s (max %.2f)", history.GetLatest(), unit, history.GetMax());
+        ImGui::PlotLines(label, history.Data(), static_cast<int>(history.Capacity()), static_cast<int>(history.GetOffset()),
+                         overlay, 0.0f, FLT_MAX, ImVec2(260, 40));
+    }
+
+    const char* RotationName(int rotation) {
+        static const char* names[] = {"0", "R", "2", "L"};
+        return names[rotation & 3];
+    }
+}
+
+void DrawPerformancePanel(const PerformanceMonitor& perf, const ImVec2& SetNextWindowPosVector) {
+    ImGui::SetNextWindowPos(SetNextWindowPosVector);
+    ImGui::Begin("Performance");
+
+    ImGui::Text("Frame %.2f ms: simulation %.2f, render %.2f, ImGui %.2f", perf.GetFrameMs().GetLatest(),
+                perf.GetPhaseMs(FramePhase::SIMULATION).GetLatest(), perf.GetPhaseMs(FramePhase::RENDER).GetLatest(),
+                perf.GetPhaseMs(FramePhase::IMGUI).GetLatest());
+    PlotHistory("Frame", perf.GetFrameMs(), "ms");
+    PlotHistory("Simulation##frame", perf.GetPhaseMs(FramePhase::SIMULATION), "ms");
+    PlotHistory("Render", perf.GetPhaseMs(FramePhase::RENDER), "ms");
+    PlotHistory("ImGui", perf.GetPhaseMs(FramePhase::IMGUI), "ms");
+    PlotHistory("Allocations", perf.GetAllocations(), "/frame");
+
+    if (perf.HasSimulation()) {
+        ImGui::Separator();
+        ImGui::Text("Simulation thread");
+        PlotHistory("Step", perf.GetStepMs(), "ms");
+        PlotHistory("Allocations##simulation", perf.GetSimulationAllocations(), "/frame");
+        const std::vector<PerformanceMonitor::History>& boards = perf.GetBoardUs();
+        for (size_t i = 0; i < boards.size(); ++i) {
+            char label[32];
+            std::snprintf(label, sizeof(label), "Board %zu", i);
+            PlotHistory(label, boards[i], "us");
+        }
+    }
+
+    if (perf.HasBots()) {
+        ImGui::Separator();
+        ImGui::Text("Bots: depth %d, %.1f nodes per decision", perf.GetSearchDepth(), perf.GetNodesPerDecision());
+        PlotHistory("Nodes", perf.GetNodesPerSecond(), "/s");
+        PlotHistory("Decision", perf.GetDecisionUs(), "us");
+        if (perf.HasInference()) PlotHistory("NN batch", perf.GetBatchMs(), "ms");
+
+        PieceType piece;
+        const int action = perf.GetPrincipalVariation(piece);
+        if (action < 0) {
+            ImGui::Text("PV: none yet");
+        } else {
+            const int placement = action % PLACEMENT_COUNT;
+            ImGui::Text("PV: %s%s, %s at column %d", PieceTypeToString(piece).c_str(), action >= PLACEMENT_COUNT ? " held" : "",
+                        RotationName(placement / BOARD_WIDTH), placement % BOARD_WIDTH);
+        }
+    }
+    ImGui::End();
+}
+
+void DrawSpectatorPanel(const SpectatorFeed& feed,
+                        double simFramesPerSecond,
+                        const ImVec2& SetNextWindowPosVector) {
+    ImGui::SetNextWindowPos(SetNextWindowPosVector);
+    ImGui::Begin("Spectator");
+
+    uint64_t lines = 0;
+    uint64_t attack = 0;
+    for (size_t t = 0; t < feed.GetTileCount(); ++t) {
+        lines += feed.GetTile(t).lines;
+        attack += feed.GetTile(t).attack;
+    }
+    ImGui::Text("%zu boards, %llu matches finished", feed.GetTileCount(), static_cast<unsigned long long>(feed.GetMatchesPlayed()));
+    ImGui::Text("Simulating %.0f frames/s", simFramesPerSecond);
+    ImGui::Text("On screen: %llu lines, %llu attack", static_cast<unsigned long long>(lines), static_cast<unsigned long long>(attack));
+    ImGui::End();
+}
+
+void DrawReplayPanel(ReplayPlayer& player,
+                     bool& playing,
+                     double& lastSeekMs,
+                     const ImVec2& SetNextWindowPosVector) {
+    ImGui::SetNextWindowPos(SetNextWindowPosVector);
+    ImGui::Begin("Replay");
+
+    const ReplayInfo& info = player.GetInfo();
+    const float fps = static_cast<float>(info.framesPerSecond);
+    const int last = static_cast<int>(info.endFrame - info.startFrame);
+    int target = static_cast<int>(player.GetFrame() - info.startFrame);
+    bool seek = false;
+
+    if (ImGui::Button(playing ? "Pause" : "Play") || IsKeyPressed(KEY_SPACE)) playing = !playing;
+    ImGui::SameLine();
+    if (ImGui::Button("-5s") || IsKeyPressed(KEY_LEFT)) {
+        target -= 5 * static_cast<int>(info.framesPerSecond);
+        seek = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("+5s") || IsKeyPressed(KEY_RIGHT)) {
+        target += 5 * static_cast<int>(info.framesPerSecond);
+        seek = true;
+    }
+    if (ImGui::SliderInt("Frame", &target, 0, last)) seek = true;
+
+    if (seek) {
+        target = std::clamp(target, 0, last);
+        auto start = std::chrono::steady_clock::now();
+        player.Seek(info.startFrame + static_cast<uint64_t>(target));
+        lastSeekMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    ImGui::Text("%.1f / %.1f s", static_cast<float>(target) / fps, static_cast<float>(last) / fps);
+    ImGui::Text("Last seek: %.3f ms", lastSeekMs);
+    ImGui::Text("%llu inputs, %u keyframes", static_cast<unsigned long long>(info.eventCount), info.keyframeCount);
+    ImGui::End();
 }
 
-bool DrawPlayer(Game& game,
-                int playerNum, 
+bool DrawPlayer(SimulationThread& sim,
+                const Game& view,
+                int playerNum,
+                BoardRenderer& renderer,
                 int offsetX, 
                 int offsetY,  
-                std::vector<std::string>& commandHistory, 
+                BoardEventReader& events, 
                 bool gameOver,
-                int cellSize){
+                PerformanceMonitor* perf){
+    TETRIS_PROFILE_ZONE("DrawPlayer");
     ImGui::PushID(playerNum);
 
-    gameOver = DrawControlsPanel(game.getBoard(playerNum), playerNum, commandHistory, gameOver, ImVec2((float)offsetX + 500, (float)offsetY));
+    // Panels follow the simulated board's events; the view board is only read if some were missed
+    const Board& board = view.getBoard(playerNum);
+    events.Update(sim.GetEvents(static_cast<size_t>(playerNum)), board);
+    const BoardHud& hud = events.GetHud();
+    if (perf) perf->Charge(FramePhase::SIMULATION);
+    gameOver = DrawControlsPanel(sim, hud, playerNum, gameOver, ImVec2((float)offsetX + 500, (float)offsetY));
 
     if (IsKeyPressed(KEY_T)) {
-        game.Reset();
+        sim.Submit(GameCommand::Reset());
     }
 
-    DrawQueuePanel(game.getBoard(playerNum), playerNum, ImVec2(static_cast<float>(offsetX + 350), static_cast<float>(offsetY)));
-    DrawHoldPanel(game.getBoard(playerNum), playerNum, ImVec2(static_cast<float>(offsetX + 350), static_cast<float>(offsetY + 300)));
-    DrawHistoryPanel(commandHistory, playerNum, ImVec2(static_cast<float>(offsetX + 500), static_cast<float>(offsetY + 300)));
-    DrawGarbagePanel(game.getBoard(playerNum), playerNum, ImVec2(static_cast<float>(offsetX), static_cast<float>(offsetY + 650)));
+    DrawQueuePanel(hud, playerNum, ImVec2(static_cast<float>(offsetX + 350), static_cast<float>(offsetY)));
+    DrawHoldPanel(hud, playerNum, ImVec2(static_cast<float>(offsetX + 350), static_cast<float>(offsetY + 300)));
+    DrawHistoryPanel(events, playerNum, ImVec2(static_cast<float>(offsetX + 500), static_cast<float>(offsetY + 300)));
+    DrawGarbagePanel(hud, playerNum, ImVec2(static_cast<float>(offsetX), static_cast<float>(offsetY + 650)));
 
     ImGui::PopID();
+    if (perf) perf->Charge(FramePhase::IMGUI);
 
     // draw the actual tetris board
-    DrawBoardGrid(game.getBoard(playerNum), offsetX, offsetY, cellSize);
+    renderer.Draw(board, offsetX, offsetY);
+    if (perf) perf->Charge(FramePhase::RENDER);
 
     return gameOver;
 }
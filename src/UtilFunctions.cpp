@@ -22,6 +22,10 @@ namespace tetris {
         double elapsedFrames = static_cast<double>(elapsedMicroseconds.count()) * MicrosecondsToSeconds * FramesPerSecond;
         
         start = now;
+        step(elapsedFrames);
+    }
+
+    void GravityClock::step(double elapsedFrames) {
         totalElapsedFrames += elapsedFrames;
 
         double gravityPerFrame = _computeCurrentGravity();
@@ -56,6 +60,23 @@ namespace tetris {
         gravityIncrement = GIncrement;
     }
 
+    void GravityClock::saveState(ByteWriter& out) const {
+        out.PutDouble(totalElapsedFrames);
+        out.PutDouble(gravityAccumulator);
+        out.PutDouble(initialGravity);
+        out.PutDouble(gravityRampUpDelay);
+        out.PutDouble(gravityIncrement);
+    }
+
+    void GravityClock::loadState(ByteReader& in) {
+        totalElapsedFrames = in.GetDouble();
+        gravityAccumulator = in.GetDouble();
+        initialGravity = in.GetDouble();
+        gravityRampUpDelay = in.GetDouble();
+        gravityIncrement = in.GetDouble();
+        start = std::chrono::steady_clock::now();
+    }
+
     LockDelayTimer::LockDelayTimer() : resetsLeft(15), elapsed(0.0), active(false), firstTouch(false) {}
 
     void LockDelayTimer::Start() {
@@ -105,4 +126,18 @@ namespace tetris {
     void LockDelayTimer::ResetCounter() {
         resetsLeft = 15;
     }
+
+    void LockDelayTimer::SaveState(ByteWriter& out) const {
+        out.PutSigned(resetsLeft);
+        out.PutDouble(elapsed);
+        out.PutU8(static_cast<uint8_t>(active | firstTouch << 1));
+    }
+
+    void LockDelayTimer::LoadState(ByteReader& in) {
+        resetsLeft = static_cast<int>(in.GetSigned());
+        elapsed = in.GetDouble();
+        uint8_t flags = in.GetU8();
+        active = flags & 1;
+        firstTouch = flags & 2;
+    }
 }
\ No newline at end of file
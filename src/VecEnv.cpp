@@ -0,0 +1,190 @@
+#include "TetrisEngine/VecEnv.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace tetris {
+    namespace {
+        constexpr size_t BAG_SIZE = 7;
+        constexpr std::array<PieceType, BAG_SIZE> FULL_BAG = {
+            PieceType::I, PieceType::J, PieceType::L, PieceType::O, PieceType::S, PieceType::T, PieceType::Z
+        };
+
+        inline uint64_t NextRandom(uint64_t& state) {
+            uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        void ShuffleBag(PieceType* bag, uint64_t& rng) {
+            for (size_t i = BAG_SIZE - 1; i > 0; --i) {
+                size_t j = static_cast<size_t>(((NextRandom(rng) >> 32) * (i + 1)) >> 32);
+                std::swap(bag[i], bag[j]);
+            }
+        }
+    }
+
+    VecEnv::VecEnv(VecEnvConfig config)
+        : m_config(config),
+          m_pool(std::make_unique<ThreadPool>(config.threads)),
+          m_rows(config.numEnvs * TOTAL_BOARD_HEIGHT, 0),
+          m_current(config.numEnvs, PieceType::EMPTY),
+          m_hold(config.numEnvs, PieceType::EMPTY),
+          m_bags(config.numEnvs * 2 * BAG_SIZE, PieceType::EMPTY),
+          m_bagIndex(config.numEnvs, 0),
+          m_rng(config.numEnvs, 0),
+          m_backToBack(config.numEnvs, 0),
+          m_combo(config.numEnvs, 0),
+          m_pieces(config.numEnvs, 0),
+          m_lines(config.numEnvs, 0),
+          m_episodes(config.numEnvs, 0),
+          m_toppedOut(config.numEnvs, 0)
+    {
+        if (config.numEnvs == 0) throw std::invalid_argument("VecEnv needs at least one env");
+    }
+
+    VecEnv::~VecEnv() = default;
+
+    void VecEnv::Reset(const uint64_t* seeds, float* observations, uint8_t* masks) {
+        m_pool->ParallelFor(Size(), m_config.grain, [&](size_t begin, size_t end) {
+            for (size_t env = begin; env < end; ++env) {
+                m_rng[env] = seeds[env];
+                m_episodes[env] = 0;
+                m_toppedOut[env] = 0;
+                _resetEnv(env);
+                _observeEnv(env,
+                            observations ? observations + env * OBSERVATION_SIZE : nullptr,
+                            masks ? masks + env * ACTION_COUNT : nullptr);
+            }
+        });
+    }
+
+    void VecEnv::Step(const int32_t* actions, float* observations, float* rewards, uint8_t* dones, uint8_t* masks) {
+        m_pool->ParallelFor(Size(), m_config.grain, [&](size_t begin, size_t end) {
+            for (size_t env = begin; env < end; ++env) {
+                bool done = false;
+                float reward = _stepEnv(env, actions[env], done);
+                if (done) {
+                    ++m_episodes[env];
+                    _resetEnv(env);
+                }
+                rewards[env] = reward;
+                dones[env] = done ? 1 : 0;
+                _observeEnv(env,
+                            observations ? observations + env * OBSERVATION_SIZE : nullptr,
+                            masks ? masks + env * ACTION_COUNT : nullptr);
+            }
+        });
+    }
+
+    void VecEnv::Observe(float* observations, uint8_t* masks) const {
+        m_pool->ParallelFor(Size(), m_config.grain, [&](size_t begin, size_t end) {
+            for (size_t env = begin; env < end; ++env) {
+                _observeEnv(env,
+                            observations ? observations + env * OBSERVATION_SIZE : nullptr,
+                            masks ? masks + env * ACTION_COUNT : nullptr);
+            }
+        });
+    }
+
+    void VecEnv::GetNextQueue(size_t env, PieceType* out) const {
+        for (size_t i = 0; i < FEATURE_NEXT_PIECES; ++i) out[i] = _peek(env, i);
+    }
+
+    void VecEnv::_resetEnv(size_t env) {
+        std::fill_n(&m_rows[env * TOTAL_BOARD_HEIGHT], TOTAL_BOARD_HEIGHT, uint16_t{0});
+        m_hold[env] = PieceType::EMPTY;
+        m_backToBack[env] = 0;
+        m_combo[env] = 0;
+        m_pieces[env] = 0;
+        m_lines[env] = 0;
+
+        // 7-bag like Board, but drawn from this env's own splitmix stream, so the piece
+        // order for a seed differs from a Board's: shuffle the next bag, then draw
+        PieceType* bags = &m_bags[env * 2 * BAG_SIZE];
+        std::copy(FULL_BAG.begin(), FULL_BAG.end(), bags + BAG_SIZE);
+        ShuffleBag(bags + BAG_SIZE, m_rng[env]);
+        m_bagIndex[env] = 0;
+        m_current[env] = _pop(env);
+    }
+
+    PieceType VecEnv::_peek(size_t env, size_t ahead) const {
+        // The next bag follows the current one in memory, and ahead < FEATURE_NEXT_PIECES < BAG_SIZE
+        return m_bags[env * 2 * BAG_SIZE + m_bagIndex[env] + ahead];
+    }
+
+    PieceType VecEnv::_pop(size_t env) {
+        PieceType* bags = &m_bags[env * 2 * BAG_SIZE];
+        uint8_t& index = m_bagIndex[env];
+        index %= BAG_SIZE;
+        if (index == 0) {
+            std::copy_n(bags + BAG_SIZE, BAG_SIZE, bags);
+            ShuffleBag(bags + BAG_SIZE, m_rng[env]);
+        }
+        return bags[index++];
+    }
+
+    void VecEnv::_observeEnv(size_t env, float* observation, uint8_t* mask) const {
+        if (observation) {
+            PieceType next[FEATURE_NEXT_PIECES];
+            GetNextQueue(env, next);
+            EncodeFeatures(GetRows(env), m_current[env], m_hold[env], next, observation);
+        }
+        if (mask) {
+            LegalPlacements(GetRows(env), m_current[env], mask);
+            PieceType afterHold = m_hold[env] != PieceType::EMPTY ? m_hold[env] : _peek(env, 0);
+            LegalPlacements(GetRows(env), afterHold, mask + PLACEMENTS);
+        }
+    }
+
+    float VecEnv::_stepEnv(size_t env, int32_t action, bool& done) {
+        if (action < 0 || action >= ACTION_COUNT) {
+            done = true;
+            m_toppedOut[env] = 1;
+            return m_config.topOutReward;
+        }
+
+        if (action >= PLACEMENTS) {
+            if (m_hold[env] == PieceType::EMPTY) {
+                m_hold[env] = m_current[env];
+                m_current[env] = _pop(env);
+            } else {
+                std::swap(m_hold[env], m_current[env]);
+            }
+        }
+
+        const PieceType type = m_current[env];
+        const int placement = action % PLACEMENTS;
+        int x = 0, y = 0;
+        if (!FindPlacement(GetRows(env), type, placement, x, y)) {
+            done = true;
+            m_toppedOut[env] = 1;
+            return m_config.topOutReward;
+        }
+
+        uint16_t* rows = &m_rows[env * TOTAL_BOARD_HEIGHT];
+        PlacePiece(rows, GetPieceShape(type, static_cast<RotationState>(placement / BOARD_WIDTH)), x, y);
+        int lines = ClearLines(rows);
+        AttackResult attack = ComputeAttack(0, false, lines, m_backToBack[env], m_combo[env]);
+        ++m_pieces[env];
+        m_lines[env] += lines;
+        float reward = static_cast<float>(attack.Total());
+
+        // Spawn the next piece; a blocked spawn is a top-out, as in Board::SpawnNewPiece
+        const PieceType next = _pop(env);
+        m_current[env] = next;
+        const Point spawn = GetSpawnPosition(next);
+        if (!PieceFits(rows, GetPieceShape(next, RotationState::STATE_0), spawn.x, spawn.y)) {
+            done = true;
+            m_toppedOut[env] = 1;
+            return reward + m_config.topOutReward;
+        }
+
+        if (m_config.maxPieces && m_pieces[env] >= m_config.maxPieces) {
+            done = true;
+            m_toppedOut[env] = 0;
+        }
+        return reward;
+    }
+}
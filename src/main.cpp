@@ -1,9 +1,22 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
-// Testing imports
-#include <onnxruntime_cxx_api.h>
 #include "TetrisEngine/Board.h"
+#include "TetrisEngine/Bot.h"
 #include "TetrisEngine/Game.h"
+#include "TetrisEngine/Metrics.h"
+#include "TetrisEngine/NeuralNetwork.h"
+#include "TetrisEngine/Profiler.h"
+#include "TetrisEngine/Replay.h"
+#include "TetrisEngine/SimulationThread.h"
+#include "TetrisEngine/Spectator.h"
 #include "TetrisEngine/Ui.h"
 #include <raylib.h>
 #include <imgui.h>
@@ -11,25 +24,303 @@
 
 using namespace tetris;
 
-int main() {
-    // All this does is test to make sure onnxruntime is importing properly.
+// Captured during static initialization, as close to process start as we can get portably
+static const auto processStart = std::chrono::steady_clock::now();
+
+// Frame rate used when --max-fps is not given
+static int MaxFpsOr(int maxFps, int fallback) { return maxFps >= 0 ? maxFps : fallback; }
+
+static void PrintFrameStats(const FrameStats& stats) {
+    std::cout << "Rendered " << stats.GetFrames() << " frames, " << stats.GetLifetimeMeanMs() << " ms mean work per frame" << std::endl;
+}
+
+// Writes the profiler's zones as a Chrome trace when main returns, whichever mode ran
+struct TraceOnExit {
+    const char* path = nullptr;
+
+    ~TraceOnExit() {
+        if (!path) return;
+        try {
+            const size_t zones = profile::WriteChromeTrace(path);
+            std::cout << "Trace written to " << path << " (" << zones << " zones)" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+};
+
+// Read-only playback of a recorded game with instant seeking
+static int RunReplayViewer(const char* replayPath, int maxFps) {
+    std::unique_ptr<ReplayPlayer> player;
     try {
-        Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "TetrisEngineTest");
-        Ort::SessionOptions session_options;
-        session_options.SetIntraOpNumThreads(1);
+        player = std::make_unique<ReplayPlayer>(std::filesystem::path(replayPath));
+    } catch (const std::exception& e) {
+        std::cerr << "Replay load failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    int monitor = GetCurrentMonitor();
+    InitWindow(GetMonitorWidth(monitor), GetMonitorHeight(monitor), "Tetris Engine - Replay");
+    rlImGuiSetup(true);
+    auto pacer = std::make_unique<FramePacer>(MaxFpsOr(maxFps, 144));
+
+    const int cellSize = 30;
+    const int boardOffsetY = 100;
+    bool playing = true;
+    double lastSeekMs = 0.0;
+    double pendingTime = 0.0;
+    std::vector<std::unique_ptr<BoardRenderer>> renderers;
+    for (size_t i = 0; i < player->GetGame().playerCount(); ++i) renderers.push_back(std::make_unique<BoardRenderer>(cellSize));
+
+    while (!WindowShouldClose()) {
+        pacer->FrameStart();
+
+        // Play back at the recorded logical rate regardless of the render rate
+        if (playing) {
+            pendingTime += GetFrameTime();
+            while (pendingTime >= Game::FRAME_SECONDS) {
+                pendingTime -= Game::FRAME_SECONDS;
+                if (!player->Step()) playing = false;
+            }
+        } else {
+            pendingTime = 0.0;
+        }
+
+        BeginDrawing();
+        ClearBackground(BLACK);
+        rlImGuiBegin();
+
+        DrawReplayPanel(*player, playing, lastSeekMs);
+        const Game& game = player->GetGame();
+        for (size_t i = 0; i < game.playerCount(); ++i) {
+            const Board& board = game.getBoard(i);
+            int offsetX = 100 + 900 * static_cast<int>(i);
+            int playerNum = static_cast<int>(i);
+            // Seeking restores states without replaying their events, so the replay's panels read the board
+            BoardHud hud;
+            hud.Sync(board);
+            DrawQueuePanel(hud, playerNum, ImVec2(static_cast<float>(offsetX + 350), static_cast<float>(boardOffsetY)));
+            DrawHoldPanel(hud, playerNum, ImVec2(static_cast<float>(offsetX + 350), static_cast<float>(boardOffsetY + 300)));
+            DrawGarbagePanel(hud, playerNum, ImVec2(static_cast<float>(offsetX), static_cast<float>(boardOffsetY + 650)));
+            renderers[i]->Draw(board, offsetX, boardOffsetY);
+        }
+        DrawFrameStatsPanel(*pacer, ImVec2(600, 20));
+
+        rlImGuiEnd();
+        pacer->FrameEnd();
 
-        std::cout << "ONNX Runtime environment and session options initialized successfully." << std::endl;
-    } catch (const Ort::Exception& e) {
-        std::cerr << "ONNX Runtime initialization failed: " << e.what() << std::endl;
+        // A paused replay only redraws for input
+        if (playing) pacer->WakeAfter(Game::FRAME_SECONDS);
+        EndDrawing();
+    }
+
+    PrintFrameStats(pacer->GetStats());
+    pacer.reset();
+    renderers.clear();  // their textures must go before the GL context
+    rlImGuiShutdown();
+    CloseWindow();
+    return 0;
+}
+
+// Wall of live bot matches for keeping an eye on the farm; the simulations run on their own threads
+static int RunSpectatorWall(size_t matches, bool versus, double speed, const NeuralNetwork* network, int maxFps) {
+    HeuristicBot heuristic;
+    std::unique_ptr<NetworkBot> networkBot;
+    if (network) networkBot = std::make_unique<NetworkBot>(*network);
+    const Bot* bot = networkBot ? static_cast<const Bot*>(networkBot.get()) : &heuristic;
+
+    SpectatorConfig config;
+    config.matches = matches;
+    config.playersPerMatch = versus ? 2 : 1;
+    config.speed = speed;
+    config.seed = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::unique_ptr<SpectatorFeed> feed;
+    try {
+        feed = std::make_unique<SpectatorFeed>(std::vector<const Bot*>{bot}, config);
+    } catch (const std::exception& e) {
+        std::cerr << "Spectator setup failed: " << e.what() << std::endl;
         return 1;
     }
 
-    // list of previous commands
-    std::vector<std::string> commandHistory0;
-    std::vector<std::string> commandHistory1;
+    int monitor = GetCurrentMonitor();
+    InitWindow(GetMonitorWidth(monitor), GetMonitorHeight(monitor), "Tetris Engine - Spectator");
+    rlImGuiSetup(true);
+    auto pacer = std::make_unique<FramePacer>(MaxFpsOr(maxFps, 60));
+
+    auto wall = std::make_unique<SpectatorWallRenderer>();
+    PerformanceMonitor perf;
+    uint64_t lastFrames = 0;
+    double lastTime = GetTime();
+    double simRate = 0.0;
+    int result = 0;
+
+    while (!WindowShouldClose()) {
+        pacer->FrameStart();
+        perf.FrameStart();
+        try {
+            feed->Poll();
+        } catch (const std::exception& e) {
+            std::cerr << "Spectator simulation failed: " << e.what() << std::endl;
+            result = 1;
+            break;
+        }
+        perf.Charge(FramePhase::SIMULATION);
+
+        const double now = GetTime();
+        if (now - lastTime >= 1.0) {
+            const uint64_t frames = feed->GetFramesSimulated();
+            simRate = (frames - lastFrames) / (now - lastTime);
+            lastFrames = frames;
+            lastTime = now;
+        }
+
+        BeginDrawing();
+        ClearBackground(BLACK);
+        rlImGuiBegin();
+
+        const float top = 120.0f;
+        wall->Draw(*feed, Rectangle{0.0f, top, static_cast<float>(GetScreenWidth()), GetScreenHeight() - top});
+        perf.Charge(FramePhase::RENDER);
+        DrawSpectatorPanel(*feed, simRate);
+        DrawFrameStatsPanel(*pacer, ImVec2(420, 20));
+
+        // Search totals cover every board; the principal variation shown is the first board's
+        const InferenceStats inference = networkBot ? networkBot->GetInferenceStats() : InferenceStats{};
+        perf.SetBots(feed->GetSearchStats(), networkBot ? &inference : nullptr);
+        const SpectatorTile& first = feed->GetTile(0);
+        perf.SetPrincipalVariation(first.lastPiece, first.lastAction);
+        DrawPerformancePanel(perf, ImVec2(static_cast<float>(GetScreenWidth() - 320), 20));
+
+        rlImGuiEnd();
+        perf.Charge(FramePhase::IMGUI);
+        perf.FrameEnd();
+        pacer->FrameEnd();
+
+        // The matches publish about once per logical frame, so there is nothing newer to draw sooner
+        pacer->WakeAfter(Game::FRAME_SECONDS);
+        EndDrawing();
+    }
+
+    PrintFrameStats(pacer->GetStats());
+    pacer.reset();
+    wall.reset();  // its texture must go before the GL context
+    feed.reset();
+    rlImGuiShutdown();
+    CloseWindow();
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const char* modelPath = nullptr;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    size_t spectateMatches = 0;
+    bool spectateVersus = false;
+    double spectateSpeed = 1.0;
+    HandlingSettings handling;
+    int maxFps = -1;
+    const char* metricsPrefix = nullptr;
+    double metricsInterval = 10.0;
+    TraceOnExit trace;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--model") == 0 && i + 1 < argc) {
+            modelPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--spectate") == 0 && i + 1 < argc) {
+            spectateMatches = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--versus") == 0) {
+            spectateVersus = true;
+        } else if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            spectateSpeed = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--max-fps") == 0 && i + 1 < argc) {
+            maxFps = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--das") == 0 && i + 1 < argc) {
+            handling.dasMs = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--arr") == 0 && i + 1 < argc) {
+            handling.arrMs = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--sdf") == 0 && i + 1 < argc) {
+            handling.sdf = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace.path = argv[++i];
+        } else if (std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metricsPrefix = argv[++i];
+        } else if (std::strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc) {
+            metricsInterval = std::strtod(argv[++i], nullptr);
+        }
+    }
+
+    TETRIS_PROFILE_THREAD("main");
+    if (trace.path && !profile::ENABLED) {
+        std::cerr << "Built without ENABLE_PROFILE, so " << trace.path << " will hold no zones" << std::endl;
+    }
+
+    // Latency histograms and throughput go to PREFIX.prom and PREFIX.json while running and once more on exit
+    std::unique_ptr<metrics::MetricsExporter> metricsExporter;
+    if (metricsPrefix) {
+        try {
+            metricsExporter = std::make_unique<metrics::MetricsExporter>(metrics::MetricsExportOptions{
+                std::string(metricsPrefix) + ".prom", std::string(metricsPrefix) + ".json", metricsInterval});
+        } catch (const std::exception& e) {
+            std::cerr << "Bad metrics settings: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (replayPath) return RunReplayViewer(replayPath, maxFps);
+
+    // ONNX Runtime is only loaded when a model is configured; plain human play never touches it
+    std::unique_ptr<NeuralNetwork> network;
+    if (modelPath) {
+        try {
+            network = std::make_unique<NeuralNetwork>(modelPath);
+        } catch (const std::exception& e) {
+            std::cerr << "Model load failed: " << e.what() << std::endl;
+            return 1;
+        }
+
+        const ModelLoadStats stats = network->GetLoadStats();
+        double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - processStart).count();
+        std::cout << "Model loaded in " << stats.totalSeconds * 1000.0 << " ms"
+                  << " (runtime library " << stats.libraryLoadSeconds * 1000.0 << " ms"
+                  << ", cache " << (stats.cacheHit ? "hit" : "miss")
+                  << ", hash " << stats.hashSeconds * 1000.0 << " ms"
+                  << ", session " << stats.sessionSeconds * 1000.0 << " ms"
+                  << ", " << stats.mappedBytes / (1024 * 1024) << " MiB mapped)."
+                  << " Process startup to model ready: " << startupMs << " ms" << std::endl;
+
+        // Pick up new checkpoints as training publishes them, without pausing the game loop
+        ModelWatchOptions watchOptions;
+        watchOptions.onReload = [](uint64_t version, const ModelLoadStats& reloadStats) {
+            std::cout << "Model reloaded (version " << version << ", "
+                      << reloadStats.totalSeconds * 1000.0 << " ms off-thread)" << std::endl;
+        };
+        network->WatchForUpdates(std::move(watchOptions));
+    }
+
+    if (spectateMatches > 0) return RunSpectatorWall(spectateMatches, spectateVersus, spectateSpeed, network.get(), maxFps);
+
+    // Each player's panels follow their board's events
+    BoardEventReader events0;
+    BoardEventReader events1;
     
     // Pass RNG to board constructor
     Game game(2);
+    game.SetBoardTiming(true);  // for the performance panel
+    Game view(game.playerCount(), game.getRNG());
+    std::unique_ptr<SimulationThread> sim;
+    try {
+        sim = std::make_unique<SimulationThread>(game, handling);
+    } catch (const std::exception& e) {
+        std::cerr << "Bad handling settings: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // Inputs are recorded from the first frame; the file is written on exit
+    std::unique_ptr<ReplayRecorder> recorder;
+    if (recordPath) recorder = std::make_unique<ReplayRecorder>(game);
 
     // Raylib + ImGui
     int monitor = GetCurrentMonitor();
@@ -37,10 +328,12 @@ int main() {
     int screenHeight = GetMonitorHeight(monitor);
 
     InitWindow(screenWidth, screenHeight, "Tetris Engine - GUI Test");
-    // test FPS, set back to 60 if need
-    SetTargetFPS(144);
     rlImGuiSetup(true);
 
+    // Frames are drawn for input and for changes the simulation reports, up to the frame cap
+    auto pacer = std::make_unique<FramePacer>(MaxFpsOr(maxFps, 144));
+    sim->SetChangeCallback([wake = pacer.get()] { wake->Wake(); });
+
     // window borders
     bool gameOver0 = false;
     bool gameOver1 = false;
@@ -48,26 +341,77 @@ int main() {
     const int board0OffsetX = 100;
     const int board1OffsetX = 1000;
     const int boardOffsetY = 100;
+    auto renderer0 = std::make_unique<BoardRenderer>(cellSize);
+    auto renderer1 = std::make_unique<BoardRenderer>(cellSize);
+    PerformanceMonitor perf;
+
+    // The game runs on the simulation thread at the fixed logical rate; frames draw its latest snapshot
+    sim->Start();
+    int result = 0;
 
     // main loop add game stuff here
+    bool focused = IsWindowFocused();
     while (!WindowShouldClose()) {
-        game.Update();
+        pacer->FrameStart();
+        perf.FrameStart();
+        PollGameKeys(*sim, game.playerCount());
+
+        // Releases of keys held while focus is elsewhere never arrive, so let go of everything
+        const bool nowFocused = IsWindowFocused();
+        if (focused && !nowFocused) sim->Submit(GameCommand::ReleaseKeys());
+        focused = nowFocused;
+        try {
+            sim->UpdateView(view);
+        } catch (const std::exception& e) {
+            std::cerr << "Simulation failed: " << e.what() << std::endl;
+            result = 1;
+            break;
+        }
+        perf.SetSimulation(sim->PollStats());
+        perf.Charge(FramePhase::SIMULATION);
         BeginDrawing();
         ClearBackground(BLACK);
+        perf.Charge(FramePhase::RENDER);
 
         rlImGuiBegin();
 
-        gameOver0 = DrawPlayer(game, 0, board0OffsetX, boardOffsetY, commandHistory0, gameOver0, cellSize);
-        gameOver1 = DrawPlayer(game, 1, board1OffsetX, boardOffsetY, commandHistory1, gameOver1, cellSize);      
+        gameOver0 = DrawPlayer(*sim, view, 0, *renderer0, board0OffsetX, boardOffsetY, events0, gameOver0, &perf);
+        gameOver1 = DrawPlayer(*sim, view, 1, *renderer1, board1OffsetX, boardOffsetY, events1, gameOver1, &perf);
+        DrawFrameStatsPanel(*pacer, ImVec2(20, 20));
+        DrawPerformancePanel(perf, ImVec2(static_cast<float>(screenWidth - 320), 20));
         
         rlImGuiEnd();
+        perf.Charge(FramePhase::IMGUI);
+        perf.FrameEnd();
 
+        // Stamped as the frame is submitted, not after EndDrawing, which also waits for events and the frame cap
+        if (const int64_t inputNs = sim->TakeViewInputNs()) {
+            const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            metrics::RecordLatency(metrics::Latency::INPUT_TO_DISPLAY, static_cast<uint64_t>(std::max<int64_t>(0, now - inputNs)));
+        }
+        pacer->FrameEnd();
         EndDrawing();
     }
 
+    sim->Stop();
+    PrintFrameStats(pacer->GetStats());
+    pacer.reset();
+    renderer0.reset();
+    renderer1.reset();
     rlImGuiShutdown();
     CloseWindow();
     std::cout << "All graphics libraries closed successfully.\n";
 
-    return 0;
+    if (recorder) {
+        try {
+            recorder->Save(recordPath);
+            std::cout << "Replay saved to " << recordPath << " (" << recorder->GetEventCount() << " inputs, "
+                      << game.GetFrame() << " frames)" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    return result;
 }
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef GAMETESTUTILS_H
+#define GAMETESTUTILS_H
+
+// Helpers shared by the tests that play whole games.
+
+#include "TetrisEngine/Game.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace tetris {
+
+/**
+ * @brief Everything SaveState writes, for comparing two games byte for byte.
+ */
+inline std::vector<uint8_t> State(const Game& game) {
+    ByteWriter out;
+    game.SaveState(out);
+    return out.GetBuffer();
+}
+
+/**
+ * @brief Deterministic random inputs and garbage, leaving the boards in a messy mid-game position.
+ *
+ * Soft drops are weighted up so pieces also lock by lock delay inside StepFrame, and a board
+ * whose input is refused now and then resets, so topped-out boards play on.
+ */
+inline void Play(Game& game, uint64_t frames, unsigned int scriptSeed) {
+    std::mt19937 script(scriptSeed);
+    for (uint64_t frame = 0; frame < frames; ++frame) {
+        for (size_t player = 0; player < game.playerCount(); ++player) {
+            if (script() % 4 != 0) continue;
+            uint32_t roll = script() % 10;
+            InputType input = roll < 4 ? InputType::SOFT_DROP : static_cast<InputType>(script() % (INPUT_TYPE_COUNT - 1));
+            if (!game.ApplyInput(player, input) && script() % 50 == 0) game.ApplyInput(player, InputType::RESET);
+        }
+        if (frame % 240 == 120) game.AddGarbage(frame % 480 == 120 ? 0 : game.playerCount() - 1, 3);
+        game.StepFrame();
+    }
+}
+
+} // namespace tetris
+
+#endif // GAMETESTUTILS_H
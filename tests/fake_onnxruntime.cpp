@@ -0,0 +1,21 @@
+// Stand-in for the ONNX Runtime library in loader tests: exports OrtGetApiBase,
+// but like a runtime older than the headers it provides no usable API version.
+
+#include <onnxruntime_c_api.h>
+
+#ifdef _WIN32
+    #define FAKE_ORT_EXPORT __declspec(dllexport)
+#else
+    #define FAKE_ORT_EXPORT __attribute__((visibility("default")))
+#endif
+
+namespace {
+    const OrtApi* ORT_API_CALL GetApi(uint32_t) NO_EXCEPTION { return nullptr; }
+    const char* ORT_API_CALL GetVersionString() NO_EXCEPTION { return "0.0.0-fake"; }
+
+    const OrtApiBase apiBase = {GetApi, GetVersionString};
+}
+
+extern "C" FAKE_ORT_EXPORT const OrtApiBase* ORT_API_CALL OrtGetApiBase(void) NO_EXCEPTION {
+    return &apiBase;
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/ShardDataset.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace tetris;
+
+namespace {
+    // Three shards of 40, 40 and 17 records; outcome holds the record's global index
+    std::filesystem::path WriteDataset(const char* name, size_t records = 97) {
+        std::filesystem::path dir = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove_all(dir);
+
+        ShardWriter writer(dir, 40);
+        for (size_t i = 0; i < records; ++i) {
+            SelfPlayRecord record;
+            record.outcome = static_cast<float>(i);
+            record.rows[0] = static_cast<uint16_t>(i & FULL_ROW_MASK);
+            record.pieces = {static_cast<uint8_t>(PieceType::T), 0, 1, 2, 3, 4, 5};
+            record.policy[i % RECORD_ACTION_COUNT] = 65535;
+            writer.Append(&record, 1);
+        }
+        writer.Close();
+        return dir;
+    }
+}
+
+TEST(ShardDatasetTest, IndexesAndDecodesRecords) {
+    std::filesystem::path dir = WriteDataset("tetris_dataset_index");
+    {
+        ShardDataset dataset(dir);
+        EXPECT_FALSE(dataset.IndexWasLoaded());
+        EXPECT_EQ(dataset.GetShardCount(), 3u);
+        ASSERT_EQ(dataset.Size(), 97u);
+        EXPECT_EQ(dataset.GetRecord(85).outcome, 85.0f);
+        EXPECT_THROW(dataset.GetRecord(97), std::out_of_range);
+
+        uint64_t indices[] = {3, 41};
+        std::vector<float> obs(2 * BOARD_FEATURE_SIZE);
+        std::vector<float> policy(2 * DATASET_POLICY_SIZE);
+        float values[2];
+        dataset.Decode(indices, 2, obs.data(), policy.data(), values);
+        EXPECT_EQ(values[1], 41.0f);
+        EXPECT_EQ(obs[0], 1.0f);  // row 0 = 3: columns 0 and 1
+        EXPECT_EQ(obs[1], 1.0f);
+        EXPECT_EQ(obs[2], 0.0f);
+        EXPECT_EQ(obs[FEATURE_CELLS + static_cast<int>(PieceType::T) - 1], 1.0f);
+        EXPECT_FLOAT_EQ(policy[3], 1.0f);
+        EXPECT_FLOAT_EQ(policy[DATASET_POLICY_SIZE + 41], 1.0f);
+    }
+
+    ShardDataset reopened(dir);
+    EXPECT_TRUE(reopened.IndexWasLoaded());
+    EXPECT_EQ(reopened.Size(), 97u);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ShardDatasetTest, LoaderVisitsEveryRecordOncePerEpoch) {
+    std::filesystem::path dir = WriteDataset("tetris_dataset_epoch");
+    ShardDataset dataset(dir);
+
+    DatasetLoaderOptions options;
+    options.batchSize = 10;
+    options.threads = 3;
+    options.prefetchBatches = 4;
+    options.seed = 7;
+
+    std::vector<int> seen(dataset.Size(), 0);
+    std::vector<float> firstBatch;
+    {
+        DatasetLoader loader(dataset, options);
+        std::vector<float> obs(options.batchSize * BOARD_FEATURE_SIZE);
+        std::vector<float> values(options.batchSize);
+        for (int batch = 0; batch < 19; ++batch) {
+            loader.Next(obs.data(), nullptr, values.data());
+            if (batch == 0) firstBatch = values;
+            for (float v : values) ++seen[static_cast<size_t>(v)];
+        }
+        EXPECT_EQ(loader.GetStats().batchesServed, 19u);
+        EXPECT_EQ(loader.GetStats().epoch, 1u);
+    }
+    // 190 samples from 97 records: every record once, then 93 of them again
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), 0), 0);
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), 2), 93);
+
+    // Batches depend on the seed only, not on thread timing
+    options.threads = 1;
+    DatasetLoader again(dataset, options);
+    std::vector<float> obs(options.batchSize * BOARD_FEATURE_SIZE);
+    std::vector<float> values(options.batchSize);
+    again.Next(obs.data(), nullptr, values.data());
+    EXPECT_EQ(values, firstBatch);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ShardDatasetTest, RejectsCorruptHeaders) {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tetris_dataset_corrupt";
+    auto writeHeader = [&dir](const ShardHeader& header) {
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        std::ofstream(dir / "shard-000000.tsp", std::ios::binary).write(reinterpret_cast<const char*>(&header), sizeof(header));
+    };
+    auto error = [&dir]() -> std::string {
+        try {
+            ShardDataset dataset(dir);
+        } catch (const std::runtime_error& e) {
+            return e.what();
+        }
+        return "";
+    };
+
+    // 2^61 records of 232 bytes wrap to zero bytes when multiplied out
+    ShardHeader header;
+    header.recordSize = sizeof(SelfPlayRecord);
+    header.recordCount = uint64_t{1} << 61;
+    writeHeader(header);
+    EXPECT_NE(error().find("truncated"), std::string::npos);
+
+    // The message names the field that is off, not the version
+    header.recordCount = 0;
+    header.recordSize = sizeof(SelfPlayRecord) + 8;
+    writeHeader(header);
+    EXPECT_NE(error().find("record size"), std::string::npos);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/EvalCache.h"
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+
+TEST(EvalCacheTest, MissThenHit) {
+    EvalCache cache(1024, 2);
+    std::array<float, 2> out{};
+    const std::array<float, 2> value{0.25f, -1.5f};
+
+    EXPECT_FALSE(cache.Lookup(42, out.data()));
+    cache.Insert(42, value.data());
+    ASSERT_TRUE(cache.Lookup(42, out.data()));
+    EXPECT_EQ(out, value);
+
+    EvalCacheStats stats = cache.GetStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_DOUBLE_EQ(stats.HitRate(), 0.5);
+}
+
+TEST(EvalCacheTest, ModelVersionChangesKey) {
+    EvalCache cache(1024, 1);
+    float value = 3.0f, out = 0.0f;
+    cache.Insert(EvalCache::MakeKey(1234, 0), &value);
+
+    EXPECT_TRUE(cache.Lookup(EvalCache::MakeKey(1234, 0), &out));
+    EXPECT_FALSE(cache.Lookup(EvalCache::MakeKey(1234, 1), &out));
+}
+
+TEST(EvalCacheTest, StaysBoundedAndEvicts) {
+    EvalCache cache(256, 1, 4);
+    const size_t capacity = cache.GetStats().capacity;
+
+    for (uint64_t i = 1; i <= capacity * 4; ++i) {
+        float value = static_cast<float>(i);
+        cache.Insert(EvalCache::MakeKey(i, 0), &value);
+    }
+
+    EvalCacheStats stats = cache.GetStats();
+    EXPECT_LE(stats.entries, capacity);
+    EXPECT_GT(stats.evictions, 0u);
+    EXPECT_EQ(stats.inserts, capacity * 4);
+}
+
+TEST(EvalCacheTest, ReferencedEntriesSurviveEviction) {
+    // One shard, one bucket: every key competes for the same 8 ways
+    EvalCache cache(EvalCache::WAYS, 1, 1);
+    float value = 1.0f, out = 0.0f;
+    for (uint64_t k = 1; k <= EvalCache::WAYS; ++k) cache.Insert(k, &value);
+
+    ASSERT_TRUE(cache.Lookup(1, &out)); // sets the CLOCK bit of the hand's first candidate
+    cache.Insert(100, &value);
+
+    EXPECT_TRUE(cache.Lookup(1, &out));
+    EXPECT_FALSE(cache.Lookup(2, &out));
+}
+
+TEST(EvalCacheTest, ConcurrentReadersNeverSeeTornValues) {
+    constexpr size_t kValues = 16;
+    EvalCache cache(64, kValues, 2);
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> torn{0};
+
+    std::thread writer([&] {
+        std::array<float, kValues> value{};
+        for (int round = 0; !stop.load(); ++round) {
+            value.fill(static_cast<float>(round));
+            for (uint64_t k = 1; k <= 32; ++k) cache.Insert(k, value.data());
+        }
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&] {
+            std::array<float, kValues> out{};
+            for (int i = 0; i < 20000; ++i) {
+                if (!cache.Lookup(1 + i % 32, out.data())) continue;
+                for (float v : out) {
+                    if (v != out[0]) { torn.fetch_add(1); break; }
+                }
+            }
+        });
+    }
+
+    for (auto& reader : readers) reader.join();
+    stop.store(true);
+    writer.join();
+    EXPECT_EQ(torn.load(), 0u);
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/Board.h"
+#include "TetrisEngine/GameEvents.h"
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+
+namespace {
+    std::vector<GameEvent> DrainAll(const GameEventRing& ring, uint64_t& cursor) {
+        std::vector<GameEvent> events;
+        ring.Drain(cursor, [&](const GameEvent& event) { events.push_back(event); });
+        return events;
+    }
+
+    void ExpectHudMatches(const BoardHud& hud, const Board& board) {
+        BoardHud expected;
+        expected.Sync(board);
+        EXPECT_EQ(hud.held, expected.held);
+        EXPECT_EQ(hud.canHold, expected.canHold);
+        EXPECT_EQ(hud.next, expected.next);
+        EXPECT_EQ(hud.pending, expected.pending);
+        EXPECT_EQ(hud.combo, expected.combo);
+        EXPECT_EQ(hud.b2b, expected.b2b);
+        EXPECT_EQ(hud.lines, expected.lines);
+        EXPECT_EQ(hud.attack, expected.attack);
+        EXPECT_EQ(hud.gameOver, expected.gameOver);
+    }
+}
+
+TEST(EventsTest, RingBroadcastsToEveryReaderAndCountsOverwrites) {
+    EventRing<uint64_t, 8> ring;
+    uint64_t early = 0;
+    for (uint64_t i = 0; i < 5; ++i) ring.Push(i);
+    uint64_t late = ring.GetHead();
+    for (uint64_t i = 5; i < 12; ++i) ring.Push(i);
+
+    // The early reader lost the four overwritten events and sees the rest in order
+    std::vector<uint64_t> seen;
+    EXPECT_EQ(ring.Drain(early, [&](uint64_t value) { seen.push_back(value); }), 4u);
+    EXPECT_EQ(seen, (std::vector<uint64_t>{4, 5, 6, 7, 8, 9, 10, 11}));
+
+    seen.clear();
+    EXPECT_EQ(ring.Drain(late, [&](uint64_t value) { seen.push_back(value); }), 0u);
+    EXPECT_EQ(seen, (std::vector<uint64_t>{5, 6, 7, 8, 9, 10, 11}));
+    EXPECT_EQ(early, late);
+
+    // Across threads, whatever a reader gets is whole and in order
+    constexpr uint64_t COUNT = 200000;
+    EventRing<GameEvent, 64> events;
+    std::thread writer([&] {
+        for (uint64_t i = 1; i <= COUNT; ++i) {
+            GameEvent event;
+            event.frame = static_cast<uint32_t>(i);
+            event.next = static_cast<uint32_t>(i * 3);
+            events.Push(event);
+        }
+    });
+    uint64_t cursor = 0;
+    uint64_t lost = 0;
+    uint64_t received = 0;
+    uint32_t last = 0;
+    while (received + lost < COUNT) {
+        lost += events.Drain(cursor, [&](const GameEvent& event) {
+            ASSERT_GT(event.frame, last);
+            ASSERT_EQ(event.next, event.frame * 3);
+            last = event.frame;
+            ++received;
+        });
+    }
+    writer.join();
+    EXPECT_EQ(received + lost, COUNT);
+}
+
+TEST(EventsTest, BoardEmitsWhatHappens) {
+    Game game(1, 11);
+    Board& board = game.getBoard(0);
+    uint64_t cursor = 0;
+
+    std::vector<GameEvent> events = DrainAll(board.GetEvents(), cursor);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].type, GameEventType::RESET);
+    EXPECT_EQ(events[1].type, GameEventType::SPAWN);
+    EXPECT_EQ(events[1].piece, board.GetCurrentPiece()->GetType());
+    const std::vector<PieceType> next = board.GetNextQueue();
+    for (size_t i = 0; i < EVENT_NEXT_PIECES; ++i) EXPECT_EQ(events[1].NextPiece(i), next[i]);
+
+    game.ApplyInput(0, InputType::MOVE_LEFT);
+    events = DrainAll(board.GetEvents(), cursor);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].type, GameEventType::MOVE);
+    EXPECT_EQ(events[0].dx, -1);
+    EXPECT_EQ(events[0].x, board.GetCurrentPiecePosition().x);
+
+    const PieceType first = board.GetCurrentPiece()->GetType();
+    game.ApplyInput(0, InputType::HOLD);
+    events = DrainAll(board.GetEvents(), cursor);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].type, GameEventType::HOLD);
+    EXPECT_EQ(events[0].piece, first);
+    EXPECT_EQ(events[1].type, GameEventType::SPAWN);
+
+    game.AddGarbage(0, 3);
+    game.ApplyInput(0, InputType::HARD_DROP);
+    events = DrainAll(board.GetEvents(), cursor);
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].type, GameEventType::GARBAGE_RECEIVED);
+    EXPECT_EQ(events[0].lines, 3);
+    EXPECT_EQ(events[0].pending, 3);
+    EXPECT_EQ(events[1].type, GameEventType::LOCK);
+    EXPECT_EQ(events[1].lines, 0);
+    EXPECT_EQ(events[1].pending, 0);    // no clear, so the garbage rose
+    EXPECT_EQ(events[2].type, GameEventType::SPAWN);
+
+    char text[64];
+    FormatGameEvent(events[0], text, sizeof(text));
+    EXPECT_STREQ(text, "Received 3 lines (3 pending)");
+}
+
+TEST(EventsTest, FoldedHudMatchesTheBoard) {
+    Game game(2, 5);
+    std::mt19937 rng(17);
+    std::array<BoardEventReader, 2> readers;
+    const InputType inputs[] = {InputType::MOVE_LEFT, InputType::MOVE_RIGHT, InputType::ROTATE_CW,
+                                InputType::HOLD, InputType::HARD_DROP, InputType::HARD_DROP, InputType::SOFT_DROP};
+
+    int locks = 0;
+    for (int step = 0; step < 4000; ++step) {
+        const size_t player = rng() % 2;
+        if (game.getBoard(player).IsGameOver()) {
+            game.ApplyInput(player, InputType::RESET);
+        } else if (rng() % 8 == 0) {
+            game.StepFrame();
+        } else if (rng() % 40 == 0) {
+            game.AddGarbage(player, 1 + static_cast<int>(rng() % 4));
+        } else {
+            game.ApplyInput(player, inputs[rng() % (sizeof(inputs) / sizeof(inputs[0]))]);
+        }
+
+        for (size_t i = 0; i < 2; ++i) {
+            const Board& board = game.getBoard(i);
+            readers[i].Update(board.GetEvents(), board);
+            ExpectHudMatches(readers[i].GetHud(), board);
+            ASSERT_FALSE(::testing::Test::HasFailure()) << "step " << step << ", player " << i;
+        }
+    }
+
+    for (const BoardEventReader& reader : readers) {
+        EXPECT_EQ(reader.GetLost(), 0u);
+        EXPECT_EQ(reader.GetRecentCount(), BoardEventReader::RECENT);
+        for (size_t i = 0; i < reader.GetRecentCount(); ++i) {
+            const GameEvent& event = reader.GetRecent(i);
+            EXPECT_FALSE(event.type == GameEventType::MOVE && event.dy < 0);
+            if (event.type == GameEventType::LOCK) ++locks;
+        }
+    }
+    EXPECT_GT(locks, 0);
+}
+
+TEST(EventsTest, ClearsCancelGarbageBeforeSendingIt) {
+    Game game(2, 3);
+    game.GetGarbageRouter().SetDelayFrames(0);
+    Board& board = game.getBoard(0);
+
+    // Two rows of I pieces short of the last two columns, which an O then fills for a double
+    auto stack = [&] {
+        for (int dx : {-3, 1, -3, 1}) {
+            board.SpawnNewPiece(PieceType::I);
+            board.MoveActivePiece(dx, 0);
+            board.HardDropActivePiece();
+        }
+    };
+    auto clear = [&] {
+        board.SpawnNewPiece(PieceType::O);
+        board.MoveActivePiece(4, 0);
+        uint64_t cursor = board.GetEvents().GetHead();
+        board.HardDropActivePiece();
+        return DrainAll(board.GetEvents(), cursor);
+    };
+
+    stack();
+    game.AddGarbage(0, 1);
+    std::vector<GameEvent> events = clear();
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].type, GameEventType::LOCK);
+    EXPECT_EQ(events[0].lines, 2);
+    EXPECT_EQ(events[1].type, GameEventType::CLEAR);
+    EXPECT_EQ(events[1].lines, 2);
+    EXPECT_EQ(events[1].spin, SpinType::NONE);
+    EXPECT_EQ(events[1].combo, 1);
+    EXPECT_EQ(events[2].type, GameEventType::GARBAGE_CANCELLED);
+    EXPECT_EQ(events[2].lines, 1);
+    EXPECT_EQ(events[2].pending, 0);
+
+    // With nothing left to cancel the attack goes out; the I locks in between broke the combo
+    stack();
+    uint64_t opponent = game.getBoard(1).GetEvents().GetHead();
+    events = clear();
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[1].combo, 1);
+    EXPECT_EQ(events[2].type, GameEventType::GARBAGE_SENT);
+    EXPECT_EQ(events[2].lines, 1);
+
+    char text[64];
+    FormatGameEvent(events[1], text, sizeof(text));
+    EXPECT_STREQ(text, "Clear double (combo 1, B2B 0)");
+
+    // With no delivery delay the router queues it on the opponent straight away
+    bool received = false;
+    game.getBoard(1).GetEvents().Drain(opponent, [&](const GameEvent& event) {
+        if (event.type == GameEventType::GARBAGE_RECEIVED) received = event.lines == 1;
+    });
+    EXPECT_TRUE(received);
+}
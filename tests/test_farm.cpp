@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "GameTestUtils.h"
+#include "TetrisEngine/Farm.h"
+#include "TetrisEngine/TaskScheduler.h"
+#include <atomic>
+#include <stdexcept>
+
+using namespace tetris;
+
+namespace {
+    bool SameResult(const MatchResult& a, const MatchResult& b) {
+        if (a.seed != b.seed || a.frames != b.frames || a.winner != b.winner || a.playerCount != b.playerCount) return false;
+        for (size_t i = 0; i < a.playerCount; ++i) {
+            const MatchPlayerResult& x = a.players[i];
+            const MatchPlayerResult& y = b.players[i];
+            if (x.pieces != y.pieces || x.lines != y.lines || x.attack != y.attack || x.toppedOut != y.toppedOut) return false;
+        }
+        return true;
+    }
+}
+
+TEST(FarmTest, ReseededGameMatchesFreshGame) {
+    Game reused(2, 1);
+    for (int frame = 0; frame < 300; ++frame) {
+        reused.ApplyInput(frame % 2, frame % 7 ? InputType::MOVE_LEFT : InputType::HARD_DROP);
+        reused.StepFrame();
+    }
+    reused.AddGarbage(1, 3);
+
+    reused.Reset(99);
+    Game fresh(2, 99);
+    EXPECT_EQ(reused.getRNG(), 99u);
+    EXPECT_EQ(State(reused), State(fresh));
+}
+
+TEST(FarmTest, SchedulerRunsNestedTasksAndRethrows) {
+    TaskScheduler scheduler(4);
+    std::atomic<int> leaves{0};
+    for (int i = 0; i < 64; ++i) {
+        scheduler.Submit([&](size_t) {
+            for (int j = 0; j < 16; ++j) scheduler.Submit([&](size_t worker) {
+                EXPECT_LT(worker, scheduler.Size());
+                ++leaves;
+            });
+        });
+    }
+    scheduler.Wait();
+    EXPECT_EQ(leaves.load(), 64 * 16);
+
+    scheduler.Submit([](size_t) { throw std::runtime_error("boom"); });
+    scheduler.Submit([&](size_t) { ++leaves; });
+    EXPECT_THROW(scheduler.Wait(), std::runtime_error);
+    EXPECT_EQ(leaves.load(), 64 * 16 + 1);
+    scheduler.Wait();  // error was consumed
+}
+
+TEST(FarmTest, MatchesAreReproducibleAcrossArenas) {
+    HeuristicBot strong;
+    HeuristicWeights sloppy;
+    sloppy.holes = 0.0f;
+    sloppy.bumpiness = 0.0f;
+    HeuristicBot weak(sloppy);
+    const Bot* seats[2] = {&strong, &weak};
+
+    MatchConfig config;
+    config.piecesPerSecond = 3.0;
+    config.maxFrames = 90 * Game::FRAMES_PER_SECOND;
+
+    MatchArena busy;
+    busy.Play(seats, 1, 5, config);  // leaves both game slots dirty
+    busy.Play(seats, 2, 6, config);
+    MatchResult reused = busy.Play(seats, 2, 7, config);
+    MatchResult fresh = MatchArena().Play(seats, 2, 7, config);
+    EXPECT_TRUE(SameResult(reused, fresh));
+
+    EXPECT_EQ(reused.playerCount, 2);
+    EXPECT_GT(reused.players[0].pieces, 20u);
+    EXPECT_GT(reused.players[0].lines, 0u);
+    EXPECT_EQ(reused.winner, 0);  // a bot that ignores holes digs its own grave
+
+    MatchResult solo = busy.Play(seats, 1, 7, config);
+    EXPECT_EQ(solo.winner, -1);
+    EXPECT_GT(solo.players[0].lines, 0u);
+    EXPECT_THROW(busy.Play(seats, 0, 1, config), std::invalid_argument);
+}
+
+TEST(FarmTest, RatingsFollowTheReferenceExamples) {
+    // Worked example from Glickman's Glicko-2 paper
+    GlickoRating player{1500.0, 200.0, 0.06};
+    const GlickoOutcome games[] = {{1400.0, 30.0, 1.0}, {1550.0, 100.0, 0.0}, {1700.0, 300.0, 0.0}};
+    UpdateGlicko(player, games, 3);
+    EXPECT_NEAR(player.rating, 1464.06, 0.05);
+    EXPECT_NEAR(player.deviation, 151.52, 0.05);
+    EXPECT_NEAR(player.volatility, 0.05999, 0.00001);
+
+    double a = 1500.0, b = 1500.0;
+    UpdateElo(a, b, 1.0, 16.0);
+    EXPECT_DOUBLE_EQ(a, 1508.0);
+    EXPECT_DOUBLE_EQ(b, 1492.0);
+
+    FarmStats stats(2);
+    MatchResult result;
+    result.playerCount = 2;
+    result.frames = 3600;
+    result.winner = 1;
+    result.players[1] = {120, 40, 30, false};
+    const size_t seats[2] = {0, 1};
+    stats.Add(result, seats);
+    stats.EndRatingPeriod();
+    const ParticipantStats& winner = stats.GetParticipants()[1];
+    EXPECT_EQ(winner.wins, 1u);
+    EXPECT_DOUBLE_EQ(winner.AttackPerMinute(), 30.0);
+    EXPECT_DOUBLE_EQ(winner.PiecesPerSecond(), 2.0);
+    EXPECT_GT(winner.glicko.rating, stats.GetParticipants()[0].glicko.rating);
+}
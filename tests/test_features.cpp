@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/Features.h"
+#include "TetrisEngine/Game.h"
+#include <vector>
+
+using namespace tetris;
+
+namespace {
+    size_t PieceSlot(PieceType type) { return static_cast<size_t>(type) - 1; }
+}
+
+TEST(FeaturesTest, EncodesCellsAndOneHotPieces) {
+    uint16_t rows[VISIBLE_BOARD_HEIGHT] = {};
+    rows[0] = 0b1000000001;
+    rows[19] = 0b0000010000;
+    const PieceType next[FEATURE_NEXT_PIECES] = {PieceType::I, PieceType::Z, PieceType::EMPTY, PieceType::G, PieceType::O};
+
+    std::vector<float> out(BOARD_FEATURE_SIZE, 7.0f);
+    EncodeFeatures(rows, PieceType::T, PieceType::EMPTY, next, out.data());
+
+    EXPECT_EQ(out[0], 1.0f);
+    EXPECT_EQ(out[1], 0.0f);
+    EXPECT_EQ(out[9], 1.0f);
+    EXPECT_EQ(out[19 * BOARD_WIDTH + 4], 1.0f);
+
+    const float* pieces = out.data() + FEATURE_CELLS;
+    EXPECT_EQ(pieces[PieceSlot(PieceType::T)], 1.0f);
+    for (size_t i = 0; i < FEATURE_PIECE_TYPES; ++i) EXPECT_EQ(pieces[FEATURE_PIECE_TYPES + i], 0.0f);
+    EXPECT_EQ(pieces[FEATURE_PIECE_TYPES * 2 + PieceSlot(PieceType::I)], 1.0f);
+    EXPECT_EQ(pieces[FEATURE_PIECE_TYPES * 3 + PieceSlot(PieceType::Z)], 1.0f);
+    EXPECT_EQ(pieces[FEATURE_PIECE_TYPES * 6 + PieceSlot(PieceType::O)], 1.0f);
+
+    // Every float was written; EMPTY and G slots stay all zero
+    float total = 0.0f;
+    for (float value : out) total += value;
+    EXPECT_EQ(total, 3.0f + 4.0f);
+}
+
+TEST(FeaturesTest, EncodeBoardMatchesRawState) {
+    Game game(1, 11);
+    Board& board = game.getBoard(0);
+    board.SpawnNewPiece(PieceType::L);
+    board.HardDropActivePiece();
+    board.SpawnNewPiece(PieceType::S);
+    board.HoldPiece();
+
+    uint16_t rows[VISIBLE_BOARD_HEIGHT];
+    for (int row = 0; row < VISIBLE_BOARD_HEIGHT; ++row) rows[row] = board.GetRowMask(row);
+    const std::vector<PieceType> next = board.GetNextQueue();
+    ASSERT_EQ(next.size(), FEATURE_NEXT_PIECES);
+
+    std::vector<float> expected(BOARD_FEATURE_SIZE);
+    EncodeFeatures(rows, board.GetCurrentPiece()->GetType(), board.GetHeldPieceType(), next.data(), expected.data());
+    std::vector<float> actual(BOARD_FEATURE_SIZE);
+    EncodeBoard(board, actual.data());
+
+    EXPECT_EQ(actual, expected);
+    EXPECT_EQ(actual[FEATURE_CELLS + FEATURE_PIECE_TYPES + PieceSlot(PieceType::S)], 1.0f);
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/FrameStats.h"
+#include "TetrisEngine/SimulationThread.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace tetris;
+
+TEST(FrameStatsTest, WindowedPercentilesAndRate) {
+    FrameStats stats;
+    EXPECT_EQ(stats.GetFramesPerSecond(), 0.0);
+    EXPECT_EQ(stats.GetPercentileMs(99.0), 0.0);
+
+    // 100 frames of 1..100 ms, ten per second
+    for (int i = 1; i <= 100; ++i) stats.Record(i / 1000.0, i * 0.1);
+    EXPECT_EQ(stats.GetFrames(), 100u);
+    EXPECT_NEAR(stats.GetMeanMs(), 50.5, 1e-9);
+    EXPECT_NEAR(stats.GetPercentileMs(50.0), 50.0, 1e-9);
+    EXPECT_NEAR(stats.GetPercentileMs(99.0), 99.0, 1e-9);
+    EXPECT_NEAR(stats.GetMaxMs(), 100.0, 1e-9);
+    EXPECT_NEAR(stats.GetFramesPerSecond(), 10.0, 1.0);
+
+    // Old frames leave the window but stay in the lifetime mean
+    for (size_t i = 0; i < FrameStats::WINDOW; ++i) stats.Record(0.002, 20.0 + i * 0.001);
+    EXPECT_NEAR(stats.GetMaxMs(), 2.0, 1e-9);
+    EXPECT_NEAR(stats.GetPercentileMs(99.0), 2.0, 1e-9);
+    EXPECT_GT(stats.GetLifetimeMeanMs(), 2.0);
+    EXPECT_EQ(stats.GetFramesPerSecond(), static_cast<double>(FrameStats::WINDOW));
+}
+
+TEST(FrameStatsTest, IdleSimulationDoesNotAskForFrames) {
+    Game game(1, 13);
+    SimulationThread sim(game);
+    std::atomic<int> changes{0};
+    sim.SetChangeCallback([&] { changes.fetch_add(1); });
+    sim.Start();
+
+    // Initial gravity moves a row every 50 frames, so a fifth of a second of play draws nothing
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_GT(sim.GetFramesSimulated(), 5u);
+    EXPECT_EQ(changes.load(), 0);
+
+    sim.Submit(GameCommand::Input(0, InputType::MOVE_RIGHT));
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (changes.load() == 0 && std::chrono::steady_clock::now() < deadline) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    sim.Stop();
+    EXPECT_GE(changes.load(), 1);
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "GameTestUtils.h"
+#include "TetrisEngine/Game.h"
+#include "TetrisEngine/ThreadPool.h"
+
+using namespace tetris;
+
+namespace {
+    // Two rows filled but for columns 8-9, with an O resting above the gap: the next
+    // gravity tick starts lock delay, and the lock inside StepFrame sends a double
+    void SetUpDouble(Board& board) {
+        for (int row = 0; row < 2; ++row) {
+            for (int shift : {0, 4}) {
+                board.SpawnNewPiece(PieceType::I);
+                for (int i = 0; i < BOARD_WIDTH; ++i) board.MoveActivePiece(-1, 0);
+                for (int i = 0; i < shift; ++i) board.MoveActivePiece(1, 0);
+                board.HardDropActivePiece();
+            }
+        }
+        board.SpawnNewPiece(PieceType::O);
+        for (int i = 0; i < BOARD_WIDTH; ++i) board.MoveActivePiece(1, 0);
+        while (board.MoveActivePiece(0, -1)) {}
+    }
+}
+
+TEST(GameTest, ParallelStepMatchesSerial) {
+    ThreadPool pool(4);
+    Game serial(48, 5), parallel(48, 5);
+    parallel.SetThreadPool(&pool, 2);
+    for (size_t player = 0; player < serial.playerCount(); ++player) {
+        auto strategy = static_cast<TargetingStrategy>(player % 4);
+        serial.GetGarbageRouter().SetStrategy(player, strategy);
+        parallel.GetGarbageRouter().SetStrategy(player, strategy);
+    }
+
+    // Most boards attack on the same frame, so routing order decides who cancels what
+    for (size_t player = 0; player < serial.playerCount(); ++player) {
+        if (player % 5 == 0) continue;
+        SetUpDouble(serial.getBoard(player));
+        SetUpDouble(parallel.getBoard(player));
+    }
+    for (int frame = 0; frame < 100; ++frame) {
+        serial.StepFrame();
+        parallel.StepFrame();
+    }
+    ASSERT_EQ(State(parallel), State(serial));
+    size_t attackers = 0;
+    for (size_t player = 0; player < serial.playerCount(); ++player) {
+        attackers += serial.GetGarbageRouter().GetTarget(player) != NO_TARGET;
+    }
+    EXPECT_GT(attackers, 10u);
+
+    for (unsigned int chunk = 1; chunk < 6; ++chunk) {
+        Play(serial, 500, chunk);
+        Play(parallel, 500, chunk);
+        ASSERT_EQ(State(parallel), State(serial)) << "diverged by frame " << serial.GetFrame();
+    }
+}
+
+TEST(GameTest, GridVersionTracksLockedCells) {
+    Game game(2, 3);
+    Board& board = game.getBoard(0);
+    const uint64_t initial = board.GetGridVersion();
+    EXPECT_NE(initial, game.getBoard(1).GetGridVersion());
+
+    // Moving and rotating the active piece leaves the locked cells alone
+    game.ApplyInput(0, InputType::MOVE_LEFT);
+    game.ApplyInput(0, InputType::ROTATE_CW);
+    game.ApplyInput(0, InputType::SOFT_DROP);
+    EXPECT_EQ(board.GetGridVersion(), initial);
+
+    // The ghost is where a hard drop lands
+    const Point ghost = board.GetGhostPosition();
+    const uint16_t repr = board.GetCurrentPiece()->GetCurrentRepresentation();
+    game.ApplyInput(0, InputType::HARD_DROP);
+    EXPECT_GT(board.GetGridVersion(), initial);
+    for (int i = 0; i < 16; ++i) {
+        if (repr & (1 << (15 - i))) {
+            EXPECT_NE(board.GetCellState(ghost.x + i % 4, ghost.y + i / 4), PieceType::EMPTY);
+        }
+    }
+
+    // Restoring a different position must invalidate anything cached for this board
+    ByteWriter out;
+    game.getBoard(1).SaveState(out);
+    const uint64_t beforeLoad = board.GetGridVersion();
+    ByteReader in(out.Data(), out.Size());
+    board.LoadState(in);
+    EXPECT_NE(board.GetGridVersion(), beforeLoad);
+
+    // ...but restoring the same cells again must not, or a view reloaded every frame would never hit the cache
+    const uint64_t afterLoad = board.GetGridVersion();
+    ByteReader again(out.Data(), out.Size());
+    board.LoadState(again);
+    EXPECT_EQ(board.GetGridVersion(), afterLoad);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "GameTestUtils.h"
+#include "TetrisEngine/GameSnapshot.h"
+#include <filesystem>
+
+using namespace tetris;
+
+TEST(GameSnapshotTest, RestoredGameContinuesIdentically) {
+    Game original(2, 42);
+    Play(original, 1500, 1);
+
+    std::vector<uint8_t> snapshot = SaveSnapshot(original);
+    ByteReader in(snapshot.data(), snapshot.size());
+    SnapshotInfo info = PeekSnapshot(in);
+    EXPECT_EQ(info.playerCount, 2u);
+    EXPECT_EQ(info.seed, 42u);
+    EXPECT_EQ(info.frame, 1500u);
+    EXPECT_EQ(info.payloadSize + SNAPSHOT_HEADER_SIZE, snapshot.size());
+
+    std::unique_ptr<Game> restored = LoadSnapshot(in);
+    EXPECT_TRUE(in.AtEnd());
+    EXPECT_EQ(State(*restored), State(original));
+
+    // Same future inputs, same future: bag, garbage holes, gravity and lock delay all line up
+    Play(original, 1500, 2);
+    Play(*restored, 1500, 2);
+    EXPECT_EQ(State(*restored), State(original));
+    for (size_t player = 0; player < 2; ++player) {
+        EXPECT_EQ(restored->getBoard(player).Hash(), original.getBoard(player).Hash());
+        EXPECT_EQ(restored->getBoard(player).GetScore(), original.getBoard(player).GetScore());
+    }
+}
+
+TEST(GameSnapshotTest, RejectsCorruptOrMismatchedSnapshots) {
+    Game game(2, 7);
+    Play(game, 600, 3);
+    const std::vector<uint8_t> snapshot = SaveSnapshot(game);
+
+    std::vector<uint8_t> flipped = snapshot;
+    flipped[SNAPSHOT_HEADER_SIZE + 20] ^= 0x10;
+    ByteReader flippedIn(flipped.data(), flipped.size());
+    EXPECT_THROW(LoadSnapshot(flippedIn), std::runtime_error);
+
+    std::vector<uint8_t> newer = snapshot;
+    newer[4] = SNAPSHOT_FORMAT_VERSION + 1;
+    ByteReader newerIn(newer.data(), newer.size());
+    EXPECT_THROW(PeekSnapshot(newerIn), std::runtime_error);
+
+    ByteReader truncated(snapshot.data(), snapshot.size() - 1);
+    EXPECT_THROW(LoadSnapshot(truncated), std::runtime_error);
+
+    Game solo(1, 7);
+    ByteReader in(snapshot.data(), snapshot.size());
+    EXPECT_THROW(RestoreSnapshot(solo, in), std::runtime_error);
+}
+
+TEST(GameSnapshotTest, FileHoldsManyGames) {
+    std::vector<std::unique_ptr<Game>> games;
+    std::vector<const Game*> pointers;
+    for (unsigned int i = 0; i < 64; ++i) {
+        games.push_back(std::make_unique<Game>(1 + i % 3, i));
+        Play(*games.back(), 100 + i * 10, i);
+        pointers.push_back(games.back().get());
+    }
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "tetris_snapshot_test.tgs";
+    SaveSnapshotFile(path, pointers);
+    std::vector<std::unique_ptr<Game>> loaded = LoadSnapshotFile(path);
+    std::filesystem::remove(path);
+
+    ASSERT_EQ(loaded.size(), games.size());
+    for (size_t i = 0; i < games.size(); ++i) {
+        EXPECT_EQ(loaded[i]->playerCount(), games[i]->playerCount());
+        EXPECT_EQ(loaded[i]->getRNG(), games[i]->getRNG());
+        EXPECT_EQ(State(*loaded[i]), State(*games[i]));
+    }
+}
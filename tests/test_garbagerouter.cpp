@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/GameSnapshot.h"
+#include "TetrisEngine/GarbageRouter.h"
+#include <random>
+#include <set>
+
+using namespace tetris;
+
+namespace {
+    GarbageRouter MakeRouter(size_t players, uint32_t delay = 0) {
+        GarbageRouter router(1, delay);
+        for (size_t i = 0; i < players; ++i) router.AddPlayer();
+        return router;
+    }
+}
+
+TEST(GarbageRouterTest, EvenCyclesThroughLivingOpponents) {
+    GarbageRouter router = MakeRouter(4);
+    router.SetAlive(2, false);
+
+    std::multiset<size_t> targets;
+    for (int i = 0; i < 6; ++i) targets.insert(router.Route(0, 1, 0));
+    EXPECT_EQ(targets.count(1), 3u);
+    EXPECT_EQ(targets.count(3), 3u);
+    EXPECT_EQ(targets.count(0) + targets.count(2), 0u);
+}
+
+TEST(GarbageRouterTest, RandomNeverPicksSelfOrDead) {
+    GarbageRouter router = MakeRouter(16);
+    router.SetStrategy(5, TargetingStrategy::RANDOM);
+    router.SetAlive(9, false);
+
+    std::set<size_t> seen;
+    for (int i = 0; i < 2000; ++i) seen.insert(router.Route(5, 1, 0));
+    EXPECT_EQ(seen.size(), 14u);
+    EXPECT_FALSE(seen.count(5));
+    EXPECT_FALSE(seen.count(9));
+}
+
+TEST(GarbageRouterTest, AttackersAndKnockoutsAndManual) {
+    GarbageRouter router = MakeRouter(5);
+
+    // 1 and 3 attack 0; 0 fights back against exactly them
+    router.SetManualTarget(1, 0);
+    router.SetManualTarget(3, 0);
+    router.SetStrategy(1, TargetingStrategy::MANUAL);
+    router.SetStrategy(3, TargetingStrategy::MANUAL);
+    EXPECT_EQ(router.Route(1, 1, 0), 0u);
+    EXPECT_EQ(router.Route(3, 1, 0), 0u);
+    EXPECT_EQ(router.GetAttackers(0).size(), 2u);
+
+    router.SetStrategy(0, TargetingStrategy::ATTACKERS);
+    std::set<size_t> answered;
+    for (int i = 0; i < 4; ++i) answered.insert(router.Route(0, 5, 0));  // 5 lines: 2 cancel, the rest goes out
+    EXPECT_EQ(answered, (std::set<size_t>{1, 3}));
+
+    // KOS goes for the tallest stack plus incoming garbage, but never yourself
+    router.SetStrategy(4, TargetingStrategy::KOS);
+    for (size_t i = 0; i < 5; ++i) router.SetDanger(i, 0);
+    router.SetDanger(2, 15);
+    router.SetDanger(4, 30);
+    EXPECT_EQ(router.Route(4, 1, 1), 2u);
+
+    // A knocked-out manual target falls back to EVEN
+    router.SetAlive(0, false);
+    EXPECT_TRUE(router.GetAttackers(0).empty());
+    EXPECT_NE(router.Route(3, 1, 2), 0u);
+}
+
+TEST(GarbageRouterTest, KnockoutTargetFollowsRevivals) {
+    GarbageRouter router = MakeRouter(3);
+    router.SetStrategy(0, TargetingStrategy::KOS);
+    router.SetDanger(1, 10);
+    router.SetDanger(2, 30);
+    router.SetAlive(2, false);
+    EXPECT_EQ(router.Route(0, 1, 5), 1u);
+
+    // Same frame, so only the alive change can refresh the cached pick
+    router.SetAlive(2, true);
+    EXPECT_EQ(router.Route(0, 1, 5), 2u);
+}
+
+TEST(GarbageRouterTest, DelayedDeliveryAndCancellation) {
+    Game game(2, 3);
+    game.GetGarbageRouter().SetDelayFrames(20);
+    Board& receiver = game.getBoard(1);
+
+    game.TransferGarbage(0, 4);
+    EXPECT_EQ(game.GetGarbageRouter().GetIncoming(1), 4);
+    for (int i = 0; i < 19; ++i) game.StepFrame();
+    EXPECT_EQ(receiver.GetGarbageQueue(), 0);
+
+    // Player 1 answers with 3 before it lands: only 1 line still arrives
+    game.TransferGarbage(1, 3);
+    EXPECT_EQ(game.GetGarbageRouter().GetIncoming(1), 1);
+    EXPECT_EQ(game.GetGarbageRouter().GetIncoming(0), 0);
+    game.StepFrame();
+    EXPECT_EQ(receiver.GetGarbageQueue(), 1);
+    EXPECT_EQ(game.GetGarbageRouter().GetIncoming(1), 0);
+}
+
+TEST(GarbageRouterTest, BattleRoyaleIsDeterministicAndSnapshots) {
+    auto play = [](Game& game, uint64_t frames) {
+        std::mt19937 script(11);
+        for (uint64_t frame = 0; frame < frames; ++frame) {
+            for (size_t player = 0; player < game.playerCount(); ++player) {
+                if (script() % 6 == 0) game.ApplyInput(player, static_cast<InputType>(script() % (INPUT_TYPE_COUNT - 1)));
+            }
+            if (frame % 30 == 0) game.TransferGarbage(script() % game.playerCount(), 2);
+            game.StepFrame();
+        }
+    };
+    auto setup = [](Game& game) {
+        for (size_t player = 0; player < game.playerCount(); ++player) {
+            game.GetGarbageRouter().SetStrategy(player, static_cast<TargetingStrategy>(player % 4));
+        }
+    };
+
+    Game a(64, 9), b(64, 9);
+    setup(a);
+    setup(b);
+    play(a, 1200);
+    play(b, 1200);
+    EXPECT_EQ(SaveSnapshot(a), SaveSnapshot(b));
+    EXPECT_LT(a.GetGarbageRouter().GetAliveCount(), 64u);
+
+    std::vector<uint8_t> snapshot = SaveSnapshot(a);
+    ByteReader in(snapshot.data(), snapshot.size());
+    std::unique_ptr<Game> restored = LoadSnapshot(in);
+    play(a, 600);
+    play(*restored, 600);
+    EXPECT_EQ(SaveSnapshot(*restored), SaveSnapshot(a));
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/InputHandler.h"
+#include "TetrisEngine/Piece.h"
+#include "TetrisEngine/SpscQueue.h"
+#include <thread>
+
+using namespace tetris;
+
+namespace {
+    bool CanMove(const Board& board, int dx, int dy) {
+        const Piece* piece = board.GetCurrentPiece();
+        return piece && board.IsValidPosition(piece->GetCurrentRepresentation(), board.GetCurrentPiecePosition() + Point{dx, dy});
+    }
+}
+
+TEST(InputTest, SpscQueueKeysOrderAcrossThreads) {
+    SpscQueue<uint64_t> queue(100);
+    EXPECT_EQ(queue.Capacity(), 128u);
+    for (uint64_t i = 0; i < 128; ++i) ASSERT_TRUE(queue.TryPush(i));
+    EXPECT_FALSE(queue.TryPush(128));
+    uint64_t value = 0;
+    for (uint64_t i = 0; i < 128; ++i) {
+        ASSERT_TRUE(queue.TryPop(value));
+        ASSERT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.TryPop(value));
+
+    constexpr uint64_t COUNT = 200000;
+    std::thread producer([&] {
+        for (uint64_t i = 1; i <= COUNT; ++i) {
+            while (!queue.TryPush(i)) std::this_thread::yield();
+        }
+    });
+    for (uint64_t expected = 1; expected <= COUNT; ++expected) {
+        while (!queue.TryPop(value)) std::this_thread::yield();
+        ASSERT_EQ(value, expected);
+    }
+    producer.join();
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(InputTest, DasThenArrInLogicalTime) {
+    Game game(1, 5);
+    const Board& board = game.getBoard(0);
+    InputHandler handler(0, HandlingSettings{100.0, 50.0, 20.0});
+    const int x0 = board.GetCurrentPiecePosition().x;
+
+    handler.OnKey(game, InputType::MOVE_LEFT, true, 0.0);
+    EXPECT_EQ(board.GetCurrentPiecePosition().x, x0 - 1);
+    EXPECT_DOUBLE_EQ(handler.NextDeadline(), 0.1);
+
+    handler.Advance(game, 0.099);
+    EXPECT_EQ(board.GetCurrentPiecePosition().x, x0 - 1);
+    handler.Advance(game, 0.1);
+    EXPECT_EQ(board.GetCurrentPiecePosition().x, x0 - 2);
+    handler.Advance(game, 0.151);
+    EXPECT_EQ(board.GetCurrentPiecePosition().x, x0 - 3);
+
+    // Against the wall, repeats are skipped instead of recorded as failed moves
+    handler.Advance(game, 2.0);
+    EXPECT_FALSE(CanMove(board, -1, 0));
+    EXPECT_EQ(handler.GetInputsSent(), static_cast<uint64_t>(x0 - board.GetCurrentPiecePosition().x));
+
+    // Releasing stops the repeats
+    handler.OnKey(game, InputType::MOVE_LEFT, false, 2.0);
+    EXPECT_EQ(handler.NextDeadline(), InputHandler::NEVER);
+}
+
+TEST(InputTest, LastDirectionWinsAndReleaseRechargesDas) {
+    Game game(1, 9);
+    const Board& board = game.getBoard(0);
+    InputHandler handler(0, HandlingSettings{100.0, 50.0, 20.0});
+    const int x0 = board.GetCurrentPiecePosition().x;
+
+    handler.OnKey(game, InputType::MOVE_LEFT, true, 0.0);
+    handler.OnKey(game, InputType::MOVE_RIGHT, true, 0.05);
+    EXPECT_EQ(board.GetCurrentPiecePosition().x, x0);
+    handler.Advance(game, 0.12);    // left's DAS would have run out; right's has not
+    EXPECT_EQ(board.GetCurrentPiecePosition().x, x0);
+
+    handler.OnKey(game, InputType::MOVE_RIGHT, false, 0.13);
+    handler.Advance(game, 0.229);
+    EXPECT_EQ(board.GetCurrentPiecePosition().x, x0);
+    handler.Advance(game, 0.23);
+    EXPECT_EQ(board.GetCurrentPiecePosition().x, x0 - 1);
+}
+
+TEST(InputTest, ZeroArrShiftsEveryPieceToTheWall) {
+    Game game(1, 3);
+    const Board& board = game.getBoard(0);
+    InputHandler handler(0, HandlingSettings{50.0, 0.0, 20.0});
+
+    handler.OnKey(game, InputType::MOVE_RIGHT, true, 0.0);
+    handler.Advance(game, 0.049);
+    EXPECT_TRUE(CanMove(board, 1, 0));
+    handler.Advance(game, 0.05);
+    EXPECT_FALSE(CanMove(board, 1, 0));
+    EXPECT_EQ(handler.NextDeadline(), InputHandler::NEVER);
+
+    // With DAS charged, the next piece goes straight to the wall too
+    handler.OnKey(game, InputType::HARD_DROP, true, 0.06);
+    EXPECT_FALSE(CanMove(board, 1, 0));
+}
+
+TEST(InputTest, HeldSoftDropFallsAtSdfAndNeverLocks) {
+    Game game(1, 4);
+    const Board& board = game.getBoard(0);
+    const double gravity = game.getGravityClock().getCurrentGravity();
+    const double interval = 1.0 / (gravity * 20.0 * Game::FRAMES_PER_SECOND);
+
+    InputHandler handler(0, HandlingSettings{133.0, 33.0, 20.0});
+    const int y0 = board.GetCurrentPiecePosition().y;
+    handler.OnKey(game, InputType::SOFT_DROP, true, 0.0);
+    EXPECT_EQ(board.GetCurrentPiecePosition().y, y0 - 1);
+    handler.Advance(game, 3.5 * interval);
+    EXPECT_EQ(board.GetCurrentPiecePosition().y, y0 - 4);
+
+    // Held long enough to land, the piece rests instead of locking
+    const PieceType type = board.GetCurrentPiece()->GetType();
+    handler.Advance(game, 200 * interval);
+    EXPECT_FALSE(CanMove(board, 0, -1));
+    EXPECT_EQ(board.GetCurrentPiece()->GetType(), type);
+
+    // SDF 0 drops to the floor on the press
+    Game instant(1, 4);
+    InputHandler sonic(0, HandlingSettings{133.0, 33.0, 0.0});
+    sonic.OnKey(instant, InputType::SOFT_DROP, true, 0.0);
+    EXPECT_FALSE(CanMove(instant.getBoard(0), 0, -1));
+    EXPECT_EQ(instant.getBoard(0).GetCurrentPiece()->GetType(), type);
+
+    EXPECT_THROW(InputHandler(0, HandlingSettings{-1.0, 0.0, 0.0}), std::invalid_argument);
+}
@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/Game.h"
+#include "TetrisEngine/Metrics.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+using namespace tetris::metrics;
+
+namespace {
+    std::string ReadFile(const std::filesystem::path& path) {
+        std::ifstream in(path);
+        std::stringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    }
+
+    size_t Index(Latency latency) { return static_cast<size_t>(latency); }
+    size_t Index(Counter counter) { return static_cast<size_t>(counter); }
+}
+
+TEST(MetricsTest, BucketsAreExactThenWithinTwoPercent) {
+    for (uint64_t value : {0ull, 1ull, 127ull}) {
+        EXPECT_EQ(LatencyHistogram::BucketLow(LatencyHistogram::BucketFor(value)), value);
+        EXPECT_EQ(LatencyHistogram::BucketHigh(LatencyHistogram::BucketFor(value)), value);
+    }
+    EXPECT_EQ(LatencyHistogram::BucketFor(128), LatencyHistogram::EXACT_LIMIT);
+
+    // Every value lands in a bucket that holds it, no wider than 1/64 of its low end
+    size_t last = 0;
+    for (uint64_t value = 100; value < (uint64_t{1} << LatencyHistogram::MAX_VALUE_BITS); value += value / 37 + 1) {
+        const size_t bucket = LatencyHistogram::BucketFor(value);
+        ASSERT_GE(bucket, last);
+        ASSERT_LE(LatencyHistogram::BucketLow(bucket), value);
+        ASSERT_GE(LatencyHistogram::BucketHigh(bucket), value);
+        ASSERT_LE(LatencyHistogram::BucketHigh(bucket) - LatencyHistogram::BucketLow(bucket),
+                  LatencyHistogram::BucketLow(bucket) / 64);
+        last = bucket;
+    }
+    EXPECT_EQ(LatencyHistogram::BucketFor(~uint64_t{0}), LatencyHistogram::BUCKET_COUNT - 1);
+}
+
+TEST(MetricsTest, PercentilesUseNearestRank) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.GetPercentile(50.0), 0u);
+
+    for (uint64_t value = 1; value <= 100; ++value) histogram.Record(value);
+    EXPECT_EQ(histogram.GetCount(), 100u);
+    EXPECT_EQ(histogram.GetSum(), 5050u);
+    EXPECT_EQ(histogram.GetMax(), 100u);
+    EXPECT_DOUBLE_EQ(histogram.GetMean(), 50.5);
+    EXPECT_EQ(histogram.GetPercentile(0.0), 1u);
+    EXPECT_EQ(histogram.GetPercentile(50.0), 50u);
+    EXPECT_EQ(histogram.GetPercentile(99.0), 99u);
+    EXPECT_EQ(histogram.GetPercentile(100.0), 100u);
+
+    // A lone large value reports its bucket's top, capped at the real max
+    LatencyHistogram slow;
+    slow.Record(1000000, 3);
+    EXPECT_EQ(slow.GetPercentile(50.0), 1000000u);
+
+    histogram.Merge(slow);
+    EXPECT_EQ(histogram.GetCount(), 103u);
+    EXPECT_EQ(histogram.GetMax(), 1000000u);
+    EXPECT_EQ(histogram.GetPercentile(99.0), 1000000u);
+    EXPECT_LE(histogram.GetPercentile(97.0), 100u);
+}
+
+TEST(MetricsTest, CollectSumsEveryThread) {
+    const MetricsSnapshot before = Collect();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([] {
+            for (int i = 0; i < 1000; ++i) {
+                RecordLatency(Latency::BOT_DECISION, 5000);
+                Increment(Counter::POSITIONS, 10);
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    RecordLatency(Latency::BOT_DECISION, 900000);
+
+    // The exited threads' counts are still there
+    const MetricsSnapshot after = Collect(&before);
+    const LatencyHistogram& decisions = after.latencies[Index(Latency::BOT_DECISION)];
+    const LatencyHistogram& earlier = before.latencies[Index(Latency::BOT_DECISION)];
+    EXPECT_EQ(decisions.GetCount() - earlier.GetCount(), 4001u);
+    EXPECT_EQ(decisions.GetSum() - earlier.GetSum(), 4000u * 5000 + 900000);
+    EXPECT_GE(decisions.GetMax(), 900000u);
+    EXPECT_EQ(after.counters[Index(Counter::POSITIONS)] - before.counters[Index(Counter::POSITIONS)], 40000u);
+
+    EXPECT_GT(after.rateSeconds, 0.0);
+    EXPECT_LE(after.rateSeconds, after.uptimeSeconds);
+    EXPECT_NEAR(after.rates[Index(Counter::POSITIONS)] * after.rateSeconds, 40000.0, 1e-6);
+}
+
+TEST(MetricsTest, ThreadsTakingOverBlocksKeepTheTotals) {
+    const MetricsSnapshot before = Collect();
+
+    // One after another, so each new thread picks up the block the last one left
+    for (int t = 0; t < 64; ++t) {
+        std::thread([] { Increment(Counter::POSITIONS, 3); }).join();
+    }
+    std::thread concurrent[2] = {std::thread([] { Increment(Counter::POSITIONS, 5); }),
+                                 std::thread([] { Increment(Counter::POSITIONS, 5); })};
+    for (std::thread& thread : concurrent) thread.join();
+
+    const MetricsSnapshot after = Collect();
+    EXPECT_EQ(after.counters[Index(Counter::POSITIONS)] - before.counters[Index(Counter::POSITIONS)], 64u * 3 + 10);
+}
+
+TEST(MetricsTest, WritesPrometheusAndJson) {
+    RecordLatency(Latency::INFERENCE, 2000000);
+    Increment(Counter::GAMES);
+    const MetricsSnapshot snapshot = Collect();
+
+    std::ostringstream prometheus;
+    WritePrometheus(prometheus, snapshot);
+    const std::string text = prometheus.str();
+    EXPECT_NE(text.find("# TYPE tetris_inference_seconds summary"), std::string::npos);
+    EXPECT_NE(text.find("tetris_inference_seconds{quantile=\"0.999\"}"), std::string::npos);
+    EXPECT_NE(text.find("tetris_inference_seconds_count"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE tetris_games_total counter"), std::string::npos);
+    EXPECT_NE(text.find("tetris_games_per_second"), std::string::npos);
+    EXPECT_NE(text.find("tetris_uptime_seconds"), std::string::npos);
+
+    std::ostringstream json;
+    WriteJson(json, snapshot);
+    const std::string object = json.str();
+    EXPECT_EQ(object.front(), '{');
+    EXPECT_NE(object.find("\"latencies_ns\""), std::string::npos);
+    EXPECT_NE(object.find("\"garbage_delay\""), std::string::npos);
+    EXPECT_NE(object.find("\"p99.9\""), std::string::npos);
+    EXPECT_NE(object.find("\"buckets\""), std::string::npos);
+    EXPECT_NE(object.find("\"games\""), std::string::npos);
+}
+
+TEST(MetricsTest, ExporterWritesBothFiles) {
+    EXPECT_THROW(MetricsExporter(MetricsExportOptions{}), std::invalid_argument);
+    EXPECT_THROW(MetricsExporter(MetricsExportOptions{"a.prom", "", 0.0}), std::invalid_argument);
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::filesystem::path prom = dir / "tetris_metrics_test.prom";
+    const std::filesystem::path json = dir / "tetris_metrics_test.json";
+    std::filesystem::remove(prom);
+    std::filesystem::remove(json);
+
+    {
+        MetricsExporter exporter(MetricsExportOptions{prom.string(), json.string(), 3600.0});
+        Increment(Counter::PIECES, 7);
+        exporter.ExportNow();
+        EXPECT_NE(ReadFile(prom).find("tetris_pieces_total"), std::string::npos);
+        EXPECT_NE(ReadFile(json).find("\"pieces\""), std::string::npos);
+        std::filesystem::remove(json);
+    }
+    // Stopping writes a final export
+    EXPECT_TRUE(std::filesystem::exists(json));
+    EXPECT_FALSE(std::filesystem::exists(json.string() + ".tmp"));
+    std::filesystem::remove(prom);
+    std::filesystem::remove(json);
+
+    MetricsExporter broken(MetricsExportOptions{(dir / "missing" / "dir" / "m.prom").string(), "", 3600.0});
+    EXPECT_THROW(broken.ExportNow(), std::runtime_error);
+    broken.Stop();
+    EXPECT_FALSE(broken.GetLastError().empty());
+}
+
+TEST(MetricsTest, BoardsCountPiecesAndGarbageDelay) {
+    Game game(2, 3);
+    game.GetGarbageRouter().SetDelayFrames(20);
+    Board& receiver = game.getBoard(1);
+    const MetricsSnapshot before = Collect();
+
+    // Sent on frame 0, delivered on frame 20, rises with the lock on frame 60
+    game.TransferGarbage(0, 2);
+    for (int i = 0; i < 60; ++i) game.StepFrame();
+    ASSERT_EQ(receiver.GetGarbageQueue(), 2);
+    receiver.HardDropActivePiece();
+    EXPECT_EQ(receiver.GetGarbageQueue(), 0);
+
+    const MetricsSnapshot after = Collect();
+    const LatencyHistogram& delay = after.latencies[Index(Latency::GARBAGE_DELAY)];
+    const LatencyHistogram& earlier = before.latencies[Index(Latency::GARBAGE_DELAY)];
+    ASSERT_EQ(delay.GetCount() - earlier.GetCount(), 1u);
+    EXPECT_EQ(delay.GetSum() - earlier.GetSum(), 60 * (1000000000ull / Game::FRAMES_PER_SECOND));
+    EXPECT_GE(after.counters[Index(Counter::PIECES)] - before.counters[Index(Counter::PIECES)], 1u);
+}
+
+TEST(MetricsTest, GarbageDelayCountsEachSentPacketOnce) {
+    Game game(2, 3);
+    game.GetGarbageRouter().SetDelayFrames(0);
+    Board& receiver = game.getBoard(1);
+    const MetricsSnapshot before = Collect();
+
+    // Garbage nobody sent (the UI's Add Garbage) has no delay to report
+    game.AddGarbage(1, 2);
+    game.ApplyInput(1, InputType::HARD_DROP);
+    EXPECT_EQ(receiver.GetGarbageQueue(), 0);
+
+    // Ten lines rise as 8 then 2, but are one packet
+    game.TransferGarbage(0, 10);
+    ASSERT_EQ(receiver.GetGarbageQueue(), 10);
+    game.ApplyInput(1, InputType::HARD_DROP);
+    EXPECT_EQ(receiver.GetGarbageQueue(), 2);
+    game.ApplyInput(1, InputType::HARD_DROP);
+    EXPECT_EQ(receiver.GetGarbageQueue(), 0);
+
+    const MetricsSnapshot after = Collect();
+    EXPECT_EQ(after.latencies[Index(Latency::GARBAGE_DELAY)].GetCount()
+              - before.latencies[Index(Latency::GARBAGE_DELAY)].GetCount(), 1u);
+}
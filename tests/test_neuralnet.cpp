@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/NeuralNetwork.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef TETRIS_ENABLE_NN
+#include "TetrisEngine/OnnxRuntime.h"
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+#endif
+
+using namespace tetris;
+
+namespace {
+    // Answers every position with the number its "model file" holds
+    class ConstantBackend : public InferenceBackend {
+        public:
+            explicit ConstantBackend(float value) : m_value(value) {}
+
+            void Run(const float*, size_t batchSize, float* output) const override {
+                for (size_t i = 0; i < batchSize; ++i) output[i] = m_value;
+            }
+            size_t GetInputSize() const override { return 1; }
+            size_t GetOutputSize() const override { return 1; }
+            const ModelLoadStats& GetLoadStats() const override { return m_stats; }
+
+        private:
+            float m_value;
+            ModelLoadStats m_stats;
+    };
+
+    // "good <value>" loads; anything else is a corrupt checkpoint
+    std::unique_ptr<InferenceBackend> LoadConstant(const std::filesystem::path& path, std::atomic<int>& loads) {
+        ++loads;
+        std::ifstream in(path);
+        std::string tag;
+        float value = 0.0f;
+        if (!(in >> tag >> value) || tag != "good") throw std::runtime_error("corrupt model");
+        return std::make_unique<ConstantBackend>(value);
+    }
+
+    void WriteModel(const std::filesystem::path& path, const std::string& contents) {
+        std::ofstream(path, std::ios::trunc) << contents;
+    }
+
+    float RunOne(const NeuralNetwork& network) {
+        float input = 0.0f, output = -1.0f;
+        network.Run(&input, 1, &output);
+        return output;
+    }
+
+    template<typename Condition>
+    bool WaitFor(Condition condition) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        return true;
+    }
+}
+
+TEST(NeuralNetworkTest, HotSwapKeepsServingThroughACorruptCheckpoint) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "tetris_hot_swap_test.model";
+    WriteModel(path, "good 1");
+
+    std::atomic<int> loads{0};
+    NeuralNetwork network(path, [&](const std::filesystem::path& file, const ModelLoadOptions&) { return LoadConstant(file, loads); });
+    EXPECT_EQ(RunOne(network), 1.0f);
+
+    ModelWatchOptions options;
+    options.pollInterval = std::chrono::milliseconds(5);
+    options.warmupBatchSize = 2;
+    network.WatchForUpdates(options);
+
+    // A valid checkpoint goes live
+    WriteModel(path, "good 22");
+    ASSERT_TRUE(WaitFor([&] { return network.GetModelVersion() == 1; }));
+    EXPECT_EQ(RunOne(network), 22.0f);
+    EXPECT_TRUE(network.GetLastReloadError().empty());
+
+    // A corrupt one is reported, the old session stays in use, and it is tried only once
+    const std::shared_ptr<const InferenceBackend> live = network.GetBackend();
+    WriteModel(path, "corrupt checkpoint");
+    ASSERT_TRUE(WaitFor([&] { return !network.GetLastReloadError().empty(); }));
+    const int loadsAfterFailure = loads.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    EXPECT_EQ(loads.load(), loadsAfterFailure);
+    EXPECT_EQ(network.GetModelVersion(), 1u);
+    EXPECT_EQ(network.GetBackend(), live);
+    EXPECT_EQ(RunOne(network), 22.0f);
+
+    // Fixing the file is picked up
+    WriteModel(path, "good 333");
+    ASSERT_TRUE(WaitFor([&] { return network.GetModelVersion() == 2; }));
+    EXPECT_EQ(RunOne(network), 333.0f);
+    EXPECT_TRUE(network.GetLastReloadError().empty());
+
+    network.StopWatching();
+    std::filesystem::remove(path);
+}
+
+#ifdef TETRIS_ENABLE_NN
+
+// These run before anything in this binary loads the real runtime
+TEST(OnnxLoaderTest, MissingLibraryIsReported) {
+    std::string error;
+    EXPECT_FALSE(LoadOnnxRuntimeFrom("/no/such/dir/libonnxruntime.so", &error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_FALSE(IsOnnxRuntimeLoaded());
+}
+
+TEST(OnnxLoaderTest, LibraryWithoutRuntimeIsRejectedAndClosed) {
+    std::string error;
+    EXPECT_FALSE(LoadOnnxRuntimeFrom(TETRIS_FAKE_ORT_LIBRARY, &error));
+    EXPECT_NE(error.find("0.0.0-fake"), std::string::npos) << error;
+    EXPECT_NE(error.find("does not provide API version"), std::string::npos) << error;
+    EXPECT_FALSE(IsOnnxRuntimeLoaded());
+#ifndef _WIN32
+    EXPECT_EQ(dlopen(TETRIS_FAKE_ORT_LIBRARY, RTLD_NOW | RTLD_NOLOAD), nullptr);
+#endif
+}
+
+#endif // TETRIS_ENABLE_NN
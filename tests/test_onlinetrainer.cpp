@@ -0,0 +1,17 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/OnlineTrainer.h"
+#include <filesystem>
+
+using namespace tetris;
+
+TEST(OnlineTrainerTest, MissingArtifactsFailToConstruct) {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tetris_missing_artifacts";
+    TrainingArtifacts artifacts;
+    artifacts.checkpoint = dir / "checkpoint";
+    artifacts.trainingModel = dir / "training_model.onnx";
+    artifacts.evalModel = dir / "eval_model.onnx";
+    artifacts.optimizerModel = dir / "optimizer_model.onnx";
+
+    // Without ENABLE_NN, or without a training-capable runtime, or without the files: all throw
+    EXPECT_ANY_THROW(OnlineTrainer trainer(artifacts));
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/Farm.h"
+#include "TetrisEngine/PerfStats.h"
+#include "TetrisEngine/SimulationThread.h"
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+
+TEST(PerfStatsTest, AllocationsAreCountedPerThread) {
+    const uint64_t before = GetThreadAllocations();
+    {
+        auto boxed = std::make_unique<int>(1);
+        std::vector<int> values(100);
+        values.push_back(1);   // grows past the 100 it was sized for
+    }
+    EXPECT_EQ(GetThreadAllocations() - before, 3u);
+
+    // Another thread's allocations are its own
+    const uint64_t mine = GetThreadAllocations();
+    uint64_t theirs = 0;
+    std::thread other([&] {
+        const uint64_t start = GetThreadAllocations();
+        std::vector<double> values(10);
+        theirs = GetThreadAllocations() - start;
+    });
+    other.join();
+    EXPECT_EQ(theirs, 1u);
+    EXPECT_EQ(GetThreadAllocations() - mine, 1u);   // the std::thread state, made on this thread
+}
+
+TEST(PerfStatsTest, HistoryScrollsOldestFirst) {
+    ValueHistory<4> history;
+    EXPECT_EQ(history.GetLatest(), 0.0f);
+    EXPECT_EQ(history.GetMax(), 0.0f);
+
+    history.Push(3.0f);
+    history.Push(1.0f);
+    EXPECT_EQ(history.GetCount(), 2u);
+    EXPECT_EQ(history.GetOffset(), 0u);
+    EXPECT_EQ(history.GetLatest(), 1.0f);
+    EXPECT_EQ(history.GetMean(), 2.0f);
+
+    for (float value : {4.0f, 2.0f, 6.0f}) history.Push(value);
+    EXPECT_EQ(history.GetCount(), 4u);
+    EXPECT_EQ(history.GetLatest(), 6.0f);
+    EXPECT_EQ(history.GetMax(), 6.0f);
+    const float* data = history.Data();
+    std::vector<float> ordered;
+    for (size_t i = 0; i < 4; ++i) ordered.push_back(data[(history.GetOffset() + i) % 4]);
+    EXPECT_EQ(ordered, (std::vector<float>{1.0f, 4.0f, 2.0f, 6.0f}));
+}
+
+TEST(PerfStatsTest, SimulationPublishesItsCost) {
+    Game game(2, 3);
+    game.StepFrame();
+    EXPECT_EQ(game.GetBoardStepNs(0), 0);   // off by default
+
+    game.SetBoardTiming(true);
+    game.StepFrame();
+    EXPECT_GT(game.GetBoardStepNs(0) + game.GetBoardStepNs(1), 0);
+    EXPECT_THROW(game.GetBoardStepNs(2), std::out_of_range);
+
+    SimulationThread sim(game);
+    EXPECT_EQ(sim.PollStats().frames, 0u);
+    EXPECT_EQ(sim.PollStats().boardUs.size(), 2u);
+
+    sim.Start();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (sim.PollStats().frames < 3 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    sim.Stop();
+
+    const SimulationStats& stats = sim.PollStats();
+    EXPECT_GE(stats.frames, 3u);
+    EXPECT_GT(stats.stepMs, 0.0);
+    EXPECT_GE(stats.allocationsPerFrame, 0.0);
+    ASSERT_EQ(stats.boardUs.size(), 2u);
+    EXPECT_GT(stats.boardUs[0] + stats.boardUs[1], 0.0f);
+}
+
+TEST(PerfStatsTest, ArenaCountsItsBotsSearches) {
+    HeuristicBot bot;
+    const Bot* bots[] = {&bot, &bot};
+    MatchConfig config;
+    config.maxFrames = 600;
+
+    MatchArena arena;
+    arena.Start(bots, 2, 5, config);
+    PieceType piece = PieceType::T;
+    EXPECT_EQ(arena.GetLastAction(0, piece), -1);
+    while (arena.Step()) {}
+
+    const MatchResult result = arena.GetResult();
+    const BotSearchStats& stats = arena.GetSearchStats();
+    EXPECT_EQ(stats.decisions, uint64_t{result.players[0].pieces} + result.players[1].pieces);
+    EXPECT_GT(stats.nodes, stats.decisions);
+    EXPECT_GT(stats.searchNs, 0u);
+    EXPECT_EQ(stats.depth, 1);
+
+    const int action = arena.GetLastAction(1, piece);
+    EXPECT_GE(action, 0);
+    EXPECT_LT(action, BOT_ACTION_COUNT);
+    EXPECT_NE(piece, PieceType::EMPTY);
+
+    // Totals carry over into the next match
+    arena.Start(bots, 1, 6, config);
+    arena.Step();
+    EXPECT_GE(arena.GetSearchStats().decisions, stats.decisions);
+}
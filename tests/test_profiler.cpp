@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/Profiler.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace tetris;
+
+namespace {
+    size_t CountOf(const std::string& text, const std::string& needle) {
+        size_t count = 0;
+        for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + needle.size())) ++count;
+        return count;
+    }
+}
+
+TEST(ProfilerTest, ThreadsTraceIntoTheirOwnRings) {
+    {
+        profile::Zone outer("test.outer");
+        profile::Zone inner("test.inner");
+    }
+    {
+        TETRIS_PROFILE_ZONE("test.macro");
+    }
+
+    // A thread that outruns its ring keeps only the newest zones, and its trace outlives it
+    std::thread worker([] {
+        profile::SetThreadName("test \"worker\"");
+        for (size_t i = 0; i < profile::RING_CAPACITY + 10; ++i) profile::Zone zone("test.worker");
+    });
+    worker.join();
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "tetris_profiler_test.json";
+    const size_t written = profile::WriteChromeTrace(path.string());
+
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    const std::string trace = contents.str();
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(trace.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0u);
+    EXPECT_EQ(trace.substr(trace.size() - 4), "\n]}\n");
+    EXPECT_EQ(CountOf(trace, "\"test.outer\""), 1u);
+    EXPECT_EQ(CountOf(trace, "\"test.inner\""), 1u);
+    EXPECT_EQ(CountOf(trace, "\"test.macro\""), profile::ENABLED ? 1u : 0u);
+    EXPECT_EQ(CountOf(trace, "\"test.worker\""), profile::RING_CAPACITY);
+    EXPECT_EQ(CountOf(trace, "\"test \\\"worker\\\"\""), 1u);
+    EXPECT_EQ(CountOf(trace, "\"ph\":\"X\""), written);
+    EXPECT_GE(written, profile::RING_CAPACITY + 2);
+
+    EXPECT_THROW(profile::WriteChromeTrace((std::filesystem::temp_directory_path() / "missing" / "dir" / "t.json").string()),
+                 std::runtime_error);
+}
+
+TEST(ProfilerTest, ExitedThreadsHandTheirRingsOn) {
+    // Threads one after another share a ring, and so a trace id, however many there are
+    auto run = [](const char* name) {
+        std::thread worker([name] {
+            profile::SetThreadName(name);
+            profile::Zone zone("test.sequential");
+        });
+        worker.join();
+    };
+    for (int i = 0; i < 50; ++i) run("test sequential");
+    run("test last");
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "tetris_profiler_reuse.json";
+    profile::WriteChromeTrace(path.string());
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    const std::string trace = contents.str();
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(CountOf(trace, "\"test.sequential\""), 51u);
+    EXPECT_EQ(CountOf(trace, "\"test last\""), 1u);
+    EXPECT_EQ(CountOf(trace, "\"test sequential\""), 0u);
+    EXPECT_LE(CountOf(trace, "\"thread_name\""), 4u);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "GameTestUtils.h"
+#include "TetrisEngine/Replay.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace tetris;
+
+namespace {
+    // Plays a two-player game with scripted inputs and garbage, keeping the state at some frames
+    std::vector<uint8_t> RecordGame(uint64_t frames, std::map<uint64_t, std::vector<uint8_t>>& checkpoints) {
+        Game game(2, 1234);
+        ReplayRecorder recorder(game);
+        std::mt19937 script(99);
+
+        for (uint64_t frame = 0; frame < frames; ++frame) {
+            for (size_t player = 0; player < 2; ++player) {
+                if (script() % 4 != 0) continue;
+                auto input = static_cast<InputType>(script() % INPUT_TYPE_COUNT);
+                if (input == InputType::RESET && !game.getBoard(player).IsGameOver()) input = InputType::HARD_DROP;
+                game.ApplyInput(player, input);
+            }
+            if (frame % 600 == 300) game.AddGarbage(frame % 1200 == 300 ? 0 : 1, 2);
+            if (frame % 997 == 0) checkpoints[game.GetFrame()] = State(game);
+            game.StepFrame();
+        }
+        checkpoints[game.GetFrame()] = State(game);
+        return recorder.Serialize();
+    }
+}
+
+TEST(ByteStreamTest, VarintsRoundTrip) {
+    ByteWriter out;
+    const int64_t values[] = {0, 1, -1, 63, -64, 300, -70000, INT64_MAX, INT64_MIN};
+    for (int64_t v : values) out.PutSigned(v);
+    out.PutVarint(UINT64_MAX);
+    out.PutDouble(0.0035);
+    EXPECT_EQ(out.GetBuffer()[0], 0u);  // zigzag keeps small values in one byte
+    EXPECT_EQ(out.GetBuffer()[2], 1u);
+
+    ByteReader in(out.Data(), out.Size());
+    for (int64_t v : values) EXPECT_EQ(in.GetSigned(), v);
+    EXPECT_EQ(in.GetVarint(), UINT64_MAX);
+    EXPECT_EQ(in.GetDouble(), 0.0035);
+    EXPECT_TRUE(in.AtEnd());
+    EXPECT_THROW(in.GetU8(), std::runtime_error);
+}
+
+TEST(ByteStreamTest, WriteFileAtomicallyReplacesWholeFiles) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "tetris_atomic_write.bin";
+    auto contents = [&path] {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream text;
+        text << in.rdbuf();
+        return text.str();
+    };
+
+    ByteWriter bytes;
+    bytes.PutBytes("first", 5);
+    WriteFileAtomically(path, bytes);
+    EXPECT_EQ(contents(), "first");
+
+    // A writer that fails halfway leaves the old file and no temporary behind
+    EXPECT_THROW(WriteFileAtomically(path, [](std::ostream& out) {
+        out << "sec";
+        throw std::runtime_error("interrupted");
+    }), std::runtime_error);
+    EXPECT_EQ(contents(), "first");
+    EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+    WriteFileAtomically(path, [](std::ostream& out) { out << "second"; });
+    EXPECT_EQ(contents(), "second");
+    std::filesystem::remove(path);
+}
+
+TEST(ReplayTest, SeekReproducesRecordedStates) {
+    // Ten minutes at 60 frames per second
+    const uint64_t frames = 10 * 60 * Game::FRAMES_PER_SECOND;
+    std::map<uint64_t, std::vector<uint8_t>> checkpoints;
+    std::vector<uint8_t> bytes = RecordGame(frames, checkpoints);
+
+    ReplayPlayer player(bytes);
+    EXPECT_EQ(player.GetInfo().playerCount, 2u);
+    EXPECT_EQ(player.GetInfo().endFrame, frames);
+    EXPECT_EQ(player.GetInfo().keyframeCount, frames / REPLAY_KEYFRAME_INTERVAL + 1);
+
+    // Backwards, forwards and far jumps all land on the recorded state
+    double slowestMs = 0.0;
+    for (auto it = checkpoints.rbegin(); it != checkpoints.rend(); ++it) {
+        auto start = std::chrono::steady_clock::now();
+        player.Seek(it->first);
+        slowestMs = std::max(slowestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        ASSERT_EQ(State(player.GetGame()), it->second) << "frame " << it->first;
+    }
+    for (const auto& [frame, state] : checkpoints) {
+        player.Seek(frame);
+        ASSERT_EQ(State(player.GetGame()), state) << "frame " << frame;
+    }
+    std::cout << bytes.size() << " bytes, slowest seek " << slowestMs << " ms" << std::endl;
+
+    EXPECT_FALSE(player.Step());
+    EXPECT_THROW(player.Seek(frames + 1), std::out_of_range);
+}
+
+TEST(ReplayTest, RejectsCorruptData) {
+    std::map<uint64_t, std::vector<uint8_t>> checkpoints;
+    std::vector<uint8_t> bytes = RecordGame(600, checkpoints);
+
+    std::vector<uint8_t> badMagic = bytes;
+    badMagic[0] = 'X';
+    EXPECT_THROW(ReplayPlayer{badMagic}, std::runtime_error);
+
+    std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 10);
+    EXPECT_THROW(ReplayPlayer{truncated}, std::runtime_error);
+
+    std::vector<uint8_t> otherRules = bytes;
+    otherRules[8] ^= 0xff;  // rules version
+    EXPECT_THROW(ReplayPlayer{otherRules}, std::runtime_error);
+}
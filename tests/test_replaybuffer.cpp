@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/Game.h"
+#include "TetrisEngine/ReplayBuffer.h"
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+
+TEST(ReplayBufferTest, OverwritesOldestOnceFull) {
+    EXPECT_THROW(ReplayBuffer(0), std::invalid_argument);
+
+    ReplayBuffer buffer(3, 2, 1);
+    std::mt19937_64 rng(1);
+    std::vector<float> features(8);
+    std::vector<float> targets(4);
+    EXPECT_FALSE(buffer.Sample(4, rng, features.data(), targets.data()));
+
+    for (int i = 0; i < 5; ++i) {
+        const float sample[2] = {static_cast<float>(i), static_cast<float>(i) + 0.5f};
+        const float target = static_cast<float>(-i);
+        buffer.Push(sample, &target);
+    }
+    EXPECT_EQ(buffer.Size(), 3u);
+    EXPECT_EQ(buffer.TotalPushed(), 5u);
+
+    // Only samples 2..4 remain, and every drawn row stays whole
+    for (int round = 0; round < 20; ++round) {
+        ASSERT_TRUE(buffer.Sample(4, rng, features.data(), targets.data()));
+        for (size_t i = 0; i < 4; ++i) {
+            EXPECT_GE(features[i * 2], 2.0f);
+            EXPECT_EQ(features[i * 2 + 1], features[i * 2] + 0.5f);
+            EXPECT_EQ(targets[i], -features[i * 2]);
+        }
+    }
+}
+
+TEST(ReplayBufferTest, PushesBoardsAsFeatures) {
+    Game game(1, 5);
+    ReplayBuffer buffer(4);
+    buffer.Push(game.getBoard(0), 0.25f);
+
+    std::vector<float> expected(BOARD_FEATURE_SIZE);
+    EncodeBoard(game.getBoard(0), expected.data());
+    std::vector<float> features(BOARD_FEATURE_SIZE);
+    float target = 0.0f;
+    std::mt19937_64 rng(2);
+    ASSERT_TRUE(buffer.Sample(1, rng, features.data(), &target));
+    EXPECT_EQ(features, expected);
+    EXPECT_EQ(target, 0.25f);
+
+    ReplayBuffer wide(4, BOARD_FEATURE_SIZE, 2);
+    EXPECT_THROW(wide.Push(game.getBoard(0), 0.0f), std::logic_error);
+}
+
+TEST(ReplayBufferTest, SamplesWhileOthersPush) {
+    constexpr size_t FEATURES = 64;
+    ReplayBuffer buffer(16, FEATURES, 1);
+    std::atomic<bool> done{false};
+
+    // Every sample is one value repeated, so a torn copy shows up as a mixed row
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 2; ++w) {
+        writers.emplace_back([&buffer, &done, w] {
+            std::vector<float> sample(FEATURES);
+            for (int i = 0; !done.load(std::memory_order_relaxed); ++i) {
+                const float value = static_cast<float>(w * 1000000 + i);
+                std::fill(sample.begin(), sample.end(), value);
+                buffer.Push(sample.data(), &value);
+            }
+        });
+    }
+
+    // Sample only once the writers are overwriting a full buffer, so every round checks rows
+    while (buffer.Size() < 16) std::this_thread::yield();
+
+    std::mt19937_64 rng(3);
+    std::vector<float> features(8 * FEATURES);
+    std::vector<float> targets(8);
+    int sampled = 0;
+    for (int round = 0; round < 2000; ++round) {
+        if (!buffer.Sample(8, rng, features.data(), targets.data())) continue;
+        ++sampled;
+        for (size_t i = 0; i < 8; ++i) {
+            for (size_t f = 0; f < FEATURES; ++f) ASSERT_EQ(features[i * FEATURES + f], targets[i]);
+        }
+    }
+    done = true;
+    for (std::thread& writer : writers) writer.join();
+    EXPECT_GT(sampled, 0);
+}
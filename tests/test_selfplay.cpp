@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/Bot.h"
+#include "TetrisEngine/SelfPlayShard.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace tetris;
+
+namespace {
+    std::filesystem::path FreshDirectory(const char* name) {
+        std::filesystem::path dir = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove_all(dir);
+        return dir;
+    }
+
+    std::vector<SelfPlayRecord> MakeRecords(size_t count) {
+        std::vector<SelfPlayRecord> records(count);
+        for (size_t i = 0; i < count; ++i) {
+            records[i].gameId = i / 10;
+            records[i].moveNumber = static_cast<uint16_t>(i % 10);
+            records[i].action = static_cast<int16_t>(i % RECORD_ACTION_COUNT);
+            records[i].rows[0] = static_cast<uint16_t>(i & FULL_ROW_MASK);
+            records[i].outcome = static_cast<float>(i);
+        }
+        return records;
+    }
+}
+
+TEST(ShardWriterTest, WritesFixedSizeShardsInOrder) {
+    std::filesystem::path dir = FreshDirectory("tetris_shard_test");
+    std::vector<SelfPlayRecord> records = MakeRecords(250);
+    {
+        ShardWriter writer(dir, 100);
+        for (size_t i = 0; i < records.size(); i += 7) {
+            writer.Append(records.data() + i, std::min<size_t>(7, records.size() - i));
+        }
+        writer.Close();
+
+        ShardWriterStats stats = writer.GetStats();
+        EXPECT_EQ(stats.recordsWritten, 250u);
+        EXPECT_EQ(stats.shardsWritten, 3u);
+        EXPECT_EQ(stats.bufferedRecords, 0u);
+    }
+
+    std::vector<SelfPlayRecord> readBack;
+    for (const char* name : {"shard-000000.tsp", "shard-000001.tsp", "shard-000002.tsp"}) {
+        ShardHeader header;
+        std::vector<SelfPlayRecord> shard = ReadShard(dir / name, &header);
+        EXPECT_EQ(header.version, SHARD_FORMAT_VERSION);
+        EXPECT_EQ(header.recordSize, sizeof(SelfPlayRecord));
+        readBack.insert(readBack.end(), shard.begin(), shard.end());
+    }
+    ASSERT_EQ(readBack.size(), records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(readBack[i].gameId, records[i].gameId);
+        EXPECT_EQ(readBack[i].action, records[i].action);
+        EXPECT_EQ(readBack[i].rows[0], records[i].rows[0]);
+    }
+
+    // A second writer continues the numbering instead of overwriting
+    {
+        ShardWriter writer(dir, 100);
+        writer.Append(records.data(), 1);
+    }
+    EXPECT_TRUE(std::filesystem::exists(dir / "shard-000003.tsp"));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ShardWriterTest, SeveralProducersFillEveryShard) {
+    std::filesystem::path dir = FreshDirectory("tetris_shard_producers");
+    constexpr size_t PER_SHARD = 16;
+    constexpr size_t PRODUCERS = 4;
+    const std::vector<SelfPlayRecord> records = MakeRecords(1000);
+    {
+        ShardWriter writer(dir, PER_SHARD);
+        std::vector<std::thread> producers;
+        for (size_t p = 0; p < PRODUCERS; ++p) {
+            producers.emplace_back([&writer, &records, p] {
+                for (size_t i = 0; i < records.size(); i += 1 + p) {
+                    writer.Append(records.data() + i, std::min<size_t>(1 + p, records.size() - i));
+                }
+            });
+        }
+        for (std::thread& producer : producers) producer.join();
+        writer.Close();
+    }
+
+    std::vector<std::filesystem::path> shards;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) shards.push_back(entry.path());
+    std::sort(shards.begin(), shards.end());
+    ASSERT_FALSE(shards.empty());
+
+    // Only the last shard may be short
+    size_t total = 0;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        const size_t count = ReadShard(shards[i]).size();
+        if (i + 1 < shards.size()) {
+            EXPECT_EQ(count, PER_SHARD) << shards[i];
+        }
+        total += count;
+    }
+    EXPECT_EQ(total, PRODUCERS * records.size());
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ShardWriterTest, RejectsForeignFiles) {
+    std::filesystem::path dir = FreshDirectory("tetris_shard_bad");
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "bad.tsp") << "this is not a shard, but it is long enough to fill a header.........";
+    EXPECT_THROW(ReadShard(dir / "bad.tsp"), std::runtime_error);
+
+    // A valid header claiming more records than the file holds
+    ShardHeader header;
+    header.recordSize = sizeof(SelfPlayRecord);
+    header.recordCount = uint64_t{1} << 40;
+    std::ofstream(dir / "short.tsp", std::ios::binary).write(reinterpret_cast<const char*>(&header), sizeof(header));
+    EXPECT_THROW(ReadShard(dir / "short.tsp"), std::runtime_error);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(HeuristicBotTest, PrefersClearingALine) {
+    // Bottom row full except column 9; a vertical I there clears it
+    uint16_t rows[TOTAL_BOARD_HEIGHT] = {};
+    rows[0] = FULL_ROW_MASK & ~(1u << 9);
+
+    BotPosition position;
+    position.rows = rows;
+    position.current = PieceType::I;
+    position.next = {PieceType::O, PieceType::T, PieceType::S, PieceType::Z, PieceType::L};
+
+    uint8_t mask[BOT_ACTION_COUNT];
+    LegalPlacements(rows, position.current, mask);
+    LegalPlacements(rows, position.next[0], mask + PLACEMENT_COUNT);
+
+    float scores[BOT_ACTION_COUNT];
+    HeuristicBot bot;
+    bot.ScoreActions(position, mask, scores);
+
+    int best = static_cast<int>(std::max_element(scores, scores + BOT_ACTION_COUNT) - scores);
+    AfterState state;
+    ASSERT_TRUE(ApplyAction(position, best, state));
+    EXPECT_EQ(state.lines, 1);
+    EXPECT_EQ(state.current, PieceType::O);
+
+    for (int a = 0; a < BOT_ACTION_COUNT; ++a) {
+        if (!mask[a]) {
+            EXPECT_TRUE(std::isinf(scores[a]));
+        }
+    }
+}
+
+TEST(HeuristicBotTest, WeightsRoundTripThroughFile) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "tetris_weights_test.txt";
+    HeuristicWeights weights;
+    weights.holes = -1.25f;
+    weights.attack = 2.0f;
+    SaveHeuristicWeights(path, weights);
+
+    HeuristicWeights loaded = LoadHeuristicWeights(path);
+    EXPECT_FLOAT_EQ(loaded.holes, -1.25f);
+    EXPECT_FLOAT_EQ(loaded.attack, 2.0f);
+    EXPECT_FLOAT_EQ(loaded.bumpiness, weights.bumpiness);
+
+    std::ofstream(path) << "holes = 1\nunknown = 2\n";
+    EXPECT_THROW(LoadHeuristicWeights(path), std::runtime_error);
+    std::filesystem::remove(path);
+}
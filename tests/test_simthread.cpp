@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "GameTestUtils.h"
+#include "TetrisEngine/SimulationThread.h"
+#include <chrono>
+#include <thread>
+
+using namespace tetris;
+
+namespace {
+    // Poll the view until it satisfies done, as a render loop would
+    template <typename Done>
+    bool WaitForView(SimulationThread& sim, Game& view, Done done) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            sim.UpdateView(view);
+            if (done()) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+}
+
+TEST(SimulationThreadTest, ViewStartsAsTheGame) {
+    Game game(2, 7);
+    game.StepFrame();
+    SimulationThread sim(game);
+
+    Game view(2, 0);
+    EXPECT_TRUE(sim.UpdateView(view));
+    EXPECT_EQ(State(view), State(game));
+    EXPECT_FALSE(sim.UpdateView(view));
+}
+
+TEST(SimulationThreadTest, CommandsReachTheGameAndTheView) {
+    Game game(2, 11);
+    Game view(2, 11);
+    SimulationThread sim(game);
+    sim.UpdateView(view);
+    const std::vector<PieceType> queue = view.getBoard(0).GetNextQueue();
+
+    sim.Start();
+    sim.Submit(GameCommand::Input(0, InputType::HARD_DROP));
+    sim.Submit(GameCommand::Garbage(1, 3));
+    EXPECT_TRUE(WaitForView(sim, view, [&] {
+        return view.getBoard(0).GetNextQueue() != queue && view.getBoard(1).GetGarbageQueue() == 3;
+    }));
+    sim.Stop();
+
+    // Once stopped, the last publication is exactly the game's state
+    sim.UpdateView(view);
+    EXPECT_EQ(State(view), State(game));
+    EXPECT_EQ(game.getBoard(1).GetGarbageQueue(), 3);
+}
+
+TEST(SimulationThreadTest, KeysAreTimedOnTheSimulationClock) {
+    Game game(1, 21);
+    Game view(1, 21);
+    SimulationThread sim(game, HandlingSettings{50.0, 0.0, 20.0});
+    sim.UpdateView(view);
+    const int x0 = view.getBoard(0).GetCurrentPiecePosition().x;
+
+    auto stamp = [] {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+    sim.Start();
+    ASSERT_TRUE(sim.PushKey(KeyEvent{stamp(), 0, InputType::MOVE_LEFT, true}));
+    EXPECT_TRUE(WaitForView(sim, view, [&] { return view.getBoard(0).GetCurrentPiecePosition().x < x0; }));
+
+    // Held past DAS with ARR 0, the piece reaches the wall without further events
+    EXPECT_TRUE(WaitForView(sim, view, [&] { return view.getBoard(0).GetCurrentPiecePosition().x <= 0; }));
+    ASSERT_TRUE(sim.PushKey(KeyEvent{stamp(), 0, InputType::MOVE_LEFT, false}));
+    sim.Stop();
+    EXPECT_THROW(sim.PushKey(KeyEvent{stamp(), 1, InputType::MOVE_LEFT, true}), std::out_of_range);
+}
+
+TEST(SimulationThreadTest, ReleasingKeysStopsAutoRepeat) {
+    Game game(1, 21);
+    Game view(1, 21);
+    SimulationThread sim(game, HandlingSettings{100.0, 50.0, 20.0});
+    sim.UpdateView(view);
+    const int x0 = view.getBoard(0).GetCurrentPiecePosition().x;
+
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    sim.Start();
+    ASSERT_TRUE(sim.PushKey(KeyEvent{now, 0, InputType::MOVE_RIGHT, true}));
+    EXPECT_TRUE(WaitForView(sim, view, [&] { return view.getBoard(0).GetCurrentPiecePosition().x > x0; }));
+
+    // Focus lost with the key down: no release comes, and the piece must not keep sliding
+    sim.Submit(GameCommand::ReleaseKeys());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    sim.UpdateView(view);
+    const int x1 = view.getBoard(0).GetCurrentPiecePosition().x;
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    sim.Stop();
+    sim.UpdateView(view);
+    EXPECT_EQ(view.getBoard(0).GetCurrentPiecePosition().x, x1);
+}
+
+TEST(SimulationThreadTest, StepsAtTheLogicalRate) {
+    Game game(1, 3);
+    Game view(1, 3);
+    SimulationThread sim(game);
+
+    const auto start = std::chrono::steady_clock::now();
+    sim.Start();
+    EXPECT_TRUE(WaitForView(sim, view, [&] { return view.GetFrame() >= 15; }));
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    sim.Stop();
+
+    // 15 frames take a quarter of a second of game time; never much less in real time
+    EXPECT_GE(seconds, 14 * Game::FRAME_SECONDS);
+    EXPECT_EQ(game.GetFrame(), sim.GetFramesSimulated());
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/Spectator.h"
+#include "TetrisEngine/TripleBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using namespace tetris;
+
+TEST(SpectatorTest, TripleBufferNeverTearsOrGoesBack) {
+    TripleBuffer<std::vector<uint64_t>> buffer(std::vector<uint64_t>(256, 0));
+    EXPECT_FALSE(buffer.Update());
+
+    constexpr uint64_t PUBLICATIONS = 200000;
+    std::thread producer([&] {
+        for (uint64_t value = 1; value <= PUBLICATIONS; ++value) {
+            std::vector<uint64_t>& out = buffer.WriteBuffer();
+            std::fill(out.begin(), out.end(), value);
+            buffer.Publish();
+        }
+    });
+
+    uint64_t last = 0;
+    while (last < PUBLICATIONS) {
+        if (!buffer.Update()) continue;
+        const std::vector<uint64_t>& in = buffer.Read();
+        ASSERT_TRUE(std::all_of(in.begin(), in.end(), [&](uint64_t v) { return v == in[0]; }));
+        ASSERT_GT(in[0], last);
+        last = in[0];
+    }
+    producer.join();
+    EXPECT_FALSE(buffer.Update());
+}
+
+TEST(SpectatorTest, SteppedMatchMatchesPlayedMatch) {
+    HeuristicBot bot;
+    const Bot* seats[2] = {&bot, &bot};
+    MatchConfig config;
+    config.maxFrames = 40 * Game::FRAMES_PER_SECOND;
+
+    MatchArena stepped;
+    stepped.Start(seats, 2, 11, config);
+    uint32_t frames = 0;
+    while (stepped.Step()) ++frames;
+    const MatchResult played = MatchArena().Play(seats, 2, 11, config);
+
+    const MatchResult result = stepped.GetResult();
+    EXPECT_EQ(result.frames, played.frames);
+    EXPECT_EQ(frames + 1, played.frames);
+    EXPECT_EQ(result.players[1].lines, played.players[1].lines);
+    EXPECT_EQ(result.players[0].pieces, played.players[0].pieces);
+    EXPECT_FALSE(stepped.Step());
+}
+
+TEST(SpectatorTest, FeedPublishesLiveBoards) {
+    HeuristicBot bot;
+    SpectatorConfig config;
+    config.matches = 6;
+    config.playersPerMatch = 2;
+    config.threads = 3;
+    config.speed = 0.0;
+    config.match.piecesPerSecond = 10.0;
+    config.match.maxFrames = 5 * Game::FRAMES_PER_SECOND;
+
+    SpectatorFeed feed({&bot}, config);
+    EXPECT_EQ(feed.GetTileCount(), 12u);
+    EXPECT_THROW(feed.GetTile(12), std::out_of_range);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while (feed.GetMatchesPlayed() < 12 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_GE(feed.GetMatchesPlayed(), 12u);
+    feed.Poll();
+
+    // A slot that has just restarted shows an empty board, so look at them all together
+    uint64_t pieces = 0, finished = 0, filled = 0;
+    for (size_t tile = 0; tile < feed.GetTileCount(); ++tile) {
+        const SpectatorTile& view = feed.GetTile(tile);
+        pieces += view.pieces;
+        finished += view.matchesPlayed;
+        filled += std::count_if(view.cells.begin(), view.cells.end(), [](PieceType cell) { return cell != PieceType::EMPTY; });
+    }
+    EXPECT_GT(pieces, 0u);
+    EXPECT_GT(finished, 0u);
+    EXPECT_GT(filled, 0u);
+    EXPECT_THROW(SpectatorFeed({}, config), std::invalid_argument);
+}
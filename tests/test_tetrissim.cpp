@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/TetrisSim.h"
+#include <string>
+#include <vector>
+
+TEST(TetrisSimTest, StepsThroughTheCInterface) {
+    ASSERT_EQ(tetris_sim_abi_version(), static_cast<uint32_t>(TETRIS_SIM_ABI_VERSION));
+    TetrisSim* sim = tetris_sim_create(3, 1, 0, -1.0f);
+    ASSERT_NE(sim, nullptr) << tetris_sim_last_error();
+    ASSERT_EQ(tetris_sim_num_envs(sim), 3u);
+
+    const size_t observationSize = tetris_sim_observation_size();
+    const size_t actionCount = tetris_sim_action_count();
+    std::vector<float> observations(3 * observationSize);
+    std::vector<uint8_t> masks(3 * actionCount);
+    const uint64_t seeds[3] = {1, 2, 3};
+    ASSERT_EQ(tetris_sim_reset(sim, seeds, observations.data(), masks.data()), 0) << tetris_sim_last_error();
+    EXPECT_STREQ(tetris_sim_last_error(), "");
+
+    // Take the first legal action of each env
+    int32_t actions[3];
+    for (size_t env = 0; env < 3; ++env) {
+        actions[env] = -1;
+        for (size_t a = 0; a < actionCount && actions[env] < 0; ++a) {
+            if (masks[env * actionCount + a]) actions[env] = static_cast<int32_t>(a);
+        }
+        ASSERT_GE(actions[env], 0);
+    }
+    float rewards[3];
+    uint8_t dones[3];
+    ASSERT_EQ(tetris_sim_step(sim, actions, observations.data(), rewards, dones, nullptr), 0) << tetris_sim_last_error();
+    for (uint8_t done : dones) EXPECT_EQ(done, 0);
+
+    std::vector<float> encoded(3 * observationSize);
+    ASSERT_EQ(tetris_sim_encode(sim, encoded.data()), 0);
+    EXPECT_EQ(encoded, observations);
+
+    tetris_sim_destroy(sim);
+}
+
+TEST(TetrisSimTest, RejectsNullHandlesAndBuffers) {
+    float rewards[1];
+    uint8_t dones[1];
+    const int32_t actions[1] = {0};
+    EXPECT_EQ(tetris_sim_step(nullptr, actions, nullptr, rewards, dones, nullptr), -1);
+    EXPECT_EQ(std::string(tetris_sim_last_error()), "null TetrisSim handle");
+
+    TetrisSim* sim = tetris_sim_create(1, 1, 0, 0.0f);
+    ASSERT_NE(sim, nullptr);
+    EXPECT_EQ(tetris_sim_reset(sim, nullptr, nullptr, nullptr), -1);
+    EXPECT_EQ(std::string(tetris_sim_last_error()), "null seeds buffer");
+
+    const uint64_t seed = 9;
+    ASSERT_EQ(tetris_sim_reset(sim, &seed, nullptr, nullptr), 0);
+    EXPECT_EQ(tetris_sim_step(sim, nullptr, nullptr, rewards, dones, nullptr), -1);
+    EXPECT_EQ(std::string(tetris_sim_last_error()), "null actions buffer");
+    EXPECT_EQ(tetris_sim_step(sim, actions, nullptr, nullptr, dones, nullptr), -1);
+    EXPECT_EQ(std::string(tetris_sim_last_error()), "null rewards buffer");
+    EXPECT_EQ(tetris_sim_step(sim, actions, nullptr, rewards, nullptr, nullptr), -1);
+    EXPECT_EQ(std::string(tetris_sim_last_error()), "null dones buffer");
+    EXPECT_EQ(tetris_sim_legal_moves(sim, nullptr), -1);
+    EXPECT_EQ(tetris_sim_encode(sim, nullptr), -1);
+    tetris_sim_destroy(sim);
+
+    EXPECT_EQ(tetris_sim_encode_positions(nullptr, nullptr, 1, nullptr), -1);
+    EXPECT_EQ(tetris_sim_encode_positions(nullptr, nullptr, 0, nullptr), 0);
+    EXPECT_EQ(tetris_dataset_next(nullptr, nullptr, nullptr, nullptr), -1);
+    EXPECT_EQ(tetris_sim_create(0, 1, 0, 0.0f), nullptr);
+    EXPECT_NE(std::string(tetris_sim_last_error()), "");
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/Tuner.h"
+#include <cmath>
+#include <filesystem>
+
+using namespace tetris;
+
+namespace {
+    // Maximised at (1, -2, 3, 0.5, -1)
+    double NegativeDistance(const std::vector<double>& x) {
+        const double target[] = {1.0, -2.0, 3.0, 0.5, -1.0};
+        double sum = 0.0;
+        for (size_t i = 0; i < x.size(); ++i) sum += (x[i] - target[i]) * (x[i] - target[i]) * (i + 1);
+        return -sum;
+    }
+
+    void Step(CmaEs& optimizer) {
+        std::vector<double> fitness;
+        for (const std::vector<double>& x : optimizer.Ask()) fitness.push_back(NegativeDistance(x));
+        optimizer.Tell(fitness);
+    }
+}
+
+TEST(TunerTest, CmaEsFindsTheOptimum) {
+    CmaEs optimizer(std::vector<double>(5, 0.0), 0.5, 0, 3);
+    EXPECT_EQ(optimizer.GetPopulationSize(), 8u);
+    for (int generation = 0; generation < 300 && optimizer.GetSigma() > 1e-8; ++generation) Step(optimizer);
+
+    EXPECT_NEAR(optimizer.GetMean()[0], 1.0, 1e-4);
+    EXPECT_NEAR(optimizer.GetMean()[2], 3.0, 1e-4);
+    EXPECT_GT(optimizer.GetBestFitness(), -1e-6);
+    EXPECT_THROW(optimizer.Tell({1.0}), std::invalid_argument);
+    EXPECT_THROW(CmaEs({}, 1.0), std::invalid_argument);
+}
+
+TEST(TunerTest, CheckpointResumesExactly) {
+    TuneConfig config;
+    config.games = 12;
+    config.seed = 77;
+    config.objective = TuneObjective::LINES;
+
+    CmaEs original(std::vector<double>(5, 0.0), 0.5, 6, 9);
+    for (int i = 0; i < 4; ++i) Step(original);
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "tetris_tuner_test.ckpt";
+    SaveTunerCheckpoint(path, original, config);
+
+    TuneConfig loadedConfig;
+    CmaEs resumed = LoadTunerCheckpoint(path, loadedConfig);
+    std::filesystem::remove(path);
+    EXPECT_EQ(loadedConfig.games, 12u);
+    EXPECT_EQ(loadedConfig.seed, 77u);
+    EXPECT_EQ(loadedConfig.objective, TuneObjective::LINES);
+    EXPECT_EQ(resumed.GetGeneration(), 4u);
+
+    for (int i = 0; i < 3; ++i) {
+        Step(original);
+        Step(resumed);
+    }
+    EXPECT_EQ(resumed.GetMean(), original.GetMean());
+    EXPECT_EQ(resumed.GetSigma(), original.GetSigma());
+    EXPECT_EQ(resumed.GetBest(), original.GetBest());
+}
+
+TEST(TunerTest, CandidatesShareGamesAcrossThreadCounts) {
+    TuneConfig config;
+    config.games = 10;
+    config.seed = 5;
+    config.match.piecesPerSecond = 3.0;
+    config.match.maxFrames = 40 * Game::FRAMES_PER_SECOND;
+
+    HeuristicWeights sloppy;
+    sloppy.holes = 0.0f;
+    sloppy.bumpiness = 0.0f;
+    const std::vector<HeuristicWeights> candidates = {HeuristicWeights{}, sloppy, HeuristicWeights{}};
+    EXPECT_EQ(VectorToWeights(WeightsToVector(sloppy)).holes, 0.0f);
+
+    TaskScheduler one(1), four(4);
+    std::vector<double> serial = WeightEvaluator(one, config).Evaluate(candidates);
+    std::vector<double> parallel = WeightEvaluator(four, config).Evaluate(candidates);
+    EXPECT_EQ(serial, parallel);
+    EXPECT_EQ(serial[0], serial[2]);  // same weights, same games, same score
+    EXPECT_GT(serial[0], serial[1]);
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "TetrisEngine/Rules.h"
+#include "TetrisEngine/VecEnv.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace tetris;
+
+TEST(RulesTest, ClearLinesShiftsRowsDown) {
+    uint16_t rows[TOTAL_BOARD_HEIGHT] = {};
+    rows[0] = FULL_ROW_MASK;
+    rows[1] = 0b0000000001;
+    rows[2] = FULL_ROW_MASK;
+    rows[3] = 0b1000000000;
+
+    EXPECT_EQ(ClearLines(rows), 2);
+    EXPECT_EQ(rows[0], 0b0000000001);
+    EXPECT_EQ(rows[1], 0b1000000000);
+    EXPECT_EQ(rows[2], 0);
+}
+
+TEST(RulesTest, HorizontalIDropsToFloor) {
+    uint16_t rows[TOTAL_BOARD_HEIGHT] = {};
+    const PieceShape& shape = GetPieceShape(PieceType::I, RotationState::STATE_0);
+    Point spawn = GetSpawnPosition(PieceType::I);
+
+    ASSERT_TRUE(PieceFits(rows, shape, spawn.x, spawn.y));
+    int y = DropPiece(rows, shape, spawn.x, spawn.y);
+    PlacePiece(rows, shape, spawn.x, y);
+    EXPECT_EQ(rows[0], 0b0001111000);
+}
+
+TEST(RulesTest, TetrisAttackAndBackToBack) {
+    int b2b = 0, combo = 0;
+    EXPECT_EQ(ComputeAttack(0, false, 4, b2b, combo).Total(), 4);
+    EXPECT_EQ(ComputeAttack(0, false, 4, b2b, combo).Total(), 5);
+    EXPECT_EQ(b2b, 2);
+    EXPECT_EQ(combo, 2);
+
+    ComputeAttack(0, false, 0, b2b, combo);
+    EXPECT_EQ(combo, 0);
+}
+
+TEST(VecEnvTest, ResetProducesLegalMoves) {
+    VecEnvConfig config;
+    config.numEnvs = 4;
+    config.threads = 1;
+    VecEnv env(config);
+
+    std::vector<uint64_t> seeds = {1, 2, 3, 4};
+    std::vector<float> obs(env.Size() * VecEnv::OBSERVATION_SIZE);
+    std::vector<uint8_t> masks(env.Size() * VecEnv::ACTION_COUNT);
+    env.Reset(seeds.data(), obs.data(), masks.data());
+
+    for (size_t e = 0; e < env.Size(); ++e) {
+        int legal = std::accumulate(masks.begin() + e * VecEnv::ACTION_COUNT,
+                                    masks.begin() + (e + 1) * VecEnv::ACTION_COUNT, 0);
+        EXPECT_GT(legal, 0);
+        EXPECT_NE(env.GetCurrentPiece(e), PieceType::EMPTY);
+    }
+}
+
+TEST(VecEnvTest, SameSeedsSameTrajectoryAcrossThreadCounts) {
+    auto run = [](size_t threads) {
+        VecEnvConfig config;
+        config.numEnvs = 64;
+        config.threads = threads;
+        config.grain = 8;
+        VecEnv env(config);
+
+        std::vector<uint64_t> seeds(env.Size());
+        std::iota(seeds.begin(), seeds.end(), 100);
+        std::vector<uint8_t> masks(env.Size() * VecEnv::ACTION_COUNT);
+        std::vector<int32_t> actions(env.Size());
+        std::vector<float> rewards(env.Size());
+        std::vector<uint8_t> dones(env.Size());
+        env.Reset(seeds.data(), nullptr, masks.data());
+
+        std::mt19937 rng(7);
+        float total = 0.0f;
+        for (int step = 0; step < 200; ++step) {
+            for (size_t e = 0; e < env.Size(); ++e) {
+                std::vector<int32_t> legal;
+                for (int a = 0; a < VecEnv::ACTION_COUNT; ++a) {
+                    if (masks[e * VecEnv::ACTION_COUNT + a]) legal.push_back(a);
+                }
+                actions[e] = legal.empty() ? 0 : legal[rng() % legal.size()];
+            }
+            env.Step(actions.data(), nullptr, rewards.data(), dones.data(), masks.data());
+            for (float r : rewards) total += r;
+        }
+        std::vector<uint16_t> rows(env.GetRows(0), env.GetRows(0) + TOTAL_BOARD_HEIGHT);
+        return std::make_pair(total, rows);
+    };
+
+    EXPECT_EQ(run(1), run(4));
+}
+
+TEST(VecEnvTest, IllegalActionEndsEpisode) {
+    VecEnvConfig config;
+    config.threads = 1;
+    VecEnv env(config);
+    uint64_t seed = 5;
+    env.Reset(&seed, nullptr, nullptr);
+
+    int32_t action = -1;
+    float reward = 0.0f;
+    uint8_t done = 0;
+    env.Step(&action, nullptr, &reward, &done, nullptr);
+    EXPECT_EQ(done, 1);
+    EXPECT_FLOAT_EQ(reward, config.topOutReward);
+    EXPECT_EQ(env.GetEpisodeCount(0), 1u);
+    EXPECT_TRUE(env.GetLastEpisodeToppedOut(0));
+
+    // Reaching maxPieces is not a top-out
+    config.maxPieces = 1;
+    VecEnv limited(config);
+    std::vector<uint8_t> mask(VecEnv::ACTION_COUNT);
+    limited.Reset(&seed, nullptr, mask.data());
+    action = static_cast<int32_t>(std::find(mask.begin(), mask.end(), 1) - mask.begin());
+    limited.Step(&action, nullptr, &reward, &done, nullptr);
+    EXPECT_EQ(done, 1);
+    EXPECT_FALSE(limited.GetLastEpisodeToppedOut(0));
+}
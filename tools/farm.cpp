@@ -0,0 +1,277 @@
+// tetris_farm: bot-vs-bot and solo games at scale.
+//
+// Plays --games matches on a work-stealing scheduler, one reusable MatchArena
+// per worker, and prints per-bot win rate, Elo, Glicko-2, APM, PPS and lines per
+// game. Match m is seeded from --seed and m alone and results are folded in
+// match order, so a run gives the same numbers on any number of threads. In
+// versus mode every seed is played twice with the seats swapped.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TetrisEngine/Bot.h"
+#include "TetrisEngine/Farm.h"
+#include "TetrisEngine/Metrics.h"
+#include "TetrisEngine/NeuralNetwork.h"
+#include "TetrisEngine/TaskScheduler.h"
+
+using namespace tetris;
+
+namespace {
+    struct Options {
+        std::vector<std::string> players;
+        uint64_t games = 10000;
+        bool solo = false;
+        size_t threads = 0;
+        bool pin = false;
+        uint64_t seed = 0;
+        double piecesPerSecond = 2.0;
+        double gameSeconds = 180.0;
+        uint32_t garbageDelay = DEFAULT_GARBAGE_DELAY_FRAMES;
+        size_t ratingPeriod = 4096;
+        size_t chunk = 16;
+        double eloK = 16.0;
+        std::string metricsPrefix;
+        double metricsInterval = 10.0;
+    };
+
+    void PrintUsage() {
+        std::cout <<
+            "Usage: tetris_farm [options]\n"
+            "  --player SPEC           heuristic, heuristic:WEIGHTS or model:PATH; repeat for each bot\n"
+            "                          (default: one default heuristic bot)\n"
+            "  --games N               Matches to play (default 10000)\n"
+            "  --solo                  Every bot plays alone instead of round-robin versus\n"
+            "  --threads N             Worker threads, 0 = all cores (default 0)\n"
+            "  --pin                   Pin each worker to its own CPU\n"
+            "  --seed N                Base seed; match m always gets the same game (default 0)\n"
+            "  --pps X                 Bot speed in pieces per second of game time (default 2)\n"
+            "  --game-seconds S        Game length cap in game time; versus games hitting it are draws (default 180)\n"
+            "  --garbage-delay F       Frames before garbage lands (default 20)\n"
+            "  --rating-period N       Matches per Glicko-2 rating period (default 4096)\n"
+            "  --chunk N               Matches per scheduled task (default 16)\n"
+            "  --elo-k K               Elo K-factor (default 16)\n"
+            "  --metrics PREFIX        Write latency and throughput metrics to PREFIX.prom and PREFIX.json\n"
+            "  --metrics-interval S    Seconds between metrics exports (default 10)\n";
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            auto is = [&](const char* name) { return std::strcmp(arg, name) == 0 && value && ++i; };
+
+            if (std::strcmp(arg, "--help") == 0)           { PrintUsage(); return false; }
+            else if (std::strcmp(arg, "--solo") == 0)      options.solo = true;
+            else if (std::strcmp(arg, "--pin") == 0)       options.pin = true;
+            else if (is("--player"))                       options.players.push_back(value);
+            else if (is("--games"))                        options.games = std::stoull(value);
+            else if (is("--threads"))                      options.threads = std::stoul(value);
+            else if (is("--seed"))                         options.seed = std::stoull(value);
+            else if (is("--pps"))                          options.piecesPerSecond = std::stod(value);
+            else if (is("--game-seconds"))                 options.gameSeconds = std::stod(value);
+            else if (is("--garbage-delay"))                options.garbageDelay = std::stoul(value);
+            else if (is("--rating-period"))                options.ratingPeriod = std::max<size_t>(1, std::stoul(value));
+            else if (is("--chunk"))                        options.chunk = std::max<size_t>(1, std::stoul(value));
+            else if (is("--elo-k"))                        options.eloK = std::stod(value);
+            else if (is("--metrics"))                      options.metricsPrefix = value;
+            else if (is("--metrics-interval"))             options.metricsInterval = std::stod(value);
+            else {
+                std::cerr << "Unknown or incomplete option " << arg << "\n";
+                PrintUsage();
+                return false;
+            }
+        }
+        if (options.players.empty()) options.players.push_back("heuristic");
+        return true;
+    }
+
+    struct Participant {
+        std::string name;
+        std::unique_ptr<NeuralNetwork> network;
+        std::unique_ptr<Bot> bot;
+    };
+
+    Participant MakeParticipant(const std::string& spec) {
+        Participant participant;
+        participant.name = spec;
+        const size_t colon = spec.find(':');
+        const std::string kind = spec.substr(0, colon);
+        const std::string path = colon == std::string::npos ? std::string() : spec.substr(colon + 1);
+
+        if (kind == "heuristic") {
+            participant.bot = std::make_unique<HeuristicBot>(path.empty() ? HeuristicWeights{} : LoadHeuristicWeights(path));
+        } else if (kind == "model" && !path.empty()) {
+            participant.network = std::make_unique<NeuralNetwork>(path);
+            participant.bot = std::make_unique<NetworkBot>(*participant.network);
+        } else {
+            throw std::runtime_error("Bad --player " + spec + " (heuristic, heuristic:WEIGHTS or model:PATH)");
+        }
+        return participant;
+    }
+
+    // Who sits where in match m
+    struct Schedule {
+        size_t participants;
+        bool solo;
+        std::vector<std::pair<size_t, size_t>> pairs;
+
+        Schedule(size_t count, bool soloGames) : participants(count), solo(soloGames) {
+            if (count == 1) pairs.emplace_back(0, 0);  // mirror match
+            for (size_t a = 0; a < count; ++a) {
+                for (size_t b = a + 1; b < count; ++b) pairs.emplace_back(a, b);
+            }
+        }
+
+        size_t Seats(uint64_t match, size_t* seats) const {
+            if (solo) {
+                seats[0] = match % participants;
+                return 1;
+            }
+            const auto& pair = pairs[(match / 2) % pairs.size()];
+            seats[0] = match % 2 ? pair.second : pair.first;
+            seats[1] = match % 2 ? pair.first : pair.second;
+            return 2;
+        }
+
+        // Both halves of a swapped pair share one game seed
+        uint64_t Seed(uint64_t base, uint64_t match) const {
+            return MatchSeed(base, solo ? match : match / 2);
+        }
+    };
+
+    void PrintTable(const std::vector<Participant>& participants, const FarmStats& stats, bool solo) {
+        std::cout << std::left << std::setw(28) << "bot" << std::right
+                  << std::setw(10) << "games";
+        if (!solo) std::cout << std::setw(8) << "win%" << std::setw(9) << "elo" << std::setw(9) << "glicko" << std::setw(6) << "rd";
+        std::cout << std::setw(8) << "apm" << std::setw(7) << "pps" << std::setw(10) << "lines/g" << "\n";
+
+        for (size_t i = 0; i < participants.size(); ++i) {
+            const ParticipantStats& p = stats.GetParticipants()[i];
+            std::cout << std::left << std::setw(28) << participants[i].name.substr(0, 27) << std::right
+                      << std::setw(10) << p.games << std::fixed;
+            if (!solo) {
+                std::cout << std::setprecision(1) << std::setw(8) << 100.0 * p.WinRate()
+                          << std::setprecision(0) << std::setw(9) << p.elo << std::setw(9) << p.glicko.rating
+                          << std::setw(6) << p.glicko.deviation;
+            }
+            std::cout << std::setprecision(1) << std::setw(8) << p.AttackPerMinute()
+                      << std::setprecision(2) << std::setw(7) << p.PiecesPerSecond()
+                      << std::setprecision(1) << std::setw(10) << p.LinesPerGame() << "\n";
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        if (!ParseOptions(argc, argv, options)) return 1;
+    } catch (const std::exception&) {
+        std::cerr << "Bad option value\n";
+        return 1;
+    }
+
+    std::vector<Participant> participants;
+    try {
+        for (const std::string& spec : options.players) participants.push_back(MakeParticipant(spec));
+    } catch (const std::exception& e) {
+        std::cerr << "Bot setup failed: " << e.what() << std::endl;
+        return 1;
+    }
+    std::unique_ptr<metrics::MetricsExporter> exporter;
+    if (!options.metricsPrefix.empty()) {
+        try {
+            exporter = std::make_unique<metrics::MetricsExporter>(metrics::MetricsExportOptions{
+                options.metricsPrefix + ".prom", options.metricsPrefix + ".json", options.metricsInterval});
+        } catch (const std::exception& e) {
+            std::cerr << "Bad metrics settings: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<const Bot*> bots;
+    for (const Participant& participant : participants) bots.push_back(participant.bot.get());
+
+    MatchConfig config;
+    config.piecesPerSecond = options.piecesPerSecond;
+    config.maxFrames = static_cast<uint32_t>(options.gameSeconds * Game::FRAMES_PER_SECOND);
+    config.garbageDelayFrames = options.garbageDelay;
+
+    const Schedule schedule(participants.size(), options.solo);
+    TaskScheduler scheduler(options.threads, options.pin);
+    std::vector<MatchArena> arenas(scheduler.Size());
+    FarmStats stats(participants.size(), options.eloK);
+
+    std::cout << "Farm: " << options.games << (options.solo ? " solo" : " versus") << " games, "
+              << participants.size() << " bots, " << scheduler.Size() << " threads"
+              << (options.pin ? " (pinned)" : "") << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto lastReport = start;
+    uint64_t pieces = 0;
+    std::vector<MatchResult> results;
+
+    // One rating period at a time: play it in parallel, then fold it in match order
+    for (uint64_t first = 0; first < options.games; first += options.ratingPeriod) {
+        const uint64_t count = std::min<uint64_t>(options.ratingPeriod, options.games - first);
+        results.assign(count, MatchResult{});
+
+        for (uint64_t begin = 0; begin < count; begin += options.chunk) {
+            const uint64_t end = std::min<uint64_t>(begin + options.chunk, count);
+            scheduler.Submit([&, begin, end](size_t worker) {
+                MatchArena& arena = arenas[worker];
+                for (uint64_t i = begin; i < end; ++i) {
+                    const uint64_t match = first + i;
+                    size_t seats[MATCH_MAX_PLAYERS];
+                    const Bot* seated[MATCH_MAX_PLAYERS];
+                    size_t players = schedule.Seats(match, seats);
+                    for (size_t s = 0; s < players; ++s) seated[s] = bots[seats[s]];
+                    results[i] = arena.Play(seated, players, schedule.Seed(options.seed, match), config);
+                }
+            });
+        }
+        try {
+            scheduler.Wait();
+        } catch (const std::exception& e) {
+            std::cerr << "Match failed: " << e.what() << std::endl;
+            return 1;
+        }
+
+        for (uint64_t i = 0; i < count; ++i) {
+            size_t seats[MATCH_MAX_PLAYERS];
+            schedule.Seats(first + i, seats);
+            stats.Add(results[i], seats);
+            for (size_t s = 0; s < results[i].playerCount; ++s) pieces += results[i].players[s].pieces;
+        }
+        if (!options.solo) stats.EndRatingPeriod();
+
+        const auto now = Clock::now();
+        if (std::chrono::duration<double>(now - lastReport).count() >= 1.0) {
+            const double elapsed = std::chrono::duration<double>(now - start).count();
+            std::cout << std::fixed << std::setprecision(0)
+                      << "[" << elapsed << "s] " << stats.GetGames() << " games, "
+                      << stats.GetGames() / elapsed << " games/s, " << pieces / elapsed << " pieces/s, "
+                      << scheduler.GetSteals() << " steals" << std::endl;
+            lastReport = now;
+        }
+    }
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(1)
+              << "Done: " << stats.GetGames() << " games in " << elapsed << " s ("
+              << std::setprecision(0) << stats.GetGames() / elapsed << " games/s, "
+              << pieces / elapsed << " simulated pieces/s)\n\n";
+    PrintTable(participants, stats, options.solo);
+    if (exporter) {
+        exporter->Stop();
+        if (!exporter->GetLastError().empty()) std::cerr << "Metrics export failed: " << exporter->GetLastError() << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,298 @@
+// tetris_selfplay: headless game generation for training data.
+//
+// Runs --envs games side by side on a VecEnv, lets a bot choose every placement
+// and streams the finished games to shard files (see docs/selfplay_format.md).
+// Games still running when generation stops are dropped, since their outcome is
+// unknown.
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TetrisEngine/Bot.h"
+#include "TetrisEngine/NeuralNetwork.h"
+#include "TetrisEngine/SelfPlayShard.h"
+#include "TetrisEngine/ThreadPool.h"
+#include "TetrisEngine/VecEnv.h"
+
+using namespace tetris;
+
+namespace {
+    struct Options {
+        std::string bot = "heuristic";
+        std::string weightsPath;
+        std::string modelPath;
+        std::string outDir = "data/selfplay";
+        std::string prefix = "shard";
+        size_t envs = 256;
+        size_t threads = 0;
+        uint32_t maxPieces = 500;
+        uint64_t positions = 1000000;
+        double seconds = 0.0;
+        size_t recordsPerShard = 65536;
+        float temperature = 1.0f;
+        uint64_t seed = 0;
+    };
+
+    void PrintUsage() {
+        std::cout <<
+            "Usage: tetris_selfplay [options]\n"
+            "  --bot heuristic|model   Move chooser (default heuristic)\n"
+            "  --weights PATH          Heuristic weights file (name = value lines)\n"
+            "  --model PATH            ONNX value model, required for --bot model\n"
+            "  --envs N                Games played side by side (default 256)\n"
+            "  --threads N             Worker threads, 0 = all cores (default 0)\n"
+            "  --max-pieces N          End a game after N pieces, 1 to 65536 (default 500)\n"
+            "  --positions N           Stop after N recorded positions (default 1000000)\n"
+            "  --seconds S             Stop after S seconds instead, if set\n"
+            "  --temperature T         Softmax temperature for move sampling, 0 = greedy (default 1)\n"
+            "  --records-per-shard N   Positions per shard file (default 65536)\n"
+            "  --out DIR               Output directory (default data/selfplay)\n"
+            "  --prefix NAME           Shard file prefix (default shard)\n"
+            "  --seed N                Seed for pieces and sampling (default 0)\n";
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            auto is = [&](const char* name) { return std::strcmp(arg, name) == 0 && value && ++i; };
+
+            if (std::strcmp(arg, "--help") == 0)           { PrintUsage(); return false; }
+            else if (is("--bot"))                          options.bot = value;
+            else if (is("--weights"))                      options.weightsPath = value;
+            else if (is("--model"))                        options.modelPath = value;
+            else if (is("--envs"))                         options.envs = std::stoul(value);
+            else if (is("--threads"))                      options.threads = std::stoul(value);
+            else if (is("--max-pieces"))                   options.maxPieces = std::stoul(value);
+            else if (is("--positions"))                    options.positions = std::stoull(value);
+            else if (is("--seconds"))                      options.seconds = std::stod(value);
+            else if (is("--temperature"))                  options.temperature = std::stof(value);
+            else if (is("--records-per-shard"))            options.recordsPerShard = std::stoul(value);
+            else if (is("--out"))                          options.outDir = value;
+            else if (is("--prefix"))                       options.prefix = value;
+            else if (is("--seed"))                         options.seed = std::stoull(value);
+            else {
+                std::cerr << "Unknown or incomplete option " << arg << "\n";
+                PrintUsage();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Softmax over the legal actions; temperature 0 puts all mass on the best one
+    void ScoresToPolicy(const float* scores, const uint8_t* mask, float temperature, float* policy) {
+        int best = -1;
+        for (int a = 0; a < BOT_ACTION_COUNT; ++a) {
+            if (mask[a] && std::isfinite(scores[a]) && (best < 0 || scores[a] > scores[best])) best = a;
+        }
+        std::fill_n(policy, BOT_ACTION_COUNT, 0.0f);
+        if (best < 0) return;
+        if (temperature <= 0.0f) {
+            policy[best] = 1.0f;
+            return;
+        }
+
+        float total = 0.0f;
+        for (int a = 0; a < BOT_ACTION_COUNT; ++a) {
+            if (!mask[a] || !std::isfinite(scores[a])) continue;
+            policy[a] = std::exp((scores[a] - scores[best]) / temperature);
+            total += policy[a];
+        }
+        for (int a = 0; a < BOT_ACTION_COUNT; ++a) policy[a] /= total;
+    }
+
+    // -1 if the policy is empty, i.e. no legal action had a finite score
+    int SampleAction(const float* policy, std::mt19937_64& rng) {
+        float target = std::uniform_real_distribution<float>(0.0f, 1.0f)(rng);
+        int last = -1;
+        for (int a = 0; a < BOT_ACTION_COUNT; ++a) {
+            if (policy[a] <= 0.0f) continue;
+            last = a;
+            target -= policy[a];
+            if (target < 0.0f) return a;
+        }
+        return last;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        if (!ParseOptions(argc, argv, options)) return 1;
+    } catch (const std::exception&) {
+        std::cerr << "Bad option value\n";
+        return 1;
+    }
+    // Records number their moves in 16 bits, so games must end
+    if (options.maxPieces == 0 || options.maxPieces > std::numeric_limits<uint16_t>::max() + 1u) {
+        std::cerr << "--max-pieces must be between 1 and " << std::numeric_limits<uint16_t>::max() + 1u << "\n";
+        return 1;
+    }
+
+    std::unique_ptr<NeuralNetwork> network;
+    std::unique_ptr<Bot> bot;
+    try {
+        if (options.bot == "heuristic") {
+            HeuristicWeights weights = options.weightsPath.empty() ? HeuristicWeights{} : LoadHeuristicWeights(options.weightsPath);
+            bot = std::make_unique<HeuristicBot>(weights);
+        } else if (options.bot == "model") {
+            if (options.modelPath.empty()) {
+                std::cerr << "--bot model needs --model PATH\n";
+                return 1;
+            }
+            network = std::make_unique<NeuralNetwork>(options.modelPath);
+            bot = std::make_unique<NetworkBot>(*network);
+        } else {
+            std::cerr << "Unknown bot " << options.bot << "\n";
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Bot setup failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    VecEnvConfig config;
+    config.numEnvs = options.envs;
+    config.threads = options.threads;
+    config.maxPieces = options.maxPieces;
+    VecEnv env(config);
+    ThreadPool pool(options.threads);
+
+    const size_t envCount = env.Size();
+    std::vector<uint64_t> seeds(envCount);
+    std::vector<std::mt19937_64> rngs;
+    rngs.reserve(envCount);
+    for (size_t e = 0; e < envCount; ++e) {
+        seeds[e] = options.seed * envCount + e;
+        rngs.emplace_back(seeds[e] ^ 0x5eedf00dull);
+    }
+
+    std::vector<uint8_t> masks(envCount * VecEnv::ACTION_COUNT);
+    std::vector<int32_t> actions(envCount);
+    std::vector<float> rewards(envCount);
+    std::vector<uint8_t> dones(envCount);
+    std::vector<std::vector<SelfPlayRecord>> games(envCount);
+    env.Reset(seeds.data(), nullptr, masks.data());
+
+    const uint8_t botFlag = network ? RECORD_MODEL_BOT : 0;
+    ShardWriter writer(options.outDir, options.recordsPerShard, options.prefix);
+    std::cout << "Self-play: " << envCount << " envs, " << pool.Size() << " threads, bot " << bot->GetName()
+              << ", writing to " << writer.GetDirectory().string() << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto lastReport = start;
+    uint64_t positions = 0;
+    uint64_t positionsAtReport = 0;
+    uint64_t gamesFinished = 0;
+    uint64_t nextGameId = 0;
+
+    while (true) {
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (options.seconds > 0.0 ? elapsed >= options.seconds : positions >= options.positions) break;
+
+        // Choose a move in every env and record the position it was chosen from
+        pool.ParallelFor(envCount, 8, [&](size_t begin, size_t end) {
+            float scores[BOT_ACTION_COUNT];
+            float policy[BOT_ACTION_COUNT];
+            for (size_t e = begin; e < end; ++e) {
+                const uint8_t* mask = &masks[e * VecEnv::ACTION_COUNT];
+                BotPosition position;
+                position.rows = env.GetRows(e);
+                position.current = env.GetCurrentPiece(e);
+                position.hold = env.GetHeldPiece(e);
+                env.GetNextQueue(e, position.next.data());
+                position.backToBack = env.GetBackToBack(e);
+                position.combo = env.GetCombo(e);
+
+                bot->ScoreActions(position, mask, scores);
+                ScoresToPolicy(scores, mask, options.temperature, policy);
+                int action = SampleAction(policy, rngs[e]);
+                actions[e] = action;
+                // Nothing to choose: the env ends the game as a top-out and the position is not recorded
+                if (action < 0) continue;
+
+                SelfPlayRecord& record = games[e].emplace_back();
+                std::copy_n(position.rows, VISIBLE_BOARD_HEIGHT, record.rows.begin());
+                record.pieces[0] = static_cast<uint8_t>(position.current);
+                record.pieces[1] = static_cast<uint8_t>(position.hold);
+                for (size_t i = 0; i < FEATURE_NEXT_PIECES; ++i) record.pieces[2 + i] = static_cast<uint8_t>(position.next[i]);
+                record.moveNumber = static_cast<uint16_t>(games[e].size() - 1);
+                record.action = static_cast<int16_t>(action);
+                record.flags = botFlag;
+                for (int a = 0; a < BOT_ACTION_COUNT; ++a) {
+                    record.policy[a] = static_cast<uint16_t>(std::lround(policy[a] * 65535.0f));
+                }
+            }
+        });
+
+        env.Step(actions.data(), nullptr, rewards.data(), dones.data(), masks.data());
+
+        for (size_t e = 0; e < envCount; ++e) {
+            std::vector<SelfPlayRecord>& game = games[e];
+            if (actions[e] >= 0) {
+                game.back().reward = rewards[e];
+                ++positions;
+            } else if (!game.empty()) {
+                // The previous move led into a dead end, so it takes the top-out penalty
+                game.back().reward += rewards[e];
+            }
+            if (!dones[e] || game.empty()) continue;
+
+            // Outcome is the return from each position to the end of its game
+            const bool toppedOut = env.GetLastEpisodeToppedOut(e);
+            float outcome = 0.0f;
+            for (size_t i = game.size(); i-- > 0;) {
+                outcome += game[i].reward;
+                game[i].outcome = outcome;
+                game[i].gameId = nextGameId;
+                game[i].gameLength = static_cast<uint32_t>(game.size());
+                if (toppedOut) game[i].flags |= RECORD_TOPPED_OUT;
+            }
+            ++nextGameId;
+            ++gamesFinished;
+            writer.Append(game.data(), game.size());
+            game.clear();
+        }
+
+        const auto now = Clock::now();
+        const double sinceReport = std::chrono::duration<double>(now - lastReport).count();
+        if (sinceReport >= 1.0) {
+            const ShardWriterStats stats = writer.GetStats();
+            const double total = std::chrono::duration<double>(now - start).count();
+            std::cout << std::fixed << std::setprecision(0)
+                      << "[" << total << "s] " << (positions - positionsAtReport) / sinceReport << " positions/s, "
+                      << positions << " positions, " << gamesFinished << " games, "
+                      << stats.shardsWritten << " shards, " << stats.bufferedRecords << " buffered, "
+                      << std::setprecision(1) << "writer wait " << 100.0 * stats.producerWaitSeconds / total << "%"
+                      << std::endl;
+            lastReport = now;
+            positionsAtReport = positions;
+        }
+    }
+
+    try {
+        writer.Close();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    const ShardWriterStats stats = writer.GetStats();
+    const double total = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(1)
+              << "Done: " << stats.recordsWritten << " positions from " << gamesFinished << " games in "
+              << stats.shardsWritten << " shards (" << stats.bytesWritten / (1024.0 * 1024.0) << " MiB), "
+              << std::setprecision(0) << positions / total << " positions/s, "
+              << std::setprecision(2) << stats.producerWaitSeconds << " s waiting on the writer" << std::endl;
+    return 0;
+}
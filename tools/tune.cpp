@@ -0,0 +1,176 @@
+// tetris_tune: CMA-ES search for HeuristicBot weights.
+//
+// Every generation samples a population of weight vectors and scores each one by
+// its mean attack (or lines) over --games headless solo games. All candidates of
+// a run play the same seeded games, so they are compared on identical piece
+// sequences. The optimiser is checkpointed after every generation and the best
+// weights so far are written where `--player heuristic:PATH` and the game load them.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TetrisEngine/Bot.h"
+#include "TetrisEngine/TaskScheduler.h"
+#include "TetrisEngine/Tuner.h"
+
+using namespace tetris;
+
+namespace {
+    struct Options {
+        uint64_t generations = 100;
+        size_t population = 0;
+        double sigma = 0.2;
+        std::string start;
+        std::string out = "tuned_weights.txt";
+        std::string checkpoint = "tune.ckpt";
+        bool resume = false;
+        size_t threads = 0;
+        bool pin = false;
+        TuneConfig config;
+    };
+
+    void PrintUsage() {
+        std::cout <<
+            "Usage: tetris_tune [options]\n"
+            "  --generations N         Generations to run, counting any resumed ones (default 100)\n"
+            "  --population N          Candidates per generation, 0 = 4 + 3 ln(weights) (default 0)\n"
+            "  --sigma X               Initial step size (default 0.2)\n"
+            "  --start WEIGHTS         Weights file to start from (default: built-in weights)\n"
+            "  --out PATH              Best weights so far (default tuned_weights.txt)\n"
+            "  --checkpoint PATH       Optimiser state, rewritten every generation (default tune.ckpt)\n"
+            "  --resume                Continue from --checkpoint with the settings it was made with\n"
+            "  --games N               Games per candidate, the same for every candidate (default 64)\n"
+            "  --objective NAME        attack or lines per game (default attack)\n"
+            "  --seed N                Seeds both the games and the sampling (default 0)\n"
+            "  --pps X                 Bot speed in pieces per second of game time (default 2)\n"
+            "  --game-seconds S        Game length cap in game time (default 180)\n"
+            "  --threads N             Worker threads, 0 = all cores (default 0)\n"
+            "  --pin                   Pin each worker to its own CPU\n";
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            auto is = [&](const char* name) { return std::strcmp(arg, name) == 0 && value && ++i; };
+
+            if (std::strcmp(arg, "--help") == 0)           { PrintUsage(); return false; }
+            else if (std::strcmp(arg, "--resume") == 0)    options.resume = true;
+            else if (std::strcmp(arg, "--pin") == 0)       options.pin = true;
+            else if (is("--generations"))                  options.generations = std::stoull(value);
+            else if (is("--population"))                   options.population = std::stoul(value);
+            else if (is("--sigma"))                        options.sigma = std::stod(value);
+            else if (is("--start"))                        options.start = value;
+            else if (is("--out"))                          options.out = value;
+            else if (is("--checkpoint"))                   options.checkpoint = value;
+            else if (is("--games"))                        options.config.games = static_cast<uint32_t>(std::stoul(value));
+            else if (is("--seed"))                         options.config.seed = std::stoull(value);
+            else if (is("--pps"))                          options.config.match.piecesPerSecond = std::stod(value);
+            else if (is("--game-seconds"))                 options.config.match.maxFrames = static_cast<uint32_t>(std::stod(value) * Game::FRAMES_PER_SECOND);
+            else if (is("--threads"))                      options.threads = std::stoul(value);
+            else if (is("--objective")) {
+                if (std::strcmp(value, "attack") == 0)     options.config.objective = TuneObjective::ATTACK;
+                else if (std::strcmp(value, "lines") == 0) options.config.objective = TuneObjective::LINES;
+                else throw std::invalid_argument("objective");
+            }
+            else {
+                std::cerr << "Unknown or incomplete option " << arg << "\n";
+                PrintUsage();
+                return false;
+            }
+        }
+        if (options.config.games == 0) {
+            std::cerr << "--games must be at least 1\n";
+            return false;
+        }
+        return true;
+    }
+
+    void PrintWeights(const std::vector<double>& vector) {
+        const HeuristicWeights weights = VectorToWeights(vector);
+        std::cout << std::setprecision(4)
+                  << "  aggregate_height " << weights.aggregateHeight << ", lines " << weights.lines
+                  << ", holes " << weights.holes << ", bumpiness " << weights.bumpiness
+                  << ", attack " << weights.attack << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        if (!ParseOptions(argc, argv, options)) return 1;
+    } catch (const std::exception&) {
+        std::cerr << "Bad option value\n";
+        return 1;
+    }
+
+    std::unique_ptr<CmaEs> optimizer;
+    try {
+        if (options.resume) {
+            optimizer = std::make_unique<CmaEs>(LoadTunerCheckpoint(options.checkpoint, options.config));
+        } else {
+            HeuristicWeights start = options.start.empty() ? HeuristicWeights{} : LoadHeuristicWeights(options.start);
+            optimizer = std::make_unique<CmaEs>(WeightsToVector(start), options.sigma, options.population, options.config.seed);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Tuner setup failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    TaskScheduler scheduler(options.threads, options.pin);
+    WeightEvaluator evaluator(scheduler, options.config);
+
+    std::cout << "Tune: " << optimizer->GetPopulationSize() << " candidates x " << options.config.games << " games, "
+              << (options.config.objective == TuneObjective::LINES ? "lines" : "attack") << " per game, "
+              << scheduler.Size() << " threads";
+    if (optimizer->GetGeneration() > 0) std::cout << ", resuming at generation " << optimizer->GetGeneration();
+    std::cout << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    while (optimizer->GetGeneration() < options.generations) {
+        const auto start = Clock::now();
+        const std::vector<std::vector<double>>& population = optimizer->Ask();
+        std::vector<HeuristicWeights> candidates;
+        for (const std::vector<double>& vector : population) candidates.push_back(VectorToWeights(vector));
+
+        std::vector<double> fitness;
+        try {
+            fitness = evaluator.Evaluate(candidates);
+        } catch (const std::exception& e) {
+            std::cerr << "Evaluation failed: " << e.what() << std::endl;
+            return 1;
+        }
+
+        const double previousBest = optimizer->GetBest().empty() ? -1.0 : optimizer->GetBestFitness();
+        const double generationBest = *std::max_element(fitness.begin(), fitness.end());
+        optimizer->Tell(fitness);
+
+        try {
+            if (optimizer->GetBestFitness() > previousBest) SaveHeuristicWeights(options.out, VectorToWeights(optimizer->GetBest()));
+            SaveTunerCheckpoint(options.checkpoint, *optimizer, options.config);
+        } catch (const std::exception& e) {
+            std::cerr << "Saving failed: " << e.what() << std::endl;
+            return 1;
+        }
+
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << std::fixed << std::setprecision(2)
+                  << "gen " << optimizer->GetGeneration() << ": best " << generationBest
+                  << ", all-time " << optimizer->GetBestFitness() << ", sigma " << std::setprecision(4) << optimizer->GetSigma()
+                  << std::setprecision(1) << " (" << candidates.size() * options.config.games / seconds << " games/s)" << std::endl;
+    }
+
+    if (optimizer->GetBest().empty()) return 0;
+    std::cout << "\nBest " << std::setprecision(2) << optimizer->GetBestFitness() << " per game, written to " << options.out << "\n";
+    PrintWeights(optimizer->GetBest());
+    std::cout << "Final mean:\n";
+    PrintWeights(optimizer->GetMean());
+    return 0;
+}